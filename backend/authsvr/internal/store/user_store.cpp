@@ -3,7 +3,7 @@
  * @brief RocksDB 用户存储实现
  *
  * Key 设计：
- *   user:{user_id}          -> UserData JSON
+ *   user:{user_id}          -> UserData（二进制记录，兼容读旧 JSON）
  *   username:{username}     -> user_id（用于登录时根据用户名查找）
  */
 
@@ -12,6 +12,7 @@
 #include <rocksdb/db.h>
 #include <rocksdb/iterator.h>
 #include <rocksdb/write_batch.h>
+#include <swift/record_codec.h>
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
@@ -21,28 +22,15 @@ using json = nlohmann::json;
 namespace swift::auth {
 
 // ============================================================================
-// JSON 序列化/反序列化
+// 序列化/反序列化：写二进制记录（swift/record_codec.h），读兼容旧版 JSON
 // ============================================================================
 
 namespace {
 
-/// UserData -> JSON string
-std::string SerializeUser(const UserData &user) {
-  json j;
-  j["user_id"] = user.user_id;
-  j["username"] = user.username;
-  j["password_hash"] = user.password_hash;
-  j["nickname"] = user.nickname;
-  j["avatar_url"] = user.avatar_url;
-  j["signature"] = user.signature;
-  j["gender"] = user.gender;
-  j["created_at"] = user.created_at;
-  j["updated_at"] = user.updated_at;
-  return j.dump();
-}
+constexpr uint8_t kUserRecordVersion = 1;
 
-/// JSON string -> UserData
-UserData DeserializeUser(const std::string &data) {
+/// 旧版 JSON 记录 -> UserData
+UserData DeserializeUserJson(const std::string &data) {
   json j = json::parse(data);
   UserData user;
   user.user_id = j.value("user_id", "");
@@ -52,8 +40,42 @@ UserData DeserializeUser(const std::string &data) {
   user.avatar_url = j.value("avatar_url", "");
   user.signature = j.value("signature", "");
   user.gender = j.value("gender", 0);
-  user.created_at = j.value("created_at", 0);
-  user.updated_at = j.value("updated_at", 0);
+  user.created_at = j.value("created_at", static_cast<int64_t>(0));
+  user.updated_at = j.value("updated_at", static_cast<int64_t>(0));
+  return user;
+}
+
+/// UserData -> 二进制记录（字段顺序固定，只能在末尾追加）
+std::string SerializeUser(const UserData &user) {
+  return swift::record::Writer(kUserRecordVersion, 128)
+      .Str(user.user_id)
+      .Str(user.username)
+      .Str(user.password_hash)
+      .Str(user.nickname)
+      .Str(user.avatar_url)
+      .Str(user.signature)
+      .I64(user.gender)
+      .I64(user.created_at)
+      .I64(user.updated_at)
+      .Finish();
+}
+
+/// 二进制记录或旧版 JSON -> UserData；损坏时抛异常
+UserData DeserializeUser(const std::string &data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeUserJson(data);
+  UserData user;
+  swift::record::Reader r(data);
+  r.Str(&user.user_id)
+      .Str(&user.username)
+      .Str(&user.password_hash)
+      .Str(&user.nickname)
+      .Str(&user.avatar_url)
+      .Str(&user.signature)
+      .I32(&user.gender)
+      .I64(&user.created_at)
+      .I64(&user.updated_at);
+  r.Check("user");
   return user;
 }
 
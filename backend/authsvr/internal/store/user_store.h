@@ -26,7 +26,7 @@ struct UserData {
  * 用户存储接口
  *
  * RocksDB Key 设计：
- *   user:{user_id}          -> UserData (JSON)
+ *   user:{user_id}          -> UserData (二进制记录，兼容读旧 JSON)
  *   username:{username}     -> user_id (用于登录查询)
  */
 class UserStore {
@@ -24,6 +24,7 @@
 #include "handler/group_handler.h"
 #include "service/chat_service.h"
 #include "service/group_service.h"
+#include "store/chat_db.h"
 #include "store/group_store.h"
 #include "store/message_store.h"
 
@@ -64,10 +65,9 @@ int main(int argc, char* argv[]) {
   LogInfo("Using config file: " << (config_file.empty() ? "<empty>" : config_file));
 
   swift::chat::ChatConfig config = swift::chat::LoadConfig(config_file);
-  std::string group_db_path = config.rocksdb_path + "/group";
-  std::string message_db_path = config.rocksdb_path + "/message";
-  std::string conv_db_path = config.rocksdb_path + "/conv";
-  std::string conv_meta_db_path = config.rocksdb_path + "/conv_meta";
+  std::string chat_db_path = config.rocksdb_path + "/chatdb";
+  // 旧版按 store 分开的库，导入到 chatdb 写入完成标记为止（中断后下次启动重跑）
+  const std::string legacy_db_names[] = {"group", "message", "conv", "conv_meta"};
   LogInfo("Config: host=" << config.host << " port=" << config.port
           << " rocksdb=" << config.rocksdb_path);
 
@@ -86,41 +86,71 @@ int main(int argc, char* argv[]) {
   };
 
   logPathInfo("RocksDB base dir", config.rocksdb_path);
-  logPathInfo("RocksDB group path", group_db_path);
-  logPathInfo("RocksDB message path", message_db_path);
-  logPathInfo("RocksDB conv path", conv_db_path);
-  logPathInfo("RocksDB conv_meta path", conv_meta_db_path);
+  logPathInfo("RocksDB chat path", chat_db_path);
 
-  // 群组存储与服务
-  std::shared_ptr<swift::group_::GroupStore> group_store;
+  // 消息、会话、群组共用一个 RocksDB（列族见 store/chat_db.h）
+  std::shared_ptr<swift::chat::ChatDB> chat_db;
   try {
-    group_store = std::make_shared<swift::group_::RocksDBGroupStore>(group_db_path);
-    LogInfo("RocksDB opened (group): " << group_db_path);
+    swift::chat::ChatDBOptions db_options;
+    db_options.block_cache_mb = config.rocksdb_block_cache_mb;
+    db_options.write_buffer_mb = config.rocksdb_write_buffer_mb;
+    db_options.max_background_jobs = config.rocksdb_max_background_jobs;
+    db_options.bloom_bits_per_key = config.rocksdb_bloom_bits_per_key;
+    db_options.dedup_ttl_ms = static_cast<int64_t>(config.client_msg_dedup_ttl_seconds) * 1000;
+    if (!swift::chat::ParseDurability(config.rocksdb_durability, &db_options.write.durability)) {
+      LogError("Invalid rocksdb_durability: " << config.rocksdb_durability
+               << " (expected sync, group_commit or wal_no_sync)");
+      swift::log::Shutdown();
+      return 1;
+    }
+    db_options.write.group_commit_max_delay_us = config.rocksdb_group_commit_max_delay_us;
+    db_options.write.group_commit_max_batch = config.rocksdb_group_commit_max_batch;
+    db_options.write.wal_flush_interval_ms = config.rocksdb_wal_flush_interval_ms;
+    chat_db = swift::chat::ChatDB::Open(chat_db_path, db_options);
+    LogInfo("RocksDB opened (chat): " << chat_db_path
+            << " block_cache_mb=" << config.rocksdb_block_cache_mb
+            << " write_buffer_mb=" << config.rocksdb_write_buffer_mb
+            << " durability=" << swift::chat::DurabilityName(db_options.write.durability));
   } catch (const std::exception& e) {
-    LogError("Failed to open RocksDB (group): " << e.what());
+    LogError("Failed to open RocksDB (chat): " << e.what());
     LogError("Hint: check that the underlying volume is mounted and writable. "
              "rocksdb_path=" << config.rocksdb_path
-             << " group_db_path=" << group_db_path);
+             << " chat_db_path=" << chat_db_path);
     swift::log::Shutdown();
     return 1;
   }
 
-  // 消息与会话存储（ChatServiceCore 依赖）
-  std::shared_ptr<swift::chat::MessageStore> msg_store;
-  std::shared_ptr<swift::chat::ConversationStore> conv_store;
-  std::shared_ptr<swift::chat::ConversationRegistry> conv_registry;
-  try {
-    msg_store = std::make_shared<swift::chat::RocksDBMessageStore>(message_db_path);
-    conv_store = std::make_shared<swift::chat::RocksDBConversationStore>(conv_db_path);
-    conv_registry = std::make_shared<swift::chat::RocksDBConversationRegistry>(conv_meta_db_path);
-    LogInfo("RocksDB opened: message=" << message_db_path
-            << " conv=" << conv_db_path << " conv_meta=" << conv_meta_db_path);
-  } catch (const std::exception& e) {
-    LogError("Failed to open RocksDB (message/conv): " << e.what());
-    swift::log::Shutdown();
-    return 1;
+  if (!chat_db->LegacyImported()) {
+    for (const auto& name : legacy_db_names) {
+      std::string legacy_path = config.rocksdb_path + "/" + name;
+      std::error_code ec;
+      if (!fs::is_directory(legacy_path, ec))
+        continue;
+      int64_t imported = chat_db->ImportLegacy(legacy_path);
+      if (imported < 0) {
+        // 未写完成标记，重启即重新导入
+        LogError("Failed to import legacy RocksDB: " << legacy_path << " (restart to retry)");
+        swift::log::Shutdown();
+        return 1;
+      }
+      LogInfo("Imported legacy RocksDB: " << legacy_path << " keys=" << imported);
+    }
+    if (!chat_db->MarkLegacyImported()) {
+      LogError("Failed to mark legacy RocksDB import done: " << chat_db_path);
+      swift::log::Shutdown();
+      return 1;
+    }
   }
 
+  std::shared_ptr<swift::group_::GroupStore> group_store =
+      std::make_shared<swift::group_::RocksDBGroupStore>(chat_db);
+  std::shared_ptr<swift::chat::MessageStore> msg_store =
+      std::make_shared<swift::chat::RocksDBMessageStore>(chat_db);
+  std::shared_ptr<swift::chat::ConversationStore> conv_store =
+      std::make_shared<swift::chat::RocksDBConversationStore>(chat_db);
+  std::shared_ptr<swift::chat::ConversationRegistry> conv_registry =
+      std::make_shared<swift::chat::RocksDBConversationRegistry>(chat_db);
+
   auto group_service = std::make_shared<swift::group_::GroupService>(group_store);
   auto chat_service = std::make_shared<swift::chat::ChatServiceCore>(
       msg_store, conv_store, conv_registry, group_store);
@@ -17,10 +17,19 @@ ChatConfig LoadConfig(const std::string& config_file) {
     config.store_type = kv.Get("store_type", "rocksdb");
     config.rocksdb_path = kv.Get("rocksdb_path", "/data/chat");
     config.mysql_dsn = kv.Get("mysql_dsn", "");
+    config.rocksdb_block_cache_mb = kv.GetInt("rocksdb_block_cache_mb", 256);
+    config.rocksdb_write_buffer_mb = kv.GetInt("rocksdb_write_buffer_mb", 128);
+    config.rocksdb_max_background_jobs = kv.GetInt("rocksdb_max_background_jobs", 4);
+    config.rocksdb_bloom_bits_per_key = kv.GetInt("rocksdb_bloom_bits_per_key", 10);
+    config.rocksdb_durability = kv.Get("rocksdb_durability", "group_commit");
+    config.rocksdb_group_commit_max_delay_us = kv.GetInt("rocksdb_group_commit_max_delay_us", 0);
+    config.rocksdb_group_commit_max_batch = kv.GetInt("rocksdb_group_commit_max_batch", 64);
+    config.rocksdb_wal_flush_interval_ms = kv.GetInt("rocksdb_wal_flush_interval_ms", 100);
 
     config.recall_timeout_seconds = kv.GetInt("recall_timeout_seconds", 120);
     config.offline_max_count = kv.GetInt("offline_max_count", 1000);
     config.history_page_size = kv.GetInt("history_page_size", 50);
+    config.client_msg_dedup_ttl_seconds = kv.GetInt("client_msg_dedup_ttl_seconds", 86400);
 
     config.jwt_secret = kv.Get("jwt_secret", "swift_online_secret_2026");
 
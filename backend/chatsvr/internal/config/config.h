@@ -10,13 +10,31 @@ struct ChatConfig {
     
     // 存储配置
     std::string store_type = "rocksdb";
-    std::string rocksdb_path = "/data/chat";
+    std::string rocksdb_path = "/data/chat";  // 基目录，单库位于 {rocksdb_path}/chatdb
     std::string mysql_dsn;
+    /** ChatDB 各列族共用的块缓存（MB），memtable 也计入其中 */
+    int rocksdb_block_cache_mb = 256;
+    /** 所有列族 memtable 总上限（MB），超出即触发 flush */
+    int rocksdb_write_buffer_mb = 128;
+    /** 整库 flush/compaction 后台线程数 */
+    int rocksdb_max_background_jobs = 4;
+    /** 布隆过滤器每 key 位数（前缀扫描列族建前缀过滤器，其余整 key）；0 关闭 */
+    int rocksdb_bloom_bits_per_key = 10;
+    /** 写入持久化模式：sync / group_commit / wal_no_sync（见 store/write_coordinator.h） */
+    std::string rocksdb_durability = "group_commit";
+    /** group_commit：凑批最多额外等待（微秒），0 表示只合并上一批 fsync 期间到达的写 */
+    int rocksdb_group_commit_max_delay_us = 0;
+    /** group_commit：每批最多合并的写请求数 */
+    int rocksdb_group_commit_max_batch = 64;
+    /** wal_no_sync：后台 FlushWAL(sync) 周期（毫秒），掉电最多丢失该时间窗内的写 */
+    int rocksdb_wal_flush_interval_ms = 100;
     
     // 消息配置
     int recall_timeout_seconds = 120;
     int offline_max_count = 1000;
     int history_page_size = 50;
+    /** client_msg_id 去重记录保留时长（秒）：该时间窗内的发送重试返回首次结果 */
+    int client_msg_dedup_ttl_seconds = 86400;
 
     /** 与 OnlineSvr 相同的 JWT 密钥，用于从 metadata 校验 Token 得到 user_id */
     std::string jwt_secret = "swift_online_secret_2026";
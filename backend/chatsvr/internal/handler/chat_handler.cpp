@@ -116,12 +116,13 @@ void FillConversation(::swift::chat::Conversation* out, const ConversationData&
     auto result = service_->SendMessage(
         uid, request->to_id(), ctype,
         request->content(), request->media_url(), request->media_type(),
-        mentions, request->reply_to_msg_id());
+        mentions, request->reply_to_msg_id(), request->client_msg_id());
     if (result.success) {
         response->set_code(static_cast<int>(swift::ErrorCode::OK));
         response->set_message(swift::ErrorCodeToString(swift::ErrorCode::OK));
         response->set_msg_id(result.msg_id);
         response->set_timestamp(result.timestamp);
+        response->set_duplicate(result.duplicate);
         LogInfo(TAG("service", "chatsvr"),"SendMessage success: " << result.msg_id);
     } else {
         swift::ErrorCode code = MapSendErrorToCode(result.error);
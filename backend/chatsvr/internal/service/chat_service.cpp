@@ -8,6 +8,8 @@
 #include "swift/utils.h"
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <swift/log_helper.h>
 
 namespace swift::chat {
@@ -38,6 +40,12 @@ std::string ChatServiceCore::ResolveConversationId(const std::string& user_id,
     return chat_id;  // 群聊 conversation_id = group_id
 }
 
+std::mutex& ChatServiceCore::SendLockFor(const std::string& from_user_id,
+                                         const std::string& client_msg_id) {
+    size_t h = std::hash<std::string>{}(from_user_id) * 31 + std::hash<std::string>{}(client_msg_id);
+    return send_locks_[h % kSendLockStripes];
+}
+
 ChatServiceCore::SendResult ChatServiceCore::SendMessage(const std::string& from_user_id,
                                                   const std::string& to_id,
                                                   ChatType chat_type,
@@ -45,7 +53,8 @@ ChatServiceCore::SendResult ChatServiceCore::SendMessage(const std::string& from
                                                   const std::string& media_url,
                                                   const std::string& media_type,
                                                   const std::vector<std::string>& mentions,
-                                                  const std::string& reply_to_msg_id) {
+                                                  const std::string& reply_to_msg_id,
+                                                  const std::string& client_msg_id) {
     SendResult result{false, "", "", 0, ""};
     if (from_user_id.empty() || to_id.empty()) {
         result.error = "invalid params";
@@ -53,6 +62,23 @@ ChatServiceCore::SendResult ChatServiceCore::SendMessage(const std::string& from
         return result;
     }
 
+    // 幂等：网关超时后的重试返回首次结果，不重复落库与扇出。锁持有到本次写完，
+    // 并发到达的同一重试在锁后必然命中去重索引
+    std::unique_lock<std::mutex> dedup_lock;
+    if (!client_msg_id.empty()) {
+        dedup_lock = std::unique_lock<std::mutex>(SendLockFor(from_user_id, client_msg_id));
+        if (auto prev = msg_store_->GetByClientMsgId(from_user_id, client_msg_id)) {
+            result.success = true;
+            result.duplicate = true;
+            result.msg_id = prev->msg_id;
+            result.conversation_id = prev->conversation_id;
+            result.timestamp = prev->timestamp;
+            LogInfo(TAG("service", "chatsvr"), "SendMessage duplicate client_msg_id=" << client_msg_id
+                    << ", from=" << from_user_id << ", msg_id=" << prev->msg_id);
+            return result;
+        }
+    }
+
     std::string conversation_id;
     if (chat_type == ChatType::PRIVATE) {
         if (!conv_registry_) {
@@ -85,13 +111,29 @@ ChatServiceCore::SendResult ChatServiceCore::SendMessage(const std::string& from
     msg.timestamp = now;
     msg.status = 0;
     msg.recall_at = 0;
+    msg.client_msg_id = client_msg_id;
+
+    // 私聊：消息、双方会话、未读与离线同批提交（一次 fsync），崩溃后不会只留下一半；
+    // 存储不支持批量（返回 nullptr）时退化为逐个写入
+    std::unique_ptr<ChatWriteBatch> batch;
+    if (chat_type == ChatType::PRIVATE)
+        batch = msg_store_->NewWriteBatch();
 
-    if (!msg_store_->Save(msg)) {
+    if (!msg_store_->Save(msg, batch.get())) {
         result.error = "save failed";
         LogError(TAG("service", "chatsvr"),"SendMessage save failed");
         return result;
     }
 
+    // 群聊到此为止：成员会话、未读与离线都从群时间线推导，不再逐成员写入
+    if (chat_type != ChatType::PRIVATE) {
+        result.success = true;
+        result.msg_id = msg.msg_id;
+        result.conversation_id = conversation_id;
+        result.timestamp = now;
+        return result;
+    }
+
     // 更新会话列表：发送方
     ConversationData conv_sender;
     conv_sender.conversation_id = conversation_id;
@@ -99,45 +141,24 @@ ChatServiceCore::SendResult ChatServiceCore::SendMessage(const std::string& from
     conv_sender.peer_id = to_id;
     conv_sender.last_msg_id = msg.msg_id;
     conv_sender.updated_at = now;
-    conv_store_->Upsert(from_user_id, conv_sender);
+    conv_store_->Upsert(from_user_id, conv_sender, batch.get());
 
-    if (chat_type == ChatType::PRIVATE) {
-        ConversationData conv_peer;
-        conv_peer.conversation_id = conversation_id;
-        conv_peer.chat_type = static_cast<int>(chat_type);
-        conv_peer.peer_id = from_user_id;
-        conv_peer.last_msg_id = msg.msg_id;
-        conv_peer.updated_at = now;
-        conv_store_->Upsert(to_id, conv_peer);
-        conv_store_->UpdateUnread(to_id, conversation_id, 1);
-    } else if (group_store_) {
-        int total = 0;
-        std::vector<swift::group_::GroupMemberData> members =
-            group_store_->GetMembers(to_id, 0, 1000, &total);
-        for (const auto& m : members) {
-            if (m.user_id == from_user_id) continue;
-            ConversationData conv_m;
-            conv_m.conversation_id = conversation_id;
-            conv_m.chat_type = static_cast<int>(chat_type);
-            conv_m.peer_id = to_id;
-            conv_m.last_msg_id = msg.msg_id;
-            conv_m.updated_at = now;
-            conv_store_->Upsert(m.user_id, conv_m);
-            conv_store_->UpdateUnread(m.user_id, conversation_id, 1);
-        }
-    }
+    ConversationData conv_peer;
+    conv_peer.conversation_id = conversation_id;
+    conv_peer.chat_type = static_cast<int>(chat_type);
+    conv_peer.peer_id = from_user_id;
+    conv_peer.last_msg_id = msg.msg_id;
+    conv_peer.updated_at = now;
+    conv_store_->Upsert(to_id, conv_peer, batch.get());
+    conv_store_->UpdateUnread(to_id, conversation_id, 1, batch.get());
 
-    // 离线：私聊给 to_id；群聊给除发送者外的所有成员
-    if (chat_type == ChatType::PRIVATE) {
-        msg_store_->AddToOffline(to_id, msg.msg_id);
-    } else if (group_store_) {
-        int total = 0;
-        std::vector<swift::group_::GroupMemberData> members =
-            group_store_->GetMembers(to_id, 0, 1000, &total);
-        for (const auto& m : members) {
-            if (m.user_id != from_user_id)
-                msg_store_->AddToOffline(m.user_id, msg.msg_id);
-        }
+    // 离线：私聊给 to_id
+    msg_store_->AddToOffline(to_id, msg, batch.get());
+
+    if (batch && !batch->Commit()) {
+        result.error = "save failed";
+        LogError(TAG("service", "chatsvr"),"SendMessage commit failed");
+        return result;
     }
 
     result.success = true;
@@ -179,13 +200,43 @@ ChatServiceCore::RecallResult ChatServiceCore::RecallMessage(const std::string&
     return result;
 }
 
+std::vector<ChatServiceCore::GroupReadState> ChatServiceCore::LoadGroupReadStates(
+    const std::string& user_id, const std::vector<ConversationData>& records) {
+    std::vector<GroupReadState> states;
+    if (!group_store_) return states;
+    std::unordered_map<std::string, const ConversationData*> by_id;
+    for (const auto& c : records) {
+        if (c.chat_type == static_cast<int>(ChatType::GROUP))
+            by_id[c.conversation_id] = &c;
+    }
+    for (auto& group_id : group_store_->GetUserGroupIds(user_id)) {
+        GroupReadState st;
+        st.group_id = std::move(group_id);
+        auto it = by_id.find(st.group_id);
+        if (it != by_id.end()) {
+            st.record = *it->second;
+            // 旧版扇出写入的记录没有 read_ts：其 unread_count 已计到 updated_at 为止，之后的再从时间线推导
+            st.after_ts = st.record->read_ts > 0 ? st.record->read_ts : st.record->updated_at;
+        } else if (auto m = group_store_->GetMember(st.group_id, user_id)) {
+            st.after_ts = m->joined_at;  // 入群前的消息不算未读/离线
+        }
+        states.push_back(std::move(st));
+    }
+    return states;
+}
+
 ChatServiceCore::OfflineResult ChatServiceCore::PullOffline(const std::string& user_id,
                                                     const std::string& cursor,
                                                     int limit) {
     OfflineResult result;
+    std::vector<MessageStore::TimelineSource> timelines;
+    if (group_store_ && !user_id.empty()) {
+        for (const auto& st : LoadGroupReadStates(user_id, conv_store_->GetList(user_id)))
+            timelines.push_back({st.group_id, st.after_ts});
+    }
     result.messages = msg_store_->PullOffline(user_id, cursor,
                                               limit <= 0 ? 100 : limit,
-                                              result.next_cursor, result.has_more);
+                                              result.next_cursor, result.has_more, timelines);
     return result;
 }
 
@@ -211,7 +262,25 @@ bool ChatServiceCore::MarkRead(const std::string& user_id, const std::string& ch
     std::string conversation_id = ResolveConversationId(user_id, chat_id, chat_type);
     if (conversation_id.empty()) return false;
 
-    bool ok = conv_store_->ClearUnread(user_id, conversation_id);
+    bool ok = false;
+    if (chat_type == ChatType::GROUP) {
+        // 群聊只推进已读水位（一次写），未读与离线在读取时据此推导
+        int64_t read_ts = 0;
+        if (!last_msg_id.empty()) {
+            if (auto m = msg_store_->GetById(last_msg_id))
+                read_ts = m->timestamp;
+        }
+        if (read_ts <= 0)
+            read_ts = swift::utils::GetTimestampMs();
+        ConversationData base;
+        base.conversation_id = conversation_id;
+        base.chat_type = static_cast<int>(ChatType::GROUP);
+        base.peer_id = chat_id;
+        ok = conv_store_->MarkReadUpTo(user_id, base, read_ts);
+    } else {
+        ok = conv_store_->ClearUnread(user_id, conversation_id);
+    }
+    // 群聊也清一次：旧版扇出写入离线队列的群消息
     if (!last_msg_id.empty())
         msg_store_->ClearOffline(user_id, last_msg_id);
     return ok;
@@ -221,15 +290,54 @@ std::vector<ConversationData> ChatServiceCore::SyncConversations(const std::stri
     if (user_id.empty()) return {};
     std::vector<ConversationData> list = conv_store_->GetList(user_id);
     if (!group_store_) return list;
+
+    // 当前所在群：last_msg_id / updated_at / 未读数由群时间线推导；尚无消息且无记录的群不进列表
+    std::unordered_map<std::string, std::optional<ConversationData>> derived;
     std::vector<ConversationData> out;
+    for (auto& st : LoadGroupReadStates(user_id, list)) {
+        auto g = group_store_->GetGroup(st.group_id);
+        if (g && g->status == 1) {
+            derived[st.group_id] = std::nullopt;  // 已解散群不展示
+            continue;
+        }
+        auto summary = msg_store_->SummarizeTimeline(st.group_id, st.after_ts, user_id, kMaxDerivedUnread);
+        if (summary.latest_msg_id.empty() && !st.record)
+            continue;
+        ConversationData c = st.record ? *st.record : ConversationData{};
+        c.conversation_id = st.group_id;
+        c.chat_type = static_cast<int>(ChatType::GROUP);
+        if (c.peer_id.empty()) c.peer_id = st.group_id;
+        if (!summary.latest_msg_id.empty()) {
+            c.last_msg_id = summary.latest_msg_id;
+            c.updated_at = summary.latest_ts;
+        }
+        c.unread_count = std::min(kMaxDerivedUnread, c.unread_count + summary.count);
+        if (st.record) {
+            derived[st.group_id] = std::move(c);
+        } else {
+            derived[st.group_id] = std::nullopt;
+            out.push_back(std::move(c));
+        }
+    }
+
+    // 已有记录保持原顺序，群记录替换为推导结果；不在群内的旧群记录原样返回（已解散的除外）
+    std::vector<ConversationData> merged;
+    merged.reserve(list.size() + out.size());
     for (auto& c : list) {
+        auto it = derived.find(c.conversation_id);
+        if (it != derived.end() && c.chat_type == static_cast<int>(ChatType::GROUP)) {
+            if (it->second) merged.push_back(std::move(*it->second));
+            continue;
+        }
         if (c.chat_type == static_cast<int>(ChatType::GROUP)) {
             auto g = group_store_->GetGroup(c.conversation_id);
             if (g && g->status == 1) continue;  // 已解散群不展示
         }
-        out.push_back(std::move(c));
+        merged.push_back(std::move(c));
     }
-    return out;
+    for (auto& c : out)
+        merged.push_back(std::move(c));
+    return merged;
 }
 
 std::optional<MessageData> ChatServiceCore::GetMessageById(const std::string& msg_id) {
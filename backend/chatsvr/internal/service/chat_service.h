@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -18,6 +21,9 @@ using ChatType = swift::ChatType;
 /**
  * 消息服务业务逻辑（类名带 Core 以区分 proto 生成的 ChatService）。
  * 依赖：MessageStore、ConversationStore、ConversationRegistry；群聊离线需 GroupStore。
+ *
+ * 群聊采用时间线指针模型：发送只写消息与群时间线（与成员数无关），
+ * 成员的会话摘要、未读数与离线消息在读取时由群时间线和该成员的已读水位（read_ts）推导。
  */
 class ChatServiceCore {
 public:
@@ -28,18 +34,22 @@ public:
     ~ChatServiceCore();
 
     // 发送消息（私聊用 GetOrCreatePrivateConversation 得到 conversation_id，群聊用 to_id）
+    // client_msg_id 非空时幂等：同一发送者重试同一 client_msg_id 直接返回首次的 msg_id/timestamp，
+    // 不再重复写存储、会话与离线队列（duplicate=true，调用方据此跳过推送）
     struct SendResult {
         bool success;
         std::string msg_id;
         std::string conversation_id;
         int64_t timestamp;
         std::string error;
+        bool duplicate = false;
     };
     SendResult SendMessage(const std::string& from_user_id, const std::string& to_id,
                            ChatType chat_type, const std::string& content,
                            const std::string& media_url, const std::string& media_type,
                            const std::vector<std::string>& mentions,
-                           const std::string& reply_to_msg_id = "");
+                           const std::string& reply_to_msg_id = "",
+                           const std::string& client_msg_id = "");
 
     // 撤回消息（2 分钟内，仅发送者）
     struct RecallResult {
@@ -61,7 +71,7 @@ public:
                                         const std::string& chat_id, ChatType chat_type,
                                         const std::string& before_msg_id, int limit);
 
-    // 标记已读：清除该会话未读数，并清除离线队列到 last_msg_id
+    // 标记已读：私聊清除未读数；群聊把已读水位推进到 last_msg_id（为空则到当前）。两者都清除离线队列到 last_msg_id
     bool MarkRead(const std::string& user_id, const std::string& chat_id,
                   ChatType chat_type, const std::string& last_msg_id);
 
@@ -82,6 +92,16 @@ private:
     std::string GenerateMsgId();
     // 解析为 store 使用的 conversation_id：私聊=GetOrCreatePrivateConversation，群聊=chat_id
     std::string ResolveConversationId(const std::string& user_id, const std::string& chat_id, ChatType chat_type);
+    // 用户当前所在群的已读状态：after_ts 之后的他人消息为未读/离线
+    struct GroupReadState {
+        std::string group_id;
+        int64_t after_ts = 0;
+        std::optional<ConversationData> record;  // 已有会话记录（已读水位或旧版逐成员扇出写入）
+    };
+    std::vector<GroupReadState> LoadGroupReadStates(const std::string& user_id,
+                                                    const std::vector<ConversationData>& records);
+    // (发送者, client_msg_id) 对应的分段锁：同一条消息的并发重试串行执行，保证只写一次
+    std::mutex& SendLockFor(const std::string& from_user_id, const std::string& client_msg_id);
 
     std::shared_ptr<MessageStore> msg_store_;
     std::shared_ptr<ConversationStore> conv_store_;
@@ -89,6 +109,9 @@ private:
     std::shared_ptr<swift::group_::GroupStore> group_store_;
 
     static constexpr int RECALL_TIMEOUT_SECONDS = 120;  // 2 分钟
+    static constexpr int kMaxDerivedUnread = 999;  // 推导群未读时最多数到的条数
+    static constexpr size_t kSendLockStripes = 256;
+    std::array<std::mutex, kSendLockStripes> send_locks_;
 };
 
 }  // namespace swift::chat
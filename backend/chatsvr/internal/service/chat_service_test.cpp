@@ -5,9 +5,12 @@
 
 #include "../store/message_store.h"
 #include "../store/group_store.h"
+#include "../store/record_serde.h"
 #include "chat_service.h"
+#include <rocksdb/db.h>
 #include <chrono>
 #include <filesystem>
+#include <thread>
 #include <gtest/gtest.h>
 
 namespace swift::chat {
@@ -17,15 +20,14 @@ protected:
     void SetUp() override {
         auto suffix = std::to_string(
             std::chrono::system_clock::now().time_since_epoch().count());
-        msg_db_path_ = "/tmp/chat_msg_" + suffix;
-        conv_db_path_ = "/tmp/chat_conv_" + suffix;
-        conv_meta_db_path_ = "/tmp/chat_conv_meta_" + suffix;
-        group_db_path_ = "/tmp/chat_group_" + suffix;
+        db_path_ = "/tmp/chat_db_" + suffix;
 
-        msg_store_ = std::make_shared<RocksDBMessageStore>(msg_db_path_);
-        conv_store_ = std::make_shared<RocksDBConversationStore>(conv_db_path_);
-        conv_registry_ = std::make_shared<RocksDBConversationRegistry>(conv_meta_db_path_);
-        group_store_ = std::make_shared<swift::group_::RocksDBGroupStore>(group_db_path_);
+        // 与 main 一致：所有 store 共用一个 ChatDB
+        chat_db_ = ChatDB::Open(db_path_);
+        msg_store_ = std::make_shared<RocksDBMessageStore>(chat_db_);
+        conv_store_ = std::make_shared<RocksDBConversationStore>(chat_db_);
+        conv_registry_ = std::make_shared<RocksDBConversationRegistry>(chat_db_);
+        group_store_ = std::make_shared<swift::group_::RocksDBGroupStore>(chat_db_);
 
         service_ = std::make_unique<ChatServiceCore>(
             msg_store_, conv_store_, conv_registry_, group_store_);
@@ -37,16 +39,12 @@ protected:
         conv_registry_.reset();
         conv_store_.reset();
         msg_store_.reset();
-        std::filesystem::remove_all(msg_db_path_);
-        std::filesystem::remove_all(conv_db_path_);
-        std::filesystem::remove_all(conv_meta_db_path_);
-        std::filesystem::remove_all(group_db_path_);
+        chat_db_.reset();
+        std::filesystem::remove_all(db_path_);
     }
 
-    std::string msg_db_path_;
-    std::string conv_db_path_;
-    std::string conv_meta_db_path_;
-    std::string group_db_path_;
+    std::string db_path_;
+    std::shared_ptr<ChatDB> chat_db_;
 
     std::shared_ptr<RocksDBMessageStore> msg_store_;
     std::shared_ptr<RocksDBConversationStore> conv_store_;
@@ -88,6 +86,134 @@ TEST_F(ChatServiceTest, SendMessage_Private_Success) {
     EXPECT_EQ(offline[0].msg_id, result.msg_id);
 }
 
+// 同一 client_msg_id 重试：返回首次的 msg_id/timestamp，不重复写离线与未读
+TEST_F(ChatServiceTest, SendMessage_RetryWithClientMsgId_IsIdempotent) {
+    auto first = service_->SendMessage(
+        "u1", "u2", ChatType::PRIVATE,
+        "hello", "", "", {}, "", "cm_retry");
+    ASSERT_TRUE(first.success);
+    EXPECT_FALSE(first.duplicate);
+
+    auto retry = service_->SendMessage(
+        "u1", "u2", ChatType::PRIVATE,
+        "hello", "", "", {}, "", "cm_retry");
+    ASSERT_TRUE(retry.success);
+    EXPECT_TRUE(retry.duplicate);
+    EXPECT_EQ(retry.msg_id, first.msg_id);
+    EXPECT_EQ(retry.timestamp, first.timestamp);
+    EXPECT_EQ(retry.conversation_id, first.conversation_id);
+
+    std::string cursor;
+    bool has_more = false;
+    auto offline = msg_store_->PullOffline("u2", "", 10, cursor, has_more);
+    ASSERT_EQ(offline.size(), 1u);
+    auto convs_u2 = conv_store_->GetList("u2");
+    ASSERT_EQ(convs_u2.size(), 1u);
+    EXPECT_EQ(convs_u2[0].unread_count, 1);
+
+    // 不同 client_msg_id 是新消息
+    auto other = service_->SendMessage(
+        "u1", "u2", ChatType::PRIVATE,
+        "hello", "", "", {}, "", "cm_other");
+    ASSERT_TRUE(other.success);
+    EXPECT_FALSE(other.duplicate);
+    EXPECT_NE(other.msg_id, first.msg_id);
+}
+
+// 共用 ChatDB 时跨 store 的写进同一批：提交前全部不可见，提交后全部可见
+TEST_F(ChatServiceTest, WriteBatch_CrossStoreWritesCommitTogether) {
+    MessageData msg;
+    msg.msg_id = "m_batch";
+    msg.from_user_id = "u1";
+    msg.to_id = "u2";
+    msg.conversation_id = "p_u1_u2";
+    msg.content = "batched";
+    msg.timestamp = 1000;
+
+    ConversationData conv;
+    conv.conversation_id = msg.conversation_id;
+    conv.peer_id = "u1";
+    conv.last_msg_id = msg.msg_id;
+    conv.updated_at = msg.timestamp;
+
+    auto batch = msg_store_->NewWriteBatch();
+    ASSERT_NE(batch, nullptr);
+    ASSERT_TRUE(msg_store_->Save(msg, batch.get()));
+    ASSERT_TRUE(conv_store_->Upsert("u2", conv, batch.get()));
+    ASSERT_TRUE(conv_store_->UpdateUnread("u2", conv.conversation_id, 1, batch.get()));
+    ASSERT_TRUE(msg_store_->AddToOffline("u2", msg, batch.get()));
+
+    std::string cursor;
+    bool has_more = false;
+    EXPECT_FALSE(msg_store_->GetById(msg.msg_id).has_value());
+    EXPECT_TRUE(conv_store_->GetList("u2").empty());
+    EXPECT_TRUE(msg_store_->PullOffline("u2", "", 10, cursor, has_more).empty());
+
+    ASSERT_TRUE(batch->Commit());
+    EXPECT_TRUE(msg_store_->GetById(msg.msg_id).has_value());
+    auto convs = conv_store_->GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 1);
+    EXPECT_EQ(msg_store_->PullOffline("u2", "", 10, cursor, has_more).size(), 1u);
+}
+
+// 未读数经 merge 盲写累加：连续发送与并发自增都不丢，标记已读后清零
+TEST_F(ChatServiceTest, UnreadCount_AccumulatesAndClears) {
+    std::string conversation_id;
+    for (int i = 0; i < 3; ++i) {
+        auto r = service_->SendMessage("u1", "u2", ChatType::PRIVATE, "hi", "", "", {}, "");
+        ASSERT_TRUE(r.success);
+        conversation_id = r.conversation_id;
+    }
+    auto convs = conv_store_->GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 3);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 50; ++i)
+                conv_store_->UpdateUnread("u2", conversation_id, 1);
+        });
+    }
+    for (auto& t : threads) t.join();
+    convs = conv_store_->GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 203);
+
+    ASSERT_TRUE(service_->MarkRead("u2", "u1", ChatType::PRIVATE, ""));
+    convs = conv_store_->GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 0);
+}
+
+// 升级前只存在 conv 记录里的未读数：首次打开时折算进计数键，之后的私聊 Upsert 覆盖记录也不丢
+TEST_F(ChatServiceTest, UnreadCount_LegacyRecordCountSurvivesUpgrade) {
+    auto first = service_->SendMessage("u1", "u2", ChatType::PRIVATE, "hi", "", "", {}, "");
+    ASSERT_TRUE(first.success);
+
+    // 还原成旧数据：记录里 unread_count=5，没有计数键与迁移标记
+    service_.reset();
+    conv_store_.reset();
+    auto* cf = chat_db_->cf(ChatColumnFamily::CONVERSATIONS);
+    const std::string conv_key = "conv:u2:" + first.conversation_id;
+    std::string value;
+    ASSERT_TRUE(chat_db_->db()->Get(rocksdb::ReadOptions(), cf, conv_key, &value).ok());
+    ConversationData legacy = DeserializeConversation(value);
+    legacy.unread_count = 5;
+    ASSERT_TRUE(chat_db_->db()->Put(rocksdb::WriteOptions(), cf, conv_key, SerializeConversation(legacy)).ok());
+    ASSERT_TRUE(chat_db_->db()->Delete(rocksdb::WriteOptions(), cf, "unread:u2:" + first.conversation_id).ok());
+    ASSERT_TRUE(chat_db_->db()->Delete(rocksdb::WriteOptions(), cf, "meta:unread_counters_migrated").ok());
+
+    conv_store_ = std::make_shared<RocksDBConversationStore>(chat_db_);
+    service_ = std::make_unique<ChatServiceCore>(msg_store_, conv_store_, conv_registry_, group_store_);
+    ASSERT_TRUE(service_->SendMessage("u1", "u2", ChatType::PRIVATE, "again", "", "", {}, "").success);
+
+    auto convs = conv_store_->GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 6);
+}
+
 // 撤回消息：发送者 2 分钟内允许撤回，状态更新
 TEST_F(ChatServiceTest, RecallMessage_Success) {
     auto send = service_->SendMessage(
@@ -116,6 +242,49 @@ TEST_F(ChatServiceTest, DeleteConversation_Private_ReturnsError) {
     EXPECT_EQ(res.error, swift::ErrorCode::CONVERSATION_PRIVATE_CANNOT_DELETE);
 }
 
+// 群聊发送只写群时间线：成员未读与离线由时间线和已读水位推导，标记已读后清零
+TEST_F(ChatServiceTest, SendMessage_Group_DerivesUnreadAndOfflineFromTimeline) {
+    swift::group_::GroupData g;
+    g.group_id = "g1";
+    g.owner_id = "owner";
+    ASSERT_TRUE(group_store_->CreateGroup(g));
+    swift::group_::GroupMemberData m_owner;
+    m_owner.user_id = "owner";
+    swift::group_::GroupMemberData m_member;
+    m_member.user_id = "member";
+    ASSERT_TRUE(group_store_->AddMember("g1", m_owner));
+    ASSERT_TRUE(group_store_->AddMember("g1", m_member));
+
+    auto first = service_->SendMessage("owner", "g1", ChatType::GROUP, "m1", "", "", {}, "");
+    auto second = service_->SendMessage("owner", "g1", ChatType::GROUP, "m2", "", "", {}, "");
+    ASSERT_TRUE(first.success);
+    ASSERT_TRUE(second.success);
+
+    // 不再逐成员写会话记录
+    EXPECT_TRUE(conv_store_->GetList("member").empty());
+
+    auto convs = service_->SyncConversations("member");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].conversation_id, "g1");
+    EXPECT_FALSE(convs[0].last_msg_id.empty());
+    EXPECT_EQ(convs[0].unread_count, 2);
+
+    auto owner_convs = service_->SyncConversations("owner");
+    ASSERT_EQ(owner_convs.size(), 1u);
+    EXPECT_EQ(owner_convs[0].unread_count, 0);
+
+    auto offline = service_->PullOffline("member", "", 10);
+    ASSERT_EQ(offline.messages.size(), 2u);
+    EXPECT_FALSE(offline.has_more);
+    EXPECT_TRUE(service_->PullOffline("owner", "", 10).messages.empty());
+
+    ASSERT_TRUE(service_->MarkRead("member", "g1", ChatType::GROUP, second.msg_id));
+    convs = service_->SyncConversations("member");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 0);
+    EXPECT_TRUE(service_->PullOffline("member", "", 10).messages.empty());
+}
+
 // 群聊删除会话：仅群主可解散，解散后会话从所有成员列表移除，历史为空
 TEST_F(ChatServiceTest, DeleteConversation_Group_OwnerDissolve) {
     // 准备群组与成员
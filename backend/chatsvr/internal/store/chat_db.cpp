@@ -0,0 +1,280 @@
+/**
+ * @file chat_db.cpp
+ * @brief ChatSvr 单一 RocksDB 实例：列族、共享块缓存与 WriteBufferManager、旧版分库导入
+ */
+
+#include "chat_db.h"
+#include <rocksdb/cache.h>
+#include <rocksdb/compaction_filter.h>
+#include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/iterator.h>
+#include <rocksdb/merge_operator.h>
+#include <rocksdb/options.h>
+#include <rocksdb/table.h>
+#include <rocksdb/write_batch.h>
+#include <rocksdb/write_buffer_manager.h>
+#include <swift/rocksdb_prefix.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace swift::chat {
+
+namespace {
+
+constexpr int kFamilyCount = static_cast<int>(ChatColumnFamily::COUNT);
+
+constexpr const char* kLegacyImportedKey = "meta:legacy_imported";  // default 列族
+
+// 与 ChatColumnFamily 顺序一致
+constexpr const char* kFamilyNames[kFamilyCount] = {
+    "messages", "timelines", "offline", "conversations", "conv_meta", "groups", "members", "dedup",
+};
+
+// 按 "{keyspace}:{owner}:" 前缀扫描的列族；conversations、members 另有点查（MarkReadUpTo、IsMember）
+bool IsPrefixScanned(ChatColumnFamily family) {
+    return family == ChatColumnFamily::TIMELINES || family == ChatColumnFamily::OFFLINE ||
+           family == ChatColumnFamily::CONVERSATIONS || family == ChatColumnFamily::MEMBERS;
+}
+
+// 只扫描、从不按整 key 点查的列族，SST 过滤器只存前缀
+bool IsScanOnly(ChatColumnFamily family) {
+    return family == ChatColumnFamily::TIMELINES || family == ChatColumnFamily::OFFLINE;
+}
+
+bool StartsWith(const rocksdb::Slice& key, const char* prefix) {
+    return key.starts_with(rocksdb::Slice(prefix));
+}
+
+// 旧版分库的 key -> 列族；conv_meta: 须先于 conv:、group_member: 须先于 group: 判断（后者带冒号，实际不冲突）
+bool RouteLegacyKey(const std::string& legacy_cf, const rocksdb::Slice& key, ChatColumnFamily* out) {
+    if (legacy_cf == kFamilyNames[static_cast<int>(ChatColumnFamily::DEDUP)]) {
+        *out = ChatColumnFamily::DEDUP;
+        return true;
+    }
+    if (legacy_cf != rocksdb::kDefaultColumnFamilyName)
+        return false;
+    if (StartsWith(key, "msg:")) *out = ChatColumnFamily::MESSAGES;
+    else if (StartsWith(key, "chat:")) *out = ChatColumnFamily::TIMELINES;
+    else if (StartsWith(key, "offline:")) *out = ChatColumnFamily::OFFLINE;
+    else if (StartsWith(key, "conv_meta:")) *out = ChatColumnFamily::CONV_META;
+    else if (StartsWith(key, "conv:") || StartsWith(key, "unread:")) *out = ChatColumnFamily::CONVERSATIONS;
+    else if (StartsWith(key, "group_member:") || StartsWith(key, "user_groups:")) *out = ChatColumnFamily::MEMBERS;
+    else if (StartsWith(key, "group:")) *out = ChatColumnFamily::GROUPS;
+    else return false;
+    return true;
+}
+
+}  // namespace
+
+struct ChatDB::Impl {
+    rocksdb::DB* db = nullptr;
+    std::string path;
+    int64_t dedup_ttl_ms = 0;
+    std::unique_ptr<rocksdb::CompactionFilter> dedup_filter;  // 须比 db 活得久
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;        // [0]=default，[1 + ChatColumnFamily]
+    std::unique_ptr<WriteCoordinator> writer;                 // 须先于 db 停止
+
+    ~Impl() {
+        writer.reset();
+        if (db) {
+            for (auto* h : handles)
+                db->DestroyColumnFamilyHandle(h);
+            delete db;
+            db = nullptr;
+        }
+    }
+};
+
+ChatDB::ChatDB() : impl_(std::make_unique<Impl>()) {}
+
+ChatDB::~ChatDB() = default;
+
+std::shared_ptr<ChatDB> ChatDB::Open(const std::string& db_path, const ChatDBOptions& options) {
+    std::shared_ptr<ChatDB> chat_db(new ChatDB());
+    Impl& impl = *chat_db->impl_;
+    impl.path = db_path;
+    impl.dedup_ttl_ms = options.dedup_ttl_ms;
+    impl.dedup_filter = detail::NewDedupExpiryFilter(options.dedup_ttl_ms);
+
+    const int jobs = std::max(2, options.max_background_jobs);
+    const size_t cache_bytes = static_cast<size_t>(std::max<int64_t>(8, options.block_cache_mb)) << 20;
+    const size_t write_buffer_bytes = static_cast<size_t>(std::max<int64_t>(16, options.write_buffer_mb)) << 20;
+
+    rocksdb::DBOptions db_options;
+    db_options.create_if_missing = true;
+    db_options.create_missing_column_families = true;
+    db_options.IncreaseParallelism(jobs);
+    db_options.max_background_jobs = jobs;
+
+    // memtable 占用计入同一块缓存：总内存 ≈ block_cache_mb，write_buffer_mb 为其中 memtable 上限
+    auto cache = rocksdb::NewLRUCache(cache_bytes);
+    db_options.write_buffer_manager = std::make_shared<rocksdb::WriteBufferManager>(write_buffer_bytes, cache);
+
+    // 过滤器块计入块缓存；L0 的过滤器与索引常驻，前缀 Seek 不必先读盘才能排除文件
+    const bool filters = options.bloom_bits_per_key > 0;
+    rocksdb::BlockBasedTableOptions table_options;
+    table_options.block_cache = cache;
+    table_options.cache_index_and_filter_blocks = true;
+    table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+    if (filters)
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(options.bloom_bits_per_key));
+    std::shared_ptr<rocksdb::TableFactory> table_factory(rocksdb::NewBlockBasedTableFactory(table_options));
+    table_options.whole_key_filtering = false;
+    std::shared_ptr<rocksdb::TableFactory> prefix_only_table_factory(
+        rocksdb::NewBlockBasedTableFactory(table_options));
+    auto prefix_extractor = swift::rocksdb_prefix::NewKeyspacePrefixExtractor();
+
+    auto family_options = [&]() {
+        rocksdb::ColumnFamilyOptions cf_options;
+        cf_options.OptimizeLevelStyleCompaction(write_buffer_bytes);
+        cf_options.table_factory = table_factory;
+        return cf_options;
+    };
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    descriptors.emplace_back(rocksdb::kDefaultColumnFamilyName, family_options());
+    for (int i = 0; i < kFamilyCount; ++i) {
+        const auto family = static_cast<ChatColumnFamily>(i);
+        rocksdb::ColumnFamilyOptions cf_options = family_options();
+        if (filters && IsPrefixScanned(family)) {
+            cf_options.prefix_extractor = prefix_extractor;
+            cf_options.memtable_prefix_bloom_size_ratio = 0.05;
+            if (IsScanOnly(family))
+                cf_options.table_factory = prefix_only_table_factory;
+            else
+                cf_options.memtable_whole_key_filtering = true;
+        }
+        switch (family) {
+        case ChatColumnFamily::CONVERSATIONS:
+            cf_options.merge_operator = detail::NewUnreadCounterMergeOperator();
+            break;
+        case ChatColumnFamily::DEDUP:
+            cf_options.compaction_filter = impl.dedup_filter.get();
+            break;
+        default:
+            break;
+        }
+        descriptors.emplace_back(kFamilyNames[i], cf_options);
+    }
+
+    rocksdb::Status status = rocksdb::DB::Open(db_options, db_path, descriptors, &impl.handles, &impl.db);
+    if (!status.ok()) {
+        throw std::runtime_error("Failed to open RocksDB (chat): " + status.ToString());
+    }
+    impl.writer = std::make_unique<WriteCoordinator>(impl.db, impl.handles, options.write);
+    return chat_db;
+}
+
+rocksdb::DB* ChatDB::db() const {
+    return impl_->db;
+}
+
+rocksdb::ColumnFamilyHandle* ChatDB::cf(ChatColumnFamily family) const {
+    return impl_->handles[1 + static_cast<int>(family)];
+}
+
+const std::string& ChatDB::path() const {
+    return impl_->path;
+}
+
+int64_t ChatDB::dedup_ttl_ms() const {
+    return impl_->dedup_ttl_ms;
+}
+
+bool ChatDB::Write(rocksdb::WriteBatch* batch) {
+    if (!impl_->writer || !batch)
+        return false;
+    if (batch->Count() == 0)
+        return true;
+    return impl_->writer->Write(batch);
+}
+
+WriteCoordinator::Stats ChatDB::write_stats() const {
+    return impl_->writer ? impl_->writer->stats() : WriteCoordinator::Stats{};
+}
+
+int64_t ChatDB::ImportLegacy(const std::string& legacy_db_path) {
+    rocksdb::DBOptions legacy_options;
+    std::vector<std::string> names;
+    if (!rocksdb::DB::ListColumnFamilies(legacy_options, legacy_db_path, &names).ok())
+        return -1;
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (const auto& name : names) {
+        rocksdb::ColumnFamilyOptions cf_options;
+        // 旧 conv 库的 unread: 键是 merge 写入的，读时需要同一个 operator 合并
+        if (name == rocksdb::kDefaultColumnFamilyName)
+            cf_options.merge_operator = detail::NewUnreadCounterMergeOperator();
+        descriptors.emplace_back(name, cf_options);
+    }
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    rocksdb::DB* legacy = nullptr;
+    if (!rocksdb::DB::OpenForReadOnly(legacy_options, legacy_db_path, descriptors, &handles, &legacy).ok())
+        return -1;
+
+    int64_t imported = 0;
+    bool ok = true;
+    rocksdb::WriteBatch batch;
+    for (size_t i = 0; i < handles.size() && ok; ++i) {
+        std::unique_ptr<rocksdb::Iterator> it(legacy->NewIterator(rocksdb::ReadOptions(), handles[i]));
+        for (it->SeekToFirst(); it->Valid() && ok; it->Next()) {
+            ChatColumnFamily family;
+            if (!RouteLegacyKey(descriptors[i].name, it->key(), &family))
+                continue;
+            batch.Put(cf(family), it->key(), it->value());
+            ++imported;
+            if (batch.Count() >= 1000) {
+                ok = Write(&batch);
+                batch.Clear();
+            }
+        }
+        ok = ok && it->status().ok();
+    }
+    if (ok)
+        ok = Write(&batch);
+
+    for (auto* h : handles)
+        legacy->DestroyColumnFamilyHandle(h);
+    delete legacy;
+    return ok ? imported : -1;
+}
+
+bool ChatDB::LegacyImported() const {
+    std::string value;
+    return impl_->db->Get(rocksdb::ReadOptions(), impl_->handles[0], kLegacyImportedKey, &value).ok();
+}
+
+bool ChatDB::MarkLegacyImported() {
+    // 导入数据已经 Write 进 WAL；标记以 sync 写在其后，WAL 按序恢复，有标记即有全部导入数据
+    rocksdb::WriteOptions write_options;
+    write_options.sync = true;
+    return impl_->db->Put(write_options, impl_->handles[0], kLegacyImportedKey, "1").ok();
+}
+
+// ============================================================================
+// ChatWriteBatch
+// ============================================================================
+
+ChatWriteBatch::ChatWriteBatch(std::shared_ptr<ChatDB> db)
+    : db_(std::move(db)), batch_(std::make_unique<rocksdb::WriteBatch>()) {}
+
+ChatWriteBatch::~ChatWriteBatch() = default;
+
+bool ChatWriteBatch::Commit() {
+    return db_ && db_->Write(batch_.get());
+}
+
+bool WriteOrStage(ChatDB& db, ChatWriteBatch* batch,
+                  const std::function<void(rocksdb::WriteBatch&)>& fill) {
+    if (batch && batch->db() == &db) {
+        fill(*batch->batch());
+        return true;
+    }
+    rocksdb::WriteBatch local;
+    fill(local);
+    return db.Write(&local);
+}
+
+}  // namespace swift::chat
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "write_coordinator.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace rocksdb {
+class ColumnFamilyHandle;
+class CompactionFilter;
+class DB;
+class MergeOperator;
+class WriteBatch;
+}  // namespace rocksdb
+
+namespace swift::chat {
+
+/**
+ * ChatSvr 单一 RocksDB 的列族。
+ * 各 store 的 key 仍保留原前缀（msg:、chat: ...），列族内前缀虽冗余，但旧版分库数据可按前缀原样导入（见 ImportLegacy）。
+ * 按前缀扫描的列族（timelines、offline、conversations、members）以 "{keyspace}:{owner}:" 为 prefix_extractor
+ * 建前缀布隆过滤器（swift/rocksdb_prefix.h）；其余列族只做点查，用整 key 布隆过滤器。
+ */
+enum class ChatColumnFamily : int {
+    MESSAGES = 0,   // msg:{msg_id}
+    TIMELINES,      // chat:{conversation_id}:{rev_ts}:{msg_id}
+    OFFLINE,        // offline:{user_id}:{rev_ts}:{msg_id}
+    CONVERSATIONS,  // conv:{user_id}:{conversation_id}、unread:{user_id}:{conversation_id}
+    CONV_META,      // conv_meta:{conversation_id}
+    GROUPS,         // group:{group_id}
+    MEMBERS,        // group_member:{group_id}:{user_id}、user_groups:{user_id}:{group_id}
+    DEDUP,          // {from_user_id}:{client_msg_id}
+    COUNT,
+};
+
+struct ChatDBOptions {
+    int64_t block_cache_mb = 256;            // 所有列族共用的块缓存
+    int64_t write_buffer_mb = 128;           // 所有列族 memtable 总上限（WriteBufferManager，计入块缓存）
+    int max_background_jobs = 4;             // 整库一份 flush/compaction 线程
+    int64_t dedup_ttl_ms = 24LL * 3600 * 1000;  // dedup 列族压缩时的过期时长
+    WriteCoordinatorOptions write;           // 持久化模式与组提交窗口
+    int bloom_bits_per_key = 10;             // 布隆过滤器每 key 位数；0 关闭过滤器与前缀提取器（基准对比用）
+};
+
+/**
+ * ChatSvr 的 RocksDB 实例：消息、会话、群组共用一个 WAL、一组后台线程、一个块缓存，
+ * 跨 store 的写可经 ChatWriteBatch 一次提交。
+ */
+class ChatDB {
+public:
+    /** 打开（不存在则创建）；失败抛 std::runtime_error */
+    static std::shared_ptr<ChatDB> Open(const std::string& db_path, const ChatDBOptions& options = {});
+    ~ChatDB();
+
+    rocksdb::DB* db() const;
+    rocksdb::ColumnFamilyHandle* cf(ChatColumnFamily family) const;
+    const std::string& path() const;
+    int64_t dedup_ttl_ms() const;
+
+    /** 各 store 的写都经此落盘：按 ChatDBOptions::write 的持久化模式交给 WriteCoordinator */
+    bool Write(rocksdb::WriteBatch* batch);
+    WriteCoordinator::Stats write_stats() const;
+
+    /**
+     * 导入旧版独立库（group / message / conv / conv_meta 目录）：default 列族按 key 前缀路由，
+     * 旧 message 库的 dedup 列族原样导入。返回导入条数，打开或写入失败返回 -1。
+     * 按原 key Put，重复导入结果相同：中途失败或进程退出后可整体重跑，直到 MarkLegacyImported。
+     */
+    int64_t ImportLegacy(const std::string& legacy_db_path);
+
+    /** 是否已写入导入完成标记（标记存于 default 列族，各 store 不使用该列族） */
+    bool LegacyImported() const;
+
+    /** 全部旧库导入成功后调用：同步写入完成标记，之后启动不再导入 */
+    bool MarkLegacyImported();
+
+private:
+    ChatDB();
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * 跨 store 的一次原子写：store 的写方法收到 batch 时只往里追加，由调用方 Commit（一次 ChatDB::Write）。
+ * 只应交给同一 ChatDB 上的 store；其他库上的 store 收到后退化为立即写入。
+ */
+class ChatWriteBatch {
+public:
+    explicit ChatWriteBatch(std::shared_ptr<ChatDB> db);
+    ~ChatWriteBatch();
+
+    ChatDB* db() const { return db_.get(); }
+    rocksdb::WriteBatch* batch() { return batch_.get(); }
+    bool Commit();
+
+private:
+    std::shared_ptr<ChatDB> db_;
+    std::unique_ptr<rocksdb::WriteBatch> batch_;
+};
+
+/** store 写入辅助：batch 属于 db 时把 fill 追加进去（由调用方提交），否则填入临时批立即提交 */
+bool WriteOrStage(ChatDB& db, ChatWriteBatch* batch,
+                  const std::function<void(rocksdb::WriteBatch&)>& fill);
+
+namespace detail {
+// 列族专用组件，值格式定义在 message_store.cpp，由其实现
+std::shared_ptr<rocksdb::MergeOperator> NewUnreadCounterMergeOperator();
+std::unique_ptr<rocksdb::CompactionFilter> NewDedupExpiryFilter(int64_t ttl_ms);
+}  // namespace detail
+
+}  // namespace swift::chat
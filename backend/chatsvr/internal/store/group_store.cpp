@@ -2,75 +2,25 @@
  * @file group_store.cpp
  * @brief RocksDB 群组存储实现
  *
- * Key 设计：
- *   group:{group_id}                 -> GroupData JSON
- *   group_member:{group_id}:{user_id} -> GroupMemberData JSON
- *   user_groups:{user_id}:{group_id}  -> ""
+ * Key 设计（ChatDB 列族，见 chat_db.h）：
+ *   [groups]  group:{group_id}                 -> GroupData（二进制记录，兼容读旧 JSON，见 record_serde.h）
+ *   [members] group_member:{group_id}:{user_id} -> GroupMemberData（同上）
+ *   [members] user_groups:{user_id}:{group_id}  -> ""
  */
 
 #include "group_store.h"
-#include <nlohmann/json.hpp>
+#include "record_serde.h"
 #include <rocksdb/db.h>
 #include <rocksdb/write_batch.h>
 #include <rocksdb/iterator.h>
-#include <stdexcept>
+#include <swift/rocksdb_prefix.h>
 #include <algorithm>
 
-using json = nlohmann::json;
-
 namespace swift::group_ {
 
-namespace {
-
-// ============== 序列化 ==============
-
-std::string SerializeGroup(const GroupData& g) {
-    json j;
-    j["group_id"] = g.group_id;
-    j["group_name"] = g.group_name;
-    j["avatar_url"] = g.avatar_url;
-    j["owner_id"] = g.owner_id;
-    j["member_count"] = g.member_count;
-    j["announcement"] = g.announcement;
-    j["created_at"] = g.created_at;
-    j["updated_at"] = g.updated_at;
-    j["status"] = g.status;
-    return j.dump();
-}
-
-GroupData DeserializeGroup(const std::string& data) {
-    json j = json::parse(data);
-    GroupData g;
-    g.group_id = j.value("group_id", "");
-    g.group_name = j.value("group_name", "");
-    g.avatar_url = j.value("avatar_url", "");
-    g.owner_id = j.value("owner_id", "");
-    g.member_count = j.value("member_count", 0);
-    g.announcement = j.value("announcement", "");
-    g.created_at = j.value("created_at", static_cast<int64_t>(0));
-    g.updated_at = j.value("updated_at", static_cast<int64_t>(0));
-    g.status = j.value("status", 0);
-    return g;
-}
-
-std::string SerializeMember(const GroupMemberData& m) {
-    json j;
-    j["user_id"] = m.user_id;
-    j["role"] = m.role;
-    j["nickname"] = m.nickname;
-    j["joined_at"] = m.joined_at;
-    return j.dump();
-}
+using swift::rocksdb_prefix::PrefixScan;
 
-GroupMemberData DeserializeMember(const std::string& data) {
-    json j = json::parse(data);
-    GroupMemberData m;
-    m.user_id = j.value("user_id", "");
-    m.role = j.value("role", 1);
-    m.nickname = j.value("nickname", "");
-    m.joined_at = j.value("joined_at", static_cast<int64_t>(0));
-    return m;
-}
+namespace {
 
 // ============== Key 前缀 ==============
 
@@ -101,29 +51,29 @@ std::string PrefixUserGroups(const std::string& user_id) {
 // ============================================================================
 
 struct RocksDBGroupStore::Impl {
+    std::shared_ptr<chat::ChatDB> chat_db;
     rocksdb::DB* db = nullptr;
-    std::string db_path;
-
-    ~Impl() {
-        if (db) {
-            delete db;
-            db = nullptr;
-        }
+    rocksdb::ColumnFamilyHandle* groups_cf = nullptr;
+    rocksdb::ColumnFamilyHandle* members_cf = nullptr;  // group_member: 与 user_groups:
+
+    explicit Impl(std::shared_ptr<chat::ChatDB> d)
+        : chat_db(std::move(d)),
+          db(chat_db->db()),
+          groups_cf(chat_db->cf(chat::ChatColumnFamily::GROUPS)),
+          members_cf(chat_db->cf(chat::ChatColumnFamily::MEMBERS)) {}
+
+    bool Put(rocksdb::ColumnFamilyHandle* cf, const std::string& key, const std::string& value) {
+        rocksdb::WriteBatch batch;
+        batch.Put(cf, key, value);
+        return chat_db->Write(&batch);
     }
 };
 
 RocksDBGroupStore::RocksDBGroupStore(const std::string& db_path)
-    : impl_(std::make_unique<Impl>()) {
-    impl_->db_path = db_path;
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    options.IncreaseParallelism();
-    options.OptimizeLevelStyleCompaction();
-    rocksdb::Status status = rocksdb::DB::Open(options, db_path, &impl_->db);
-    if (!status.ok()) {
-        throw std::runtime_error("Failed to open RocksDB: " + status.ToString());
-    }
-}
+    : RocksDBGroupStore(chat::ChatDB::Open(db_path)) {}
+
+RocksDBGroupStore::RocksDBGroupStore(std::shared_ptr<chat::ChatDB> db)
+    : impl_(std::make_unique<Impl>(std::move(db))) {}
 
 RocksDBGroupStore::~RocksDBGroupStore() = default;
 
@@ -137,12 +87,10 @@ bool RocksDBGroupStore::CreateGroup(const GroupData& data) {
 
     std::string key = KeyGroup(data.group_id);
     std::string value;
-    if (impl_->db->Get(rocksdb::ReadOptions(), key, &value).ok())
+    if (impl_->db->Get(rocksdb::ReadOptions(), impl_->groups_cf, key, &value).ok())
         return false;  // 群已存在
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, key, SerializeGroup(data)).ok();
+    return impl_->Put(impl_->groups_cf, key, SerializeGroup(data));
 }
 
 std::optional<GroupData> RocksDBGroupStore::GetGroup(const std::string& group_id) {
@@ -150,7 +98,7 @@ std::optional<GroupData> RocksDBGroupStore::GetGroup(const std::string& group_id
         return std::nullopt;
 
     std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), KeyGroup(group_id), &value).ok())
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->groups_cf, KeyGroup(group_id), &value).ok())
         return std::nullopt;
 
     try {
@@ -175,9 +123,7 @@ bool RocksDBGroupStore::UpdateGroup(const std::string& group_id, const std::stri
     g->announcement = announcement;
     if (updated_at != 0)
         g->updated_at = updated_at;
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, KeyGroup(group_id), SerializeGroup(*g)).ok();
+    return impl_->Put(impl_->groups_cf, KeyGroup(group_id), SerializeGroup(*g));
 }
 
 bool RocksDBGroupStore::UpdateGroupOwner(const std::string& group_id,
@@ -189,9 +135,7 @@ bool RocksDBGroupStore::UpdateGroupOwner(const std::string& group_id,
     if (!g)
         return false;
     g->owner_id = new_owner_id;
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, KeyGroup(group_id), SerializeGroup(*g)).ok();
+    return impl_->Put(impl_->groups_cf, KeyGroup(group_id), SerializeGroup(*g));
 }
 
 bool RocksDBGroupStore::DeleteGroup(const std::string& group_id) {
@@ -201,7 +145,8 @@ bool RocksDBGroupStore::DeleteGroup(const std::string& group_id) {
     // 先收集所有成员，删除 user_groups 索引
     std::string prefix = PrefixGroupMember(group_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->members_cf));
     std::vector<std::string> user_ids;
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
@@ -213,15 +158,13 @@ bool RocksDBGroupStore::DeleteGroup(const std::string& group_id) {
     }
 
     rocksdb::WriteBatch batch;
-    batch.Delete(KeyGroup(group_id));
+    batch.Delete(impl_->groups_cf, KeyGroup(group_id));
     for (const auto& uid : user_ids) {
-        batch.Delete(KeyGroupMember(group_id, uid));
-        batch.Delete(KeyUserGroup(uid, group_id));
+        batch.Delete(impl_->members_cf, KeyGroupMember(group_id, uid));
+        batch.Delete(impl_->members_cf, KeyUserGroup(uid, group_id));
     }
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return impl_->chat_db->Write(&batch);
 }
 
 bool RocksDBGroupStore::DissolveGroup(const std::string& group_id) {
@@ -236,7 +179,8 @@ bool RocksDBGroupStore::DissolveGroup(const std::string& group_id) {
 
     std::string prefix = PrefixGroupMember(group_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->members_cf));
     std::vector<std::string> user_ids;
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
@@ -250,15 +194,13 @@ bool RocksDBGroupStore::DissolveGroup(const std::string& group_id) {
     rocksdb::WriteBatch batch;
     g->status = 1;
     g->member_count = 0;
-    batch.Put(KeyGroup(group_id), SerializeGroup(*g));
+    batch.Put(impl_->groups_cf, KeyGroup(group_id), SerializeGroup(*g));
     for (const auto& uid : user_ids) {
-        batch.Delete(KeyGroupMember(group_id, uid));
-        batch.Delete(KeyUserGroup(uid, group_id));
+        batch.Delete(impl_->members_cf, KeyGroupMember(group_id, uid));
+        batch.Delete(impl_->members_cf, KeyUserGroup(uid, group_id));
     }
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return impl_->chat_db->Write(&batch);
 }
 
 // ============================================================================
@@ -271,7 +213,7 @@ bool RocksDBGroupStore::AddMember(const std::string& group_id, const GroupMember
 
     std::string mem_key = KeyGroupMember(group_id, member.user_id);
     std::string value;
-    if (impl_->db->Get(rocksdb::ReadOptions(), mem_key, &value).ok())
+    if (impl_->db->Get(rocksdb::ReadOptions(), impl_->members_cf, mem_key, &value).ok())
         return false;  // 已是成员
 
     auto g = GetGroup(group_id);
@@ -279,15 +221,13 @@ bool RocksDBGroupStore::AddMember(const std::string& group_id, const GroupMember
         return false;
 
     rocksdb::WriteBatch batch;
-    batch.Put(mem_key, SerializeMember(member));
-    batch.Put(KeyUserGroup(member.user_id, group_id), "");
+    batch.Put(impl_->members_cf, mem_key, SerializeMember(member));
+    batch.Put(impl_->members_cf, KeyUserGroup(member.user_id, group_id), "");
     g->member_count++;
     g->updated_at = 0;  // 上层可再写回
-    batch.Put(KeyGroup(group_id), SerializeGroup(*g));
+    batch.Put(impl_->groups_cf, KeyGroup(group_id), SerializeGroup(*g));
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return impl_->chat_db->Write(&batch);
 }
 
 bool RocksDBGroupStore::RemoveMember(const std::string& group_id, const std::string& user_id) {
@@ -296,7 +236,7 @@ bool RocksDBGroupStore::RemoveMember(const std::string& group_id, const std::str
 
     std::string mem_key = KeyGroupMember(group_id, user_id);
     std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), mem_key, &value).ok())
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->members_cf, mem_key, &value).ok())
         return false;  // 不是成员
 
     auto g = GetGroup(group_id);
@@ -304,14 +244,12 @@ bool RocksDBGroupStore::RemoveMember(const std::string& group_id, const std::str
         return false;
 
     rocksdb::WriteBatch batch;
-    batch.Delete(mem_key);
-    batch.Delete(KeyUserGroup(user_id, group_id));
+    batch.Delete(impl_->members_cf, mem_key);
+    batch.Delete(impl_->members_cf, KeyUserGroup(user_id, group_id));
     g->member_count = std::max(0, g->member_count - 1);
-    batch.Put(KeyGroup(group_id), SerializeGroup(*g));
+    batch.Put(impl_->groups_cf, KeyGroup(group_id), SerializeGroup(*g));
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return impl_->chat_db->Write(&batch);
 }
 
 std::optional<GroupMemberData> RocksDBGroupStore::GetMember(const std::string& group_id,
@@ -320,7 +258,8 @@ std::optional<GroupMemberData> RocksDBGroupStore::GetMember(const std::string& g
         return std::nullopt;
 
     std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), KeyGroupMember(group_id, user_id), &value).ok())
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->members_cf, KeyGroupMember(group_id, user_id),
+                        &value).ok())
         return std::nullopt;
 
     try {
@@ -339,7 +278,8 @@ std::vector<GroupMemberData> RocksDBGroupStore::GetMembers(const std::string& gr
 
     std::string prefix = PrefixGroupMember(group_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->members_cf));
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
             break;
@@ -372,16 +312,15 @@ bool RocksDBGroupStore::UpdateMemberRole(const std::string& group_id, const std:
         return false;
 
     m->role = role;
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, KeyGroupMember(group_id, user_id), SerializeMember(*m)).ok();
+    return impl_->Put(impl_->members_cf, KeyGroupMember(group_id, user_id), SerializeMember(*m));
 }
 
 bool RocksDBGroupStore::IsMember(const std::string& group_id, const std::string& user_id) {
     if (!impl_->db || group_id.empty() || user_id.empty())
         return false;
     std::string value;
-    return impl_->db->Get(rocksdb::ReadOptions(), KeyGroupMember(group_id, user_id), &value).ok();
+    return impl_->db->Get(rocksdb::ReadOptions(), impl_->members_cf, KeyGroupMember(group_id, user_id),
+                          &value).ok();
 }
 
 std::vector<std::string> RocksDBGroupStore::GetUserGroupIds(const std::string& user_id) {
@@ -391,7 +330,8 @@ std::vector<std::string> RocksDBGroupStore::GetUserGroupIds(const std::string& u
 
     std::string prefix = PrefixUserGroups(user_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->members_cf));
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
             break;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "chat_db.h"
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -36,10 +37,10 @@ struct GroupMemberData {
 /**
  * 群组存储接口
  *
- * RocksDB Key 设计：
- *   group:{group_id}                 -> GroupData JSON
- *   group_member:{group_id}:{user_id} -> GroupMemberData JSON
- *   user_groups:{user_id}:{group_id}  -> "" (用户加入的群索引)
+ * RocksDB Key 设计（ChatDB 列族）：
+ *   [groups]  group:{group_id}                 -> GroupData（二进制记录）
+ *   [members] group_member:{group_id}:{user_id} -> GroupMemberData（二进制记录）
+ *   [members] user_groups:{user_id}:{group_id}  -> "" (用户加入的群索引)
  */
 class GroupStore {
 public:
@@ -77,7 +78,10 @@ public:
  */
 class RocksDBGroupStore : public GroupStore {
 public:
+    /** 独占打开 db_path 上的 ChatDB（测试与单独使用） */
     explicit RocksDBGroupStore(const std::string& db_path);
+    /** 与消息、会话 store 共用 ChatDB */
+    explicit RocksDBGroupStore(std::shared_ptr<chat::ChatDB> db);
     ~RocksDBGroupStore() override;
 
     bool CreateGroup(const GroupData& data) override;
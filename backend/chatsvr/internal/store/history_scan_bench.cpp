@@ -0,0 +1,134 @@
+/**
+ * @file history_scan_bench.cpp
+ * @brief 历史分页读放大基准：关闭 / 开启布隆过滤器与前缀提取器时，每页 GetHistory 的块缓存未命中数
+ *
+ * 编译: 随 BUILD_CHATSVR_TESTS 生成 history_scan_bench（不注册为 ctest）
+ * 运行: ./history_scan_bench [conversations] [rounds] [pages] [db_dir]
+ *
+ * 每轮随机挑约 10% 的会话各写 5 条消息后 flush，使每个会话的时间线分散在多个 SST 中（近似真实的冷热分布）；
+ * 写完关闭重开（冷缓存），随机取 pages 个会话各读一页（50 条），用 PerfContext 统计：
+ *   block reads  - 块缓存未命中、从文件读的块数（data/index/filter）
+ *   cache hits   - 块缓存命中数
+ *   bloom skips  - SST 过滤器判定不含目标、直接跳过的次数
+ */
+
+#include "chat_db.h"
+#include "message_store.h"
+#include <rocksdb/db.h>
+#include <rocksdb/options.h>
+#include <rocksdb/perf_context.h>
+#include <rocksdb/perf_level.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace swift::chat;
+
+namespace {
+
+constexpr int kPageSize = 50;
+constexpr int kMessagesPerRound = 5;
+
+std::string ConvId(int i) {
+    return "p_u_" + std::to_string(i) + "_u_peer";
+}
+
+ChatDBOptions BenchOptions(int bloom_bits_per_key) {
+    ChatDBOptions options;
+    options.block_cache_mb = 8;  // 小缓存，读放大直接体现为未命中
+    options.write_buffer_mb = 16;
+    options.bloom_bits_per_key = bloom_bits_per_key;
+    options.write.durability = Durability::WAL_NO_SYNC;  // 只关心读路径，灌数据不必逐条 fsync
+    return options;
+}
+
+void Populate(const std::string& path, int bloom_bits_per_key, int conversations, int rounds) {
+    auto db = ChatDB::Open(path, BenchOptions(bloom_bits_per_key));
+    RocksDBMessageStore store(db);
+    std::mt19937 rng(42);  // 固定种子：两种配置写入完全相同的数据
+    std::uniform_int_distribution<int> pick(0, 9);
+    int64_t ts = 1700000000000;
+    int seq = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (int c = 0; c < conversations; ++c) {
+            if (pick(rng) != 0)
+                continue;
+            for (int k = 0; k < kMessagesPerRound; ++k) {
+                MessageData msg;
+                msg.msg_id = "m_" + std::to_string(seq++);
+                msg.from_user_id = "u_" + std::to_string(c);
+                msg.to_id = "u_peer";
+                msg.conversation_id = ConvId(c);
+                msg.content = "history scan benchmark message body";
+                msg.media_type = "text";
+                msg.timestamp = ++ts;
+                store.Save(msg);
+            }
+        }
+        for (auto family : {ChatColumnFamily::MESSAGES, ChatColumnFamily::TIMELINES})
+            db->db()->Flush(rocksdb::FlushOptions(), db->cf(family));
+    }
+}
+
+void Measure(const char* label, const std::string& path, int bloom_bits_per_key,
+             int conversations, int pages) {
+    auto db = ChatDB::Open(path, BenchOptions(bloom_bits_per_key));
+    RocksDBMessageStore store(db);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, conversations - 1);
+
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
+    uint64_t block_reads = 0, cache_hits = 0, bloom_skips = 0, messages = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < pages; ++p) {
+        rocksdb::get_perf_context()->Reset();
+        messages += store.GetHistory(ConvId(pick(rng)), 1, "", kPageSize).size();
+        const auto* ctx = rocksdb::get_perf_context();
+        block_reads += ctx->block_read_count;
+        cache_hits += ctx->block_cache_hit_count;
+        bloom_skips += ctx->bloom_sst_miss_count;
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
+
+    std::string sst_count;
+    db->db()->GetProperty(db->cf(ChatColumnFamily::TIMELINES), "rocksdb.num-files-at-level0", &sst_count);
+    std::printf("%-16s %12.1f %12.1f %12.1f %10.1f %10.1f %8s\n", label,
+                static_cast<double>(block_reads) / pages, static_cast<double>(cache_hits) / pages,
+                static_cast<double>(bloom_skips) / pages, static_cast<double>(messages) / pages,
+                us / pages, sst_count.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int conversations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 40;
+    int pages = argc > 3 ? std::atoi(argv[3]) : 1000;
+    std::string dir = argc > 4 ? argv[4] : "/tmp";
+    if (conversations <= 0) conversations = 2000;
+    if (rounds <= 0) rounds = 40;
+    if (pages <= 0) pages = 1000;
+
+    std::printf("conversations=%d rounds=%d pages=%d page_size=%d dir=%s\n", conversations, rounds, pages,
+                kPageSize, dir.c_str());
+    std::printf("%-16s %12s %12s %12s %10s %10s %8s\n", "config", "block reads", "cache hits", "bloom skips",
+                "msgs/page", "us/page", "L0 SSTs");
+
+    struct Config {
+        const char* label;
+        int bloom_bits_per_key;
+    };
+    for (const Config& config : {Config{"no_filter", 0}, Config{"prefix_bloom", 10}}) {
+        std::string path = dir + "/history_scan_bench_" + config.label;
+        std::filesystem::remove_all(path);
+        Populate(path, config.bloom_bits_per_key, conversations, rounds);
+        Measure(config.label, path, config.bloom_bits_per_key, conversations, pages);
+        std::filesystem::remove_all(path);
+    }
+    return 0;
+}
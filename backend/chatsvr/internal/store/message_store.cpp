@@ -2,27 +2,38 @@
  * @file message_store.cpp
  * @brief RocksDB 消息与会话存储实现
  *
- * Key 设计：
- *   msg:{msg_id}                              -> MessageData JSON
- *   chat:{conversation_id}:{rev_ts}:{msg_id}  -> "" (会话时间线，rev_ts=MAX_TS-ts 便于倒序)
- *   offline:{user_id}:{rev_ts}:{msg_id}       -> "" (离线队列，按时间倒序)
- *   conv:{user_id}:{conversation_id}         -> ConversationData JSON
- *   conv_meta:{conversation_id}               -> 私聊会话元信息（ConversationRegistry）
+ * 所有 store 共用一个 ChatDB（chat_db.h），按列族存放；Key 设计：
+ *   [messages]      msg:{msg_id}                              -> MessageData（二进制记录，兼容读旧 JSON，见 record_serde.h）
+ *   [timelines]     chat:{conversation_id}:{rev_ts}:{msg_id}  -> from_user_id (会话时间线，rev_ts=MAX_TS-ts 便于倒序；旧数据为 "")
+ *   [offline]       offline:{user_id}:{rev_ts}:{msg_id}       -> "" (私聊离线队列，按时间倒序)
+ *   [conversations] conv:{user_id}:{conversation_id}         -> ConversationData（同上）
+ *   [conversations] unread:{user_id}:{conversation_id}       -> 未读计数，"+N"/"=N"，经 UnreadCounterMergeOperator 累加（见 GetList）
+ *   [conv_meta]     conv_meta:{conversation_id}               -> 私聊会话元信息（ConversationRegistry）
+ *   [dedup]         {from_user_id}:{client_msg_id}            -> {saved_at_ms}:{msg_id}（发送去重索引）
  *
  * 撤回：仅更新消息 status=1、recall_at，不删除；服务器仍保留该消息。
+ * 群聊：消息只写一次（msg + 群时间线），成员的离线与未读在读取时按 conv 记录中的 read_ts 从群时间线推导。
  */
 
 #include "message_store.h"
+#include "record_serde.h"
 #include <nlohmann/json.hpp>
+#include <rocksdb/compaction_filter.h>
 #include <rocksdb/db.h>
 #include <rocksdb/iterator.h>
+#include <rocksdb/merge_operator.h>
 #include <rocksdb/write_batch.h>
+#include <swift/rocksdb_prefix.h>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <cstdint>
+#include <cstdlib>
+#include <map>
 
 using json = nlohmann::json;
+using swift::rocksdb_prefix::PrefixScan;
 
 namespace swift::chat {
 
@@ -30,75 +41,6 @@ namespace {
 
 constexpr int64_t MAX_TS = 9999999999999;  // 用于 rev_ts = MAX_TS - timestamp，使键按时间倒序
 
-// ============== 序列化 ==============
-
-std::string SerializeMessage(const MessageData& m) {
-    json j;
-    j["msg_id"] = m.msg_id;
-    j["from_user_id"] = m.from_user_id;
-    j["to_id"] = m.to_id;
-    j["conversation_id"] = m.conversation_id;
-    j["chat_type"] = m.chat_type;
-    j["content"] = m.content;
-    j["media_url"] = m.media_url;
-    j["media_type"] = m.media_type;
-    j["mentions"] = m.mentions;
-    j["reply_to_msg_id"] = m.reply_to_msg_id;
-    j["timestamp"] = m.timestamp;
-    j["status"] = m.status;
-    j["recall_at"] = m.recall_at;
-    return j.dump();
-}
-
-MessageData DeserializeMessage(const std::string& data) {
-    json j = json::parse(data);
-    MessageData m;
-    m.msg_id = j.value("msg_id", "");
-    m.from_user_id = j.value("from_user_id", "");
-    m.to_id = j.value("to_id", "");
-    m.conversation_id = j.value("conversation_id", j.value("chat_id", ""));
-    m.chat_type = j.value("chat_type", 1);
-    m.content = j.value("content", "");
-    m.media_url = j.value("media_url", "");
-    m.media_type = j.value("media_type", "");
-    if (j.contains("mentions") && j["mentions"].is_array()) {
-        for (const auto& x : j["mentions"])
-            m.mentions.push_back(x.get<std::string>());
-    }
-    m.reply_to_msg_id = j.value("reply_to_msg_id", "");
-    m.timestamp = j.value("timestamp", static_cast<int64_t>(0));
-    m.status = j.value("status", 0);
-    m.recall_at = j.value("recall_at", static_cast<int64_t>(0));
-    return m;
-}
-
-std::string SerializeConversation(const ConversationData& c) {
-    json j;
-    j["conversation_id"] = c.conversation_id;
-    j["chat_type"] = c.chat_type;
-    j["peer_id"] = c.peer_id;
-    j["last_msg_id"] = c.last_msg_id;
-    j["unread_count"] = c.unread_count;
-    j["updated_at"] = c.updated_at;
-    j["is_pinned"] = c.is_pinned;
-    j["is_muted"] = c.is_muted;
-    return j.dump();
-}
-
-ConversationData DeserializeConversation(const std::string& data) {
-    json j = json::parse(data);
-    ConversationData c;
-    c.conversation_id = j.value("conversation_id", j.value("chat_id", ""));
-    c.chat_type = j.value("chat_type", 1);
-    c.peer_id = j.value("peer_id", "");
-    c.last_msg_id = j.value("last_msg_id", "");
-    c.unread_count = j.value("unread_count", 0);
-    c.updated_at = j.value("updated_at", static_cast<int64_t>(0));
-    c.is_pinned = j.value("is_pinned", false);
-    c.is_muted = j.value("is_muted", false);
-    return c;
-}
-
 // ============== Key ==============
 
 constexpr const char* K_MSG = "msg:";
@@ -106,6 +48,8 @@ constexpr const char* K_CHAT = "chat:";
 constexpr const char* K_OFFLINE = "offline:";
 constexpr const char* K_CONV = "conv:";
 constexpr const char* K_CONV_META = "conv_meta:";
+constexpr const char* K_UNREAD = "unread:";
+constexpr const char* K_UNREAD_MIGRATED = "meta:unread_counters_migrated";  // 旧 unread_count 已折算进计数键
 
 std::string KeyMsg(const std::string& msg_id) {
     return std::string(K_MSG) + msg_id;
@@ -147,6 +91,14 @@ std::string PrefixConv(const std::string& user_id) {
     return std::string(K_CONV) + user_id + ":";
 }
 
+std::string KeyUnread(const std::string& user_id, const std::string& conversation_id) {
+    return std::string(K_UNREAD) + user_id + ":" + conversation_id;
+}
+
+std::string PrefixUnread(const std::string& user_id) {
+    return std::string(K_UNREAD) + user_id + ":";
+}
+
 // 从 chat key 解析出 rev_ts 和 msg_id: chat:{chat_id}:{rev_ts}:{msg_id}
 void ParseChatKey(const std::string& key, const std::string& prefix,
                   std::string& rev_ts, std::string& msg_id) {
@@ -156,6 +108,107 @@ void ParseChatKey(const std::string& key, const std::string& prefix,
     msg_id = key.substr(pos + 14);
 }
 
+// dedup 列族：{from_user_id}:{client_msg_id} -> {saved_at_ms}:{msg_id}
+std::string KeyDedup(const std::string& from_user_id, const std::string& client_msg_id) {
+    return from_user_id + ":" + client_msg_id;
+}
+
+std::string DedupValue(int64_t saved_at_ms, const std::string& msg_id) {
+    return std::to_string(saved_at_ms) + ":" + msg_id;
+}
+
+bool ParseDedupValue(const rocksdb::Slice& value, int64_t* saved_at_ms, std::string* msg_id) {
+    std::string v = value.ToString();
+    size_t colon = v.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 >= v.size())
+        return false;
+    char* end = nullptr;
+    long long ts = std::strtoll(v.c_str(), &end, 10);
+    if (end != v.c_str() + colon)
+        return false;
+    *saved_at_ms = ts;
+    if (msg_id) *msg_id = v.substr(colon + 1);
+    return true;
+}
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/** 压缩时丢弃超过 TTL 的去重记录（及无法解析的脏数据），去重索引无需显式删除 */
+class DedupExpiryFilter : public rocksdb::CompactionFilter {
+public:
+    explicit DedupExpiryFilter(int64_t ttl_ms) : ttl_ms_(ttl_ms) {}
+
+    bool Filter(int /*level*/, const rocksdb::Slice& /*key*/, const rocksdb::Slice& existing_value,
+                std::string* /*new_value*/, bool* /*value_changed*/) const override {
+        int64_t saved_at = 0;
+        if (!ParseDedupValue(existing_value, &saved_at, nullptr))
+            return true;
+        return NowMs() - saved_at >= ttl_ms_;
+    }
+
+    const char* Name() const override { return "swift.chat.DedupExpiryFilter"; }
+
+private:
+    int64_t ttl_ms_;
+};
+
+// ============== 未读计数 ==============
+//
+// 值与 merge 操作数同一格式："+N" 表示在 conv 记录的 unread_count 之上再加 N（从未清零过），
+// "=N" 表示绝对值 N（清零之后的累加）。两者合并满足结合律，故可用 AssociativeMergeOperator：
+// 自增与清零都是盲写，不读旧值，并发发送不会丢增量。
+
+struct UnreadCounter {
+    bool absolute = false;
+    int64_t value = 0;
+};
+
+bool ParseUnreadCounter(const rocksdb::Slice& s, UnreadCounter* out) {
+    if (s.size() < 2 || (s[0] != '+' && s[0] != '='))
+        return false;
+    std::string digits(s.data() + 1, s.size() - 1);
+    char* end = nullptr;
+    long long v = std::strtoll(digits.c_str(), &end, 10);
+    if (end != digits.c_str() + digits.size())
+        return false;
+    out->absolute = s[0] == '=';
+    out->value = v;
+    return true;
+}
+
+std::string UnreadCounterValue(bool absolute, int64_t value) {
+    return (absolute ? "=" : "+") + std::to_string(value);
+}
+
+class UnreadCounterMergeOperator : public rocksdb::AssociativeMergeOperator {
+public:
+    bool Merge(const rocksdb::Slice& /*key*/, const rocksdb::Slice* existing_value,
+               const rocksdb::Slice& value, std::string* new_value,
+               rocksdb::Logger* /*logger*/) const override {
+        UnreadCounter rhs;
+        if (!ParseUnreadCounter(value, &rhs))
+            return false;
+        UnreadCounter lhs;
+        if (!existing_value || !ParseUnreadCounter(*existing_value, &lhs) || rhs.absolute) {
+            *new_value = UnreadCounterValue(rhs.absolute, rhs.value);
+            return true;
+        }
+        *new_value = UnreadCounterValue(lhs.absolute, lhs.value + rhs.value);
+        return true;
+    }
+
+    const char* Name() const override { return "swift.chat.UnreadCounterMergeOperator"; }
+};
+
+// conv 记录中的 unread_count 叠加计数键，得到最终未读数
+int ApplyUnreadCounter(int record_unread, const UnreadCounter& counter) {
+    int64_t n = counter.absolute ? counter.value : record_unread + counter.value;
+    return static_cast<int>(std::clamp<int64_t>(n, 0, INT32_MAX));
+}
+
 void ParseOfflineKey(const std::string& key, const std::string& prefix,
                      std::string& rev_ts, std::string& msg_id) {
     size_t pos = prefix.size();
@@ -166,52 +219,102 @@ void ParseOfflineKey(const std::string& key, const std::string& prefix,
 
 }  // namespace
 
+namespace detail {
+
+std::shared_ptr<rocksdb::MergeOperator> NewUnreadCounterMergeOperator() {
+    return std::make_shared<UnreadCounterMergeOperator>();
+}
+
+std::unique_ptr<rocksdb::CompactionFilter> NewDedupExpiryFilter(int64_t ttl_ms) {
+    return std::make_unique<DedupExpiryFilter>(ttl_ms);
+}
+
+}  // namespace detail
+
 // ============================================================================
 // RocksDBMessageStore
 // ============================================================================
 
 struct RocksDBMessageStore::Impl {
+    std::shared_ptr<ChatDB> chat_db;
     rocksdb::DB* db = nullptr;
-    std::string db_path;
-
-    ~Impl() {
-        if (db) {
-            delete db;
-            db = nullptr;
+    rocksdb::ColumnFamilyHandle* messages_cf = nullptr;
+    rocksdb::ColumnFamilyHandle* timelines_cf = nullptr;
+    rocksdb::ColumnFamilyHandle* offline_cf = nullptr;
+    rocksdb::ColumnFamilyHandle* dedup_cf = nullptr;
+    int64_t dedup_ttl_ms = 0;
+
+    explicit Impl(std::shared_ptr<ChatDB> d)
+        : chat_db(std::move(d)),
+          db(chat_db->db()),
+          messages_cf(chat_db->cf(ChatColumnFamily::MESSAGES)),
+          timelines_cf(chat_db->cf(ChatColumnFamily::TIMELINES)),
+          offline_cf(chat_db->cf(ChatColumnFamily::OFFLINE)),
+          dedup_cf(chat_db->cf(ChatColumnFamily::DEDUP)),
+          dedup_ttl_ms(chat_db->dedup_ttl_ms()) {}
+
+    /** 按 msg_ids 顺序批量读取消息（一次 MultiGet，同批 key 共享 SST 查找与块读取）；缺失或无法解析的跳过 */
+    std::vector<MessageData> MultiGetMessages(const std::vector<std::string>& msg_ids) const {
+        std::vector<MessageData> result;
+        if (msg_ids.empty())
+            return result;
+        const size_t n = msg_ids.size();
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        for (const auto& id : msg_ids)
+            keys.push_back(KeyMsg(id));
+        std::vector<rocksdb::Slice> key_slices(keys.begin(), keys.end());
+        std::vector<rocksdb::PinnableSlice> values(n);
+        std::vector<rocksdb::Status> statuses(n);
+        db->MultiGet(rocksdb::ReadOptions(), messages_cf, n, key_slices.data(), values.data(), statuses.data());
+
+        result.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!statuses[i].ok())
+                continue;
+            try {
+                result.push_back(DeserializeMessage(values[i].ToString()));
+            } catch (...) {
+            }
         }
+        return result;
     }
 };
 
-RocksDBMessageStore::RocksDBMessageStore(const std::string& db_path)
-    : impl_(std::make_unique<Impl>()) {
-    impl_->db_path = db_path;
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    options.IncreaseParallelism();
-    options.OptimizeLevelStyleCompaction();
-    rocksdb::Status status = rocksdb::DB::Open(options, db_path, &impl_->db);
-    if (!status.ok()) {
-        throw std::runtime_error("Failed to open RocksDB (message): " + status.ToString());
-    }
-}
+RocksDBMessageStore::RocksDBMessageStore(const std::string& db_path, int64_t dedup_ttl_ms)
+    : RocksDBMessageStore(ChatDB::Open(db_path, [&] {
+          ChatDBOptions options;
+          options.dedup_ttl_ms = dedup_ttl_ms;
+          return options;
+      }())) {}
+
+RocksDBMessageStore::RocksDBMessageStore(std::shared_ptr<ChatDB> db)
+    : impl_(std::make_unique<Impl>(std::move(db))) {}
 
 RocksDBMessageStore::~RocksDBMessageStore() = default;
 
-bool RocksDBMessageStore::Save(const MessageData& msg) {
+std::unique_ptr<ChatWriteBatch> RocksDBMessageStore::NewWriteBatch() {
+    return std::make_unique<ChatWriteBatch>(impl_->chat_db);
+}
+
+bool RocksDBMessageStore::Save(const MessageData& msg, ChatWriteBatch* batch) {
     if (!impl_->db || msg.msg_id.empty() || msg.from_user_id.empty())
         return false;
 
     std::string value;
-    if (impl_->db->Get(rocksdb::ReadOptions(), KeyMsg(msg.msg_id), &value).ok())
+    if (impl_->db->Get(rocksdb::ReadOptions(), impl_->messages_cf, KeyMsg(msg.msg_id), &value).ok())
         return false;  // 已存在，不允许覆盖（或可改为 Upsert，按需求）
 
-    rocksdb::WriteBatch batch;
-    batch.Put(KeyMsg(msg.msg_id), SerializeMessage(msg));
-    std::string timeline_id = msg.conversation_id.empty() ? msg.to_id : msg.conversation_id;
-    batch.Put(KeyChat(timeline_id, msg.timestamp, msg.msg_id), "");
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return WriteOrStage(*impl_->chat_db, batch, [&](rocksdb::WriteBatch& wb) {
+        wb.Put(impl_->messages_cf, KeyMsg(msg.msg_id), SerializeMessage(msg));
+        std::string timeline_id = msg.conversation_id.empty() ? msg.to_id : msg.conversation_id;
+        // 时间线值存发送者，推导未读/离线时据此跳过本人消息而无需读消息体
+        wb.Put(impl_->timelines_cf, KeyChat(timeline_id, msg.timestamp, msg.msg_id), msg.from_user_id);
+        // 去重索引与消息同批提交：重试要么看到完整消息，要么什么都看不到
+        if (!msg.client_msg_id.empty())
+            wb.Put(impl_->dedup_cf, KeyDedup(msg.from_user_id, msg.client_msg_id),
+                   DedupValue(NowMs(), msg.msg_id));
+    });
 }
 
 std::optional<MessageData> RocksDBMessageStore::GetById(const std::string& msg_id) {
@@ -219,7 +322,7 @@ std::optional<MessageData> RocksDBMessageStore::GetById(const std::string& msg_i
         return std::nullopt;
 
     std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), KeyMsg(msg_id), &value).ok())
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->messages_cf, KeyMsg(msg_id), &value).ok())
         return std::nullopt;
 
     try {
@@ -229,6 +332,23 @@ std::optional<MessageData> RocksDBMessageStore::GetById(const std::string& msg_i
     }
 }
 
+std::optional<MessageData> RocksDBMessageStore::GetByClientMsgId(const std::string& from_user_id,
+                                                                const std::string& client_msg_id) {
+    if (!impl_->db || from_user_id.empty() || client_msg_id.empty())
+        return std::nullopt;
+
+    std::string value;
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->dedup_cf,
+                        KeyDedup(from_user_id, client_msg_id), &value).ok())
+        return std::nullopt;
+
+    int64_t saved_at = 0;
+    std::string msg_id;
+    if (!ParseDedupValue(value, &saved_at, &msg_id) || NowMs() - saved_at >= impl_->dedup_ttl_ms)
+        return std::nullopt;
+    return GetById(msg_id);
+}
+
 std::vector<MessageData> RocksDBMessageStore::GetHistory(const std::string& conversation_id,
                                                           int /*chat_type*/,
                                                           const std::string& before_msg_id,
@@ -239,7 +359,8 @@ std::vector<MessageData> RocksDBMessageStore::GetHistory(const std::string& conv
 
     std::string prefix = PrefixChat(conversation_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->timelines_cf));
 
     int64_t rev_ts_cutoff = -1;  // -1 表示不按 before 过滤，取最新 limit 条
     if (!before_msg_id.empty()) {
@@ -249,7 +370,7 @@ std::vector<MessageData> RocksDBMessageStore::GetHistory(const std::string& conv
         rev_ts_cutoff = MAX_TS - msg->timestamp;  // 只取比 before 更旧的（rev_ts > rev_ts_cutoff）
     }
 
-    std::vector<std::pair<std::string, std::string>> keys;  // rev_ts, msg_id
+    std::vector<std::string> msg_ids;
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
             break;
@@ -260,17 +381,11 @@ std::vector<MessageData> RocksDBMessageStore::GetHistory(const std::string& conv
         int64_t r = 0;
         try { r = std::stoll(rev_ts); } catch (...) { continue; }
         if (rev_ts_cutoff >= 0 && r <= rev_ts_cutoff) continue;  // 只取比 before 更旧的（r 更大 = 时间更早）
-        keys.emplace_back(rev_ts, msg_id);
-        if (static_cast<int>(keys.size()) >= limit)
+        msg_ids.push_back(std::move(msg_id));
+        if (static_cast<int>(msg_ids.size()) >= limit)
             break;
     }
-
-    for (const auto& p : keys) {
-        auto msg = GetById(p.second);
-        if (msg)
-            result.push_back(std::move(*msg));
-    }
-    return result;
+    return impl_->MultiGetMessages(msg_ids);
 }
 
 bool RocksDBMessageStore::MarkRecalled(const std::string& msg_id, int64_t recall_at) {
@@ -283,9 +398,9 @@ bool RocksDBMessageStore::MarkRecalled(const std::string& msg_id, int64_t recall
 
     msg->status = 1;
     msg->recall_at = recall_at;
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, KeyMsg(msg_id), SerializeMessage(*msg)).ok();
+    rocksdb::WriteBatch batch;
+    batch.Put(impl_->messages_cf, KeyMsg(msg_id), SerializeMessage(*msg));
+    return impl_->chat_db->Write(&batch);
 }
 
 bool RocksDBMessageStore::AddToOffline(const std::string& user_id,
@@ -296,56 +411,111 @@ bool RocksDBMessageStore::AddToOffline(const std::string& user_id,
     auto msg = GetById(msg_id);
     if (!msg)
         return false;
+    return AddToOffline(user_id, *msg, nullptr);
+}
+
+bool RocksDBMessageStore::AddToOffline(const std::string& user_id, const MessageData& msg,
+                                       ChatWriteBatch* batch) {
+    if (!impl_->db || user_id.empty() || msg.msg_id.empty())
+        return false;
 
-    std::string key = KeyOffline(user_id, msg->timestamp, msg_id);
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, key, "").ok();
+    return WriteOrStage(*impl_->chat_db, batch, [&](rocksdb::WriteBatch& wb) {
+        wb.Put(impl_->offline_cf, KeyOffline(user_id, msg.timestamp, msg.msg_id), "");
+    });
 }
 
 std::vector<MessageData> RocksDBMessageStore::PullOffline(const std::string& user_id,
                                                           const std::string& cursor,
                                                           int limit,
                                                           std::string& next_cursor,
-                                                          bool& has_more) {
+                                                          bool& has_more,
+                                                          const std::vector<TimelineSource>& timelines) {
     std::vector<MessageData> result;
     next_cursor.clear();
     has_more = false;
     if (!impl_->db || user_id.empty() || limit <= 0)
         return result;
 
-    std::string prefix = PrefixOffline(user_id);
-    rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    // 各来源的 key 后缀 {rev_ts}:{msg_id} 全局同序，按它归并；每个来源取 limit+1 条即可判断 has_more。
+    // 同一 msg_id 的后缀相同，旧版扇出写入离线队列的群消息与群时间线重叠时自然去重
+    std::map<std::string, std::string> candidates;  // position -> msg_id
+    auto collect = [&](rocksdb::ColumnFamilyHandle* cf, const std::string& prefix, int64_t after_ts,
+                       bool skip_own) {
+        rocksdb::Slice prefix_slice(prefix);
+        PrefixScan scan(prefix);
+        std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), cf));
+        int taken = 0;
+        for (it->Seek(prefix + cursor); it->Valid() && taken <= limit; it->Next()) {
+            if (!it->key().starts_with(prefix_slice))
+                break;
+            std::string key = it->key().ToString();
+            std::string position = key.substr(prefix.size());
+            if (!cursor.empty() && position <= cursor)
+                continue;
+            std::string rev_ts, msg_id;
+            ParseChatKey(key, prefix, rev_ts, msg_id);
+            if (rev_ts.size() != 13 || msg_id.empty()) continue;
+            int64_t r = 0;
+            try { r = std::stoll(rev_ts); } catch (...) { continue; }
+            if (MAX_TS - r <= after_ts)
+                break;  // 倒序扫描，之后都已读
+            if (skip_own && it->value() == rocksdb::Slice(user_id))
+                continue;
+            candidates.emplace(std::move(position), std::move(msg_id));
+            ++taken;
+        }
+    };
+    collect(impl_->offline_cf, PrefixOffline(user_id), -1, false);
+    for (const auto& src : timelines) {
+        if (!src.conversation_id.empty())
+            collect(impl_->timelines_cf, PrefixChat(src.conversation_id), src.after_ts, true);
+    }
 
-    bool skip = !cursor.empty();
-    int count = 0;
-    std::string last_rev_ts;
-    for (it->Seek(prefix); it->Valid(); it->Next()) {
-        if (!it->key().starts_with(prefix_slice))
+    std::vector<std::string> msg_ids;
+    for (const auto& [position, msg_id] : candidates) {
+        if (static_cast<int>(msg_ids.size()) >= limit) {
+            has_more = true;
             break;
-        std::string key = it->key().ToString();
-        std::string rev_ts, msg_id;
-        ParseOfflineKey(key, prefix, rev_ts, msg_id);
-        if (skip && rev_ts == cursor) { skip = false; continue; }
-        if (skip) continue;
-
-        auto msg = GetById(msg_id);
-        if (msg) {
-            result.push_back(std::move(*msg));
-            last_rev_ts = rev_ts;
-            if (++count >= limit) break;
         }
+        next_cursor = position;
+        msg_ids.push_back(msg_id);
     }
+    if (!has_more)
+        next_cursor.clear();
+    return impl_->MultiGetMessages(msg_ids);
+}
 
-    if (count >= limit && it->Valid() && it->key().starts_with(prefix_slice)) {
-        it->Next();
-        if (it->Valid() && it->key().starts_with(prefix_slice)) {
-            next_cursor = last_rev_ts;
-            has_more = true;
+MessageStore::TimelineSummary RocksDBMessageStore::SummarizeTimeline(const std::string& conversation_id,
+                                                                     int64_t after_ts,
+                                                                     const std::string& exclude_from_user_id,
+                                                                     int max_count) {
+    TimelineSummary summary;
+    if (!impl_->db || conversation_id.empty())
+        return summary;
+
+    std::string prefix = PrefixChat(conversation_id);
+    rocksdb::Slice prefix_slice(prefix);
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->timelines_cf));
+    for (it->Seek(prefix); it->Valid(); it->Next()) {
+        if (!it->key().starts_with(prefix_slice))
+            break;
+        std::string rev_ts, msg_id;
+        ParseChatKey(it->key().ToString(), prefix, rev_ts, msg_id);
+        if (rev_ts.size() != 13) continue;
+        int64_t r = 0;
+        try { r = std::stoll(rev_ts); } catch (...) { continue; }
+        int64_t ts = MAX_TS - r;
+        if (summary.latest_msg_id.empty()) {
+            summary.latest_msg_id = msg_id;
+            summary.latest_ts = ts;
         }
+        if (ts <= after_ts || summary.count >= max_count)
+            break;
+        if (exclude_from_user_id.empty() || it->value() != rocksdb::Slice(exclude_from_user_id))
+            ++summary.count;
     }
-    return result;
+    return summary;
 }
 
 bool RocksDBMessageStore::ClearOffline(const std::string& user_id,
@@ -355,15 +525,14 @@ bool RocksDBMessageStore::ClearOffline(const std::string& user_id,
     if (until_msg_id.empty()) {
         std::string prefix = PrefixOffline(user_id);
         rocksdb::Slice prefix_slice(prefix);
-        std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+        PrefixScan scan(prefix);
+        std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->offline_cf));
         rocksdb::WriteBatch batch;
         for (it->Seek(prefix); it->Valid(); it->Next()) {
             if (!it->key().starts_with(prefix_slice)) break;
-            batch.Delete(it->key().ToString());
+            batch.Delete(impl_->offline_cf, it->key());
         }
-        rocksdb::WriteOptions wo;
-        wo.sync = true;
-        return impl_->db->Write(wo, &batch).ok();
+        return impl_->chat_db->Write(&batch);
     }
 
     auto until_msg = GetById(until_msg_id);
@@ -372,7 +541,8 @@ bool RocksDBMessageStore::ClearOffline(const std::string& user_id,
     int64_t until_ts = until_msg->timestamp;
     std::string prefix = PrefixOffline(user_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->offline_cf));
     rocksdb::WriteBatch batch;
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice)) break;
@@ -383,11 +553,9 @@ bool RocksDBMessageStore::ClearOffline(const std::string& user_id,
         try { r = std::stoll(rev_ts); } catch (...) { continue; }
         int64_t ts = MAX_TS - r;
         if (ts <= until_ts)
-            batch.Delete(key);
+            batch.Delete(impl_->offline_cf, key);
     }
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Write(wo, &batch).ok();
+    return impl_->chat_db->Write(&batch);
 }
 
 // ============================================================================
@@ -395,40 +563,86 @@ bool RocksDBMessageStore::ClearOffline(const std::string& user_id,
 // ============================================================================
 
 struct RocksDBConversationStore::Impl {
+    std::shared_ptr<ChatDB> chat_db;
     rocksdb::DB* db = nullptr;
-    std::string db_path;
-
-    ~Impl() {
-        if (db) {
-            delete db;
-            db = nullptr;
+    rocksdb::ColumnFamilyHandle* cf = nullptr;  // conversations：conv: 记录与 unread: 计数键
+
+    explicit Impl(std::shared_ptr<ChatDB> d)
+        : chat_db(std::move(d)), db(chat_db->db()), cf(chat_db->cf(ChatColumnFamily::CONVERSATIONS)) {}
+
+    /**
+     * 计数键之前的版本把未读数存在 conv 记录的 unread_count 里，而 Upsert 整条覆盖记录（unread_count=0），
+     * 旧基数会在下一条私聊时丢失。首次打开时把 unread_count > 0 的记录连同已有计数折算为绝对值 "=N"，
+     * 此后记录中的 unread_count 不再影响结果。完成后写标记键，只执行一次。
+     */
+    bool MigrateLegacyUnread() {
+        std::string marker;
+        if (db->Get(rocksdb::ReadOptions(), cf, K_UNREAD_MIGRATED, &marker).ok())
+            return true;
+
+        constexpr int kBatchEntries = 10000;
+        rocksdb::WriteBatch batch;
+        const std::string prefix = K_CONV;
+        rocksdb::Slice prefix_slice(prefix);
+        PrefixScan scan(prefix);
+        scan.options().total_order_seek = true;  // "conv:" 不在前缀提取器的域内
+        std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(scan.options(), cf));
+        for (it->Seek(prefix); it->Valid(); it->Next()) {
+            if (!it->key().starts_with(prefix_slice))
+                break;
+            ConversationData c;
+            try {
+                c = DeserializeConversation(it->value().ToString());
+            } catch (...) {
+                continue;
+            }
+            std::string key = it->key().ToString();
+            size_t suffix = c.conversation_id.size() + 1;  // ":{conversation_id}"
+            if (c.unread_count <= 0 || key.size() <= prefix.size() + suffix)
+                continue;
+            std::string user_id = key.substr(prefix.size(), key.size() - prefix.size() - suffix);
+            if (KeyConv(user_id, c.conversation_id) != key)
+                continue;
+
+            std::string unread_key = KeyUnread(user_id, c.conversation_id);
+            std::string value;
+            UnreadCounter counter;
+            if (db->Get(rocksdb::ReadOptions(), cf, unread_key, &value).ok())
+                ParseUnreadCounter(value, &counter);
+            batch.Put(cf, unread_key, UnreadCounterValue(true, ApplyUnreadCounter(c.unread_count, counter)));
+            if (batch.Count() >= kBatchEntries) {
+                if (!chat_db->Write(&batch))
+                    return false;
+                batch.Clear();
+            }
         }
+        if (!it->status().ok())
+            return false;
+        it.reset();
+        batch.Put(cf, K_UNREAD_MIGRATED, "1");
+        return chat_db->Write(&batch);
     }
 };
 
 RocksDBConversationStore::RocksDBConversationStore(const std::string& db_path)
-    : impl_(std::make_unique<Impl>()) {
-    impl_->db_path = db_path;
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    options.IncreaseParallelism();
-    options.OptimizeLevelStyleCompaction();
-    rocksdb::Status status = rocksdb::DB::Open(options, db_path, &impl_->db);
-    if (!status.ok()) {
-        throw std::runtime_error("Failed to open RocksDB (conversation): " + status.ToString());
-    }
+    : RocksDBConversationStore(ChatDB::Open(db_path)) {}
+
+RocksDBConversationStore::RocksDBConversationStore(std::shared_ptr<ChatDB> db)
+    : impl_(std::make_unique<Impl>(std::move(db))) {
+    if (!impl_->MigrateLegacyUnread())
+        throw std::runtime_error("RocksDBConversationStore: migrate legacy unread counts failed");
 }
 
 RocksDBConversationStore::~RocksDBConversationStore() = default;
 
-bool RocksDBConversationStore::Upsert(const std::string& user_id, const ConversationData& conv) {
+bool RocksDBConversationStore::Upsert(const std::string& user_id, const ConversationData& conv,
+                                      ChatWriteBatch* batch) {
     if (!impl_->db || user_id.empty() || conv.conversation_id.empty())
         return false;
 
-    std::string key = KeyConv(user_id, conv.conversation_id);
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Put(wo, key, SerializeConversation(conv)).ok();
+    return WriteOrStage(*impl_->chat_db, batch, [&](rocksdb::WriteBatch& wb) {
+        wb.Put(impl_->cf, KeyConv(user_id, conv.conversation_id), SerializeConversation(conv));
+    });
 }
 
 std::vector<ConversationData> RocksDBConversationStore::GetList(const std::string& user_id) {
@@ -436,9 +650,13 @@ std::vector<ConversationData> RocksDBConversationStore::GetList(const std::strin
     if (!impl_->db || user_id.empty())
         return result;
 
+    // 同一快照下先读会话记录，再读计数键叠加上去（两者前缀不同，各扫一遍）
+    const rocksdb::Snapshot* snapshot = impl_->db->GetSnapshot();
     std::string prefix = PrefixConv(user_id);
     rocksdb::Slice prefix_slice(prefix);
-    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(rocksdb::ReadOptions()));
+    PrefixScan scan(prefix);
+    scan.options().snapshot = snapshot;
+    std::unique_ptr<rocksdb::Iterator> it(impl_->db->NewIterator(scan.options(), impl_->cf));
     for (it->Seek(prefix); it->Valid(); it->Next()) {
         if (!it->key().starts_with(prefix_slice))
             break;
@@ -446,6 +664,30 @@ std::vector<ConversationData> RocksDBConversationStore::GetList(const std::strin
             result.push_back(DeserializeConversation(it->value().ToString()));
         } catch (...) {}
     }
+    it.reset();
+
+    if (!result.empty()) {
+        std::map<std::string, UnreadCounter> counters;
+        std::string unread_prefix = PrefixUnread(user_id);
+        rocksdb::Slice unread_prefix_slice(unread_prefix);
+        PrefixScan unread_scan(unread_prefix);
+        unread_scan.options().snapshot = snapshot;
+        it.reset(impl_->db->NewIterator(unread_scan.options(), impl_->cf));
+        for (it->Seek(unread_prefix); it->Valid(); it->Next()) {
+            if (!it->key().starts_with(unread_prefix_slice))
+                break;
+            UnreadCounter counter;
+            if (ParseUnreadCounter(it->value(), &counter))
+                counters.emplace(it->key().ToString().substr(unread_prefix.size()), counter);
+        }
+        for (auto& c : result) {
+            auto found = counters.find(c.conversation_id);
+            if (found != counters.end())
+                c.unread_count = ApplyUnreadCounter(c.unread_count, found->second);
+        }
+        it.reset();
+    }
+    impl_->db->ReleaseSnapshot(snapshot);
     return result;
 }
 
@@ -453,30 +695,21 @@ bool RocksDBConversationStore::Delete(const std::string& user_id, const std::str
     if (!impl_->db || user_id.empty() || conversation_id.empty())
         return false;
 
-    rocksdb::WriteOptions wo;
-    wo.sync = true;
-    return impl_->db->Delete(wo, KeyConv(user_id, conversation_id)).ok();
+    rocksdb::WriteBatch batch;
+    batch.Delete(impl_->cf, KeyConv(user_id, conversation_id));
+    batch.Delete(impl_->cf, KeyUnread(user_id, conversation_id));
+    return impl_->chat_db->Write(&batch);
 }
 
 bool RocksDBConversationStore::UpdateUnread(const std::string& user_id,
-                                            const std::string& conversation_id, int delta) {
+                                            const std::string& conversation_id, int delta,
+                                            ChatWriteBatch* batch) {
     if (!impl_->db || user_id.empty() || conversation_id.empty())
         return false;
 
-    std::string key = KeyConv(user_id, conversation_id);
-    std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), key, &value).ok())
-        return false;
-
-    try {
-        ConversationData c = DeserializeConversation(value);
-        c.unread_count = std::max(0, c.unread_count + delta);
-        rocksdb::WriteOptions wo;
-        wo.sync = true;
-        return impl_->db->Put(wo, key, SerializeConversation(c)).ok();
-    } catch (...) {
-        return false;
-    }
+    return WriteOrStage(*impl_->chat_db, batch, [&](rocksdb::WriteBatch& wb) {
+        wb.Merge(impl_->cf, KeyUnread(user_id, conversation_id), UnreadCounterValue(false, delta));
+    });
 }
 
 bool RocksDBConversationStore::ClearUnread(const std::string& user_id,
@@ -484,20 +717,32 @@ bool RocksDBConversationStore::ClearUnread(const std::string& user_id,
     if (!impl_->db || user_id.empty() || conversation_id.empty())
         return false;
 
-    std::string key = KeyConv(user_id, conversation_id);
-    std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), key, &value).ok())
-        return false;
+    rocksdb::WriteBatch batch;
+    batch.Merge(impl_->cf, KeyUnread(user_id, conversation_id), UnreadCounterValue(true, 0));
+    return impl_->chat_db->Write(&batch);
+}
 
-    try {
-        ConversationData c = DeserializeConversation(value);
-        c.unread_count = 0;
-        rocksdb::WriteOptions wo;
-        wo.sync = true;
-        return impl_->db->Put(wo, key, SerializeConversation(c)).ok();
-    } catch (...) {
+bool RocksDBConversationStore::MarkReadUpTo(const std::string& user_id,
+                                            const ConversationData& base, int64_t read_ts) {
+    if (!impl_->db || user_id.empty() || base.conversation_id.empty())
         return false;
+
+    std::string key = KeyConv(user_id, base.conversation_id);
+    std::string value;
+    ConversationData c = base;
+    if (impl_->db->Get(rocksdb::ReadOptions(), impl_->cf, key, &value).ok()) {
+        try {
+            c = DeserializeConversation(value);
+        } catch (...) {
+            c = base;
+        }
     }
+    c.read_ts = std::max(c.read_ts, read_ts);
+    c.unread_count = 0;
+    rocksdb::WriteBatch batch;
+    batch.Put(impl_->cf, key, SerializeConversation(c));
+    batch.Merge(impl_->cf, KeyUnread(user_id, base.conversation_id), UnreadCounterValue(true, 0));
+    return impl_->chat_db->Write(&batch);
 }
 
 // ============================================================================
@@ -505,29 +750,19 @@ bool RocksDBConversationStore::ClearUnread(const std::string& user_id,
 // ============================================================================
 
 struct RocksDBConversationRegistry::Impl {
+    std::shared_ptr<ChatDB> chat_db;
     rocksdb::DB* db = nullptr;
-    std::string db_path;
+    rocksdb::ColumnFamilyHandle* cf = nullptr;  // conv_meta
 
-    ~Impl() {
-        if (db) {
-            delete db;
-            db = nullptr;
-        }
-    }
+    explicit Impl(std::shared_ptr<ChatDB> d)
+        : chat_db(std::move(d)), db(chat_db->db()), cf(chat_db->cf(ChatColumnFamily::CONV_META)) {}
 };
 
 RocksDBConversationRegistry::RocksDBConversationRegistry(const std::string& db_path)
-    : impl_(std::make_unique<Impl>()) {
-    impl_->db_path = db_path;
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    options.IncreaseParallelism();
-    options.OptimizeLevelStyleCompaction();
-    rocksdb::Status status = rocksdb::DB::Open(options, db_path, &impl_->db);
-    if (!status.ok()) {
-        throw std::runtime_error("Failed to open RocksDB (conv_registry): " + status.ToString());
-    }
-}
+    : RocksDBConversationRegistry(ChatDB::Open(db_path)) {}
+
+RocksDBConversationRegistry::RocksDBConversationRegistry(std::shared_ptr<ChatDB> db)
+    : impl_(std::make_unique<Impl>(std::move(db))) {}
 
 RocksDBConversationRegistry::~RocksDBConversationRegistry() = default;
 
@@ -540,12 +775,12 @@ std::string RocksDBConversationRegistry::GetOrCreatePrivateConversation(
     std::string conversation_id = "p_" + a + "_" + b;
     std::string key = KeyConvMeta(conversation_id);
     std::string value;
-    if (!impl_->db->Get(rocksdb::ReadOptions(), key, &value).ok()) {
+    if (!impl_->db->Get(rocksdb::ReadOptions(), impl_->cf, key, &value).ok()) {
         json j;
         j["type"] = "private";
-        rocksdb::WriteOptions wo;
-        wo.sync = true;
-        impl_->db->Put(wo, key, j.dump());
+        rocksdb::WriteBatch batch;
+        batch.Put(impl_->cf, key, j.dump());
+        impl_->chat_db->Write(&batch);
     }
     return conversation_id;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "chat_db.h"
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -27,26 +28,50 @@ struct MessageData {
     int64_t timestamp = 0;
     int status = 0;              // 0=正常, 1=已撤回
     int64_t recall_at = 0;
+    std::string client_msg_id;   // 客户端消息 ID（可空），非空时 Save 同时写入发送去重索引
 };
 
 /**
  * 消息存储接口
  * 
- * RocksDB Key 设计：
- *   msg:{msg_id}                                    -> MessageData (JSON)
- *   chat:{conversation_id}:{rev_ts}:{msg_id}         -> "" (时间线索引)
- *   conv_meta:{conversation_id}                      -> 私聊会话元信息（type=private）
- *   offline:{user_id}:{rev_ts}:{msg_id}             -> "" (离线队列)
+ * RocksDB Key 设计（ChatDB 列族见 chat_db.h）：
+ *   [messages]  msg:{msg_id}                            -> MessageData (二进制记录，兼容读旧 JSON)
+ *   [timelines] chat:{conversation_id}:{rev_ts}:{msg_id} -> from_user_id (时间线索引；旧数据为 "")
+ *   [conv_meta] conv_meta:{conversation_id}              -> 私聊会话元信息（type=private）
+ *   [offline]   offline:{user_id}:{rev_ts}:{msg_id}     -> "" (私聊离线队列；群聊离线由群时间线 + 已读水位推导)
+ *   [dedup]     {from_user_id}:{client_msg_id}           -> {saved_at_ms}:{msg_id}（发送去重，按 TTL 过期）
+ *
+ * 写方法的 batch 参数：非空时只追加到该批（同一 ChatDB 上的多个 store 一次提交），由调用方 Commit。
  */
 class MessageStore {
 public:
     virtual ~MessageStore() = default;
+
+    /// 群聊离线来源：该会话时间线上 timestamp > after_ts 且非本人发送的消息视为离线
+    struct TimelineSource {
+        std::string conversation_id;
+        int64_t after_ts = 0;
+    };
+
+    /// 时间线摘要：最新一条，以及 timestamp > after_ts 的他人消息数（达到 max_count 即停止计数）
+    struct TimelineSummary {
+        std::string latest_msg_id;
+        int64_t latest_ts = 0;
+        int count = 0;
+    };
     
+    // 新建一个跨 store 原子写批；存储不支持时返回 nullptr（调用方逐个写入）
+    virtual std::unique_ptr<ChatWriteBatch> NewWriteBatch() { return nullptr; }
+
     // 存储消息
-    virtual bool Save(const MessageData& msg) = 0;
+    virtual bool Save(const MessageData& msg, ChatWriteBatch* batch = nullptr) = 0;
     
     // 根据 msg_id 查询
     virtual std::optional<MessageData> GetById(const std::string& msg_id) = 0;
+
+    // 按 (发送者, client_msg_id) 查已保存的消息，用于发送重试去重；未命中或去重记录已过期返回 nullopt
+    virtual std::optional<MessageData> GetByClientMsgId(const std::string& from_user_id,
+                                                        const std::string& client_msg_id) = 0;
     
     // 获取会话历史消息（倒序，支持分页）；conversation_id = 私聊 id 或 group_id
     virtual std::vector<MessageData> GetHistory(
@@ -60,33 +85,59 @@ public:
     
     // 添加到离线队列
     virtual bool AddToOffline(const std::string& user_id, const std::string& msg_id) = 0;
+    // 同上，调用方已持有消息（如刚 Save 尚未提交），不再回读
+    virtual bool AddToOffline(const std::string& user_id, const MessageData& msg,
+                              ChatWriteBatch* batch = nullptr) = 0;
     
-    // 拉取离线消息
+    // 拉取离线消息：私聊离线队列与 timelines 中各群时间线按时间倒序归并分页
+    // cursor/next_cursor 为 "{rev_ts}:{msg_id}"，对所有来源统一有序
     virtual std::vector<MessageData> PullOffline(
         const std::string& user_id,
         const std::string& cursor,
         int limit,
         std::string& next_cursor,
-        bool& has_more) = 0;
+        bool& has_more,
+        const std::vector<TimelineSource>& timelines = {}) = 0;
+
+    // 会话时间线摘要（单次迭代）：供会话列表推导 last_msg_id 与未读数，exclude_from_user_id 的消息不计数
+    virtual TimelineSummary SummarizeTimeline(const std::string& conversation_id, int64_t after_ts,
+                                              const std::string& exclude_from_user_id, int max_count) = 0;
     
     // 清除离线消息（用户已读后）
     virtual bool ClearOffline(const std::string& user_id, const std::string& until_msg_id) = 0;
 };
 
-/** RocksDB 消息存储实现 */
+/**
+ * RocksDB 消息存储实现
+ * 去重索引单独放在 dedup 列族，由 compaction filter 丢弃超过 dedup_ttl_ms（ChatDBOptions）的记录；
+ * 读取时同样按 TTL 判断，未及压缩的过期记录不会命中。
+ */
 class RocksDBMessageStore : public MessageStore {
 public:
-    explicit RocksDBMessageStore(const std::string& db_path);
+    static constexpr int64_t kDefaultDedupTtlMs = 24LL * 3600 * 1000;
+
+    /** 独占打开 db_path 上的 ChatDB（测试与单独使用） */
+    explicit RocksDBMessageStore(const std::string& db_path, int64_t dedup_ttl_ms = kDefaultDedupTtlMs);
+    /** 与其他 store 共用 ChatDB */
+    explicit RocksDBMessageStore(std::shared_ptr<ChatDB> db);
     ~RocksDBMessageStore() override;
 
-    bool Save(const MessageData& msg) override;
+    std::unique_ptr<ChatWriteBatch> NewWriteBatch() override;
+    bool Save(const MessageData& msg, ChatWriteBatch* batch = nullptr) override;
     std::optional<MessageData> GetById(const std::string& msg_id) override;
+    std::optional<MessageData> GetByClientMsgId(const std::string& from_user_id,
+                                                const std::string& client_msg_id) override;
     std::vector<MessageData> GetHistory(const std::string& conversation_id, int chat_type,
                                          const std::string& before_msg_id, int limit) override;
     bool MarkRecalled(const std::string& msg_id, int64_t recall_at) override;
     bool AddToOffline(const std::string& user_id, const std::string& msg_id) override;
+    bool AddToOffline(const std::string& user_id, const MessageData& msg,
+                      ChatWriteBatch* batch = nullptr) override;
     std::vector<MessageData> PullOffline(const std::string& user_id, const std::string& cursor,
-                                          int limit, std::string& next_cursor, bool& has_more) override;
+                                          int limit, std::string& next_cursor, bool& has_more,
+                                          const std::vector<TimelineSource>& timelines = {}) override;
+    TimelineSummary SummarizeTimeline(const std::string& conversation_id, int64_t after_ts,
+                                      const std::string& exclude_from_user_id, int max_count) override;
     bool ClearOffline(const std::string& user_id, const std::string& until_msg_id) override;
 
 private:
@@ -104,10 +155,11 @@ public:
                                                         const std::string& user_id_2) = 0;
 };
 
-/** RocksDB 实现：conv_meta:p_u1_u2 -> {"type":"private"} */
+/** RocksDB 实现：[conv_meta] conv_meta:p_u1_u2 -> {"type":"private"} */
 class RocksDBConversationRegistry : public ConversationRegistry {
 public:
     explicit RocksDBConversationRegistry(const std::string& db_path);
+    explicit RocksDBConversationRegistry(std::shared_ptr<ChatDB> db);
     ~RocksDBConversationRegistry() override;
     std::string GetOrCreatePrivateConversation(const std::string& user_id_1,
                                                 const std::string& user_id_2) override;
@@ -119,6 +171,8 @@ private:
 
 /**
  * 用户侧会话列表（每个用户看到的会话摘要）
+ * 群聊发消息不再逐成员写入：群会话的 last_msg_id / updated_at / 未读数在同步时由群时间线与 read_ts 推导，
+ * 记录本身只在已读（MarkReadUpTo）或旧版逐成员扇出时写入。
  */
 struct ConversationData {
     std::string conversation_id;
@@ -129,30 +183,40 @@ struct ConversationData {
     int64_t updated_at = 0;
     bool is_pinned = false;
     bool is_muted = false;
+    int64_t read_ts = 0;         // 已读水位（消息 timestamp），0 表示从未按水位标记已读
 };
 
 class ConversationStore {
 public:
     virtual ~ConversationStore() = default;
     
-    virtual bool Upsert(const std::string& user_id, const ConversationData& conv) = 0;
+    virtual bool Upsert(const std::string& user_id, const ConversationData& conv,
+                        ChatWriteBatch* batch = nullptr) = 0;
     virtual std::vector<ConversationData> GetList(const std::string& user_id) = 0;
     virtual bool Delete(const std::string& user_id, const std::string& conversation_id) = 0;
-    virtual bool UpdateUnread(const std::string& user_id, const std::string& conversation_id, int delta) = 0;
+    // 未读数单独存放，增减与清零均为盲写（不要求记录已存在）；GetList 返回时已合并
+    virtual bool UpdateUnread(const std::string& user_id, const std::string& conversation_id, int delta,
+                              ChatWriteBatch* batch = nullptr) = 0;
     virtual bool ClearUnread(const std::string& user_id, const std::string& conversation_id) = 0;
+    // 已读到 read_ts（只前进不后退）并清零未读；记录不存在时以 base 新建
+    virtual bool MarkReadUpTo(const std::string& user_id, const ConversationData& base, int64_t read_ts) = 0;
 };
 
-/** RocksDB 会话存储实现 */
+/** RocksDB 会话存储实现：[conversations] 列族，conv: 记录与 unread: 计数键 */
 class RocksDBConversationStore : public ConversationStore {
 public:
     explicit RocksDBConversationStore(const std::string& db_path);
+    explicit RocksDBConversationStore(std::shared_ptr<ChatDB> db);
     ~RocksDBConversationStore() override;
 
-    bool Upsert(const std::string& user_id, const ConversationData& conv) override;
+    bool Upsert(const std::string& user_id, const ConversationData& conv,
+                ChatWriteBatch* batch = nullptr) override;
     std::vector<ConversationData> GetList(const std::string& user_id) override;
     bool Delete(const std::string& user_id, const std::string& conversation_id) override;
-    bool UpdateUnread(const std::string& user_id, const std::string& conversation_id, int delta) override;
+    bool UpdateUnread(const std::string& user_id, const std::string& conversation_id, int delta,
+                      ChatWriteBatch* batch = nullptr) override;
     bool ClearUnread(const std::string& user_id, const std::string& conversation_id) override;
+    bool MarkReadUpTo(const std::string& user_id, const ConversationData& base, int64_t read_ts) override;
 
 private:
     struct Impl;
@@ -1,12 +1,16 @@
 /**
  * @file message_store_test.cpp
- * @brief RocksDBMessageStore 单元测试（消息、历史、撤回、离线队列）
+ * @brief RocksDBMessageStore 单元测试（消息、历史、撤回、离线队列、旧版分库导入）
  */
 
 #include "message_store.h"
+#include "record_serde.h"
+#include <rocksdb/db.h>
+#include <swift/rocksdb_prefix.h>
 #include <chrono>
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <thread>
 
 namespace swift::chat {
 
@@ -127,6 +131,263 @@ TEST_F(MessageStoreTest, OfflineQueue_PullAndClear) {
     EXPECT_TRUE(empty.empty());
 }
 
+// 离线拉取合并群时间线：只取 after_ts 之后他人发的消息，与私聊离线按时间倒序合并
+TEST_F(MessageStoreTest, PullOffline_MergesTimelineSources) {
+    ASSERT_TRUE(store_->Save(MakeMessage("c_private", "p1", 1000)));
+    ASSERT_TRUE(store_->AddToOffline("u2", "p1"));
+
+    MessageData before = MakeMessage("g1", "g_before", 500);
+    MessageData other = MakeMessage("g1", "g_other", 2000);
+    MessageData own = MakeMessage("g1", "g_own", 3000);
+    own.from_user_id = "u2";
+    for (const auto* m : {&before, &other, &own})
+        ASSERT_TRUE(store_->Save(*m));
+
+    std::string next_cursor;
+    bool has_more = false;
+    auto all = store_->PullOffline("u2", "", 10, next_cursor, has_more, {{"g1", 600}});
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0].msg_id, "g_other");
+    EXPECT_EQ(all[1].msg_id, "p1");
+    EXPECT_FALSE(has_more);
+
+    // 分页：游标跨来源生效
+    auto page1 = store_->PullOffline("u2", "", 1, next_cursor, has_more, {{"g1", 600}});
+    ASSERT_EQ(page1.size(), 1u);
+    EXPECT_EQ(page1[0].msg_id, "g_other");
+    EXPECT_TRUE(has_more);
+    auto page2 = store_->PullOffline("u2", next_cursor, 1, next_cursor, has_more, {{"g1", 600}});
+    ASSERT_EQ(page2.size(), 1u);
+    EXPECT_EQ(page2[0].msg_id, "p1");
+    EXPECT_FALSE(has_more);
+
+    auto summary = store_->SummarizeTimeline("g1", 600, "u2", 999);
+    EXPECT_EQ(summary.latest_msg_id, "g_own");
+    EXPECT_EQ(summary.latest_ts, 3000);
+    EXPECT_EQ(summary.count, 1);
+}
+
+// 发送去重索引：按 (发送者, client_msg_id) 查回原消息，不同发送者互不影响
+TEST_F(MessageStoreTest, GetByClientMsgId_FindsOriginal) {
+    MessageData m = MakeMessage("c_dedup", "m_dedup", 1000);
+    m.client_msg_id = "cm1";
+    ASSERT_TRUE(store_->Save(m));
+
+    auto got = store_->GetByClientMsgId("u1", "cm1");
+    ASSERT_TRUE(got.has_value());
+    EXPECT_EQ(got->msg_id, "m_dedup");
+    EXPECT_EQ(got->timestamp, 1000);
+    EXPECT_EQ(got->client_msg_id, "cm1");
+
+    EXPECT_FALSE(store_->GetByClientMsgId("u2", "cm1").has_value());
+    EXPECT_FALSE(store_->GetByClientMsgId("u1", "cm2").has_value());
+}
+
+// 去重记录超过 TTL 后不再命中（消息本身仍在）
+TEST_F(MessageStoreTest, GetByClientMsgId_ExpiresAfterTtl) {
+    store_.reset();
+    std::filesystem::remove_all(db_path_);
+    store_ = std::make_unique<RocksDBMessageStore>(db_path_, 50);
+
+    MessageData m = MakeMessage("c_dedup", "m_ttl", 1000);
+    m.client_msg_id = "cm_ttl";
+    ASSERT_TRUE(store_->Save(m));
+    EXPECT_TRUE(store_->GetByClientMsgId("u1", "cm_ttl").has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_FALSE(store_->GetByClientMsgId("u1", "cm_ttl").has_value());
+    EXPECT_TRUE(store_->GetById("m_ttl").has_value());
+}
+
+// 旧版分库（default 列族，key 带前缀）按前缀导入到 ChatDB 各列族，store 照常读出
+TEST_F(MessageStoreTest, ImportLegacy_RoutesKeysToColumnFamilies) {
+    std::string legacy_path = db_path_ + "_legacy";
+    {
+        rocksdb::Options options;
+        options.create_if_missing = true;
+        rocksdb::DB* legacy = nullptr;
+        ASSERT_TRUE(rocksdb::DB::Open(options, legacy_path, &legacy).ok());
+        MessageData m = MakeMessage("c_old", "m_old", 1000);
+        legacy->Put(rocksdb::WriteOptions(), "msg:m_old", SerializeMessageJson(m));
+        legacy->Put(rocksdb::WriteOptions(), "chat:c_old:9999999998999:m_old", "");
+        legacy->Put(rocksdb::WriteOptions(), "offline:u2:9999999998999:m_old", "");
+        ConversationData c;
+        c.conversation_id = "c_old";
+        c.unread_count = 2;
+        legacy->Put(rocksdb::WriteOptions(), "conv:u2:c_old", SerializeConversationJson(c));
+        delete legacy;
+    }
+
+    store_.reset();
+    std::filesystem::remove_all(db_path_);
+    auto chat_db = ChatDB::Open(db_path_);
+    EXPECT_FALSE(chat_db->LegacyImported());
+    EXPECT_EQ(chat_db->ImportLegacy(legacy_path), 4);
+    EXPECT_EQ(chat_db->ImportLegacy(legacy_path), 4);  // 中断后重跑：同 key 覆盖，不产生重复
+    store_ = std::make_unique<RocksDBMessageStore>(chat_db);
+    RocksDBConversationStore conv_store(chat_db);
+
+    auto history = store_->GetHistory("c_old", 1, "", 10);
+    ASSERT_EQ(history.size(), 1u);
+    EXPECT_EQ(history[0].content, "hello m_old");
+    std::string cursor;
+    bool has_more = false;
+    EXPECT_EQ(store_->PullOffline("u2", "", 10, cursor, has_more).size(), 1u);
+    auto convs = conv_store.GetList("u2");
+    ASSERT_EQ(convs.size(), 1u);
+    EXPECT_EQ(convs[0].unread_count, 2);
+
+    ASSERT_TRUE(chat_db->MarkLegacyImported());
+    EXPECT_TRUE(chat_db->LegacyImported());
+    EXPECT_EQ(chat_db->ImportLegacy(legacy_path + "_missing"), -1);
+    std::filesystem::remove_all(legacy_path);
+}
+
+// 各持久化模式下并发写都完整落库，重开后仍在；组提交每批至多一次 DB 写
+TEST_F(MessageStoreTest, Durability_AllModesPersistConcurrentWrites) {
+    store_.reset();
+    for (Durability mode : {Durability::SYNC, Durability::GROUP_COMMIT, Durability::WAL_NO_SYNC}) {
+        std::filesystem::remove_all(db_path_);
+        ChatDBOptions options;
+        options.write.durability = mode;
+        options.write.group_commit_max_delay_us = 500;
+        {
+            auto chat_db = ChatDB::Open(db_path_, options);
+            RocksDBMessageStore store(chat_db);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t] {
+                    for (int i = 0; i < 25; ++i) {
+                        std::string id = "m_" + std::to_string(t) + "_" + std::to_string(i);
+                        EXPECT_TRUE(store.Save(MakeMessage("c_dur", id, 1000 + t * 100 + i)));
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+            auto stats = chat_db->write_stats();
+            EXPECT_EQ(stats.writes, 100u) << DurabilityName(mode);
+            EXPECT_LE(stats.commits, stats.writes) << DurabilityName(mode);
+        }
+        auto reopened = ChatDB::Open(db_path_, options);
+        RocksDBMessageStore store(reopened);
+        EXPECT_EQ(store.GetHistory("c_dur", 1, "", 200).size(), 100u) << DurabilityName(mode);
+    }
+}
+
+// 前缀过滤器 + 上界迭代：相邻 keyspace（c1 / c10、u1 / u10）互不串扰，flush 到 SST 后依然成立
+TEST_F(MessageStoreTest, PrefixScan_DoesNotLeakIntoNeighbourKeyspaces) {
+    store_.reset();
+    std::filesystem::remove_all(db_path_);
+    auto chat_db = ChatDB::Open(db_path_);
+    store_ = std::make_unique<RocksDBMessageStore>(chat_db);
+
+    ASSERT_TRUE(store_->Save(MakeMessage("c1", "m_c1", 1000)));
+    ASSERT_TRUE(store_->Save(MakeMessage("c10", "m_c10", 2000)));
+    ASSERT_TRUE(store_->AddToOffline("u1", "m_c1"));
+    ASSERT_TRUE(store_->AddToOffline("u10", "m_c10"));
+    for (auto family : {ChatColumnFamily::TIMELINES, ChatColumnFamily::OFFLINE})
+        ASSERT_TRUE(chat_db->db()->Flush(rocksdb::FlushOptions(), chat_db->cf(family)).ok());
+    ASSERT_TRUE(store_->Save(MakeMessage("c1", "m_c1_mem", 3000)));  // 一条留在 memtable
+
+    auto history = store_->GetHistory("c1", 1, "", 10);
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history[0].msg_id, "m_c1_mem");
+    EXPECT_EQ(history[1].msg_id, "m_c1");
+    EXPECT_TRUE(store_->GetHistory("c2", 1, "", 10).empty());
+
+    std::string cursor;
+    bool has_more = false;
+    auto offline = store_->PullOffline("u1", "", 10, cursor, has_more);
+    ASSERT_EQ(offline.size(), 1u);
+    EXPECT_EQ(offline[0].msg_id, "m_c1");
+
+    EXPECT_EQ(swift::rocksdb_prefix::PrefixSuccessor("chat:c1:"), "chat:c1;");
+    EXPECT_EQ(swift::rocksdb_prefix::PrefixSuccessor("a\xff"), "b");
+}
+
+// 批量回填：结果保持时间线顺序（跨 SST / memtable），消息记录缺失的条目跳过，游标仍推进
+TEST_F(MessageStoreTest, MultiGetHydration_KeepsOrderAndSkipsMissing) {
+    store_.reset();
+    std::filesystem::remove_all(db_path_);
+    auto chat_db = ChatDB::Open(db_path_);
+    store_ = std::make_unique<RocksDBMessageStore>(chat_db);
+
+    for (int i = 1; i <= 4; ++i) {
+        auto msg = MakeMessage("c_hydrate", "m" + std::to_string(i), 1000 * i);
+        ASSERT_TRUE(store_->Save(msg));
+        ASSERT_TRUE(store_->AddToOffline("u2", msg));
+        if (i == 2)
+            ASSERT_TRUE(chat_db->db()->Flush(rocksdb::FlushOptions(), chat_db->cf(ChatColumnFamily::MESSAGES)).ok());
+    }
+    ASSERT_TRUE(chat_db->db()->Delete(rocksdb::WriteOptions(), chat_db->cf(ChatColumnFamily::MESSAGES), "msg:m3").ok());
+
+    auto history = store_->GetHistory("c_hydrate", 1, "", 10);
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history[0].msg_id, "m4");
+    EXPECT_EQ(history[1].msg_id, "m2");
+    EXPECT_EQ(history[2].msg_id, "m1");
+
+    std::string cursor;
+    bool has_more = false;
+    auto page = store_->PullOffline("u2", "", 2, cursor, has_more);  // m4、m3(缺失)
+    ASSERT_EQ(page.size(), 1u);
+    EXPECT_EQ(page[0].msg_id, "m4");
+    EXPECT_TRUE(has_more);
+    std::string next_cursor;
+    page = store_->PullOffline("u2", cursor, 2, next_cursor, has_more);
+    ASSERT_EQ(page.size(), 2u);
+    EXPECT_EQ(page[0].msg_id, "m2");
+    EXPECT_EQ(page[1].msg_id, "m1");
+    EXPECT_FALSE(has_more);
+}
+
+// 记录编码：二进制与旧版 JSON 都能解出同样的字段，二进制更小；损坏的二进制记录抛异常
+TEST(RecordSerdeTest, DecodesBinaryAndLegacyJson) {
+    MessageData m;
+    m.msg_id = "m1";
+    m.from_user_id = "u1";
+    m.conversation_id = "g1";
+    m.chat_type = 2;
+    m.content = "你好";
+    m.mentions = {"u2", "u3"};
+    m.timestamp = 1760000000123;
+    m.status = 1;
+    m.recall_at = 1760000000456;
+    m.client_msg_id = "cm1";
+
+    std::string binary = SerializeMessage(m);
+    std::string legacy = SerializeMessageJson(m);
+    EXPECT_LT(binary.size(), legacy.size());
+    for (const auto& data : {binary, legacy}) {
+        MessageData d = DeserializeMessage(data);
+        EXPECT_EQ(d.msg_id, m.msg_id);
+        EXPECT_EQ(d.content, m.content);
+        EXPECT_EQ(d.mentions, m.mentions);
+        EXPECT_EQ(d.timestamp, m.timestamp);
+        EXPECT_EQ(d.status, m.status);
+        EXPECT_EQ(d.recall_at, m.recall_at);
+        EXPECT_EQ(d.client_msg_id, m.client_msg_id);
+    }
+
+    ConversationData c;
+    c.conversation_id = "g1";
+    c.chat_type = 2;
+    c.unread_count = 5;
+    c.is_muted = true;
+    c.read_ts = 1760000000123;
+    ConversationData from_json = DeserializeConversation(SerializeConversationJson(c));
+    ConversationData from_binary = DeserializeConversation(SerializeConversation(c));
+    for (const auto& d : {from_json, from_binary}) {
+        EXPECT_EQ(d.conversation_id, c.conversation_id);
+        EXPECT_EQ(d.unread_count, c.unread_count);
+        EXPECT_TRUE(d.is_muted);
+        EXPECT_EQ(d.read_ts, c.read_ts);
+    }
+
+    // 截在字符串中间
+    EXPECT_ANY_THROW(DeserializeMessage(binary.substr(0, 4)));
+}
+
 } // namespace swift::chat
 
 int main(int argc, char** argv) {
@@ -0,0 +1,270 @@
+/**
+ * @file record_serde.cpp
+ * @brief ChatSvr 存储记录编解码实现
+ *
+ * 二进制字段顺序即下方 Writer 调用顺序，只能在末尾追加（同时提升 kV* 版本号）。
+ */
+
+#include "record_serde.h"
+#include <nlohmann/json.hpp>
+#include <swift/record_codec.h>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace swift::chat {
+
+namespace {
+
+constexpr uint8_t kMessageVersion = 1;
+constexpr uint8_t kConversationVersion = 1;
+
+MessageData DeserializeMessageJson(const std::string& data) {
+    json j = json::parse(data);
+    MessageData m;
+    m.msg_id = j.value("msg_id", "");
+    m.from_user_id = j.value("from_user_id", "");
+    m.to_id = j.value("to_id", "");
+    m.conversation_id = j.value("conversation_id", j.value("chat_id", ""));
+    m.chat_type = j.value("chat_type", 1);
+    m.content = j.value("content", "");
+    m.media_url = j.value("media_url", "");
+    m.media_type = j.value("media_type", "");
+    if (j.contains("mentions") && j["mentions"].is_array()) {
+        for (const auto& x : j["mentions"])
+            m.mentions.push_back(x.get<std::string>());
+    }
+    m.reply_to_msg_id = j.value("reply_to_msg_id", "");
+    m.timestamp = j.value("timestamp", static_cast<int64_t>(0));
+    m.status = j.value("status", 0);
+    m.recall_at = j.value("recall_at", static_cast<int64_t>(0));
+    m.client_msg_id = j.value("client_msg_id", "");
+    return m;
+}
+
+ConversationData DeserializeConversationJson(const std::string& data) {
+    json j = json::parse(data);
+    ConversationData c;
+    c.conversation_id = j.value("conversation_id", j.value("chat_id", ""));
+    c.chat_type = j.value("chat_type", 1);
+    c.peer_id = j.value("peer_id", "");
+    c.last_msg_id = j.value("last_msg_id", "");
+    c.unread_count = j.value("unread_count", 0);
+    c.updated_at = j.value("updated_at", static_cast<int64_t>(0));
+    c.is_pinned = j.value("is_pinned", false);
+    c.is_muted = j.value("is_muted", false);
+    c.read_ts = j.value("read_ts", static_cast<int64_t>(0));
+    return c;
+}
+
+}  // namespace
+
+std::string SerializeMessage(const MessageData& m) {
+    return swift::record::Writer(kMessageVersion, 64 + m.content.size())
+        .Str(m.msg_id)
+        .Str(m.from_user_id)
+        .Str(m.to_id)
+        .Str(m.conversation_id)
+        .I64(m.chat_type)
+        .Str(m.content)
+        .Str(m.media_url)
+        .Str(m.media_type)
+        .StrList(m.mentions)
+        .Str(m.reply_to_msg_id)
+        .I64(m.timestamp)
+        .I64(m.status)
+        .I64(m.recall_at)
+        .Str(m.client_msg_id)
+        .Finish();
+}
+
+MessageData DeserializeMessage(const std::string& data) {
+    if (!swift::record::IsBinary(data))
+        return DeserializeMessageJson(data);
+    MessageData m;
+    swift::record::Reader r(data);
+    r.Str(&m.msg_id)
+        .Str(&m.from_user_id)
+        .Str(&m.to_id)
+        .Str(&m.conversation_id)
+        .I32(&m.chat_type)
+        .Str(&m.content)
+        .Str(&m.media_url)
+        .Str(&m.media_type)
+        .StrList(&m.mentions)
+        .Str(&m.reply_to_msg_id)
+        .I64(&m.timestamp)
+        .I32(&m.status)
+        .I64(&m.recall_at)
+        .Str(&m.client_msg_id);
+    r.Check("message");
+    return m;
+}
+
+std::string SerializeMessageJson(const MessageData& m) {
+    json j;
+    j["msg_id"] = m.msg_id;
+    j["from_user_id"] = m.from_user_id;
+    j["to_id"] = m.to_id;
+    j["conversation_id"] = m.conversation_id;
+    j["chat_type"] = m.chat_type;
+    j["content"] = m.content;
+    j["media_url"] = m.media_url;
+    j["media_type"] = m.media_type;
+    j["mentions"] = m.mentions;
+    j["reply_to_msg_id"] = m.reply_to_msg_id;
+    j["timestamp"] = m.timestamp;
+    j["status"] = m.status;
+    j["recall_at"] = m.recall_at;
+    if (!m.client_msg_id.empty())
+        j["client_msg_id"] = m.client_msg_id;
+    return j.dump();
+}
+
+std::string SerializeConversation(const ConversationData& c) {
+    return swift::record::Writer(kConversationVersion)
+        .Str(c.conversation_id)
+        .I64(c.chat_type)
+        .Str(c.peer_id)
+        .Str(c.last_msg_id)
+        .I64(c.unread_count)
+        .I64(c.updated_at)
+        .Bool(c.is_pinned)
+        .Bool(c.is_muted)
+        .I64(c.read_ts)
+        .Finish();
+}
+
+ConversationData DeserializeConversation(const std::string& data) {
+    if (!swift::record::IsBinary(data))
+        return DeserializeConversationJson(data);
+    ConversationData c;
+    swift::record::Reader r(data);
+    r.Str(&c.conversation_id)
+        .I32(&c.chat_type)
+        .Str(&c.peer_id)
+        .Str(&c.last_msg_id)
+        .I32(&c.unread_count)
+        .I64(&c.updated_at)
+        .Bool(&c.is_pinned)
+        .Bool(&c.is_muted)
+        .I64(&c.read_ts);
+    r.Check("conversation");
+    return c;
+}
+
+std::string SerializeConversationJson(const ConversationData& c) {
+    json j;
+    j["conversation_id"] = c.conversation_id;
+    j["chat_type"] = c.chat_type;
+    j["peer_id"] = c.peer_id;
+    j["last_msg_id"] = c.last_msg_id;
+    j["unread_count"] = c.unread_count;
+    j["updated_at"] = c.updated_at;
+    j["is_pinned"] = c.is_pinned;
+    j["is_muted"] = c.is_muted;
+    if (c.read_ts > 0)
+        j["read_ts"] = c.read_ts;
+    return j.dump();
+}
+
+}  // namespace swift::chat
+
+namespace swift::group_ {
+
+namespace {
+
+constexpr uint8_t kGroupVersion = 1;
+constexpr uint8_t kMemberVersion = 1;
+
+GroupData DeserializeGroupJson(const std::string& data) {
+    json j = json::parse(data);
+    GroupData g;
+    g.group_id = j.value("group_id", "");
+    g.group_name = j.value("group_name", "");
+    g.avatar_url = j.value("avatar_url", "");
+    g.owner_id = j.value("owner_id", "");
+    g.member_count = j.value("member_count", 0);
+    g.announcement = j.value("announcement", "");
+    g.created_at = j.value("created_at", static_cast<int64_t>(0));
+    g.updated_at = j.value("updated_at", static_cast<int64_t>(0));
+    g.status = j.value("status", 0);
+    return g;
+}
+
+GroupMemberData DeserializeMemberJson(const std::string& data) {
+    json j = json::parse(data);
+    GroupMemberData m;
+    m.user_id = j.value("user_id", "");
+    m.role = j.value("role", 1);
+    m.nickname = j.value("nickname", "");
+    m.joined_at = j.value("joined_at", static_cast<int64_t>(0));
+    return m;
+}
+
+}  // namespace
+
+std::string SerializeGroup(const GroupData& g) {
+    return swift::record::Writer(kGroupVersion, 64 + g.announcement.size())
+        .Str(g.group_id)
+        .Str(g.group_name)
+        .Str(g.avatar_url)
+        .Str(g.owner_id)
+        .I64(g.member_count)
+        .Str(g.announcement)
+        .I64(g.created_at)
+        .I64(g.updated_at)
+        .I64(g.status)
+        .Finish();
+}
+
+GroupData DeserializeGroup(const std::string& data) {
+    if (!swift::record::IsBinary(data))
+        return DeserializeGroupJson(data);
+    GroupData g;
+    swift::record::Reader r(data);
+    r.Str(&g.group_id)
+        .Str(&g.group_name)
+        .Str(&g.avatar_url)
+        .Str(&g.owner_id)
+        .I32(&g.member_count)
+        .Str(&g.announcement)
+        .I64(&g.created_at)
+        .I64(&g.updated_at)
+        .I32(&g.status);
+    r.Check("group");
+    return g;
+}
+
+std::string SerializeMember(const GroupMemberData& m) {
+    return swift::record::Writer(kMemberVersion, 32)
+        .Str(m.user_id)
+        .I64(m.role)
+        .Str(m.nickname)
+        .I64(m.joined_at)
+        .Finish();
+}
+
+GroupMemberData DeserializeMember(const std::string& data) {
+    if (!swift::record::IsBinary(data))
+        return DeserializeMemberJson(data);
+    GroupMemberData m;
+    swift::record::Reader r(data);
+    r.Str(&m.user_id)
+        .I32(&m.role)
+        .Str(&m.nickname)
+        .I64(&m.joined_at);
+    r.Check("group member");
+    return m;
+}
+
+std::string SerializeMemberJson(const GroupMemberData& m) {
+    json j;
+    j["user_id"] = m.user_id;
+    j["role"] = m.role;
+    j["nickname"] = m.nickname;
+    j["joined_at"] = m.joined_at;
+    return j.dump();
+}
+
+}  // namespace swift::group_
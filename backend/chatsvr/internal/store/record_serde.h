@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file record_serde.h
+ * @brief ChatSvr 存储记录的编解码（message_store、group_store 共用）
+ *
+ * 写入统一为 swift/record_codec.h 的二进制格式；读取兼容旧版 JSON 记录，记录再次写入时即迁移为二进制。
+ * Deserialize* 在数据损坏时抛异常（与原 json::parse 一致），调用方按原有方式捕获。
+ * *Json 为旧版编码，只用于兼容性测试与编码基准。
+ */
+
+#include "group_store.h"
+#include "message_store.h"
+#include <string>
+
+namespace swift::chat {
+
+std::string SerializeMessage(const MessageData& m);
+MessageData DeserializeMessage(const std::string& data);
+std::string SerializeMessageJson(const MessageData& m);
+
+std::string SerializeConversation(const ConversationData& c);
+ConversationData DeserializeConversation(const std::string& data);
+std::string SerializeConversationJson(const ConversationData& c);
+
+}  // namespace swift::chat
+
+namespace swift::group_ {
+
+std::string SerializeGroup(const GroupData& g);
+GroupData DeserializeGroup(const std::string& data);
+
+std::string SerializeMember(const GroupMemberData& m);
+GroupMemberData DeserializeMember(const std::string& data);
+std::string SerializeMemberJson(const GroupMemberData& m);
+
+}  // namespace swift::group_
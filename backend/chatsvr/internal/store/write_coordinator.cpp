@@ -0,0 +1,209 @@
+/**
+ * @file write_coordinator.cpp
+ * @brief ChatDB 写入协调：同步写、组提交（每批一次 fsync）、WAL 不同步 + 周期 FlushWAL
+ */
+
+#include "write_coordinator.h"
+#include <rocksdb/db.h>
+#include <rocksdb/options.h>
+#include <rocksdb/write_batch.h>
+#include <algorithm>
+#include <chrono>
+
+namespace swift::chat {
+
+namespace {
+
+/** 把一个 WriteBatch 的操作按列族 ID 重放到另一个批（组提交合并用） */
+class BatchAppender : public rocksdb::WriteBatch::Handler {
+public:
+    BatchAppender(rocksdb::WriteBatch* out,
+                  const std::unordered_map<uint32_t, rocksdb::ColumnFamilyHandle*>& families)
+        : out_(out), families_(families) {}
+
+    rocksdb::Status PutCF(uint32_t id, const rocksdb::Slice& key, const rocksdb::Slice& value) override {
+        auto* cf = Find(id);
+        return cf ? out_->Put(cf, key, value) : Unknown();
+    }
+    rocksdb::Status DeleteCF(uint32_t id, const rocksdb::Slice& key) override {
+        auto* cf = Find(id);
+        return cf ? out_->Delete(cf, key) : Unknown();
+    }
+    rocksdb::Status SingleDeleteCF(uint32_t id, const rocksdb::Slice& key) override {
+        auto* cf = Find(id);
+        return cf ? out_->SingleDelete(cf, key) : Unknown();
+    }
+    rocksdb::Status DeleteRangeCF(uint32_t id, const rocksdb::Slice& begin,
+                                  const rocksdb::Slice& end) override {
+        auto* cf = Find(id);
+        return cf ? out_->DeleteRange(cf, begin, end) : Unknown();
+    }
+    rocksdb::Status MergeCF(uint32_t id, const rocksdb::Slice& key, const rocksdb::Slice& value) override {
+        auto* cf = Find(id);
+        return cf ? out_->Merge(cf, key, value) : Unknown();
+    }
+    void LogData(const rocksdb::Slice& blob) override { out_->PutLogData(blob); }
+
+private:
+    rocksdb::ColumnFamilyHandle* Find(uint32_t id) const {
+        auto it = families_.find(id);
+        return it == families_.end() ? nullptr : it->second;
+    }
+    static rocksdb::Status Unknown() { return rocksdb::Status::InvalidArgument("unknown column family"); }
+
+    rocksdb::WriteBatch* out_;
+    const std::unordered_map<uint32_t, rocksdb::ColumnFamilyHandle*>& families_;
+};
+
+}  // namespace
+
+bool ParseDurability(const std::string& name, Durability* out) {
+    if (name == "sync") *out = Durability::SYNC;
+    else if (name == "group_commit") *out = Durability::GROUP_COMMIT;
+    else if (name == "wal_no_sync") *out = Durability::WAL_NO_SYNC;
+    else return false;
+    return true;
+}
+
+const char* DurabilityName(Durability durability) {
+    switch (durability) {
+    case Durability::SYNC: return "sync";
+    case Durability::GROUP_COMMIT: return "group_commit";
+    case Durability::WAL_NO_SYNC: return "wal_no_sync";
+    }
+    return "unknown";
+}
+
+WriteCoordinator::WriteCoordinator(rocksdb::DB* db,
+                                   const std::vector<rocksdb::ColumnFamilyHandle*>& handles,
+                                   const WriteCoordinatorOptions& options)
+    : db_(db), options_(options) {
+    options_.group_commit_max_batch = std::max(1, options_.group_commit_max_batch);
+    options_.group_commit_max_delay_us = std::max<int64_t>(0, options_.group_commit_max_delay_us);
+    options_.wal_flush_interval_ms = std::max<int64_t>(1, options_.wal_flush_interval_ms);
+    for (auto* h : handles)
+        families_[h->GetID()] = h;
+
+    if (options_.durability == Durability::GROUP_COMMIT)
+        worker_ = std::thread(&WriteCoordinator::CommitLoop, this);
+    else if (options_.durability == Durability::WAL_NO_SYNC)
+        worker_ = std::thread(&WriteCoordinator::FlushLoop, this);
+}
+
+WriteCoordinator::~WriteCoordinator() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+bool WriteCoordinator::Write(rocksdb::WriteBatch* batch) {
+    writes_.fetch_add(1, std::memory_order_relaxed);
+    switch (options_.durability) {
+    case Durability::SYNC:
+        return WriteDirect(batch, true);
+    case Durability::WAL_NO_SYNC:
+        return WriteDirect(batch, false);
+    case Durability::GROUP_COMMIT:
+        break;
+    }
+
+    Pending pending;
+    pending.batch = batch;
+    std::unique_lock<std::mutex> lock(mu_);
+    if (stopping_)
+        return false;
+    queue_.push_back(&pending);
+    work_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return pending.done; });
+    return pending.ok;
+}
+
+WriteCoordinator::Stats WriteCoordinator::stats() const {
+    Stats s;
+    s.writes = writes_.load(std::memory_order_relaxed);
+    s.commits = commits_.load(std::memory_order_relaxed);
+    s.syncs = syncs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool WriteCoordinator::WriteDirect(rocksdb::WriteBatch* batch, bool sync) {
+    rocksdb::WriteOptions wo;
+    wo.sync = sync;
+    commits_.fetch_add(1, std::memory_order_relaxed);
+    if (sync)
+        syncs_.fetch_add(1, std::memory_order_relaxed);
+    return db_->Write(wo, batch).ok();
+}
+
+void WriteCoordinator::CommitLoop() {
+    const auto max_delay = std::chrono::microseconds(options_.group_commit_max_delay_us);
+    const size_t max_batch = static_cast<size_t>(options_.group_commit_max_batch);
+    std::vector<Pending*> group;
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        work_cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;  // stopping_ 且已提交完
+        // 上一批 fsync 期间到达的写已在队列里；配置了 max_delay 时再等一会凑批
+        if (max_delay.count() > 0 && queue_.size() < max_batch && !stopping_) {
+            work_cv_.wait_for(lock, max_delay, [&] { return stopping_ || queue_.size() >= max_batch; });
+        }
+        size_t n = std::min(queue_.size(), max_batch);
+        group.assign(queue_.begin(), queue_.begin() + n);
+        queue_.erase(queue_.begin(), queue_.begin() + n);
+
+        lock.unlock();
+        CommitGroup(group);
+        lock.lock();
+        for (auto* p : group)
+            p->done = true;
+        done_cv_.notify_all();
+    }
+}
+
+void WriteCoordinator::CommitGroup(const std::vector<Pending*>& group) {
+    if (group.size() == 1) {
+        group[0]->ok = WriteDirect(group[0]->batch, true);
+        return;
+    }
+
+    rocksdb::WriteBatch merged;
+    BatchAppender appender(&merged, families_);
+    bool merged_ok = true;
+    for (auto* p : group) {
+        if (!p->batch->Iterate(&appender).ok()) {
+            merged_ok = false;
+            break;
+        }
+    }
+    if (merged_ok) {
+        // 写入失败（如 I/O 错误）不逐个重试：fsync 失败时数据可能已进 WAL，重放 merge 会重复计数
+        bool ok = WriteDirect(&merged, true);
+        for (auto* p : group)
+            p->ok = ok;
+        return;
+    }
+    // 无法合并（不应出现，如未知列族）：逐个写，只让真正失败的请求返回 false
+    for (auto* p : group)
+        p->ok = WriteDirect(p->batch, true);
+}
+
+void WriteCoordinator::FlushLoop() {
+    const auto interval = std::chrono::milliseconds(options_.wal_flush_interval_ms);
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        bool stop = work_cv_.wait_for(lock, interval, [&] { return stopping_; });
+        lock.unlock();
+        db_->FlushWAL(true);
+        syncs_.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+        if (stop)
+            return;
+    }
+}
+
+}  // namespace swift::chat
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace rocksdb {
+class ColumnFamilyHandle;
+class DB;
+class WriteBatch;
+}  // namespace rocksdb
+
+namespace swift::chat {
+
+/**
+ * 写入持久化模式（配置项 rocksdb_durability）
+ *   SYNC          每次写各自 fsync（旧行为）
+ *   GROUP_COMMIT  并发写合并为一个 WriteBatch，每批一次 fsync；返回即已落盘
+ *   WAL_NO_SYNC   写 WAL 不 fsync，后台按 wal_flush_interval_ms 周期 FlushWAL(sync)；进程崩溃不丢，掉电可丢最近一个周期
+ */
+enum class Durability {
+    SYNC,
+    GROUP_COMMIT,
+    WAL_NO_SYNC,
+};
+
+/** "sync" / "group_commit" / "wal_no_sync"，无法识别返回 false */
+bool ParseDurability(const std::string& name, Durability* out);
+const char* DurabilityName(Durability durability);
+
+struct WriteCoordinatorOptions {
+    Durability durability = Durability::GROUP_COMMIT;
+    /** 组提交：凑批最多等待的时长；0 表示不额外等待，只合并上一批 fsync 期间到达的写 */
+    int64_t group_commit_max_delay_us = 0;
+    /** 组提交：每批最多合并的写请求数 */
+    int group_commit_max_batch = 64;
+    /** WAL_NO_SYNC：后台 FlushWAL(sync) 周期 */
+    int64_t wal_flush_interval_ms = 100;
+};
+
+/**
+ * ChatDB 的写入口：按 Durability 决定每次写的 fsync 方式。
+ * GROUP_COMMIT 下由单独的提交线程取走队列中的请求，重放进一个 WriteBatch 后一次同步写入，
+ * 各请求仍保持原子，同批请求一起成功或一起失败。
+ * 析构时提交完队列中剩余请求并停止后台线程，须先于 DB 销毁。
+ */
+class WriteCoordinator {
+public:
+    struct Stats {
+        uint64_t writes = 0;   // Write 调用次数
+        uint64_t commits = 0;  // 实际 DB::Write 次数（组提交下 writes / commits 即平均批大小）
+        uint64_t syncs = 0;    // fsync 次数（含 WAL_NO_SYNC 周期刷盘）
+    };
+
+    /** handles 为 DB 打开的全部列族，用于合并时按列族 ID 重放 */
+    WriteCoordinator(rocksdb::DB* db, const std::vector<rocksdb::ColumnFamilyHandle*>& handles,
+                     const WriteCoordinatorOptions& options);
+    ~WriteCoordinator();
+
+    WriteCoordinator(const WriteCoordinator&) = delete;
+    WriteCoordinator& operator=(const WriteCoordinator&) = delete;
+
+    /** 按持久化模式写入，返回时已满足该模式的持久化保证 */
+    bool Write(rocksdb::WriteBatch* batch);
+
+    Stats stats() const;
+    Durability durability() const { return options_.durability; }
+
+private:
+    struct Pending {
+        rocksdb::WriteBatch* batch = nullptr;
+        bool done = false;
+        bool ok = false;
+    };
+
+    bool WriteDirect(rocksdb::WriteBatch* batch, bool sync);
+    void CommitLoop();
+    void CommitGroup(const std::vector<Pending*>& group);
+    void FlushLoop();
+
+    rocksdb::DB* db_;
+    WriteCoordinatorOptions options_;
+    std::unordered_map<uint32_t, rocksdb::ColumnFamilyHandle*> families_;
+
+    mutable std::mutex mu_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Pending*> queue_;
+    bool stopping_ = false;
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::thread worker_;  // GROUP_COMMIT 提交线程或 WAL_NO_SYNC 刷盘线程
+};
+
+}  // namespace swift::chat
@@ -0,0 +1,236 @@
+#pragma once
+
+/**
+ * @file cmd_id.h
+ * @brief 客户端命令的数值 ID 与分发表（Gate、Zone 共用）
+ *
+ * ClientMessage/ServerMessage/HandleClientRequestRequest 的 cmd_id 字段取值。
+ * 新客户端只需填 cmd_id；老客户端只填 cmd 字符串，服务端用 CmdFromName 查回 ID。
+ *
+ * 编码规则（百位即所属域，CmdDomainOf 直接除法得到，无需查表）：
+ *   1-99     - 连接/系统（heartbeat、推送类通知）
+ *   100-199  - auth.*
+ *   200-299  - chat.*
+ *   300-399  - friend.*
+ *   400-499  - group.*
+ *   500-599  - file.*
+ * 已分配的数值不得修改或复用，只能追加。
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace swift {
+
+enum class CmdId : uint16_t {
+    UNKNOWN = 0,
+
+    // ========== 连接/系统 1-99 ==========
+    HEARTBEAT = 1,
+    SYSTEM_KICKED = 2,             // 推送
+    USER_STATUS_CHANGE = 3,        // 推送
+
+    // ========== auth.* 100-199 ==========
+    AUTH_LOGIN = 100,
+    AUTH_REGISTER = 101,
+    AUTH_LOGOUT = 102,
+    AUTH_VALIDATE_TOKEN = 103,
+
+    // ========== chat.* 200-299 ==========
+    CHAT_SEND_MESSAGE = 200,
+    CHAT_RECALL_MESSAGE = 201,
+    CHAT_PULL_OFFLINE = 202,
+    CHAT_MARK_READ = 203,
+    CHAT_GET_HISTORY = 204,
+    CHAT_SYNC_CONVERSATIONS = 205,
+    CHAT_DELETE_CONVERSATION = 206,
+    CHAT_MESSAGE = 250,            // 推送
+    CHAT_READ_RECEIPT = 251,       // 推送
+
+    // ========== friend.* 300-399 ==========
+    FRIEND_ADD = 300,
+    FRIEND_HANDLE_REQUEST = 301,
+    FRIEND_REMOVE = 302,
+    FRIEND_BLOCK = 303,
+    FRIEND_UNBLOCK = 304,
+    FRIEND_GET_FRIENDS = 305,
+    FRIEND_GET_REQUESTS = 306,
+    FRIEND_GET_FRIEND_REQUESTS = 307,
+    FRIEND_CREATE_GROUP = 308,
+    FRIEND_GET_GROUPS = 309,
+    FRIEND_DELETE_GROUP = 310,
+    FRIEND_MOVE_TO_GROUP = 311,
+    FRIEND_SET_REMARK = 312,
+    FRIEND_SEARCH = 313,
+    FRIEND_GET_BLOCK_LIST = 314,
+
+    // ========== group.* 400-499 ==========
+    GROUP_CREATE = 400,
+    GROUP_DISMISS = 401,
+    GROUP_INVITE_MEMBERS = 402,
+    GROUP_REMOVE_MEMBER = 403,
+    GROUP_LEAVE = 404,
+    GROUP_GET_INFO = 405,
+    GROUP_GET_MEMBERS = 406,
+    GROUP_GET_USER_GROUPS = 407,
+
+    // ========== file.* 500-599 ==========
+    FILE_GET_UPLOAD_TOKEN = 500,
+    FILE_INIT_UPLOAD = 501,
+    FILE_GET_FILE_URL = 502,
+    FILE_GET_FILE_INFO = 503,
+    FILE_DELETE = 504,
+};
+
+/// 命令所属域（CmdId 的百位）
+enum class CmdDomain : uint8_t {
+    SYSTEM = 0,
+    AUTH = 1,
+    CHAT = 2,
+    FRIEND = 3,
+    GROUP = 4,
+    FILE = 5,
+};
+
+constexpr CmdDomain CmdDomainOf(CmdId id) {
+    return static_cast<CmdDomain>(static_cast<uint16_t>(id) / 100);
+}
+
+struct CmdEntry {
+    CmdId id;
+    std::string_view name;
+};
+
+inline constexpr CmdEntry kCmdTable[] = {
+    {CmdId::HEARTBEAT, "heartbeat"},
+    {CmdId::SYSTEM_KICKED, "system.kicked"},
+    {CmdId::USER_STATUS_CHANGE, "user.status_change"},
+    {CmdId::AUTH_LOGIN, "auth.login"},
+    {CmdId::AUTH_REGISTER, "auth.register"},
+    {CmdId::AUTH_LOGOUT, "auth.logout"},
+    {CmdId::AUTH_VALIDATE_TOKEN, "auth.validate_token"},
+    {CmdId::CHAT_SEND_MESSAGE, "chat.send_message"},
+    {CmdId::CHAT_RECALL_MESSAGE, "chat.recall_message"},
+    {CmdId::CHAT_PULL_OFFLINE, "chat.pull_offline"},
+    {CmdId::CHAT_MARK_READ, "chat.mark_read"},
+    {CmdId::CHAT_GET_HISTORY, "chat.get_history"},
+    {CmdId::CHAT_SYNC_CONVERSATIONS, "chat.sync_conversations"},
+    {CmdId::CHAT_DELETE_CONVERSATION, "chat.delete_conversation"},
+    {CmdId::CHAT_MESSAGE, "chat.message"},
+    {CmdId::CHAT_READ_RECEIPT, "chat.read_receipt"},
+    {CmdId::FRIEND_ADD, "friend.add"},
+    {CmdId::FRIEND_HANDLE_REQUEST, "friend.handle_request"},
+    {CmdId::FRIEND_REMOVE, "friend.remove"},
+    {CmdId::FRIEND_BLOCK, "friend.block"},
+    {CmdId::FRIEND_UNBLOCK, "friend.unblock"},
+    {CmdId::FRIEND_GET_FRIENDS, "friend.get_friends"},
+    {CmdId::FRIEND_GET_REQUESTS, "friend.get_requests"},
+    {CmdId::FRIEND_GET_FRIEND_REQUESTS, "friend.get_friend_requests"},
+    {CmdId::FRIEND_CREATE_GROUP, "friend.create_group"},
+    {CmdId::FRIEND_GET_GROUPS, "friend.get_groups"},
+    {CmdId::FRIEND_DELETE_GROUP, "friend.delete_group"},
+    {CmdId::FRIEND_MOVE_TO_GROUP, "friend.move_to_group"},
+    {CmdId::FRIEND_SET_REMARK, "friend.set_remark"},
+    {CmdId::FRIEND_SEARCH, "friend.search"},
+    {CmdId::FRIEND_GET_BLOCK_LIST, "friend.get_block_list"},
+    {CmdId::GROUP_CREATE, "group.create"},
+    {CmdId::GROUP_DISMISS, "group.dismiss"},
+    {CmdId::GROUP_INVITE_MEMBERS, "group.invite_members"},
+    {CmdId::GROUP_REMOVE_MEMBER, "group.remove_member"},
+    {CmdId::GROUP_LEAVE, "group.leave"},
+    {CmdId::GROUP_GET_INFO, "group.get_info"},
+    {CmdId::GROUP_GET_MEMBERS, "group.get_members"},
+    {CmdId::GROUP_GET_USER_GROUPS, "group.get_user_groups"},
+    {CmdId::FILE_GET_UPLOAD_TOKEN, "file.get_upload_token"},
+    {CmdId::FILE_INIT_UPLOAD, "file.init_upload"},
+    {CmdId::FILE_GET_FILE_URL, "file.get_file_url"},
+    {CmdId::FILE_GET_FILE_INFO, "file.get_file_info"},
+    {CmdId::FILE_DELETE, "file.delete"},
+};
+
+namespace detail {
+
+inline constexpr size_t kCmdCount = sizeof(kCmdTable) / sizeof(kCmdTable[0]);
+inline constexpr size_t kCmdMaxId = 599;
+inline constexpr size_t kCmdSlots = 128;  // 2 的幂且 >= 2 * kCmdCount，线性探测平均不到两次比较
+static_assert(kCmdSlots >= 2 * kCmdCount, "enlarge kCmdSlots");
+
+constexpr uint32_t CmdHash(std::string_view s) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/// 编译期生成的两张表，元素为 kCmdTable 下标 + 1（0 表示空）
+struct CmdIndex {
+    std::array<uint8_t, kCmdSlots> by_name{};
+    std::array<uint8_t, kCmdMaxId + 1> by_id{};
+};
+
+constexpr CmdIndex BuildCmdIndex() {
+    CmdIndex index;
+    for (size_t i = 0; i < kCmdCount; ++i) {
+        size_t slot = CmdHash(kCmdTable[i].name) & (kCmdSlots - 1);
+        while (index.by_name[slot] != 0) slot = (slot + 1) & (kCmdSlots - 1);
+        index.by_name[slot] = static_cast<uint8_t>(i + 1);
+        index.by_id[static_cast<uint16_t>(kCmdTable[i].id)] = static_cast<uint8_t>(i + 1);
+    }
+    return index;
+}
+
+inline constexpr CmdIndex kCmdIndex = BuildCmdIndex();
+
+}  // namespace detail
+
+/// 字符串 cmd → ID；未知命令返回 UNKNOWN。无分配，O(1)
+constexpr CmdId CmdFromName(std::string_view name) {
+    size_t slot = detail::CmdHash(name) & (detail::kCmdSlots - 1);
+    while (uint8_t e = detail::kCmdIndex.by_name[slot]) {
+        if (kCmdTable[e - 1].name == name) return kCmdTable[e - 1].id;
+        slot = (slot + 1) & (detail::kCmdSlots - 1);
+    }
+    return CmdId::UNKNOWN;
+}
+
+/// 线上收到的 cmd_id 原始值 → CmdId；未分配的值返回 UNKNOWN
+constexpr CmdId CmdFromWire(uint32_t raw) {
+    if (raw == 0 || raw > detail::kCmdMaxId || detail::kCmdIndex.by_id[raw] == 0) return CmdId::UNKNOWN;
+    return static_cast<CmdId>(raw);
+}
+
+/// ID → 字符串 cmd；UNKNOWN 返回空串
+constexpr std::string_view CmdName(CmdId id) {
+    auto raw = static_cast<uint16_t>(id);
+    if (raw > detail::kCmdMaxId) return {};
+    uint8_t e = detail::kCmdIndex.by_id[raw];
+    return e ? kCmdTable[e - 1].name : std::string_view();
+}
+
+/// 优先使用 cmd_id，为 0（老客户端）时按字符串查
+constexpr CmdId ResolveCmd(uint32_t cmd_id, std::string_view cmd) {
+    return cmd_id != 0 ? CmdFromWire(cmd_id) : CmdFromName(cmd);
+}
+
+namespace detail {
+/// 每一项都能双向查回自身（同时排除重复的名字或 ID）
+constexpr bool CmdTableConsistent() {
+    for (const auto& e : kCmdTable) {
+        if (static_cast<uint16_t>(e.id) > kCmdMaxId) return false;
+        if (CmdFromName(e.name) != e.id || CmdName(e.id) != e.name) return false;
+    }
+    return true;
+}
+}  // namespace detail
+
+static_assert(detail::CmdTableConsistent(), "kCmdTable has duplicate or out-of-range entries");
+static_assert(CmdFromName("chat.send_message") == CmdId::CHAT_SEND_MESSAGE);
+static_assert(CmdFromName("chat.") == CmdId::UNKNOWN);
+static_assert(CmdName(CmdId::GROUP_LEAVE) == "group.leave");
+static_assert(CmdDomainOf(CmdId::FRIEND_SEARCH) == CmdDomain::FRIEND);
+
+}  // namespace swift
@@ -0,0 +1,186 @@
+#pragma once
+
+/**
+ * @file record_codec.h
+ * @brief RocksDB 值的二进制记录编码（各服务 store 共用，header-only）
+ *
+ * 格式：[魔数 0xB5][schema 版本 1 字节][字段...]
+ *   整数   - varint（有符号整数先 zigzag）
+ *   bool   - 1 字节
+ *   字符串 - varint 长度 + 原始字节
+ *   字符串数组 - varint 个数 + 各字符串
+ *
+ * 字段按各记录约定的固定顺序写入，不带字段名。演进规则：只能在末尾追加字段并提升版本号；
+ * 读取到记录末尾时后续字段保持默认值，所以新代码能读旧记录。
+ *
+ * 首字节不是魔数（旧版为 '{'）的值是 nlohmann JSON 记录，由各 store 走原 JSON 解析兜底；
+ * 记录再次写入时统一编码为二进制，即惰性迁移，无需离线转换。
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace swift::record {
+
+constexpr uint8_t kMagic = 0xB5;
+
+/// 是否为二进制记录（否则按旧版 JSON 解析）
+inline bool IsBinary(std::string_view data) {
+    return data.size() >= 2 && static_cast<uint8_t>(data[0]) == kMagic;
+}
+
+class Writer {
+public:
+    explicit Writer(uint8_t version, size_t reserve = 64) {
+        buf_.reserve(reserve);
+        buf_.push_back(static_cast<char>(kMagic));
+        buf_.push_back(static_cast<char>(version));
+    }
+
+    Writer& U64(uint64_t v) {
+        while (v >= 0x80) {
+            buf_.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        buf_.push_back(static_cast<char>(v));
+        return *this;
+    }
+
+    Writer& I64(int64_t v) {
+        return U64((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    Writer& Bool(bool v) {
+        buf_.push_back(v ? 1 : 0);
+        return *this;
+    }
+
+    Writer& Str(std::string_view s) {
+        U64(s.size());
+        buf_.append(s.data(), s.size());
+        return *this;
+    }
+
+    Writer& StrList(const std::vector<std::string>& v) {
+        U64(v.size());
+        for (const auto& s : v) Str(s);
+        return *this;
+    }
+
+    std::string Finish() { return std::move(buf_); }
+
+private:
+    std::string buf_;
+};
+
+/**
+ * 按写入顺序逐字段读取。已到记录末尾的字段保持 out 原值（旧版本缺少的字段取默认值）；
+ * 字段被截断或魔数不符时 ok() 为 false，之后的读取都不再修改 out。
+ */
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {
+        ok_ = IsBinary(data);
+        if (ok_) {
+            version_ = static_cast<uint8_t>(data[1]);
+            pos_ = 2;
+        }
+    }
+
+    bool ok() const { return ok_; }
+    uint8_t version() const { return version_; }
+
+    /// 读完全部字段后调用：记录损坏时抛 runtime_error("corrupt {what} record")，与 JSON 解析失败一样由调用方捕获
+    void Check(const char* what) const {
+        if (!ok_)
+            throw std::runtime_error(std::string("corrupt ") + what + " record");
+    }
+
+    Reader& U64(uint64_t* out) {
+        if (!Readable()) return *this;
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= data_.size()) break;
+            auto b = static_cast<uint8_t>(data_[pos_++]);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                *out = v;
+                return *this;
+            }
+        }
+        ok_ = false;
+        return *this;
+    }
+
+    Reader& I64(int64_t* out) {
+        uint64_t u = 0;
+        bool present = Readable();
+        U64(&u);
+        if (present && ok_)
+            *out = static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1));
+        return *this;
+    }
+
+    Reader& I32(int* out) {
+        int64_t v = *out;
+        I64(&v);
+        *out = static_cast<int>(v);
+        return *this;
+    }
+
+    Reader& Bool(bool* out) {
+        if (!Readable()) return *this;
+        *out = data_[pos_++] != 0;
+        return *this;
+    }
+
+    Reader& Str(std::string* out) {
+        if (!Readable()) return *this;
+        uint64_t n = 0;
+        U64(&n);
+        if (!ok_) return *this;
+        if (n > data_.size() - pos_) {
+            ok_ = false;
+            return *this;
+        }
+        out->assign(data_.data() + pos_, static_cast<size_t>(n));
+        pos_ += static_cast<size_t>(n);
+        return *this;
+    }
+
+    Reader& StrList(std::vector<std::string>* out) {
+        if (!Readable()) return *this;
+        uint64_t n = 0;
+        U64(&n);
+        if (!ok_) return *this;
+        if (n > data_.size() - pos_) {  // 每个元素至少 1 字节长度
+            ok_ = false;
+            return *this;
+        }
+        out->clear();
+        out->reserve(static_cast<size_t>(n));
+        for (uint64_t i = 0; i < n && ok_; ++i) {
+            if (pos_ >= data_.size()) {
+                ok_ = false;
+                break;
+            }
+            out->emplace_back();
+            Str(&out->back());
+        }
+        return *this;
+    }
+
+private:
+    bool Readable() const { return ok_ && pos_ < data_.size(); }
+
+    std::string_view data_;
+    size_t pos_ = 0;
+    uint8_t version_ = 0;
+    bool ok_ = false;
+};
+
+}  // namespace swift::record
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * @file rocksdb_prefix.h
+ * @brief RocksDB 前缀扫描支持（各服务 store 共用，header-only，仅供链接 RocksDB 的 store 源文件包含）
+ *
+ * 各 store 的 key 均为 "{keyspace}:{owner_id}:{...}"，列表查询都是按 "{keyspace}:{owner_id}:" 前缀扫描：
+ *   - KeyspacePrefixTransform 作为 prefix_extractor，取到第二个 ':'（含），SST 的前缀布隆过滤器据此建立，
+ *     Seek 时跳过不含该前缀的文件；只有一个 ':' 的 key（如 msg:{id}）不在域内，只走整 key 过滤器。
+ *   - PrefixScan 为迭代器设置 iterate_upper_bound = 前缀的后继，迭代越过前缀即结束，不再读后面的块。
+ * Transform 名称写入 SST，修改规则须同时改名；旧 SST 名称不符时 RocksDB 只是不使用其前缀过滤器。
+ */
+
+#include <rocksdb/options.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/slice_transform.h>
+#include <memory>
+#include <string>
+
+namespace swift::rocksdb_prefix {
+
+class KeyspacePrefixTransform : public rocksdb::SliceTransform {
+public:
+    const char* Name() const override { return "swift.KeyspacePrefix.2"; }
+
+    rocksdb::Slice Transform(const rocksdb::Slice& key) const override {
+        return rocksdb::Slice(key.data(), PrefixLength(key));
+    }
+
+    bool InDomain(const rocksdb::Slice& key) const override { return PrefixLength(key) > 0; }
+
+private:
+    // 到第二个 ':'（含）的长度；不足两个 ':' 返回 0
+    static size_t PrefixLength(const rocksdb::Slice& key) {
+        int seen = 0;
+        for (size_t i = 0; i < key.size(); ++i) {
+            if (key[i] == ':' && ++seen == 2)
+                return i + 1;
+        }
+        return 0;
+    }
+};
+
+inline std::shared_ptr<const rocksdb::SliceTransform> NewKeyspacePrefixExtractor() {
+    return std::make_shared<KeyspacePrefixTransform>();
+}
+
+/** 字典序上所有以 prefix 开头的 key 的上界（不含）；prefix 全为 0xff 时返回空串表示无上界 */
+inline std::string PrefixSuccessor(std::string prefix) {
+    while (!prefix.empty()) {
+        unsigned char last = static_cast<unsigned char>(prefix.back());
+        if (last != 0xff) {
+            prefix.back() = static_cast<char>(last + 1);
+            return prefix;
+        }
+        prefix.pop_back();
+    }
+    return prefix;
+}
+
+/**
+ * 前缀扫描的 ReadOptions：iterate_upper_bound 指向内部保存的前缀后继，须在迭代器销毁后才能析构。
+ *   swift::rocksdb_prefix::PrefixScan scan(prefix);
+ *   std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(scan.options(), cf));
+ */
+class PrefixScan {
+public:
+    explicit PrefixScan(const std::string& prefix) : upper_(PrefixSuccessor(prefix)), upper_slice_(upper_) {
+        if (!upper_.empty())
+            options_.iterate_upper_bound = &upper_slice_;
+    }
+
+    PrefixScan(const PrefixScan&) = delete;
+    PrefixScan& operator=(const PrefixScan&) = delete;
+
+    rocksdb::ReadOptions& options() { return options_; }
+
+private:
+    std::string upper_;
+    rocksdb::Slice upper_slice_;
+    rocksdb::ReadOptions options_;
+};
+
+}  // namespace swift::rocksdb_prefix
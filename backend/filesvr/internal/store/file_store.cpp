@@ -3,7 +3,7 @@
  * @brief RocksDB 文件元信息存储实现
  *
  * Key 设计：
- *   file:{file_id}     -> FileMetaData JSON
+ *   file:{file_id}     -> FileMetaData（二进制记录，兼容读旧 JSON）
  *   file_md5:{md5}     -> file_id（用于秒传检测）
  */
 
@@ -12,6 +12,7 @@
 #include <nlohmann/json.hpp>
 #include <rocksdb/db.h>
 #include <rocksdb/write_batch.h>
+#include <swift/record_codec.h>
 #include <stdexcept>
 
 using json = nlohmann::json;
@@ -20,20 +21,11 @@ namespace swift::file {
 
 namespace {
 
-std::string SerializeMeta(const FileMetaData& meta) {
-  json j;
-  j["file_id"] = meta.file_id;
-  j["file_name"] = meta.file_name;
-  j["content_type"] = meta.content_type;
-  j["file_size"] = meta.file_size;
-  j["md5"] = meta.md5;
-  j["uploader_id"] = meta.uploader_id;
-  j["storage_path"] = meta.storage_path;
-  j["uploaded_at"] = meta.uploaded_at;
-  return j.dump();
-}
+// 写二进制记录（swift/record_codec.h，字段顺序固定、只能在末尾追加），读兼容旧版 JSON；损坏时抛异常
+constexpr uint8_t kMetaVersion = 1;
+constexpr uint8_t kSessionVersion = 1;
 
-FileMetaData DeserializeMeta(const std::string& data) {
+FileMetaData DeserializeMetaJson(const std::string& data) {
   json j = json::parse(data);
   FileMetaData meta;
   meta.file_id = j.value("file_id", "");
@@ -47,22 +39,7 @@ FileMetaData DeserializeMeta(const std::string& data) {
   return meta;
 }
 
-std::string SerializeSession(const UploadSessionData& s) {
-  json j;
-  j["upload_id"] = s.upload_id;
-  j["user_id"] = s.user_id;
-  j["file_name"] = s.file_name;
-  j["content_type"] = s.content_type;
-  j["file_size"] = s.file_size;
-  j["md5"] = s.md5;
-  j["msg_id"] = s.msg_id;
-  j["temp_path"] = s.temp_path;
-  j["bytes_written"] = s.bytes_written;
-  j["expire_at"] = s.expire_at;
-  return j.dump();
-}
-
-UploadSessionData DeserializeSession(const std::string& data) {
+UploadSessionData DeserializeSessionJson(const std::string& data) {
   json j = json::parse(data);
   UploadSessionData s;
   s.upload_id = j.value("upload_id", "");
@@ -78,6 +55,70 @@ UploadSessionData DeserializeSession(const std::string& data) {
   return s;
 }
 
+std::string SerializeMeta(const FileMetaData& meta) {
+  return swift::record::Writer(kMetaVersion, 128)
+      .Str(meta.file_id)
+      .Str(meta.file_name)
+      .Str(meta.content_type)
+      .I64(meta.file_size)
+      .Str(meta.md5)
+      .Str(meta.uploader_id)
+      .Str(meta.storage_path)
+      .I64(meta.uploaded_at)
+      .Finish();
+}
+
+FileMetaData DeserializeMeta(const std::string& data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeMetaJson(data);
+  FileMetaData meta;
+  swift::record::Reader r(data);
+  r.Str(&meta.file_id)
+      .Str(&meta.file_name)
+      .Str(&meta.content_type)
+      .I64(&meta.file_size)
+      .Str(&meta.md5)
+      .Str(&meta.uploader_id)
+      .Str(&meta.storage_path)
+      .I64(&meta.uploaded_at);
+  r.Check("file meta");
+  return meta;
+}
+
+std::string SerializeSession(const UploadSessionData& s) {
+  return swift::record::Writer(kSessionVersion, 160)
+      .Str(s.upload_id)
+      .Str(s.user_id)
+      .Str(s.file_name)
+      .Str(s.content_type)
+      .I64(s.file_size)
+      .Str(s.md5)
+      .Str(s.msg_id)
+      .Str(s.temp_path)
+      .I64(s.bytes_written)
+      .I64(s.expire_at)
+      .Finish();
+}
+
+UploadSessionData DeserializeSession(const std::string& data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeSessionJson(data);
+  UploadSessionData s;
+  swift::record::Reader r(data);
+  r.Str(&s.upload_id)
+      .Str(&s.user_id)
+      .Str(&s.file_name)
+      .Str(&s.content_type)
+      .I64(&s.file_size)
+      .Str(&s.md5)
+      .Str(&s.msg_id)
+      .Str(&s.temp_path)
+      .I64(&s.bytes_written)
+      .I64(&s.expire_at);
+  r.Check("upload session");
+  return s;
+}
+
 constexpr const char* KEY_PREFIX_FILE = "file:";
 constexpr const char* KEY_PREFIX_FILE_MD5 = "file_md5:";
 constexpr const char* KEY_PREFIX_UPLOAD = "upload:";
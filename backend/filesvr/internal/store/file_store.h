@@ -43,7 +43,7 @@ struct UploadSessionData {
  * RocksDB Key 设计：
  *   file:{file_id}      -> FileMetaData
  *   file_md5:{md5}      -> file_id (用于秒传检测)
- *   upload:{upload_id}  -> UploadSessionData JSON
+ *   upload:{upload_id}  -> UploadSessionData（二进制记录，兼容读旧 JSON）
  */
 class FileStore {
 public:
@@ -3,62 +3,54 @@
  * @brief RocksDB 好友存储实现
  *
  * Key 设计：
- *   friend:{user_id}:{friend_id}        -> FriendData JSON
- *   friend_req:{request_id}             -> FriendRequestData JSON
+ *   friend:{user_id}:{friend_id}        -> FriendData（二进制记录，兼容读旧 JSON，下同）
+ *   friend_req:{request_id}             -> FriendRequestData
  *   friend_req_to:{to_user_id}:{req_id}  -> "" (收到的请求索引)
  *   friend_req_from:{from_user_id}:{req_id} -> "" (发出的请求索引)
- *   friend_group:{user_id}:{group_id}   -> FriendGroupData JSON
+ *   friend_group:{user_id}:{group_id}   -> FriendGroupData
  *   block:{user_id}:{target_id}         -> "1"
+ *
+ * 列表查询都按 "{keyspace}:{user_id}:" 前缀扫描：以此为 prefix_extractor 建前缀布隆过滤器，
+ * 迭代器带 iterate_upper_bound（swift/rocksdb_prefix.h）；点查走整 key 布隆过滤器。
  */
 
 #include "friend_store.h"
 #include <nlohmann/json.hpp>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
 #include <rocksdb/iterator.h>
+#include <rocksdb/table.h>
 #include <rocksdb/write_batch.h>
+#include <swift/record_codec.h>
+#include <swift/rocksdb_prefix.h>
 #include <stdexcept>
 
 using json = nlohmann::json;
+using swift::rocksdb_prefix::PrefixScan;
 
 namespace swift::friend_ {
 
 namespace {
 
 // ============== 序列化 ==============
+// 写二进制记录（swift/record_codec.h，字段顺序固定、只能在末尾追加），读兼容旧版 JSON；损坏时抛异常
 
-std::string SerializeFriend(const FriendData &d) {
-  json j;
-  j["user_id"] = d.user_id;
-  j["friend_id"] = d.friend_id;
-  j["remark"] = d.remark;
-  j["group_id"] = d.group_id;
-  j["added_at"] = d.added_at;
-  return j.dump();
-}
+constexpr uint8_t kFriendVersion = 1;
+constexpr uint8_t kRequestVersion = 1;
+constexpr uint8_t kGroupVersion = 1;
 
-FriendData DeserializeFriend(const std::string &data) {
+FriendData DeserializeFriendJson(const std::string &data) {
   json j = json::parse(data);
   FriendData d;
   d.user_id = j.value("user_id", "");
   d.friend_id = j.value("friend_id", "");
   d.remark = j.value("remark", "");
   d.group_id = j.value("group_id", "");
-  d.added_at = j.value("added_at", 0);
+  d.added_at = j.value("added_at", static_cast<int64_t>(0));
   return d;
 }
 
-std::string SerializeRequest(const FriendRequestData &r) {
-  json j;
-  j["request_id"] = r.request_id;
-  j["from_user_id"] = r.from_user_id;
-  j["to_user_id"] = r.to_user_id;
-  j["remark"] = r.remark;
-  j["status"] = r.status;
-  j["created_at"] = r.created_at;
-  return j.dump();
-}
-
-FriendRequestData DeserializeRequest(const std::string &data) {
+FriendRequestData DeserializeRequestJson(const std::string &data) {
   json j = json::parse(data);
   FriendRequestData r;
   r.request_id = j.value("request_id", "");
@@ -66,20 +58,11 @@ FriendRequestData DeserializeRequest(const std::string &data) {
   r.to_user_id = j.value("to_user_id", "");
   r.remark = j.value("remark", "");
   r.status = j.value("status", 0);
-  r.created_at = j.value("created_at", 0);
+  r.created_at = j.value("created_at", static_cast<int64_t>(0));
   return r;
 }
 
-std::string SerializeGroup(const FriendGroupData &g) {
-  json j;
-  j["group_id"] = g.group_id;
-  j["user_id"] = g.user_id;
-  j["group_name"] = g.group_name;
-  j["sort_order"] = g.sort_order;
-  return j.dump();
-}
-
-FriendGroupData DeserializeGroup(const std::string &data) {
+FriendGroupData DeserializeGroupJson(const std::string &data) {
   json j = json::parse(data);
   FriendGroupData g;
   g.group_id = j.value("group_id", "");
@@ -89,6 +72,71 @@ FriendGroupData DeserializeGroup(const std::string &data) {
   return g;
 }
 
+std::string SerializeFriend(const FriendData &d) {
+  return swift::record::Writer(kFriendVersion)
+      .Str(d.user_id)
+      .Str(d.friend_id)
+      .Str(d.remark)
+      .Str(d.group_id)
+      .I64(d.added_at)
+      .Finish();
+}
+
+FriendData DeserializeFriend(const std::string &data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeFriendJson(data);
+  FriendData d;
+  swift::record::Reader r(data);
+  r.Str(&d.user_id).Str(&d.friend_id).Str(&d.remark).Str(&d.group_id).I64(&d.added_at);
+  r.Check("friend");
+  return d;
+}
+
+std::string SerializeRequest(const FriendRequestData &req) {
+  return swift::record::Writer(kRequestVersion)
+      .Str(req.request_id)
+      .Str(req.from_user_id)
+      .Str(req.to_user_id)
+      .Str(req.remark)
+      .I64(req.status)
+      .I64(req.created_at)
+      .Finish();
+}
+
+FriendRequestData DeserializeRequest(const std::string &data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeRequestJson(data);
+  FriendRequestData req;
+  swift::record::Reader r(data);
+  r.Str(&req.request_id)
+      .Str(&req.from_user_id)
+      .Str(&req.to_user_id)
+      .Str(&req.remark)
+      .I32(&req.status)
+      .I64(&req.created_at);
+  r.Check("friend request");
+  return req;
+}
+
+std::string SerializeGroup(const FriendGroupData &g) {
+  return swift::record::Writer(kGroupVersion)
+      .Str(g.group_id)
+      .Str(g.user_id)
+      .Str(g.group_name)
+      .I64(g.sort_order)
+      .Finish();
+}
+
+FriendGroupData DeserializeGroup(const std::string &data) {
+  if (!swift::record::IsBinary(data))
+    return DeserializeGroupJson(data);
+  FriendGroupData g;
+  swift::record::Reader r(data);
+  r.Str(&g.group_id).Str(&g.user_id).Str(&g.group_name).I32(&g.sort_order);
+  r.Check("friend group");
+  return g;
+}
+
 // ============== Key 前缀 ==============
 
 constexpr const char *K_FRIEND = "friend:";
@@ -162,6 +210,14 @@ RocksDBFriendStore::RocksDBFriendStore(const std::string &db_path)
   options.create_if_missing = true;
   options.IncreaseParallelism();
   options.OptimizeLevelStyleCompaction();
+  options.prefix_extractor = swift::rocksdb_prefix::NewKeyspacePrefixExtractor();
+  options.memtable_prefix_bloom_size_ratio = 0.05;
+  options.memtable_whole_key_filtering = true;  // IsFriend / IsBlocked 点查
+  rocksdb::BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+  options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
   rocksdb::Status status = rocksdb::DB::Open(options, db_path, &impl_->db);
   if (!status.ok()) {
     throw std::runtime_error("Failed to open RocksDB: " + status.ToString());
@@ -221,8 +277,9 @@ RocksDBFriendStore::GetFriends(const std::string &user_id,
 
   std::string prefix = PrefixFriend(user_id);
   rocksdb::Slice prefix_slice(prefix);
+  PrefixScan scan(prefix);
   std::unique_ptr<rocksdb::Iterator> it(
-      impl_->db->NewIterator(rocksdb::ReadOptions()));
+      impl_->db->NewIterator(scan.options()));
   for (it->Seek(prefix); it->Valid(); it->Next()) {
     if (!it->key().starts_with(prefix_slice))
       break;
@@ -355,8 +412,9 @@ RocksDBFriendStore::GetReceivedRequests(const std::string &user_id) {
 
   std::string prefix = PrefixFriendReqTo(user_id);
   rocksdb::Slice prefix_slice(prefix);
+  PrefixScan scan(prefix);
   std::unique_ptr<rocksdb::Iterator> it(
-      impl_->db->NewIterator(rocksdb::ReadOptions()));
+      impl_->db->NewIterator(scan.options()));
   for (it->Seek(prefix); it->Valid(); it->Next()) {
     if (!it->key().starts_with(prefix_slice))
       break;
@@ -381,8 +439,9 @@ RocksDBFriendStore::GetSentRequests(const std::string &user_id) {
 
   std::string prefix = PrefixFriendReqFrom(user_id);
   rocksdb::Slice prefix_slice(prefix);
+  PrefixScan scan(prefix);
   std::unique_ptr<rocksdb::Iterator> it(
-      impl_->db->NewIterator(rocksdb::ReadOptions()));
+      impl_->db->NewIterator(scan.options()));
   for (it->Seek(prefix); it->Valid(); it->Next()) {
     if (!it->key().starts_with(prefix_slice))
       break;
@@ -424,8 +483,9 @@ RocksDBFriendStore::GetGroups(const std::string &user_id) {
 
   std::string prefix = PrefixFriendGroup(user_id);
   rocksdb::Slice prefix_slice(prefix);
+  PrefixScan scan(prefix);
   std::unique_ptr<rocksdb::Iterator> it(
-      impl_->db->NewIterator(rocksdb::ReadOptions()));
+      impl_->db->NewIterator(scan.options()));
   for (it->Seek(prefix); it->Valid(); it->Next()) {
     if (!it->key().starts_with(prefix_slice))
       break;
@@ -501,8 +561,9 @@ RocksDBFriendStore::GetBlockList(const std::string &user_id) {
 
   std::string prefix = PrefixBlock(user_id);
   rocksdb::Slice prefix_slice(prefix);
+  PrefixScan scan(prefix);
   std::unique_ptr<rocksdb::Iterator> it(
-      impl_->db->NewIterator(rocksdb::ReadOptions()));
+      impl_->db->NewIterator(scan.options()));
   for (it->Seek(prefix); it->Valid(); it->Next()) {
     if (!it->key().starts_with(prefix_slice))
       break;
@@ -16,6 +16,9 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 
 #include <grpcpp/security/server_credentials.h>
@@ -133,6 +136,19 @@ bool RegisterGateWithRetry(const std::shared_ptr<swift::gate::GateService>& gate
     return false;
 }
 
+/** 将线程绑定到 cpu 号核心（按在线核数取模）；失败仅告警 */
+void PinThreadToCpu(std::thread& t, int cpu) {
+    int ncpu = static_cast<int>(std::thread::hardware_concurrency());
+    if (ncpu <= 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % ncpu, &set);
+    int rc = pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+    if (rc != 0) {
+        LogWarning("GateSvr pin io thread to cpu " << (cpu % ncpu) << " failed, rc=" << rc);
+    }
+}
+
 bool IsWildcardHost(const std::string& host) {
     return host.empty() || host == "0.0.0.0" || host == "::";
 }
@@ -214,23 +230,49 @@ int main(int argc, char* argv[]) {
     }
 
     // WebSocket 监听：9090
-    boost::asio::io_context ioc{1};
-    auto ws_listener = std::make_shared<swift::gate::WsListener>(
-        ioc, config.host, config.websocket_port, gate_svc, ws_handler);
-    ws_listener->Run();
+    // io_reuse_port：每线程一个 io_context + SO_REUSEPORT 监听器（无跨线程共享，内核分摊 accept）；
+    // 否则多线程共同 run 一个 io_context，连接按 strand 串行。
+    int io_threads = config.io_threads > 0
+        ? config.io_threads : static_cast<int>(std::thread::hardware_concurrency());
+    if (io_threads <= 0) io_threads = 1;
+    const bool per_thread_ioc = config.io_reuse_port && io_threads > 1;
+    std::vector<std::unique_ptr<boost::asio::io_context>> io_contexts;
+    std::vector<std::shared_ptr<swift::gate::WsListener>> ws_listeners;
+    const int num_ioc = per_thread_ioc ? io_threads : 1;
+    swift::gate::WsDeflateOptions deflate;
+    deflate.enable = config.ws_deflate_enable;
+    deflate.server_max_window_bits = config.ws_deflate_server_max_window_bits;
+    deflate.client_max_window_bits = config.ws_deflate_client_max_window_bits;
+    deflate.server_no_context_takeover = config.ws_deflate_server_no_context_takeover;
+    deflate.client_no_context_takeover = config.ws_deflate_client_no_context_takeover;
+    deflate.level = config.ws_deflate_level;
+    deflate.mem_level = config.ws_deflate_mem_level;
+    deflate.min_size = config.ws_deflate_min_size > 0 ? static_cast<std::size_t>(config.ws_deflate_min_size) : 0;
+    for (int i = 0; i < num_ioc; ++i) {
+        io_contexts.push_back(std::make_unique<boost::asio::io_context>(per_thread_ioc ? 1 : io_threads));
+        auto listener = std::make_shared<swift::gate::WsListener>(
+            *io_contexts.back(), config.host, config.websocket_port, gate_svc, ws_handler,
+            per_thread_ioc, deflate);
+        listener->Run();
+        ws_listeners.push_back(std::move(listener));
+    }
     LogInfo("GateSvr WebSocket listening on " << config.host << ":"
-              << config.websocket_port);
+              << config.websocket_port << " (io_threads=" << io_threads
+              << ", io_contexts=" << num_ioc
+              << ", cpu_affinity=" << (config.io_cpu_affinity ? "on" : "off")
+              << ", permessage_deflate=" << (deflate.enable ? "on" : "off") << ")");
 
-    // WebSocket 在独立线程运行
+    // WebSocket 在独立线程池运行
     std::atomic<bool> running{true};
-    std::thread ws_thread([&ioc, &running]() {
-        while (running) {
-            ioc.run();
-            break;
-        }
-    });
+    std::vector<std::thread> io_thread_pool;
+    for (int i = 0; i < io_threads; ++i) {
+        boost::asio::io_context& ioc = *io_contexts[per_thread_ioc ? i : 0];
+        io_thread_pool.emplace_back([&ioc]() { ioc.run(); });
+        if (config.io_cpu_affinity)
+            PinThreadToCpu(io_thread_pool.back(), i);
+    }
 
-    // 心跳：① 客户端超时检测 CheckHeartbeat；② 向 ZoneSvr 上报 Gate 存活 GateHeartbeat（建议每 30s）
+    // 向 ZoneSvr 上报 Gate 存活 GateHeartbeat（建议每 30s）；客户端心跳超时由各 WsListener 的时间轮在 I/O 线程上回收
     // 每次心跳前先尝试 RegisterGate，应对启动时 Zone/Redis 未就绪导致的偶发注册失败
     int heartbeat_interval = config.heartbeat_interval_seconds > 0
         ? config.heartbeat_interval_seconds : 30;
@@ -239,8 +281,9 @@ int main(int argc, char* argv[]) {
             std::this_thread::sleep_for(std::chrono::seconds(heartbeat_interval));
             if (!running) break;
             gate_svc->RegisterGate(register_addr);  // 幂等，偶发失败时每轮重试
-            gate_svc->CheckHeartbeat();
             gate_svc->GateHeartbeat();
+            LogInfo("GateSvr stats: connections=" << gate_svc->GetConnectionCount()
+                    << " " << gate_svc->metrics().Format());
         }
     });
 
@@ -248,10 +291,14 @@ int main(int argc, char* argv[]) {
     grpc_server->Wait();
 
     running = false;
-    ws_listener->Stop();
-    ioc.stop();
-    if (ws_thread.joinable())
-        ws_thread.join();
+    for (auto& listener : ws_listeners)
+        listener->Stop();
+    for (auto& ioc : io_contexts)
+        ioc->stop();
+    for (auto& t : io_thread_pool) {
+        if (t.joinable())
+            t.join();
+    }
     if (heartbeat_thread.joinable())
         heartbeat_thread.join();
 
@@ -13,9 +13,27 @@ GateConfig LoadConfig(const std::string& config_file) {
     c.grpc_port = kv.GetInt("grpc_port", c.grpc_port);
     c.gate_id = kv.Get("gate_id", c.gate_id);
     c.zone_svr_addr = kv.Get("zone_svr_addr", c.zone_svr_addr);
+    c.io_threads = kv.GetInt("io_threads", c.io_threads);
+    c.io_reuse_port = kv.GetBool("io_reuse_port", c.io_reuse_port);
+    c.io_cpu_affinity = kv.GetBool("io_cpu_affinity", c.io_cpu_affinity);
+    c.ws_deflate_enable = kv.GetBool("ws_deflate_enable", c.ws_deflate_enable);
+    c.ws_deflate_server_max_window_bits = kv.GetInt("ws_deflate_server_max_window_bits", c.ws_deflate_server_max_window_bits);
+    c.ws_deflate_client_max_window_bits = kv.GetInt("ws_deflate_client_max_window_bits", c.ws_deflate_client_max_window_bits);
+    c.ws_deflate_server_no_context_takeover = kv.GetBool("ws_deflate_server_no_context_takeover", c.ws_deflate_server_no_context_takeover);
+    c.ws_deflate_client_no_context_takeover = kv.GetBool("ws_deflate_client_no_context_takeover", c.ws_deflate_client_no_context_takeover);
+    c.ws_deflate_level = kv.GetInt("ws_deflate_level", c.ws_deflate_level);
+    c.ws_deflate_mem_level = kv.GetInt("ws_deflate_mem_level", c.ws_deflate_mem_level);
+    c.ws_deflate_min_size = kv.GetInt("ws_deflate_min_size", c.ws_deflate_min_size);
     c.max_connections = kv.GetInt("max_connections", c.max_connections);
     c.heartbeat_interval_seconds = kv.GetInt("heartbeat_interval_seconds", c.heartbeat_interval_seconds);
     c.heartbeat_timeout_seconds = kv.GetInt("heartbeat_timeout_seconds", c.heartbeat_timeout_seconds);
+    c.heartbeat_check_tick_ms = kv.GetInt("heartbeat_check_tick_ms", c.heartbeat_check_tick_ms);
+    c.max_inflight_per_conn = kv.GetInt("max_inflight_per_conn", c.max_inflight_per_conn);
+    c.ws_send_high_water_bytes = kv.GetInt("ws_send_high_water_bytes", c.ws_send_high_water_bytes);
+    c.ws_send_low_water_bytes = kv.GetInt("ws_send_low_water_bytes", c.ws_send_low_water_bytes);
+    c.ws_send_high_water_frames = kv.GetInt("ws_send_high_water_frames", c.ws_send_high_water_frames);
+    c.ws_send_low_water_frames = kv.GetInt("ws_send_low_water_frames", c.ws_send_low_water_frames);
+    c.ws_slow_consumer_policy = kv.Get("ws_slow_consumer_policy", c.ws_slow_consumer_policy);
     c.log_dir = kv.Get("log_dir", c.log_dir);
     c.log_level = kv.Get("log_level", c.log_level);
     // zonesvr_internal_secret：环境变量 GATESVR_ZONESVR_INTERNAL_SECRET 覆盖（ApplyEnvOverrides 已将 GATESVR_ZONESVR_INTERNAL_SECRET -> zonesvr_internal_secret）
@@ -20,10 +20,38 @@ struct GateConfig {
     // 调用 ZoneSvr 时携带的内网密钥，与 ZoneSvr ZONESVR_INTERNAL_SECRET 一致；建议仅从环境变量 GATESVR_ZONESVR_INTERNAL_SECRET 注入
     std::string zonesvr_internal_secret;
     
+    // WebSocket I/O 线程数；0 表示按 CPU 核数
+    int io_threads = 1;
+    // true 且 io_threads>1 时每线程独立 io_context + SO_REUSEPORT 监听器；否则多线程共享一个 io_context
+    bool io_reuse_port = false;
+    // I/O 线程按序号绑定 CPU 核（Linux）
+    bool io_cpu_affinity = false;
+
+    // WebSocket permessage-deflate（RFC 7692）：仅当客户端在握手中提出时才启用
+    bool ws_deflate_enable = false;
+    int ws_deflate_server_max_window_bits = 15;  // 9..15，越小每连接压缩内存越省
+    int ws_deflate_client_max_window_bits = 15;
+    bool ws_deflate_server_no_context_takeover = false;  // true：每条消息独立压缩，省内存但压缩率下降
+    bool ws_deflate_client_no_context_takeover = false;
+    int ws_deflate_level = 6;       // 0..9
+    int ws_deflate_mem_level = 4;   // 1..9
+    int ws_deflate_min_size = 256;  // 小于该字节数的消息不压缩（需 Boost >= 1.81）
+
     // 连接配置
     int max_connections = 10000;
     int heartbeat_interval_seconds = 30;
     int heartbeat_timeout_seconds = 90;
+    // 心跳超时时间轮的 tick（毫秒）：超时判定精度，各 I/O 线程按此周期推进时间轮
+    int heartbeat_check_tick_ms = 1000;
+    // 单连接同时转发到 ZoneSvr 未返回的请求上限，超出直接回 RATE_LIMITED；<=0 表示不限制
+    int max_inflight_per_conn = 64;
+    // 单连接下行积压水位（字节 / 帧）：超过高水位视为慢消费者，回落到低水位以下恢复；0 表示不限制该项
+    int ws_send_high_water_bytes = 4 * 1024 * 1024;
+    int ws_send_low_water_bytes = 1024 * 1024;
+    int ws_send_high_water_frames = 4096;
+    int ws_send_low_water_frames = 1024;
+    // 慢消费者策略：drop（丢弃低优先级推送）| coalesce（按 key 合并低优先级推送）| kick（system.kicked 后断开）
+    std::string ws_slow_consumer_policy = "drop";
     
     std::string log_dir = "/data/logs";
     std::string log_level = "INFO";
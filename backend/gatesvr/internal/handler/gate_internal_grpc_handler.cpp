@@ -7,6 +7,7 @@
 #include "service/gate_service.h"
 #include "swift/error_code.h"
 #include <string>
+#include <vector>
 
 namespace swift::gate {
 
@@ -32,6 +33,24 @@ GateInternalGrpcHandler::~GateInternalGrpcHandler() = default;
     return ::grpc::Status::OK;
 }
 
+::grpc::Status GateInternalGrpcHandler::BatchPushMessage(::grpc::ServerContext* context,
+                                                         const ::swift::gate::BatchPushMessageRequest* request,
+                                                         ::swift::gate::BatchPushMessageResponse* response) {
+    (void)context;
+    if (!request || !response)
+        return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response");
+    std::vector<std::string> user_ids(request->user_ids().begin(), request->user_ids().end());
+    std::vector<std::string> offline;
+    int delivered = service_->PushToUsers(user_ids,
+                                          request->cmd().empty() ? "message" : request->cmd(),
+                                          request->payload(), &offline);
+    response->set_code(swift::ErrorCodeToInt(swift::ErrorCode::OK));
+    response->set_delivered_count(delivered);
+    for (auto& u : offline)
+        response->add_offline_user_ids(std::move(u));
+    return ::grpc::Status::OK;
+}
+
 ::grpc::Status GateInternalGrpcHandler::DisconnectUser(::grpc::ServerContext* context,
                                                        const ::swift::gate::DisconnectUserRequest* request,
                                                        ::swift::common::CommonResponse* response) {
@@ -39,9 +58,9 @@ GateInternalGrpcHandler::~GateInternalGrpcHandler() = default;
     if (!request || !response)
         return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response");
     std::string user_id = request->user_id();
-    std::string conn_id = service_->GetConnIdByUser(user_id);
-    if (!conn_id.empty())
-        service_->CloseConnection(conn_id);
+    ConnHandle handle = service_->GetConnByUser(user_id);
+    if (handle != kInvalidConnHandle)
+        service_->CloseConnection(handle);
     response->set_code(swift::ErrorCodeToInt(swift::ErrorCode::OK));
     return ::grpc::Status::OK;
 }
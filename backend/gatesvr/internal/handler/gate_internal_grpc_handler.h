@@ -8,7 +8,7 @@ namespace swift::gate {
 class GateService;
 
 /**
- * GateInternalService gRPC 实现：ZoneSvr 调用 PushMessage/DisconnectUser。
+ * GateInternalService gRPC 实现：ZoneSvr 调用 PushMessage/BatchPushMessage/DisconnectUser。
  */
 class GateInternalGrpcHandler : public swift::gate::GateInternalService::Service {
 public:
@@ -19,6 +19,10 @@ public:
                                const ::swift::gate::PushMessageRequest* request,
                                ::swift::common::CommonResponse* response) override;
 
+    ::grpc::Status BatchPushMessage(::grpc::ServerContext* context,
+                                    const ::swift::gate::BatchPushMessageRequest* request,
+                                    ::swift::gate::BatchPushMessageResponse* response) override;
+
     ::grpc::Status DisconnectUser(::grpc::ServerContext* context,
                                   const ::swift::gate::DisconnectUserRequest* request,
                                   ::swift::common::CommonResponse* response) override;
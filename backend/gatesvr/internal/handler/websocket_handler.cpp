@@ -9,27 +9,29 @@ WebSocketHandler::WebSocketHandler(std::shared_ptr<GateService> service)
 
 WebSocketHandler::~WebSocketHandler() = default;
 
-void WebSocketHandler::OnConnect(const std::string& conn_id) {
-    (void)conn_id;
+void WebSocketHandler::OnConnect(ConnHandle handle) {
+    (void)handle;
 }
 
-void WebSocketHandler::OnMessage(const std::string& conn_id, const std::string& data) {
+void WebSocketHandler::OnMessage(ConnHandle handle, const std::string& data) {
     swift::gate::ClientMessage msg;
     if (!msg.ParseFromString(data)) {
         return;  // 解析失败，忽略
     }
-    std::string cmd = msg.cmd();
+    // 新客户端只填 cmd_id，老客户端只填 cmd：两边互相补齐，回包和转发 Zone 时都带上
+    swift::CmdId cmd_id = swift::ResolveCmd(msg.cmd_id(), msg.cmd());
+    std::string cmd = msg.cmd().empty() ? std::string(swift::CmdName(cmd_id)) : msg.cmd();
     std::string payload = msg.payload();
     std::string request_id = msg.request_id();
-    service_->HandleClientMessage(conn_id, cmd, payload, request_id);
+    service_->HandleClientMessage(handle, cmd_id, cmd, payload, request_id);
 }
 
-void WebSocketHandler::OnDisconnect(const std::string& conn_id) {
-    (void)conn_id;
+void WebSocketHandler::OnDisconnect(ConnHandle handle) {
+    (void)handle;
 }
 
-bool WebSocketHandler::SendToClient(const std::string& conn_id, const std::string& data) {
-    return service_->SendToConn(conn_id, data);
+bool WebSocketHandler::SendToClient(ConnHandle handle, const std::string& data) {
+    return service_->SendToConn(handle, data);
 }
 
 GateInternalHandler::GateInternalHandler(std::shared_ptr<GateService> service)
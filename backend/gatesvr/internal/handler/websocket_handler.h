@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include "service/connection_registry.h"
 
 namespace swift::gate {
 
@@ -17,16 +18,16 @@ public:
     ~WebSocketHandler();
     
     // 新连接建立
-    void OnConnect(const std::string& conn_id);
+    void OnConnect(ConnHandle handle);
     
     // 收到客户端消息
-    void OnMessage(const std::string& conn_id, const std::string& data);
+    void OnMessage(ConnHandle handle, const std::string& data);
     
     // 连接断开
-    void OnDisconnect(const std::string& conn_id);
+    void OnDisconnect(ConnHandle handle);
     
     // 发送消息给客户端
-    bool SendToClient(const std::string& conn_id, const std::string& data);
+    bool SendToClient(ConnHandle handle, const std::string& data);
     
 private:
     std::shared_ptr<GateService> service_;
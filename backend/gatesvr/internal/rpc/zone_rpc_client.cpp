@@ -1,6 +1,8 @@
 /**
  * @file zone_rpc_client.cpp
  * @brief ZoneSvr gRPC 客户端：UserOnline、UserOffline、GateRegister、HandleClientRequest
+ * *Async 方法走 gRPC callback API，调用状态由 shared_ptr 持有至回调结束。
+ * UserOnlineAsync/UserOfflineAsync 按 user_id 排队，同一用户同时只有一个在途 RPC，保证到达 Zone 的顺序。
  * 每次调用在 ClientContext 上 AddMetadata("x-internal-secret", zonesvr_internal_secret)
  */
 
@@ -36,14 +38,58 @@ static void AddInternalSecret(grpc::ClientContext* ctx,
         ctx->AddMetadata(kMetadataKey, secret);
 }
 
+namespace {
+
+/** 异步单次调用的请求/响应/上下文，需存活到 gRPC 回调执行完 */
+template <typename Req, typename Resp>
+struct AsyncCall {
+    grpc::ClientContext ctx;
+    Req req;
+    Resp resp;
+};
+
+void BuildHandleClientRequest(const std::string& conn_id, const std::string& user_id,
+                              swift::CmdId cmd_id, const std::string& cmd, const std::string& payload,
+                              const std::string& request_id, const std::string& token,
+                              swift::zone::HandleClientRequestRequest* req) {
+    req->set_conn_id(conn_id);
+    req->set_user_id(user_id);
+    req->set_cmd(cmd);
+    req->set_cmd_id(static_cast<uint32_t>(cmd_id));
+    req->set_payload(payload);
+    req->set_request_id(request_id);
+    if (!token.empty()) req->set_token(token);
+}
+
+bool FillHandleClientRequestResult(const grpc::Status& status,
+                                   const swift::zone::HandleClientRequestResponse& resp,
+                                   const std::string& request_id,
+                                   HandleClientRequestResult* result) {
+    if (!status.ok()) {
+        result->code = -1;
+        result->message = status.error_message();
+        result->request_id = request_id;
+        return false;
+    }
+    result->code = resp.code();
+    result->message = resp.message();
+    result->payload = resp.payload();
+    result->request_id = resp.request_id();
+    return true;
+}
+
+}  // namespace
+
 bool ZoneRpcClient::UserOnline(const std::string& user_id,
                                const std::string& gate_id,
+                               const std::string& conn_id,
                                const std::string& device_type,
                                const std::string& device_id) {
     if (!stub_) return false;
     swift::zone::UserOnlineRequest req;
     req.set_user_id(user_id);
     req.set_gate_id(gate_id);
+    req.set_conn_id(conn_id);
     req.set_device_type(device_type);
     req.set_device_id(device_id);
     swift::common::CommonResponse resp;
@@ -55,11 +101,13 @@ bool ZoneRpcClient::UserOnline(const std::string& user_id,
 }
 
 bool ZoneRpcClient::UserOffline(const std::string& user_id,
-                                const std::string& gate_id) {
+                                const std::string& gate_id,
+                                const std::string& conn_id) {
     if (!stub_) return false;
     swift::zone::UserOfflineRequest req;
     req.set_user_id(user_id);
     req.set_gate_id(gate_id);
+    req.set_conn_id(conn_id);
     swift::common::CommonResponse resp;
     grpc::ClientContext ctx;
     ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
@@ -68,6 +116,91 @@ bool ZoneRpcClient::UserOffline(const std::string& user_id,
     return status.ok() && resp.code() == 0;
 }
 
+void ZoneRpcClient::UserOnlineAsync(const std::string& user_id,
+                                    const std::string& gate_id,
+                                    const std::string& conn_id,
+                                    const std::string& device_type,
+                                    const std::string& device_id) {
+    if (!stub_) return;
+    using Call = AsyncCall<swift::zone::UserOnlineRequest, swift::common::CommonResponse>;
+    auto call = std::make_shared<Call>();
+    call->req.set_user_id(user_id);
+    call->req.set_gate_id(gate_id);
+    call->req.set_conn_id(conn_id);
+    call->req.set_device_type(device_type);
+    call->req.set_device_id(device_id);
+    EnqueuePresence(user_id, [this, call](std::function<void()> done) {
+        // deadline 从真正发出时算起，排队等待前一个 RPC 的时间不占用本次超时
+        call->ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+        AddInternalSecret(&call->ctx, zonesvr_internal_secret_);
+        stub_->async()->UserOnline(&call->ctx, &call->req, &call->resp,
+            [call, done = std::move(done)](grpc::Status status) {
+                if (!status.ok() || call->resp.code() != 0) {
+                    LogWarning(TAG("service", "gatesvr"), "UserOnline async failed: user_id=" << call->req.user_id()
+                               << ", conn_id=" << call->req.conn_id()
+                               << ", grpc_code=" << static_cast<int>(status.error_code())
+                               << ", code=" << call->resp.code());
+                }
+                done();
+            });
+    });
+}
+
+void ZoneRpcClient::UserOfflineAsync(const std::string& user_id,
+                                     const std::string& gate_id,
+                                     const std::string& conn_id) {
+    if (!stub_) return;
+    using Call = AsyncCall<swift::zone::UserOfflineRequest, swift::common::CommonResponse>;
+    auto call = std::make_shared<Call>();
+    call->req.set_user_id(user_id);
+    call->req.set_gate_id(gate_id);
+    call->req.set_conn_id(conn_id);
+    EnqueuePresence(user_id, [this, call](std::function<void()> done) {
+        call->ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+        AddInternalSecret(&call->ctx, zonesvr_internal_secret_);
+        stub_->async()->UserOffline(&call->ctx, &call->req, &call->resp,
+            [call, done = std::move(done)](grpc::Status status) {
+                if (!status.ok() || call->resp.code() != 0) {
+                    LogWarning(TAG("service", "gatesvr"), "UserOffline async failed: user_id=" << call->req.user_id()
+                               << ", conn_id=" << call->req.conn_id()
+                               << ", grpc_code=" << static_cast<int>(status.error_code())
+                               << ", code=" << call->resp.code());
+                }
+                done();
+            });
+    });
+}
+
+void ZoneRpcClient::EnqueuePresence(const std::string& user_id, PresenceCall call) {
+    PresenceCall first;
+    {
+        std::lock_guard<std::mutex> lock(presence_mutex_);
+        auto& queue = presence_queues_[user_id];
+        queue.push_back(std::move(call));
+        if (queue.size() > 1)
+            return;  // 前一个仍在途，完成后由 OnPresenceDone 发出
+        first = queue.front();
+    }
+    first([this, user_id] { OnPresenceDone(user_id); });
+}
+
+void ZoneRpcClient::OnPresenceDone(const std::string& user_id) {
+    PresenceCall next;
+    {
+        std::lock_guard<std::mutex> lock(presence_mutex_);
+        auto it = presence_queues_.find(user_id);
+        if (it == presence_queues_.end())
+            return;
+        it->second.pop_front();
+        if (it->second.empty()) {
+            presence_queues_.erase(it);
+            return;
+        }
+        next = it->second.front();
+    }
+    next([this, user_id] { OnPresenceDone(user_id); });
+}
+
 bool ZoneRpcClient::GateRegister(const std::string& gate_id,
                                 const std::string& address,
                                 int current_connections) {
@@ -117,6 +250,7 @@ bool ZoneRpcClient::GateHeartbeat(const std::string& gate_id,
 
 bool ZoneRpcClient::HandleClientRequest(const std::string& conn_id,
                                         const std::string& user_id,
+                                        swift::CmdId cmd_id,
                                         const std::string& cmd,
                                         const std::string& payload,
                                         const std::string& request_id,
@@ -124,28 +258,42 @@ bool ZoneRpcClient::HandleClientRequest(const std::string& conn_id,
                                         HandleClientRequestResult* result) {
     if (!stub_ || !result) return false;
     swift::zone::HandleClientRequestRequest req;
-    req.set_conn_id(conn_id);
-    req.set_user_id(user_id);
-    req.set_cmd(cmd);
-    req.set_payload(payload);
-    req.set_request_id(request_id);
-    if (!token.empty()) req.set_token(token);
+    BuildHandleClientRequest(conn_id, user_id, cmd_id, cmd, payload, request_id, token, &req);
     swift::zone::HandleClientRequestResponse resp;
     grpc::ClientContext ctx;
     ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
     AddInternalSecret(&ctx, zonesvr_internal_secret_);
     grpc::Status status = stub_->HandleClientRequest(&ctx, req, &resp);
-    if (!status.ok()) {
-        result->code = -1;
-        result->message = status.error_message();
-        result->request_id = request_id;
-        return false;
+    return FillHandleClientRequestResult(status, resp, request_id, result);
+}
+
+void ZoneRpcClient::HandleClientRequestAsync(const std::string& conn_id,
+                                             const std::string& user_id,
+                                             swift::CmdId cmd_id,
+                                             const std::string& cmd,
+                                             const std::string& payload,
+                                             const std::string& request_id,
+                                             const std::string& token,
+                                             HandleClientRequestCallback done) {
+    if (!stub_) {
+        HandleClientRequestResult result;
+        result.code = -1;
+        result.request_id = request_id;
+        if (done) done(false, result);
+        return;
     }
-    result->code = resp.code();
-    result->message = resp.message();
-    result->payload = resp.payload();
-    result->request_id = resp.request_id();
-    return true;
+    using Call = AsyncCall<swift::zone::HandleClientRequestRequest,
+                           swift::zone::HandleClientRequestResponse>;
+    auto call = std::make_shared<Call>();
+    BuildHandleClientRequest(conn_id, user_id, cmd_id, cmd, payload, request_id, token, &call->req);
+    call->ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+    AddInternalSecret(&call->ctx, zonesvr_internal_secret_);
+    stub_->async()->HandleClientRequest(&call->ctx, &call->req, &call->resp,
+        [call, done = std::move(done)](grpc::Status status) {
+            HandleClientRequestResult result;
+            bool ok = FillHandleClientRequestResult(status, call->resp, call->req.request_id(), &result);
+            if (done) done(ok, result);
+        });
 }
 
 }  // namespace swift::gate
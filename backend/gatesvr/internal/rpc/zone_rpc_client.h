@@ -1,8 +1,13 @@
 #pragma once
 
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <grpcpp/grpcpp.h>
+#include "swift/cmd_id.h"
 #include "zone.grpc.pb.h"
 
 namespace swift::gate {
@@ -15,6 +20,12 @@ struct HandleClientRequestResult {
     std::string request_id;
 };
 
+/**
+ * 异步 HandleClientRequest 完成回调：在 gRPC 回调线程执行，ok=false 表示 RPC 层失败（result.code=-1）。
+ * 回调内不得做阻塞调用，需要写回客户端时经 SendToConn 投递到 Session 的 strand。
+ */
+using HandleClientRequestCallback = std::function<void(bool ok, const HandleClientRequestResult& result)>;
+
 /**
  * ZoneSvr gRPC 客户端
  * 每次调用在 ClientContext 上 AddMetadata("x-internal-secret", zonesvr_internal_secret)
@@ -27,12 +38,22 @@ public:
     void Init(const std::string& zone_svr_addr,
               const std::string& zonesvr_internal_secret);
 
-    /** 用户上线 */
-    bool UserOnline(const std::string& user_id, const std::string& gate_id,
+    /** 用户上线；conn_id 为网关侧连接 ID，下线时 Zone 据此判断会话归属 */
+    bool UserOnline(const std::string& user_id, const std::string& gate_id, const std::string& conn_id,
                     const std::string& device_type, const std::string& device_id);
 
     /** 用户下线 */
-    bool UserOffline(const std::string& user_id, const std::string& gate_id);
+    bool UserOffline(const std::string& user_id, const std::string& gate_id, const std::string& conn_id);
+
+    /**
+     * 用户上线（异步，不等待结果，失败仅打日志；供 I/O 线程与 RPC 回调线程使用）。
+     * 同一用户的上线/下线按调用顺序串行发出：前一个 RPC 完成后才发下一个，Zone 不会先收到后发的下线。
+     */
+    void UserOnlineAsync(const std::string& user_id, const std::string& gate_id, const std::string& conn_id,
+                         const std::string& device_type, const std::string& device_id);
+
+    /** 用户下线（异步，不等待结果，失败仅打日志；与 UserOnlineAsync 同队列串行） */
+    void UserOfflineAsync(const std::string& user_id, const std::string& gate_id, const std::string& conn_id);
 
     /** Gate 注册（启动时调用） */
     bool GateRegister(const std::string& gate_id, const std::string& address,
@@ -43,14 +64,34 @@ public:
 
     /** 客户端业务请求统一入口：转发到 Zone，返回 (code, message, payload, request_id)；token 为已登录连接的 JWT，供 Zone 调业务服务时注入 */
     bool HandleClientRequest(const std::string& conn_id, const std::string& user_id,
-                            const std::string& cmd, const std::string& payload,
+                            swift::CmdId cmd_id, const std::string& cmd, const std::string& payload,
                             const std::string& request_id, const std::string& token,
                             HandleClientRequestResult* result);
 
+    /**
+     * HandleClientRequest 的非阻塞版本（gRPC callback API）：立即返回，完成后调用 done。
+     * 供 WebSocket I/O 线程转发使用，避免一个慢请求阻塞同线程上所有连接的读取。
+     */
+    void HandleClientRequestAsync(const std::string& conn_id, const std::string& user_id,
+                                  swift::CmdId cmd_id, const std::string& cmd, const std::string& payload,
+                                  const std::string& request_id, const std::string& token,
+                                  HandleClientRequestCallback done);
+
 private:
+    /** 一次上线/下线 RPC：发出调用，完成时（无论成败）调用 done */
+    using PresenceCall = std::function<void(std::function<void()> done)>;
+
+    /** 入该用户的上线/下线队列；队列原本为空则立即发出 */
+    void EnqueuePresence(const std::string& user_id, PresenceCall call);
+    /** 队首 RPC 完成：出队并发出下一个，队列空则删除 */
+    void OnPresenceDone(const std::string& user_id);
+
     std::shared_ptr<grpc::Channel> channel_;
     std::unique_ptr<swift::zone::ZoneService::Stub> stub_;
     std::string zonesvr_internal_secret_;
+
+    std::mutex presence_mutex_;
+    std::unordered_map<std::string, std::deque<PresenceCall>> presence_queues_;  // user_id -> 待发（队首为在途）
 };
 
 }  // namespace swift::gate
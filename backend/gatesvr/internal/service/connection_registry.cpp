@@ -0,0 +1,267 @@
+#include "connection_registry.h"
+#include <cerrno>
+#include <cstdlib>
+
+namespace swift::gate {
+
+namespace {
+
+constexpr char kConnIdPrefix[] = "conn_";
+
+uint32_t HandleIndex(ConnHandle handle) { return static_cast<uint32_t>(handle & 0xffffffffu); }
+uint32_t HandleGeneration(ConnHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+ConnHandle MakeHandle(uint32_t generation, uint32_t index) {
+    return (static_cast<ConnHandle>(generation) << 32) | index;
+}
+
+}  // namespace
+
+std::string ConnHandleToString(ConnHandle handle) {
+    return kConnIdPrefix + std::to_string(handle);
+}
+
+ConnHandle ParseConnHandle(const std::string& conn_id) {
+    const size_t prefix_len = sizeof(kConnIdPrefix) - 1;
+    if (conn_id.size() <= prefix_len || conn_id.compare(0, prefix_len, kConnIdPrefix) != 0)
+        return kInvalidConnHandle;
+    // strtoull 会跳过前导空白并接受正负号（"conn_-1" 会回绕成合法句柄），要求首字符即为数字
+    const char* digits = conn_id.c_str() + prefix_len;
+    if (*digits < '0' || *digits > '9') return kInvalidConnHandle;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long v = std::strtoull(digits, &end, 10);
+    if (errno == ERANGE || !end || *end != '\0') return kInvalidConnHandle;
+    return static_cast<ConnHandle>(v);
+}
+
+// ---------------------------------------------------------------------------
+// ConnSession
+// ---------------------------------------------------------------------------
+
+ConnSession::ConnSession(ConnHandle handle, int64_t now_ms)
+    : handle_(handle)
+    , connected_at_(now_ms)
+    , last_heartbeat_(now_ms) {}
+
+bool ConnSession::TryAcquireInflight(int limit) {
+    int cur = inflight_.load(std::memory_order_relaxed);
+    do {
+        if (limit > 0 && cur >= limit) return false;
+    } while (!inflight_.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed));
+    return true;
+}
+
+void ConnSession::ReleaseInflight() {
+    int cur = inflight_.load(std::memory_order_relaxed);
+    while (cur > 0 && !inflight_.compare_exchange_weak(cur, cur - 1, std::memory_order_relaxed)) {
+    }
+}
+
+std::string ConnSession::user_id() const {
+    std::lock_guard lock(mutex_);
+    return user_id_;
+}
+
+Connection ConnSession::Snapshot() const {
+    Connection c;
+    c.handle = handle_;
+    c.conn_id = conn_id();
+    c.connected_at = connected_at_;
+    c.last_heartbeat = last_heartbeat();
+    c.inflight = inflight_.load(std::memory_order_relaxed);
+    std::lock_guard lock(mutex_);
+    c.user_id = user_id_;
+    c.token = token_;
+    c.device_id = device_id_;
+    c.device_type = device_type_;
+    c.authenticated = authenticated_;
+    return c;
+}
+
+void ConnSession::SetSendCallback(SendCallback fn) {
+    auto cb = std::make_shared<const SendCallback>(std::move(fn));
+    std::lock_guard lock(mutex_);
+    send_cb_ = std::move(cb);
+}
+
+void ConnSession::ClearSendCallback() {
+    std::lock_guard lock(mutex_);
+    send_cb_.reset();
+}
+
+bool ConnSession::Send(const OutFrame& frame) const {
+    std::shared_ptr<const SendCallback> cb;
+    {
+        std::lock_guard lock(mutex_);
+        cb = send_cb_;
+    }
+    return cb && *cb && (*cb)(frame);
+}
+
+void ConnSession::SetCloseCallback(CloseCallback fn) {
+    auto cb = std::make_shared<const CloseCallback>(std::move(fn));
+    std::lock_guard lock(mutex_);
+    close_cb_ = std::move(cb);
+}
+
+void ConnSession::ClearCloseCallback() {
+    std::lock_guard lock(mutex_);
+    close_cb_.reset();
+}
+
+void ConnSession::Close() const {
+    std::shared_ptr<const CloseCallback> cb;
+    {
+        std::lock_guard lock(mutex_);
+        cb = close_cb_;
+    }
+    if (cb && *cb) (*cb)();
+}
+
+// ---------------------------------------------------------------------------
+// ConnectionRegistry
+// ---------------------------------------------------------------------------
+
+ConnectionRegistry::ConnectionRegistry() {
+    for (auto& c : chunks_)
+        c.store(nullptr, std::memory_order_relaxed);
+}
+
+ConnectionRegistry::~ConnectionRegistry() {
+    for (auto& c : chunks_)
+        delete c.load(std::memory_order_relaxed);
+}
+
+ConnectionRegistry::Slot* ConnectionRegistry::SlotOf(ConnHandle handle) const {
+    uint32_t index = HandleIndex(handle);
+    uint32_t chunk_idx = index / kSlotsPerChunk;
+    if (chunk_idx >= kMaxChunks) return nullptr;
+    Chunk* chunk = chunks_[chunk_idx].load(std::memory_order_acquire);
+    return chunk ? &chunk->slots[index % kSlotsPerChunk] : nullptr;
+}
+
+ConnectionRegistry::Shard& ConnectionRegistry::UserShard(const std::string& user_id) const {
+    return user_shards_[std::hash<std::string>{}(user_id) % kShardCount];
+}
+
+std::shared_ptr<ConnSession> ConnectionRegistry::Add(int64_t now_ms) {
+    uint32_t index;
+    {
+        std::lock_guard lock(alloc_mutex_);
+        if (!free_list_.empty()) {
+            index = free_list_.back();
+            free_list_.pop_back();
+        } else {
+            index = next_index_.load(std::memory_order_relaxed);
+            uint32_t chunk_idx = index / kSlotsPerChunk;
+            if (chunk_idx >= kMaxChunks) return nullptr;
+            if (index % kSlotsPerChunk == 0)
+                chunks_[chunk_idx].store(new Chunk(), std::memory_order_release);
+            next_index_.store(index + 1, std::memory_order_release);
+        }
+    }
+    Slot* slot = SlotOf(index);
+    std::lock_guard lock(slot->mutex);
+    auto session = std::make_shared<ConnSession>(MakeHandle(slot->generation, index), now_ms);
+    slot->session = session;
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return session;
+}
+
+std::shared_ptr<ConnSession> ConnectionRegistry::Remove(ConnHandle handle) {
+    Slot* slot = SlotOf(handle);
+    if (!slot) return nullptr;
+    std::shared_ptr<ConnSession> session;
+    {
+        std::lock_guard lock(slot->mutex);
+        if (slot->generation != HandleGeneration(handle) || !slot->session) return nullptr;
+        session = std::move(slot->session);
+        slot->session.reset();
+        // 代数递增使旧句柄失效；回绕时跳过 0，保证句柄非 0
+        if (++slot->generation == 0) slot->generation = 1;
+    }
+    {
+        std::lock_guard lock(alloc_mutex_);
+        free_list_.push_back(HandleIndex(handle));
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard lock(session->mutex_);
+    session->removed_ = true;
+    if (!session->user_id_.empty())
+        EraseUserIndexLocked(session->user_id_, session.get());
+    return session;
+}
+
+std::shared_ptr<ConnSession> ConnectionRegistry::Find(ConnHandle handle) const {
+    Slot* slot = SlotOf(handle);
+    if (!slot) return nullptr;
+    std::lock_guard lock(slot->mutex);
+    if (slot->generation != HandleGeneration(handle)) return nullptr;
+    return slot->session;
+}
+
+std::shared_ptr<ConnSession> ConnectionRegistry::FindByUser(const std::string& user_id) const {
+    Shard& shard = UserShard(user_id);
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.map.find(user_id);
+    return it != shard.map.end() ? it->second : nullptr;
+}
+
+bool ConnectionRegistry::BindUser(ConnHandle handle, const std::string& user_id,
+                                  const std::string& token, const std::string& device_id,
+                                  const std::string& device_type) {
+    std::shared_ptr<ConnSession> session = Find(handle);
+    if (!session) return false;
+    std::lock_guard lock(session->mutex_);
+    if (session->removed_) return false;
+    if (!session->user_id_.empty() && session->user_id_ != user_id)
+        EraseUserIndexLocked(session->user_id_, session.get());
+    session->user_id_ = user_id;
+    session->token_ = token;
+    session->device_id_ = device_id;
+    session->device_type_ = device_type;
+    session->authenticated_ = true;
+    Shard& shard = UserShard(user_id);
+    std::unique_lock ulock(shard.mutex);
+    shard.map[user_id] = session;
+    return true;
+}
+
+void ConnectionRegistry::UnbindUser(const std::string& user_id) {
+    std::shared_ptr<ConnSession> session = FindByUser(user_id);
+    if (!session) return;
+    std::lock_guard lock(session->mutex_);
+    if (session->user_id_ != user_id) return;
+    EraseUserIndexLocked(user_id, session.get());
+    session->user_id_.clear();
+    session->token_.clear();
+    session->device_id_.clear();
+    session->device_type_.clear();
+    session->authenticated_ = false;
+}
+
+void ConnectionRegistry::EraseUserIndexLocked(const std::string& user_id, const ConnSession* session) {
+    Shard& shard = UserShard(user_id);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.map.find(user_id);
+    // 仅当索引仍指向本会话时删除，避免误删同一用户在新连接上的映射
+    if (it != shard.map.end() && it->second.get() == session)
+        shard.map.erase(it);
+}
+
+void ConnectionRegistry::ForEach(
+    const std::function<void(const std::shared_ptr<ConnSession>&)>& fn) const {
+    uint32_t used = next_index_.load(std::memory_order_acquire);
+    for (uint32_t index = 0; index < used; ++index) {
+        Slot* slot = SlotOf(index);
+        if (!slot) continue;
+        std::shared_ptr<ConnSession> session;
+        {
+            std::lock_guard lock(slot->mutex);
+            session = slot->session;
+        }
+        if (session) fn(session);
+    }
+}
+
+}  // namespace swift::gate
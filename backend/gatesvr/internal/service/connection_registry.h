@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace swift::gate {
+
+/**
+ * 连接句柄：高 32 位为槽位代数（generation，从 1 开始），低 32 位为 slab 槽位下标。
+ * 槽位复用时代数递增，旧句柄自动失效（防 ABA）；0 为无效句柄。
+ * 字符串形式（conn_id）仅在 RPC 边界使用，见 ConnHandleToString / ParseConnHandle。
+ */
+using ConnHandle = uint64_t;
+constexpr ConnHandle kInvalidConnHandle = 0;
+
+/** 句柄转 conn_id 字符串，格式 "conn_<十进制句柄>" */
+std::string ConnHandleToString(ConnHandle handle);
+/** 解析 conn_id 字符串，失败返回 kInvalidConnHandle */
+ConnHandle ParseConnHandle(const std::string& conn_id);
+
+/**
+ * 待发送的一帧（序列化好的 ServerMessage），不可变、引用计数共享：
+ * 推送给多个连接时只序列化一次，各连接写队列持有同一份缓冲直到写完。
+ */
+using Frame = std::shared_ptr<const std::string>;
+inline Frame MakeFrame(std::string data) {
+    return std::make_shared<const std::string>(std::move(data));
+}
+
+/**
+ * 带发送属性的帧。连接积压（慢消费者）时：low_priority 帧可被丢弃，
+ * 或按 coalesce_key 只保留最新一帧（如同一用户的在线状态、同一会话的已读回执）。
+ */
+struct OutFrame {
+    OutFrame(Frame d, bool low = false, std::string key = {})
+        : data(std::move(d)), low_priority(low), coalesce_key(std::move(key)) {}
+
+    Frame data;
+    bool low_priority = false;
+    std::string coalesce_key;
+};
+
+/** 慢消费者策略：积压超过高水位后对低优先级推送的处理方式 */
+enum class SlowConsumerPolicy {
+    kDrop,      // 丢弃低优先级推送
+    kCoalesce,  // 低优先级推送按 coalesce_key 合并，无 key 的照常入队
+    kKick,      // 发送 system.kicked 后断开
+};
+
+/** 单连接下行队列水位；各项 <=0 表示不按该项限制 */
+struct SendQueueLimits {
+    int64_t high_water_bytes = 4 * 1024 * 1024;
+    int64_t low_water_bytes = 1024 * 1024;
+    int64_t high_water_frames = 4096;
+    int64_t low_water_frames = 1024;
+    SlowConsumerPolicy policy = SlowConsumerPolicy::kDrop;
+};
+
+/** 发送回调：Session 注册，供 PushToUser/SendToConn 调用 */
+using SendCallback = std::function<bool(const OutFrame&)>;
+/** 关闭连接回调：Session 注册，供心跳超时踢线时调用 */
+using CloseCallback = std::function<void()>;
+
+/**
+ * 连接信息快照：conn_id → (user_id, token, device_id, device_type)
+ * 由 ConnSession::Snapshot() 拷贝生成，可在任意线程持有。
+ */
+struct Connection {
+    ConnHandle handle = kInvalidConnHandle;
+    std::string conn_id;       // handle 的字符串形式，仅用于 RPC
+    std::string user_id;       // 登录后才有
+    std::string token;         // 登录时校验通过的 JWT，转发业务请求时带给 Zone 注入业务服务
+    std::string device_id;     // 设备 ID
+    std::string device_type;   // windows, android, ios, web
+    int64_t connected_at = 0;
+    int64_t last_heartbeat = 0;
+    bool authenticated = false;
+    int inflight = 0;          // 已转发到 ZoneSvr、尚未收到响应的请求数
+};
+
+/**
+ * 单个连接的会话对象，由 ConnectionRegistry 以 shared_ptr 持有。
+ * 取出后即使连接被并发移除也可安全访问；心跳、在途计数为原子量，热路径无需加锁。
+ */
+class ConnSession {
+public:
+    ConnSession(ConnHandle handle, int64_t now_ms);
+
+    ConnHandle handle() const { return handle_; }
+    /** RPC 边界使用的字符串形式 */
+    std::string conn_id() const { return ConnHandleToString(handle_); }
+    int64_t connected_at() const { return connected_at_; }
+
+    int64_t last_heartbeat() const { return last_heartbeat_.load(std::memory_order_relaxed); }
+    void TouchHeartbeat(int64_t now_ms) { last_heartbeat_.store(now_ms, std::memory_order_relaxed); }
+
+    /** 占用一个在途名额；limit<=0 不限制 */
+    bool TryAcquireInflight(int limit);
+    void ReleaseInflight();
+
+    std::string user_id() const;
+    /** 拷贝当前连接信息 */
+    Connection Snapshot() const;
+
+    void SetSendCallback(SendCallback fn);
+    void ClearSendCallback();
+    /** 调用发送回调；未注册返回 false */
+    bool Send(const OutFrame& frame) const;
+
+    void SetCloseCallback(CloseCallback fn);
+    void ClearCloseCallback();
+    /** 调用关闭回调；未注册时忽略 */
+    void Close() const;
+
+private:
+    friend class ConnectionRegistry;
+
+    const ConnHandle handle_;
+    const int64_t connected_at_;
+    std::atomic<int64_t> last_heartbeat_;
+    std::atomic<int> inflight_{0};
+
+    // 保护以下字段；加锁顺序：ConnSession::mutex_ → 用户索引分片锁
+    mutable std::mutex mutex_;
+    std::string user_id_;
+    std::string token_;
+    std::string device_id_;
+    std::string device_type_;
+    bool authenticated_ = false;
+    bool removed_ = false;     // 已从注册表移除，不再接受 BindUser
+    std::shared_ptr<const SendCallback> send_cb_;
+    std::shared_ptr<const CloseCallback> close_cb_;
+};
+
+/**
+ * 连接注册表。
+ * - 连接按 ConnHandle 直接索引 slab 槽位（分块分配、块地址不变），查找无哈希、无全局锁，
+ *   仅锁定目标槽位；槽位释放时代数 +1，旧句柄查找返回空。
+ * - user_id 索引按哈希分到 kShardCount 个分片，每片独立读写锁。
+ * 推送、心跳、转发取到 ConnSession 后即在锁外操作。
+ */
+class ConnectionRegistry {
+public:
+    static constexpr size_t kShardCount = 64;
+    static constexpr uint32_t kSlotsPerChunk = 1024;
+    static constexpr uint32_t kMaxChunks = 4096;  // 槽位上限 kSlotsPerChunk * kMaxChunks
+
+    ConnectionRegistry();
+    ~ConnectionRegistry();
+    ConnectionRegistry(const ConnectionRegistry&) = delete;
+    ConnectionRegistry& operator=(const ConnectionRegistry&) = delete;
+
+    /** 分配槽位并新建会话；槽位耗尽返回 nullptr */
+    std::shared_ptr<ConnSession> Add(int64_t now_ms);
+    /** 移除会话（同时清理其用户索引）并回收槽位，返回被移除的会话；句柄失效返回 nullptr */
+    std::shared_ptr<ConnSession> Remove(ConnHandle handle);
+
+    std::shared_ptr<ConnSession> Find(ConnHandle handle) const;
+    std::shared_ptr<ConnSession> FindByUser(const std::string& user_id) const;
+
+    /** 绑定用户；同一 user_id 的旧映射被覆盖。会话不存在或已移除返回 false */
+    bool BindUser(ConnHandle handle, const std::string& user_id,
+                  const std::string& token, const std::string& device_id,
+                  const std::string& device_type);
+    /** 解绑用户并清空该会话的登录信息 */
+    void UnbindUser(const std::string& user_id);
+
+    size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+    /** 逐槽位遍历（持槽位锁），fn 内不得再访问注册表 */
+    void ForEach(const std::function<void(const std::shared_ptr<ConnSession>&)>& fn) const;
+
+private:
+    struct Slot {
+        mutable std::mutex mutex;
+        uint32_t generation = 1;
+        std::shared_ptr<ConnSession> session;
+    };
+    struct Chunk {
+        std::array<Slot, kSlotsPerChunk> slots;
+    };
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<ConnSession>> map;
+    };
+
+    /** 句柄对应的槽位；下标越界或块未分配返回 nullptr（不校验代数） */
+    Slot* SlotOf(ConnHandle handle) const;
+    Shard& UserShard(const std::string& user_id) const;
+    /** 调用方需持有 session->mutex_ */
+    void EraseUserIndexLocked(const std::string& user_id, const ConnSession* session);
+
+    // slab：chunks_[i] 一经发布不再改变，读侧 acquire 读取即可
+    std::array<std::atomic<Chunk*>, kMaxChunks> chunks_;
+    std::atomic<uint32_t> next_index_{0};  // 从未使用过的最小槽位下标
+    std::mutex alloc_mutex_;               // 保护 free_list_ 与块分配
+    std::vector<uint32_t> free_list_;
+
+    mutable std::array<Shard, kShardCount> user_shards_;
+    std::atomic<size_t> size_{0};
+};
+
+}  // namespace swift::gate
@@ -0,0 +1,183 @@
+/**
+ * @file connection_registry_test.cpp
+ * @brief ConnectionRegistry 单元测试（句柄/代数、登记/移除、用户绑定、回调、在途计数、并发）
+ */
+
+#include "connection_registry.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace swift::gate {
+
+class ConnectionRegistryTest : public ::testing::Test {
+protected:
+    ConnectionRegistry registry_;
+};
+
+// 登记、查找、移除
+TEST_F(ConnectionRegistryTest, AddFindRemove) {
+    auto s = registry_.Add(1000);
+    ASSERT_NE(s, nullptr);
+    ConnHandle h = s->handle();
+    EXPECT_NE(h, kInvalidConnHandle);
+    EXPECT_EQ(registry_.Size(), 1u);
+    EXPECT_EQ(registry_.Find(h), s);
+
+    auto removed = registry_.Remove(h);
+    EXPECT_EQ(removed, s);
+    EXPECT_EQ(registry_.Find(h), nullptr);
+    EXPECT_EQ(registry_.Remove(h), nullptr);
+    EXPECT_EQ(registry_.Size(), 0u);
+    EXPECT_EQ(registry_.Find(kInvalidConnHandle), nullptr);
+}
+
+// 槽位复用后旧句柄失效（代数校验防 ABA）
+TEST_F(ConnectionRegistryTest, StaleHandleAfterSlotReuse) {
+    auto s1 = registry_.Add(1000);
+    ConnHandle h1 = s1->handle();
+    registry_.Remove(h1);
+    auto s2 = registry_.Add(2000);
+    ConnHandle h2 = s2->handle();
+    EXPECT_NE(h1, h2);
+    EXPECT_EQ(h1 & 0xffffffffu, h2 & 0xffffffffu);  // 同一槽位
+    EXPECT_EQ(registry_.Find(h1), nullptr);
+    EXPECT_EQ(registry_.Remove(h1), nullptr);
+    EXPECT_EQ(registry_.Find(h2), s2);
+}
+
+// conn_id 字符串与句柄互转
+TEST_F(ConnectionRegistryTest, ConnIdRoundTrip) {
+    auto s = registry_.Add(1000);
+    std::string conn_id = s->conn_id();
+    EXPECT_EQ(ParseConnHandle(conn_id), s->handle());
+    EXPECT_EQ(s->Snapshot().conn_id, conn_id);
+    EXPECT_EQ(ParseConnHandle("conn_"), kInvalidConnHandle);
+    EXPECT_EQ(ParseConnHandle("conn_12x"), kInvalidConnHandle);
+    EXPECT_EQ(ParseConnHandle("conn_ 5"), kInvalidConnHandle);
+    EXPECT_EQ(ParseConnHandle("conn_+5"), kInvalidConnHandle);
+    EXPECT_EQ(ParseConnHandle("conn_-1"), kInvalidConnHandle);
+    EXPECT_EQ(ParseConnHandle("conn_99999999999999999999"), kInvalidConnHandle);  // 超出 64 位
+    EXPECT_EQ(ParseConnHandle("foo_1"), kInvalidConnHandle);
+}
+
+// 跨块分配
+TEST_F(ConnectionRegistryTest, GrowsAcrossChunks) {
+    std::vector<ConnHandle> handles;
+    for (uint32_t i = 0; i < ConnectionRegistry::kSlotsPerChunk * 2 + 3; ++i)
+        handles.push_back(registry_.Add(i)->handle());
+    for (ConnHandle h : handles)
+        ASSERT_NE(registry_.Find(h), nullptr);
+    EXPECT_EQ(registry_.Size(), handles.size());
+}
+
+// 绑定用户、换绑、解绑
+TEST_F(ConnectionRegistryTest, BindAndUnbindUser) {
+    ConnHandle h = registry_.Add(1000)->handle();
+    ASSERT_TRUE(registry_.BindUser(h, "u1", "tok", "d1", "web"));
+    auto s = registry_.FindByUser("u1");
+    ASSERT_NE(s, nullptr);
+    Connection c = s->Snapshot();
+    EXPECT_EQ(c.handle, h);
+    EXPECT_EQ(c.user_id, "u1");
+    EXPECT_EQ(c.token, "tok");
+    EXPECT_EQ(c.device_type, "web");
+    EXPECT_TRUE(c.authenticated);
+
+    // 同一连接换绑用户，旧用户索引被清理
+    ASSERT_TRUE(registry_.BindUser(h, "u2", "tok2", "d1", "web"));
+    EXPECT_EQ(registry_.FindByUser("u1"), nullptr);
+    EXPECT_EQ(registry_.FindByUser("u2"), s);
+
+    registry_.UnbindUser("u2");
+    EXPECT_EQ(registry_.FindByUser("u2"), nullptr);
+    c = s->Snapshot();
+    EXPECT_FALSE(c.authenticated);
+    EXPECT_TRUE(c.user_id.empty());
+    EXPECT_TRUE(c.token.empty());
+    EXPECT_FALSE(registry_.BindUser(h + 1, "u3", "", "", ""));
+}
+
+// 同一用户在新连接登录后，旧连接断开不应删除新映射
+TEST_F(ConnectionRegistryTest, RemoveOldConnectionKeepsNewUserMapping) {
+    ConnHandle h1 = registry_.Add(1000)->handle();
+    ConnHandle h2 = registry_.Add(1000)->handle();
+    ASSERT_TRUE(registry_.BindUser(h1, "u1", "", "", ""));
+    ASSERT_TRUE(registry_.BindUser(h2, "u1", "", "", ""));
+    registry_.Remove(h1);
+    auto s = registry_.FindByUser("u1");
+    ASSERT_NE(s, nullptr);
+    EXPECT_EQ(s->handle(), h2);
+}
+
+// 已移除的会话不能再绑定用户
+TEST_F(ConnectionRegistryTest, BindAfterRemoveFails) {
+    ConnHandle h = registry_.Add(1000)->handle();
+    registry_.Remove(h);
+    EXPECT_FALSE(registry_.BindUser(h, "u1", "", "", ""));
+    EXPECT_EQ(registry_.FindByUser("u1"), nullptr);
+}
+
+// 发送、关闭回调
+TEST_F(ConnectionRegistryTest, SendAndCloseCallbacks) {
+    auto s = registry_.Add(1000);
+    EXPECT_FALSE(s->Send(MakeFrame("x")));
+    Frame got;
+    s->SetSendCallback([&got](const OutFrame& f) { got = f.data; return true; });
+    Frame hello = MakeFrame("hello");
+    EXPECT_TRUE(s->Send(hello));
+    EXPECT_EQ(got, hello);  // 共享同一缓冲，无拷贝
+    EXPECT_EQ(*got, "hello");
+    s->ClearSendCallback();
+    EXPECT_FALSE(s->Send(MakeFrame("again")));
+
+    int closed = 0;
+    s->SetCloseCallback([&closed]() { ++closed; });
+    s->Close();
+    s->ClearCloseCallback();
+    s->Close();
+    EXPECT_EQ(closed, 1);
+}
+
+// 在途计数上限
+TEST_F(ConnectionRegistryTest, InflightLimit) {
+    auto s = registry_.Add(1000);
+    EXPECT_TRUE(s->TryAcquireInflight(2));
+    EXPECT_TRUE(s->TryAcquireInflight(2));
+    EXPECT_FALSE(s->TryAcquireInflight(2));
+    s->ReleaseInflight();
+    EXPECT_TRUE(s->TryAcquireInflight(2));
+    EXPECT_TRUE(s->TryAcquireInflight(0));  // 0 不限制
+    EXPECT_EQ(s->Snapshot().inflight, 3);
+}
+
+// 多线程并发登记/绑定/移除
+TEST_F(ConnectionRegistryTest, ConcurrentAddBindRemove) {
+    const int kThreads = 8;
+    const int kPerThread = 500;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                std::string uid = "u" + std::to_string(t) + "_" + std::to_string(i);
+                ConnHandle h = registry_.Add(i)->handle();
+                registry_.BindUser(h, uid, "", "", "");
+                if (i % 2 == 0) registry_.Remove(h);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(registry_.Size(), static_cast<size_t>(kThreads * kPerThread / 2));
+    size_t visited = 0;
+    registry_.ForEach([&visited](const std::shared_ptr<ConnSession>&) { ++visited; });
+    EXPECT_EQ(visited, registry_.Size());
+    EXPECT_EQ(registry_.FindByUser("u0_0"), nullptr);
+    EXPECT_NE(registry_.FindByUser("u0_1"), nullptr);
+}
+
+}  // namespace swift::gate
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,32 @@
+#include "gate_metrics.h"
+#include <sstream>
+
+namespace swift::gate {
+
+namespace {
+
+template <typename T>
+T Load(const std::atomic<T>& v) {
+    return v.load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+std::string GateMetrics::Format() const {
+    std::ostringstream os;
+    os << "frames_serialized=" << Load(frames_serialized)
+       << " bytes_serialized=" << Load(bytes_serialized)
+       << " frames_enqueued=" << Load(frames_enqueued)
+       << " bytes_shared=" << Load(bytes_shared)
+       << " write_batches=" << Load(write_batches)
+       << " frames_written=" << Load(frames_written)
+       << " bytes_written=" << Load(bytes_written)
+       << " slow_consumers=" << Load(slow_consumers)
+       << " bytes_queued=" << Load(bytes_queued)
+       << " frames_dropped=" << Load(frames_dropped)
+       << " frames_coalesced=" << Load(frames_coalesced)
+       << " slow_consumer_kicks=" << Load(slow_consumer_kicks);
+    return os.str();
+}
+
+}  // namespace swift::gate
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace swift::gate {
+
+/**
+ * GateSvr 进程内计数器（原子量，relaxed 累加，热路径无锁）。
+ * 由 GateService 持有，WsSession 等通过 GateService::metrics() 累加；
+ * 主程序心跳线程周期性以 Format() 输出到日志。
+ */
+struct GateMetrics {
+    // 下行推送：序列化一次、按引用计数共享给多个连接
+    std::atomic<uint64_t> frames_serialized{0};   // ServerMessage 序列化次数
+    std::atomic<uint64_t> bytes_serialized{0};    // 序列化产生的字节数
+    std::atomic<uint64_t> frames_enqueued{0};     // 投递给连接的帧数（共享帧按连接计）
+    std::atomic<uint64_t> bytes_shared{0};        // 因共享免去拷贝的字节数（第 2..N 个接收方）
+
+    // WebSocket 写出
+    std::atomic<uint64_t> write_batches{0};       // 跨线程投递到 strand 的批次数（一批可含多帧）
+    std::atomic<uint64_t> frames_written{0};
+    std::atomic<uint64_t> bytes_written{0};
+
+    // 下行背压
+    std::atomic<int64_t> slow_consumers{0};       // 当前处于高水位之上的连接数
+    std::atomic<int64_t> bytes_queued{0};         // 所有连接写队列中尚未写出的字节数
+    std::atomic<uint64_t> frames_dropped{0};      // 慢消费者下被丢弃的低优先级帧
+    std::atomic<uint64_t> frames_coalesced{0};    // 慢消费者下被合并替换的低优先级帧
+    std::atomic<uint64_t> slow_consumer_kicks{0}; // 因积压被踢下线的连接数
+
+    static void Add(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+    static void Add(std::atomic<int64_t>& gauge, int64_t n) {
+        gauge.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /** 单行 key=value 文本，便于日志采集 */
+    std::string Format() const;
+};
+
+}  // namespace swift::gate
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unistd.h>
 
@@ -14,6 +15,11 @@ namespace swift::gate {
 
 namespace {
 
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 /** 未配置 gate_id 时用 hostname:grpc_port，保证多实例唯一 */
 std::string FallbackGateId(int grpc_port) {
     char name[256];
@@ -22,6 +28,20 @@ std::string FallbackGateId(int grpc_port) {
     return std::string(name) + ":" + std::to_string(grpc_port);
 }
 
+SlowConsumerPolicy ParseSlowConsumerPolicy(const std::string& s) {
+    if (s == "coalesce") return SlowConsumerPolicy::kCoalesce;
+    if (s == "kick") return SlowConsumerPolicy::kKick;
+    return SlowConsumerPolicy::kDrop;
+}
+
+/** 本网关命令表里没有的命令按域前缀放行，由 Zone 判断是否支持（新增 Zone 命令无需先升级 Gate） */
+bool IsZoneDomainCmd(std::string_view cmd) {
+    for (std::string_view prefix : {"chat.", "friend.", "group.", "file."}) {
+        if (cmd.substr(0, prefix.size()) == prefix) return true;
+    }
+    return false;
+}
+
 }  // namespace
 
 GateService::GateService() {
@@ -36,196 +56,223 @@ void GateService::Init(const GateConfig& config) {
     zonesvr_internal_secret_ = config.zonesvr_internal_secret;
     heartbeat_timeout_seconds_ = config.heartbeat_timeout_seconds > 0
         ? config.heartbeat_timeout_seconds : 90;
+    heartbeat_check_tick_ms_ = config.heartbeat_check_tick_ms > 0
+        ? config.heartbeat_check_tick_ms : 1000;
+    max_inflight_per_conn_ = config.max_inflight_per_conn;
+    send_limits_.high_water_bytes = config.ws_send_high_water_bytes;
+    send_limits_.low_water_bytes = config.ws_send_low_water_bytes;
+    send_limits_.high_water_frames = config.ws_send_high_water_frames;
+    send_limits_.low_water_frames = config.ws_send_low_water_frames;
+    send_limits_.policy = ParseSlowConsumerPolicy(config.ws_slow_consumer_policy);
     zone_client_ = std::make_unique<ZoneRpcClient>();
     zone_client_->Init(zone_svr_addr_, zonesvr_internal_secret_);
 }
 
-void GateService::AddConnection(const std::string& conn_id) {
-    std::unique_lock lock(mutex_);
-    Connection c;
-    c.conn_id = conn_id;
-    c.connected_at = c.last_heartbeat =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-    connections_[conn_id] = std::move(c);
-}
-
-void GateService::RemoveConnection(const std::string& conn_id) {
-    std::string user_id;
-    {
-        std::unique_lock lock(mutex_);
-        auto it = connections_.find(conn_id);
-        if (it != connections_.end()) {
-            user_id = it->second.user_id;
-            if (!user_id.empty())
-                user_to_conn_.erase(user_id);
-            connections_.erase(it);
-        }
-    }
+ConnHandle GateService::AddConnection() {
+    auto session = registry_.Add(NowMs());
+    return session ? session->handle() : kInvalidConnHandle;
+}
+
+void GateService::RemoveConnection(ConnHandle handle) {
+    auto session = registry_.Remove(handle);
+    if (!session) return;
+    std::string user_id = session->user_id();
     if (!user_id.empty())
-        NotifyUserOffline(user_id);
+        NotifyUserOffline(user_id, session->conn_id());
 }
 
-Connection* GateService::GetConnection(const std::string& conn_id) {
-    std::shared_lock lock(mutex_);
-    auto it = connections_.find(conn_id);
-    return it != connections_.end() ? &it->second : nullptr;
+std::optional<Connection> GateService::GetConnection(ConnHandle handle) const {
+    auto session = registry_.Find(handle);
+    if (!session) return std::nullopt;
+    return session->Snapshot();
 }
 
-bool GateService::BindUser(const std::string& conn_id, const std::string& user_id,
+bool GateService::BindUser(ConnHandle handle, const std::string& user_id,
                            const std::string& token,
                            const std::string& device_id, const std::string& device_type) {
-    std::unique_lock lock(mutex_);
-    auto it = connections_.find(conn_id);
-    if (it == connections_.end()) return false;
-    if (!it->second.user_id.empty())
-        user_to_conn_.erase(it->second.user_id);
-    it->second.user_id = user_id;
-    it->second.token = token;
-    it->second.device_id = device_id;
-    it->second.device_type = device_type;
-    it->second.authenticated = true;
-    user_to_conn_[user_id] = conn_id;
-    return true;
+    return registry_.BindUser(handle, user_id, token, device_id, device_type);
 }
 
 void GateService::UnbindUser(const std::string& user_id) {
-    std::unique_lock lock(mutex_);
-    user_to_conn_.erase(user_id);
-    for (auto& [cid, c] : connections_) {
-        if (c.user_id == user_id) {
-            c.user_id.clear();
-            c.device_id.clear();
-            c.device_type.clear();
-            c.authenticated = false;
-            break;
-        }
-    }
+    registry_.UnbindUser(user_id);
 }
 
-std::string GateService::GetConnIdByUser(const std::string& user_id) {
-    std::shared_lock lock(mutex_);
-    auto it = user_to_conn_.find(user_id);
-    return it != user_to_conn_.end() ? it->second : "";
+ConnHandle GateService::GetConnByUser(const std::string& user_id) const {
+    auto session = registry_.FindByUser(user_id);
+    return session ? session->handle() : kInvalidConnHandle;
 }
 
-Connection* GateService::GetConnectionByUserId(const std::string& user_id) {
-    std::shared_lock lock(mutex_);
-    auto it = user_to_conn_.find(user_id);
-    if (it == user_to_conn_.end()) return nullptr;
-    auto cIt = connections_.find(it->second);
-    return cIt != connections_.end() ? &cIt->second : nullptr;
+std::optional<Connection> GateService::GetConnectionByUserId(const std::string& user_id) const {
+    auto session = registry_.FindByUser(user_id);
+    if (!session) return std::nullopt;
+    return session->Snapshot();
 }
 
-void GateService::HandleClientMessage(const std::string& conn_id, const std::string& cmd,
+void GateService::HandleClientMessage(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
                                        const std::string& payload, const std::string& request_id) {
-    if (cmd == "auth.login") {
-        HandleLogin(conn_id, payload, request_id);
-    } else if (cmd == "auth.register") {
-        ForwardToZone(conn_id, cmd, payload, request_id);
-    } else if (cmd == "heartbeat") {
-        HandleHeartbeat(conn_id, request_id);
-    } else if (cmd == "auth.logout" || cmd == "auth.validate_token") {
-        ForwardToZone(conn_id, cmd, payload, request_id);
-    } else if ((cmd.size() >= 5 && cmd.substr(0, 5) == "chat.") ||
-               (cmd.size() >= 7 && cmd.substr(0, 7) == "friend.") ||
-               (cmd.size() >= 6 && cmd.substr(0, 6) == "group.") ||
-               (cmd.size() >= 5 && cmd.substr(0, 5) == "file.")) {
-        ForwardToZone(conn_id, cmd, payload, request_id);
-    } else {
-        SendResponse(conn_id, cmd, request_id,
+    switch (cmd_id) {
+    case swift::CmdId::AUTH_LOGIN:
+        HandleLogin(handle, payload, request_id);
+        return;
+    case swift::CmdId::HEARTBEAT:
+        HandleHeartbeat(handle, request_id);
+        return;
+    default:
+        break;
+    }
+    // 其余已登记的业务命令整域转发，具体命令由 Zone 分发；UNKNOWN 按字符串域前缀转发原始 cmd
+    switch (swift::CmdDomainOf(cmd_id)) {
+    case swift::CmdDomain::AUTH:
+    case swift::CmdDomain::CHAT:
+    case swift::CmdDomain::FRIEND:
+    case swift::CmdDomain::GROUP:
+    case swift::CmdDomain::FILE:
+        ForwardToZone(handle, cmd_id, cmd, payload, request_id);
+        return;
+    default:
+        if (cmd_id == swift::CmdId::UNKNOWN && IsZoneDomainCmd(cmd)) {
+            ForwardToZone(handle, cmd_id, cmd, payload, request_id);
+            return;
+        }
+        SendResponse(handle, cmd, request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::UNSUPPORTED),
                      swift::ErrorCodeToString(swift::ErrorCode::UNSUPPORTED));
+        return;
     }
 }
 
-bool GateService::PushToUser(const std::string& user_id, const std::string& cmd,
-                              const std::string& payload) {
-    std::string conn_id = GetConnIdByUser(user_id);
-    if (conn_id.empty()) return false;
-    // 组 ServerMessage 并发送
+Frame GateService::BuildPushFrame(const std::string& cmd, const std::string& payload) {
     swift::gate::ServerMessage msg;
     msg.set_cmd(cmd.empty() ? "message" : cmd);
+    msg.set_cmd_id(static_cast<uint32_t>(swift::CmdFromName(cmd)));
     msg.set_payload(payload);
     msg.set_code(0);
     std::string data;
-    if (!msg.SerializeToString(&data)) return false;
-    return SendToConn(conn_id, data);
+    if (!msg.SerializeToString(&data)) return nullptr;
+    GateMetrics::Add(metrics_.frames_serialized);
+    GateMetrics::Add(metrics_.bytes_serialized, data.size());
+    return MakeFrame(std::move(data));
 }
 
-void GateService::CheckHeartbeat() {
-    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    int64_t timeout_ms = static_cast<int64_t>(heartbeat_timeout_seconds_) * 1000;
-    std::vector<std::string> to_close;
-    {
-        std::shared_lock lock(mutex_);
-        for (const auto& [conn_id, c] : connections_) {
-            if (now_ms - c.last_heartbeat > timeout_ms)
-                to_close.push_back(conn_id);
-        }
+OutFrame GateService::MakePushOutFrame(const std::string& cmd, const std::string& payload,
+                                       Frame frame) {
+    switch (swift::CmdFromName(cmd)) {
+    case swift::CmdId::USER_STATUS_CHANGE: {
+        swift::gate::UserStatusChangeNotify notify;
+        std::string key = notify.ParseFromString(payload) ? "status:" + notify.user_id() : "";
+        return OutFrame(std::move(frame), true, std::move(key));
+    }
+    case swift::CmdId::CHAT_READ_RECEIPT: {
+        swift::gate::ReadReceiptNotify notify;
+        std::string key = notify.ParseFromString(payload)
+            ? "read:" + notify.chat_id() + ":" + notify.user_id() : "";
+        return OutFrame(std::move(frame), true, std::move(key));
+    }
+    default:
+        return OutFrame(std::move(frame));
     }
-    for (const std::string& conn_id : to_close)
-        CloseConnection(conn_id);
 }
 
-void GateService::SetCloseCallback(const std::string& conn_id, CloseCallback fn) {
-    std::unique_lock lock(mutex_);
-    close_callbacks_[conn_id] = std::move(fn);
+Frame GateService::BuildKickedFrame(const std::string& reason) {
+    swift::gate::KickedNotify notify;
+    notify.set_reason(reason);
+    std::string payload;
+    if (!notify.SerializeToString(&payload)) return nullptr;
+    return BuildPushFrame("system.kicked", payload);
 }
 
-void GateService::RemoveCloseCallback(const std::string& conn_id) {
-    std::unique_lock lock(mutex_);
-    close_callbacks_.erase(conn_id);
+bool GateService::PushToUser(const std::string& user_id, const std::string& cmd,
+                              const std::string& payload) {
+    auto session = registry_.FindByUser(user_id);
+    if (!session) return false;
+    Frame frame = BuildPushFrame(cmd, payload);
+    if (!frame || !session->Send(MakePushOutFrame(cmd, payload, frame))) return false;
+    GateMetrics::Add(metrics_.frames_enqueued);
+    return true;
 }
 
-void GateService::CloseConnection(const std::string& conn_id) {
-    CloseCallback fn;
-    {
-        std::shared_lock lock(mutex_);
-        auto it = close_callbacks_.find(conn_id);
-        if (it == close_callbacks_.end()) return;
-        fn = it->second;
+int GateService::PushToUsers(const std::vector<std::string>& user_ids, const std::string& cmd,
+                             const std::string& payload, std::vector<std::string>* undelivered) {
+    std::optional<OutFrame> out;
+    int delivered = 0;
+    for (const auto& user_id : user_ids) {
+        auto session = registry_.FindByUser(user_id);
+        // 有在线接收方时才序列化，且只序列化一次
+        if (session && !out) {
+            Frame frame = BuildPushFrame(cmd, payload);
+            if (!frame) return 0;
+            out = MakePushOutFrame(cmd, payload, std::move(frame));
+        }
+        if (!session || !session->Send(*out)) {
+            if (undelivered) undelivered->push_back(user_id);
+            continue;
+        }
+        if (delivered > 0)
+            GateMetrics::Add(metrics_.bytes_shared, out->data->size());
+        ++delivered;
     }
-    if (fn) fn();
+    GateMetrics::Add(metrics_.frames_enqueued, static_cast<uint64_t>(delivered));
+    return delivered;
+}
+
+int64_t GateService::ReapIfIdle(ConnHandle handle, int64_t now_ms) {
+    auto session = registry_.Find(handle);
+    if (!session) return 0;
+    int64_t deadline = session->last_heartbeat() + HeartbeatTimeoutMs();
+    if (deadline > now_ms) return deadline;
+    session->Close();
+    return 0;
+}
+
+void GateService::SetCloseCallback(ConnHandle handle, CloseCallback fn) {
+    if (auto session = registry_.Find(handle))
+        session->SetCloseCallback(std::move(fn));
+}
+
+void GateService::RemoveCloseCallback(ConnHandle handle) {
+    if (auto session = registry_.Find(handle))
+        session->ClearCloseCallback();
+}
+
+void GateService::CloseConnection(ConnHandle handle) {
+    if (auto session = registry_.Find(handle))
+        session->Close();
 }
 
 int GateService::GetConnectionCount() const {
-    std::shared_lock lock(mutex_);
-    return static_cast<int>(connections_.size());
+    return static_cast<int>(registry_.Size());
 }
 
-void GateService::SetSendCallback(const std::string& conn_id, SendCallback fn) {
-    std::unique_lock lock(mutex_);
-    send_callbacks_[conn_id] = std::move(fn);
+void GateService::SetSendCallback(ConnHandle handle, SendCallback fn) {
+    if (auto session = registry_.Find(handle))
+        session->SetSendCallback(std::move(fn));
 }
 
-void GateService::RemoveSendCallback(const std::string& conn_id) {
-    std::unique_lock lock(mutex_);
-    send_callbacks_.erase(conn_id);
+void GateService::RemoveSendCallback(ConnHandle handle) {
+    if (auto session = registry_.Find(handle))
+        session->ClearSendCallback();
 }
 
-bool GateService::SendToConn(const std::string& conn_id, const std::string& data) {
-    SendCallback fn;
-    {
-        std::shared_lock lock(mutex_);
-        auto it = send_callbacks_.find(conn_id);
-        if (it == send_callbacks_.end()) return false;
-        fn = it->second;
-    }
-    return fn && fn(data);
+bool GateService::SendToConn(ConnHandle handle, const std::string& data) {
+    return SendToConn(handle, MakeFrame(data));
+}
+
+bool GateService::SendToConn(ConnHandle handle, const Frame& frame) {
+    auto session = registry_.Find(handle);
+    return session && session->Send(frame);
 }
 
-void GateService::NotifyUserOffline(const std::string& user_id) {
+void GateService::NotifyUserOffline(const std::string& user_id, const std::string& conn_id) {
     if (!zone_client_) return;
-    zone_client_->UserOffline(user_id, gate_id_);
+    zone_client_->UserOfflineAsync(user_id, gate_id_, conn_id);
 }
 
-bool GateService::SendResponse(const std::string& conn_id, const std::string& cmd,
+bool GateService::SendResponse(ConnHandle handle, const std::string& cmd,
                                 const std::string& request_id, int code,
                                 const std::string& message, const std::string& payload) {
     swift::gate::ServerMessage msg;
     msg.set_cmd(cmd);
+    msg.set_cmd_id(static_cast<uint32_t>(swift::CmdFromName(cmd)));
     msg.set_request_id(request_id);
     msg.set_code(code);
     msg.set_message(message);
@@ -233,22 +280,18 @@ bool GateService::SendResponse(const std::string& conn_id, const std::string& cm
         msg.set_payload(payload);
     std::string data;
     if (!msg.SerializeToString(&data)) return false;
-    return SendToConn(conn_id, data);
+    return SendToConn(handle, MakeFrame(std::move(data)));
 }
 
-void GateService::UpdateHeartbeat(const std::string& conn_id) {
-    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    std::unique_lock lock(mutex_);
-    auto it = connections_.find(conn_id);
-    if (it != connections_.end())
-        it->second.last_heartbeat = now;
+void GateService::UpdateHeartbeat(ConnHandle handle) {
+    if (auto session = registry_.Find(handle))
+        session->TouchHeartbeat(NowMs());
 }
 
-void GateService::HandleLogin(const std::string& conn_id, const std::string& payload,
+void GateService::HandleLogin(ConnHandle handle, const std::string& payload,
                               const std::string& request_id) {
     if (!zone_client_) {
-        SendResponse(conn_id, "auth.login", request_id,
+        SendResponse(handle, "auth.login", request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::UPSTREAM_UNAVAILABLE),
                      swift::ErrorCodeToString(swift::ErrorCode::UPSTREAM_UNAVAILABLE));
         return;
@@ -256,24 +299,43 @@ void GateService::HandleLogin(const std::string& conn_id, const std::string& pay
     // auth.login 统一为 zone::AuthLoginPayload（username/password/device）。
     swift::zone::AuthLoginPayload account_login_req;
     if (!account_login_req.ParseFromString(payload)) {
-        SendResponse(conn_id, "auth.login", request_id,
+        SendResponse(handle, "auth.login", request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::INVALID_PARAM),
                      swift::ErrorCodeToString(swift::ErrorCode::INVALID_PARAM));
         return;
     }
+    auto session = registry_.Find(handle);
+    if (!session) return;
+    if (!session->TryAcquireInflight(max_inflight_per_conn_)) {
+        SendResponse(handle, "auth.login", request_id,
+                     swift::ErrorCodeToInt(swift::ErrorCode::RATE_LIMITED),
+                     swift::ErrorCodeToString(swift::ErrorCode::RATE_LIMITED));
+        return;
+    }
 
-    HandleClientRequestResult login_result;
-    if (!zone_client_->HandleClientRequest(conn_id, "", "auth.login",
-                                           payload, request_id, "", &login_result)) {
+    zone_client_->HandleClientRequestAsync(session->conn_id(), "", swift::CmdId::AUTH_LOGIN, "auth.login",
+                                           payload, request_id, "",
+        [this, session, handle, request_id,
+         device_id = account_login_req.device_id(),
+         device_type = account_login_req.device_type()](bool ok, const HandleClientRequestResult& result) {
+            session->ReleaseInflight();
+            OnLoginResult(handle, request_id, device_id, device_type, ok, result);
+        });
+}
+
+void GateService::OnLoginResult(ConnHandle handle, const std::string& request_id,
+                                const std::string& device_id, const std::string& device_type,
+                                bool ok, const HandleClientRequestResult& login_result) {
+    if (!ok) {
         int code = login_result.code < 0 ? swift::ErrorCodeToInt(swift::ErrorCode::RPC_FAILED) : login_result.code;
         std::string msg = login_result.message.empty()
             ? swift::ErrorCodeToString(swift::ErrorCode::RPC_FAILED)
             : login_result.message;
-        SendResponse(conn_id, "auth.login", request_id, code, msg);
+        SendResponse(handle, "auth.login", request_id, code, msg);
         return;
     }
     if (login_result.code != swift::ErrorCodeToInt(swift::ErrorCode::OK)) {
-        SendResponse(conn_id, "auth.login", login_result.request_id,
+        SendResponse(handle, "auth.login", login_result.request_id,
                      login_result.code, login_result.message, login_result.payload);
         return;
     }
@@ -281,66 +343,75 @@ void GateService::HandleLogin(const std::string& conn_id, const std::string& pay
     swift::zone::AuthLoginResponsePayload login_resp;
     if (!login_resp.ParseFromString(login_result.payload) ||
         login_resp.user_id().empty() || login_resp.token().empty()) {
-        SendResponse(conn_id, "auth.login", request_id,
+        SendResponse(handle, "auth.login", request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::INTERNAL_ERROR),
                      swift::ErrorCodeToString(swift::ErrorCode::INTERNAL_ERROR));
         return;
     }
 
-    if (!BindUser(conn_id, login_resp.user_id(), login_resp.token(),
-                  account_login_req.device_id(), account_login_req.device_type())) {
-        SendResponse(conn_id, "auth.login", request_id,
+    // 响应返回前连接可能已断开，此时 BindUser 失败，不再上报上线
+    if (!BindUser(handle, login_resp.user_id(), login_resp.token(), device_id, device_type)) {
+        SendResponse(handle, "auth.login", request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::INTERNAL_ERROR),
                      swift::ErrorCodeToString(swift::ErrorCode::INTERNAL_ERROR));
         return;
     }
 
-    zone_client_->UserOnline(login_resp.user_id(), gate_id_,
-                             account_login_req.device_type(), account_login_req.device_id());
-    SendResponse(conn_id, "auth.login", login_result.request_id,
+    zone_client_->UserOnlineAsync(login_resp.user_id(), gate_id_, ConnHandleToString(handle),
+                                  device_type, device_id);
+    SendResponse(handle, "auth.login", login_result.request_id,
                  login_result.code, login_result.message, login_result.payload);
 }
 
-void GateService::HandleHeartbeat(const std::string& conn_id,
+void GateService::HandleHeartbeat(ConnHandle handle,
                                   const std::string& request_id) {
-    UpdateHeartbeat(conn_id);
+    UpdateHeartbeat(handle);
     swift::gate::HeartbeatResponse resp;
     resp.set_server_time(std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count());
     std::string payload;
     if (!resp.SerializeToString(&payload))
         return;
-    SendResponse(conn_id, "heartbeat", request_id,
+    SendResponse(handle, "heartbeat", request_id,
                  swift::ErrorCodeToInt(swift::ErrorCode::OK),
                  swift::ErrorCodeToString(swift::ErrorCode::OK), payload);
 }
 
-void GateService::ForwardToZone(const std::string& conn_id, const std::string& cmd,
+void GateService::ForwardToZone(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
                                 const std::string& payload, const std::string& request_id) {
     if (!zone_client_) {
-        SendResponse(conn_id, cmd, request_id,
+        SendResponse(handle, cmd, request_id,
                      swift::ErrorCodeToInt(swift::ErrorCode::UPSTREAM_UNAVAILABLE),
                      swift::ErrorCodeToString(swift::ErrorCode::UPSTREAM_UNAVAILABLE));
         return;
     }
-    std::string user_id;
-    std::string token;
-    {
-        Connection* c = GetConnection(conn_id);
-        if (c) {
-            user_id = c->user_id;
-            token = c->token;
-        }
+    auto session = registry_.Find(handle);
+    if (!session) return;
+    if (!session->TryAcquireInflight(max_inflight_per_conn_)) {
+        SendResponse(handle, cmd, request_id,
+                     swift::ErrorCodeToInt(swift::ErrorCode::RATE_LIMITED),
+                     swift::ErrorCodeToString(swift::ErrorCode::RATE_LIMITED));
+        return;
     }
-    HandleClientRequestResult result;
-    if (!zone_client_->HandleClientRequest(conn_id, user_id, cmd, payload, request_id, token, &result)) {
+    Connection c = session->Snapshot();
+    zone_client_->HandleClientRequestAsync(c.conn_id, c.user_id, cmd_id, cmd, payload, request_id, c.token,
+        [this, session, handle, cmd_id, cmd, payload, request_id](bool ok, const HandleClientRequestResult& result) {
+            session->ReleaseInflight();
+            OnForwardResult(handle, cmd_id, cmd, payload, request_id, ok, result);
+        });
+}
+
+void GateService::OnForwardResult(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
+                                  const std::string& payload, const std::string& request_id,
+                                  bool ok, const HandleClientRequestResult& result) {
+    if (!ok) {
         int code = result.code < 0 ? swift::ErrorCodeToInt(swift::ErrorCode::RPC_FAILED) : result.code;
         std::string msg = result.message.empty() ? swift::ErrorCodeToString(swift::ErrorCode::RPC_FAILED) : result.message;
-        SendResponse(conn_id, cmd, request_id, code, msg);
+        SendResponse(handle, cmd, request_id, code, msg);
         return;
     }
 
-    if (cmd == "auth.validate_token" &&
+    if (cmd_id == swift::CmdId::AUTH_VALIDATE_TOKEN &&
         result.code == swift::ErrorCodeToInt(swift::ErrorCode::OK)) {
         swift::zone::AuthValidateTokenPayload validate_req;
         swift::zone::AuthValidateTokenResponsePayload validate_resp;
@@ -351,19 +422,17 @@ void GateService::ForwardToZone(const std::string& conn_id, const std::string& c
         if (!validated_user_id.empty() && !validated_token.empty()) {
             std::string device_id;
             std::string device_type;
-            {
-                Connection* c = GetConnection(conn_id);
-                if (c) {
-                    device_id = c->device_id;
-                    device_type = c->device_type;
-                }
+            if (auto c = GetConnection(handle)) {
+                device_id = c->device_id;
+                device_type = c->device_type;
             }
-            BindUser(conn_id, validated_user_id, validated_token, device_id, device_type);
-            zone_client_->UserOnline(validated_user_id, gate_id_, device_type, device_id);
+            if (BindUser(handle, validated_user_id, validated_token, device_id, device_type))
+                zone_client_->UserOnlineAsync(validated_user_id, gate_id_, ConnHandleToString(handle),
+                                              device_type, device_id);
         }
     }
 
-    SendResponse(conn_id, cmd, result.request_id, result.code, result.message, result.payload);
+    SendResponse(handle, cmd, result.request_id, result.code, result.message, result.payload);
 }
 
 bool GateService::RegisterGate(const std::string& grpc_address) {
@@ -1,34 +1,18 @@
 #pragma once
 
-#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <shared_mutex>
+#include <vector>
+#include "connection_registry.h"
+#include "gate_metrics.h"
+#include "swift/cmd_id.h"
 
 namespace swift::gate {
 
 struct GateConfig;
 class ZoneRpcClient;
-
-/** 发送回调：Session 注册，供 PushToUser/SendToConn 调用 */
-using SendCallback = std::function<bool(const std::string&)>;
-/** 关闭连接回调：Session 注册，供 CheckHeartbeat 超时踢线时调用 */
-using CloseCallback = std::function<void()>;
-
-/**
- * 连接信息：conn_id → (user_id, token, device_id, device_type)
- */
-struct Connection {
-    std::string conn_id;
-    std::string user_id;       // 登录后才有
-    std::string token;         // 登录时校验通过的 JWT，转发业务请求时带给 Zone 注入业务服务
-    std::string device_id;     // 设备 ID
-    std::string device_type;   // windows, android, ios, web
-    int64_t connected_at;
-    int64_t last_heartbeat;
-    bool authenticated = false;
-};
+struct HandleClientRequestResult;
 
 /**
  * 网关服务
@@ -47,48 +31,71 @@ public:
     /** 初始化：zone_svr_addr、zonesvr_internal_secret、gate_id，用于 OnDisconnect 通知 ZoneSvr UserOffline */
     void Init(const GateConfig& config);
     
-    // 连接管理
-    void AddConnection(const std::string& conn_id);
-    void RemoveConnection(const std::string& conn_id);
-    Connection* GetConnection(const std::string& conn_id);
+    // 连接管理（连接以 ConnHandle 标识，字符串 conn_id 仅在调用 ZoneSvr 时生成）
+    /** 登记新连接，返回句柄；槽位耗尽返回 kInvalidConnHandle */
+    ConnHandle AddConnection();
+    void RemoveConnection(ConnHandle handle);
+    /** 连接信息快照（拷贝），连接不存在返回 nullopt */
+    std::optional<Connection> GetConnection(ConnHandle handle) const;
     
     // 用户登录后绑定（含 token、device_id、device_type）
-    bool BindUser(const std::string& conn_id, const std::string& user_id,
+    bool BindUser(ConnHandle handle, const std::string& user_id,
                   const std::string& token = "",
                   const std::string& device_id = "", const std::string& device_type = "");
     void UnbindUser(const std::string& user_id);
     
     // 根据 user_id 查找连接
-    std::string GetConnIdByUser(const std::string& user_id);
-    /** 根据 user_id 获取 Connection*（用于获取完整连接信息） */
-    Connection* GetConnectionByUserId(const std::string& user_id);
+    ConnHandle GetConnByUser(const std::string& user_id) const;
+    /** 根据 user_id 获取连接信息快照（用于获取完整连接信息） */
+    std::optional<Connection> GetConnectionByUserId(const std::string& user_id) const;
     
-    // 处理客户端消息
-    void HandleClientMessage(const std::string& conn_id, const std::string& cmd,
+    // 处理客户端消息：按 cmd_id 分发（老客户端由调用方按 cmd 字符串查回 ID），cmd 用于回包与转发
+    void HandleClientMessage(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
                              const std::string& payload, const std::string& request_id);
     
     // 推送消息给用户
     bool PushToUser(const std::string& user_id, const std::string& cmd,
                     const std::string& payload);
+    /**
+     * 推送同一消息给多个用户：只序列化一次，各连接共享同一帧；返回投递成功的用户数。
+     * @param undelivered 非空时追加未投递（本 Gate 无连接）的 user_id
+     */
+    int PushToUsers(const std::vector<std::string>& user_ids, const std::string& cmd,
+                    const std::string& payload, std::vector<std::string>* undelivered = nullptr);
     
-    // 心跳检测
-    void CheckHeartbeat();
+    // 心跳超时回收（由 WsListener 的时间轮在 I/O 线程上驱动）
+    /**
+     * 时间轮到期回调：连接自最后一次心跳起已超时则关闭并返回 0；
+     * 未超时返回新的截止时间（last_heartbeat + 超时），连接不存在返回 0。
+     */
+    int64_t ReapIfIdle(ConnHandle handle, int64_t now_ms);
+    int64_t HeartbeatTimeoutMs() const { return static_cast<int64_t>(heartbeat_timeout_seconds_) * 1000; }
+    int64_t HeartbeatCheckTickMs() const { return heartbeat_check_tick_ms_; }
     
     // 获取当前连接数
     int GetConnectionCount() const;
 
-    /** 注册 conn_id 的发送回调（WsSession 在连接建立时调用） */
-    void SetSendCallback(const std::string& conn_id, SendCallback fn);
-    /** 移除 conn_id 的发送回调（WsSession 在断开时调用） */
-    void RemoveSendCallback(const std::string& conn_id);
-    /** 注册 conn_id 的关闭回调（WsSession 注册，CheckHeartbeat 超时踢线时调用） */
-    void SetCloseCallback(const std::string& conn_id, CloseCallback fn);
-    /** 移除 conn_id 的关闭回调（WsSession 在 Close 时调用） */
-    void RemoveCloseCallback(const std::string& conn_id);
+    /** 注册连接的发送回调（WsSession 在连接建立时调用） */
+    void SetSendCallback(ConnHandle handle, SendCallback fn);
+    /** 移除连接的发送回调（WsSession 在断开时调用） */
+    void RemoveSendCallback(ConnHandle handle);
+    /** 注册连接的关闭回调（WsSession 注册，心跳超时踢线时调用） */
+    void SetCloseCallback(ConnHandle handle, CloseCallback fn);
+    /** 移除连接的关闭回调（WsSession 在 Close 时调用） */
+    void RemoveCloseCallback(ConnHandle handle);
     /** 主动关闭连接（从任意线程调用，会触发 Session Close → RemoveConnection → UserOffline） */
-    void CloseConnection(const std::string& conn_id);
+    void CloseConnection(ConnHandle handle);
     /** 向指定连接发送数据（由 PushToUser、WebSocketHandler::SendToClient 使用） */
-    bool SendToConn(const std::string& conn_id, const std::string& data);
+    bool SendToConn(ConnHandle handle, const std::string& data);
+    bool SendToConn(ConnHandle handle, const Frame& frame);
+
+    /** 单连接下行队列水位与慢消费者策略（WsSession 使用） */
+    const SendQueueLimits& send_limits() const { return send_limits_; }
+    /** system.kicked 推送帧（KickedNotify{reason}） */
+    Frame BuildKickedFrame(const std::string& reason);
+
+    GateMetrics& metrics() { return metrics_; }
+    const GateMetrics& metrics() const { return metrics_; }
 
     /** 向 ZoneSvr 注册本 Gate（启动时调用，传入本机 gRPC 地址） */
     bool RegisterGate(const std::string& grpc_address);
@@ -97,29 +104,43 @@ public:
     bool GateHeartbeat();
     
 private:
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<std::string, Connection> connections_;      // conn_id -> Connection
-    std::unordered_map<std::string, std::string> user_to_conn_;    // user_id -> conn_id
-    std::unordered_map<std::string, SendCallback> send_callbacks_; // conn_id -> SendCallback
-    
+    // 连接注册表：ConnHandle（slab 槽位）/ user_id（分片）-> ConnSession，无全局锁
+    ConnectionRegistry registry_;
+    GateMetrics metrics_;
+
     std::string gate_id_;
     std::string zone_svr_addr_;
     std::string zonesvr_internal_secret_;
     int heartbeat_timeout_seconds_ = 90;
+    int64_t heartbeat_check_tick_ms_ = 1000;
+    int max_inflight_per_conn_ = 64;
+    SendQueueLimits send_limits_;
     std::unique_ptr<ZoneRpcClient> zone_client_;
-    std::unordered_map<std::string, CloseCallback> close_callbacks_;
 
-    void NotifyUserOffline(const std::string& user_id);
+    void NotifyUserOffline(const std::string& user_id, const std::string& conn_id);
+    /** 序列化下行推送帧（ServerMessage{cmd,payload,code=0}），失败返回 nullptr */
+    Frame BuildPushFrame(const std::string& cmd, const std::string& payload);
+    /** 推送帧附带优先级：user.status_change、chat.read_receipt 为低优先级并带合并 key */
+    OutFrame MakePushOutFrame(const std::string& cmd, const std::string& payload, Frame frame);
     /** 向连接发送 ServerMessage（cmd/request_id/code/message/payload） */
-    bool SendResponse(const std::string& conn_id, const std::string& cmd,
+    bool SendResponse(ConnHandle handle, const std::string& cmd,
                      const std::string& request_id, int code, const std::string& message,
                      const std::string& payload = "");
-    void UpdateHeartbeat(const std::string& conn_id);
-    void HandleLogin(const std::string& conn_id, const std::string& payload,
+    void UpdateHeartbeat(ConnHandle handle);
+    void HandleLogin(ConnHandle handle, const std::string& payload,
                      const std::string& request_id);
-    void HandleHeartbeat(const std::string& conn_id, const std::string& request_id);
-    void ForwardToZone(const std::string& conn_id, const std::string& cmd,
+    void HandleHeartbeat(ConnHandle handle, const std::string& request_id);
+    /** 异步转发到 ZoneSvr，立即返回；响应在 RPC 回调中经 SendToConn 投递回连接 */
+    void ForwardToZone(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
                       const std::string& payload, const std::string& request_id);
+    /** auth.login 的 Zone 响应处理（RPC 回调线程） */
+    void OnLoginResult(ConnHandle handle, const std::string& request_id,
+                       const std::string& device_id, const std::string& device_type,
+                       bool ok, const HandleClientRequestResult& result);
+    /** 普通转发的 Zone 响应处理（RPC 回调线程） */
+    void OnForwardResult(ConnHandle handle, swift::CmdId cmd_id, const std::string& cmd,
+                         const std::string& payload, const std::string& request_id,
+                         bool ok, const HandleClientRequestResult& result);
 };
 
 }  // namespace swift::gate
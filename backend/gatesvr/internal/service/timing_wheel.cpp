@@ -0,0 +1,56 @@
+#include "timing_wheel.h"
+#include <utility>
+
+namespace swift::gate {
+
+TimingWheel::TimingWheel(int64_t tick_ms, size_t slots, int64_t now_ms)
+    : tick_ms_(tick_ms > 0 ? tick_ms : 1)
+    , start_ms_(now_ms)
+    , buckets_(slots > 0 ? slots : 1) {}
+
+int64_t TimingWheel::TickOf(int64_t time_ms) const {
+    int64_t delta = time_ms - start_ms_;
+    if (delta <= 0) return 0;
+    return (delta + tick_ms_ - 1) / tick_ms_;  // 向上取整，保证不早于截止时间触发
+}
+
+void TimingWheel::Schedule(ConnHandle handle, int64_t deadline_ms) {
+    int64_t tick = TickOf(deadline_ms);
+    if (tick <= current_tick_) tick = current_tick_ + 1;
+    const int64_t slots = static_cast<int64_t>(buckets_.size());
+    Entry e;
+    e.handle = handle;
+    e.rounds = static_cast<uint32_t>((tick - current_tick_ - 1) / slots);
+    buckets_[static_cast<size_t>(tick % slots)].push_back(e);
+    ++size_;
+}
+
+size_t TimingWheel::Advance(int64_t now_ms, const ExpireFn& on_expire) {
+    const int64_t target = (now_ms - start_ms_) / tick_ms_;
+    const int64_t slots = static_cast<int64_t>(buckets_.size());
+    size_t removed = 0;
+    std::vector<Entry> due;
+    while (current_tick_ < target) {
+        ++current_tick_;
+        // 先整体换出：回调里重新挂入的条目可能落回同一桶（恰好一整圈后）
+        std::vector<Entry>& bucket = buckets_[static_cast<size_t>(current_tick_ % slots)];
+        due.clear();
+        due.swap(bucket);
+        for (Entry& e : due) {
+            if (e.rounds > 0) {
+                --e.rounds;
+                bucket.push_back(e);
+                continue;
+            }
+            --size_;
+            int64_t next_deadline = on_expire ? on_expire(e.handle) : 0;
+            if (next_deadline > 0)
+                Schedule(e.handle, next_deadline);
+            else
+                ++removed;
+        }
+    }
+    return removed;
+}
+
+}  // namespace swift::gate
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "connection_registry.h"
+
+namespace swift::gate {
+
+/**
+ * 哈希时间轮：管理连接的心跳超时，取代按周期全量扫描连接表。
+ *
+ * - 共 slots 个桶，每桶跨 tick_ms；截止时间超出一圈的条目记录剩余圈数（rounds），
+ *   因此任意超时都只占一个桶位，无需多级轮。
+ * - 心跳本身不触碰时间轮（只原子更新 ConnSession::last_heartbeat）；桶到期时由回调
+ *   判断是否真的超时，未超时则按最新心跳重新挂入（惰性重排），每次 O(1)。
+ * - 非线程安全：由调用方串行使用（GateSvr 中每个 WsListener 一个，运行在其 strand 上）。
+ */
+class TimingWheel {
+public:
+    static constexpr size_t kDefaultSlots = 512;
+
+    /** 到期回调：返回新的截止时间（毫秒）则重新挂入；返回 0 表示移出时间轮 */
+    using ExpireFn = std::function<int64_t(ConnHandle)>;
+
+    TimingWheel(int64_t tick_ms, size_t slots, int64_t now_ms);
+
+    /** 挂入句柄，deadline_ms 所在 tick 到期时回调；已过期的截止时间在下一 tick 触发 */
+    void Schedule(ConnHandle handle, int64_t deadline_ms);
+
+    /**
+     * 推进到 now_ms，对沿途到期桶内的条目调用 on_expire。
+     * @return 本次移出时间轮的条目数
+     */
+    size_t Advance(int64_t now_ms, const ExpireFn& on_expire);
+
+    size_t Size() const { return size_; }
+    int64_t tick_ms() const { return tick_ms_; }
+
+private:
+    struct Entry {
+        ConnHandle handle;
+        uint32_t rounds;  // 还需转过的整圈数
+    };
+
+    int64_t TickOf(int64_t time_ms) const;
+
+    const int64_t tick_ms_;
+    const int64_t start_ms_;
+    int64_t current_tick_ = 0;  // 已处理到的 tick（相对 start_ms_）
+    std::vector<std::vector<Entry>> buckets_;
+    size_t size_ = 0;
+};
+
+}  // namespace swift::gate
@@ -0,0 +1,87 @@
+/**
+ * @file timing_wheel_test.cpp
+ * @brief TimingWheel 单元测试（到期时刻、跨圈、惰性重排、移出）
+ */
+
+#include "timing_wheel.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace swift::gate {
+
+// 截止时间到达所在 tick 前不触发，到达后触发一次
+TEST(TimingWheelTest, FiresAtDeadlineTick) {
+    TimingWheel wheel(100, 8, 0);
+    wheel.Schedule(1, 250);  // 向上取整到 tick 3（300ms）
+    std::vector<ConnHandle> fired;
+    auto collect = [&fired](ConnHandle h) { fired.push_back(h); return int64_t{0}; };
+
+    EXPECT_EQ(wheel.Advance(299, collect), 0u);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    EXPECT_EQ(wheel.Advance(300, collect), 1u);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0], 1u);
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+// 已过期的截止时间在下一 tick 触发
+TEST(TimingWheelTest, PastDeadlineFiresNextTick) {
+    TimingWheel wheel(100, 8, 0);
+    int calls = 0;
+    auto count = [&calls](ConnHandle) { ++calls; return int64_t{0}; };
+    wheel.Advance(500, count);
+    wheel.Schedule(7, 100);
+    wheel.Advance(599, count);
+    EXPECT_EQ(calls, 0);
+    wheel.Advance(600, count);
+    EXPECT_EQ(calls, 1);
+}
+
+// 超出一圈的截止时间按圈数延后，不会提前触发
+TEST(TimingWheelTest, DeadlineBeyondOneRevolution) {
+    TimingWheel wheel(10, 4, 0);  // 一圈 40ms
+    wheel.Schedule(42, 130);
+    int calls = 0;
+    auto count = [&calls](ConnHandle) { ++calls; return int64_t{0}; };
+    for (int64_t t = 10; t < 130; t += 10) {
+        wheel.Advance(t, count);
+        ASSERT_EQ(calls, 0) << "fired early at " << t;
+    }
+    wheel.Advance(130, count);
+    EXPECT_EQ(calls, 1);
+}
+
+// 回调返回新截止时间则重新挂入（含恰好一整圈后落回同一桶的情况）
+TEST(TimingWheelTest, ReArmFromCallback) {
+    TimingWheel wheel(10, 4, 0);
+    wheel.Schedule(5, 10);
+    std::vector<int64_t> fired_at;
+    int64_t now = 0;
+    auto rearm = [&](ConnHandle) {
+        fired_at.push_back(now);
+        return fired_at.size() < 3 ? now + 40 : int64_t{0};
+    };
+    for (now = 10; now <= 200; now += 10)
+        wheel.Advance(now, rearm);
+    EXPECT_EQ(fired_at, (std::vector<int64_t>{10, 50, 90}));
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+// 一次推进跨多个 tick 时沿途桶均被处理
+TEST(TimingWheelTest, AdvanceCatchesUpSkippedTicks) {
+    TimingWheel wheel(10, 16, 0);
+    for (ConnHandle h = 1; h <= 10; ++h)
+        wheel.Schedule(h, static_cast<int64_t>(h) * 10);
+    size_t removed = wheel.Advance(1000, [](ConnHandle) { return int64_t{0}; });
+    EXPECT_EQ(removed, 10u);
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+}  // namespace swift::gate
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,31 +2,28 @@
  * @file ws_listener.cpp
  * @brief Boost.Beast WebSocket 监听器与 Session
  *
- * Step 2: accept、async_read、async_write、close；每连接生成 conn_id，维护 Session。
+ * Step 2: accept、async_read、async_write、close；每连接由 GateService 分配 ConnHandle，维护 Session。
+ * 心跳超时由各监听器的时间轮在其 strand 上回收。
  */
 
 #include "ws_listener.h"
 #include "../handler/websocket_handler.h"
 #include "../service/gate_service.h"
-#include <atomic>
 #include <chrono>
+#include <deque>
 #include <iostream>
-#include <queue>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 namespace swift::gate {
 
 namespace {
 
-static std::atomic<int64_t> g_session_seq{0};
-
-std::string GenerateConnId() {
-    int64_t seq = g_session_seq.fetch_add(1);
-    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
-    std::ostringstream os;
-    os << "conn_" << now << "_" << seq;
-    return os.str();
 }
 
 void fail(beast::error_code ec, const char* what) {
@@ -48,6 +45,9 @@ std::string RemoteEndpointString(const websocket::stream<beast::tcp_stream>& ws)
     return os.str();
 }
 
+/** 停止派发新帧后，等待 system.kicked 写出的最长时间，超时直接断开 TCP */
+constexpr auto kKickFlushTimeout = std::chrono::seconds(2);
+
 bool IsExpectedWsPath(const http::request<http::string_body>& req) {
     return req.target() == "/ws";
 }
@@ -56,29 +56,59 @@ class WsSession : public std::enable_shared_from_this<WsSession> {
 public:
     WsSession(tcp::socket&& socket,
               std::shared_ptr<GateService> service,
-              std::shared_ptr<WebSocketHandler> ws_handler)
+              std::shared_ptr<WebSocketHandler> ws_handler,
+              std::shared_ptr<WsListener> listener)
         : ws_(std::move(socket))
         , service_(std::move(service))
         , ws_handler_(std::move(ws_handler))
-        , conn_id_(GenerateConnId()) {}
+        , listener_(std::move(listener)) {}
 
     void Run() {
         net::dispatch(ws_.get_executor(),
             beast::bind_front_handler(&WsSession::OnRun, shared_from_this()));
     }
 
-    /** async_write：供 GateService 回调，从任意线程调用，内部 post 到 strand */
-    bool Send(const std::string& data) {
-        auto self = shared_from_this();
-        net::post(ws_.get_executor(), [self, data]() {
-            self->QueueSend(data);
-        });
+    /**
+     * 供 GateService 回调，从任意线程调用。帧先进入待发列表，仅当列表由空变非空时
+     * post 一次到 strand，同一批次内的多帧由一次 DrainPending 取走（帧为共享缓冲，不拷贝）。
+     */
+    bool Send(const OutFrame& frame) {
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_.push_back(frame);
+            if (!drain_posted_) {
+                drain_posted_ = true;
+                schedule = true;
+            }
+        }
+        if (schedule) {
+            GateMetrics::Add(service_->metrics().write_batches);
+            net::post(ws_.get_executor(),
+                beast::bind_front_handler(&WsSession::DrainPending, shared_from_this()));
+        }
         return true;
     }
 
 private:
     void OnRun() {
         ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        const WsDeflateOptions& deflate = listener_->deflate_options();
+        if (deflate.enable) {
+            // 仅提供扩展，是否启用由客户端握手中的 Sec-WebSocket-Extensions 决定
+            websocket::permessage_deflate pmd;
+            pmd.server_enable = true;
+            pmd.server_max_window_bits = deflate.server_max_window_bits;
+            pmd.client_max_window_bits = deflate.client_max_window_bits;
+            pmd.server_no_context_takeover = deflate.server_no_context_takeover;
+            pmd.client_no_context_takeover = deflate.client_no_context_takeover;
+            pmd.compLevel = deflate.level;
+            pmd.memLevel = deflate.mem_level;
+#if BOOST_VERSION >= 108100
+            pmd.msg_size_threshold = deflate.min_size;
+#endif
+            ws_.set_option(pmd);
+        }
         DoReadHandshake();
     }
 
@@ -139,14 +169,23 @@ private:
         }
         // 强制使用二进制帧与客户端通信。
         ws_.binary(true);
-        service_->AddConnection(conn_id_);
-        service_->SetSendCallback(conn_id_, [self = shared_from_this()](const std::string& d) {
-            return self->Send(d);
+        handle_ = service_->AddConnection();
+        if (handle_ == kInvalidConnHandle) {
+            std::cerr << "GateSvr ws: connection slots exhausted"
+                      << ", remote=" << RemoteEndpointString(ws_) << std::endl;
+            closed_ = true;
+            beast::error_code ignored_ec;
+            ws_.close(websocket::close_code::try_again_later, ignored_ec);
+            return;
+        }
+        service_->SetSendCallback(handle_, [self = shared_from_this()](const OutFrame& f) {
+            return self->Send(f);
         });
-        service_->SetCloseCallback(conn_id_, [self = shared_from_this()]() {
+        service_->SetCloseCallback(handle_, [self = shared_from_this()]() {
             net::post(self->ws_.get_executor(), [self]() { self->Close(); });
         });
-        ws_handler_->OnConnect(conn_id_);
+        listener_->Watch(handle_);
+        ws_handler_->OnConnect(handle_);
         DoRead();
     }
 
@@ -169,34 +208,150 @@ private:
         if (ws_.got_text()) {
             std::cerr << "GateSvr ws: text frame is not supported"
                       << ", remote=" << RemoteEndpointString(ws_)
-                      << ", conn_id=" << conn_id_
+                      << ", conn_id=" << ConnHandleToString(handle_)
                       << std::endl;
             Close();
             return;
         }
         std::string data = beast::buffers_to_string(buffer_.data());
         buffer_.consume(buffer_.size());
-        ws_handler_->OnMessage(conn_id_, data);
+        ws_handler_->OnMessage(handle_, data);
         DoRead();
     }
 
-    void QueueSend(const std::string& data) {
-        if (closed_) return;
-        write_queue_.push(data);
+    /** strand 上取走待发列表，经背压策略后追加到写队列 */
+    void DrainPending() {
+        std::vector<OutFrame> batch;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            batch.swap(pending_);
+            drain_posted_ = false;
+        }
+        if (closed_ || kicking_) return;
+        for (auto& frame : batch) {
+            Enqueue(std::move(frame));
+            if (kicking_) return;
+        }
         if (!writing_) DoWrite();
     }
 
+    void Enqueue(OutFrame&& frame) {
+        const SendQueueLimits& limits = service_->send_limits();
+        GateMetrics& m = service_->metrics();
+        if (slow_ && frame.low_priority) {
+            if (limits.policy == SlowConsumerPolicy::kDrop) {
+                GateMetrics::Add(m.frames_dropped);
+                return;
+            }
+            if (limits.policy == SlowConsumerPolicy::kCoalesce && !frame.coalesce_key.empty()) {
+                auto it = coalesce_index_.find(frame.coalesce_key);
+                if (it != coalesce_index_.end()) {
+                    // 替换队列中尚未开始写的同 key 帧，保留其排队位置
+                    AdjustQueuedBytes(static_cast<int64_t>(frame.data->size())
+                                      - static_cast<int64_t>(it->second->data->size()));
+                    it->second->data = std::move(frame.data);
+                    GateMetrics::Add(m.frames_coalesced);
+                    return;
+                }
+            }
+        }
+        AdjustQueuedBytes(static_cast<int64_t>(frame.data->size()));
+        write_queue_.push_back(std::move(frame));
+        OutFrame& queued = write_queue_.back();
+        if (queued.low_priority && !queued.coalesce_key.empty())
+            coalesce_index_[queued.coalesce_key] = &queued;
+        CheckHighWater();
+    }
+
+    bool AboveHighWater() const {
+        const SendQueueLimits& limits = service_->send_limits();
+        return (limits.high_water_bytes > 0 && queued_bytes_ > limits.high_water_bytes) ||
+               (limits.high_water_frames > 0 &&
+                static_cast<int64_t>(write_queue_.size()) > limits.high_water_frames);
+    }
+
+    bool BelowLowWater() const {
+        const SendQueueLimits& limits = service_->send_limits();
+        return (limits.low_water_bytes <= 0 || queued_bytes_ <= limits.low_water_bytes) &&
+               (limits.low_water_frames <= 0 ||
+                static_cast<int64_t>(write_queue_.size()) <= limits.low_water_frames);
+    }
+
+    /** 入队后检查：越过高水位进入慢消费者状态；kick 策略或积压达 2 倍高水位时踢下线 */
+    void CheckHighWater() {
+        const SendQueueLimits& limits = service_->send_limits();
+        if (!slow_) {
+            if (!AboveHighWater()) return;
+            slow_ = true;
+            GateMetrics::Add(service_->metrics().slow_consumers, 1);
+            std::cerr << "GateSvr ws: slow consumer, queued_bytes=" << queued_bytes_
+                      << ", queued_frames=" << write_queue_.size()
+                      << ", conn_id=" << ConnHandleToString(handle_) << std::endl;
+            if (limits.policy == SlowConsumerPolicy::kKick) Kick();
+            return;
+        }
+        if ((limits.high_water_bytes > 0 && queued_bytes_ > 2 * limits.high_water_bytes) ||
+            (limits.high_water_frames > 0 &&
+             static_cast<int64_t>(write_queue_.size()) > 2 * limits.high_water_frames))
+            Kick();
+    }
+
+    void LeaveSlowState() {
+        if (!slow_) return;
+        slow_ = false;
+        GateMetrics::Add(service_->metrics().slow_consumers, -1);
+    }
+
+    void AdjustQueuedBytes(int64_t delta) {
+        queued_bytes_ += delta;
+        GateMetrics::Add(service_->metrics().bytes_queued, delta);
+    }
+
+    /**
+     * 积压踢线：丢弃尚未开始写的帧，发送 system.kicked 后关闭；
+     * 对端始终不读时由 kick_timer_ 兜底直接断开 TCP。
+     */
+    void Kick() {
+        if (kicking_ || closed_) return;
+        kicking_ = true;
+        GateMetrics::Add(service_->metrics().slow_consumer_kicks);
+        std::cerr << "GateSvr ws: kick slow consumer, queued_bytes=" << queued_bytes_
+                  << ", conn_id=" << ConnHandleToString(handle_) << std::endl;
+        coalesce_index_.clear();
+        while (write_queue_.size() > (writing_ ? 1u : 0u)) {
+            AdjustQueuedBytes(-static_cast<int64_t>(write_queue_.back().data->size()));
+            write_queue_.pop_back();
+        }
+        if (Frame kicked = service_->BuildKickedFrame("slow consumer")) {
+            AdjustQueuedBytes(static_cast<int64_t>(kicked->size()));
+            write_queue_.emplace_back(std::move(kicked));
+        }
+        kick_timer_ = std::make_unique<net::steady_timer>(ws_.get_executor(), kKickFlushTimeout);
+        kick_timer_->async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (ec || self->closed_) return;
+            beast::get_lowest_layer(self->ws_).close();
+            self->Close();
+        });
+        if (!writing_) DoWrite();
+    }
+
+    // 每个 ServerMessage 是独立的 WebSocket 消息（客户端按消息解析），故逐帧 async_write；
+    // 写完一帧紧接着写下一帧，期间不再回到跨线程投递。
     void DoWrite() {
         if (closed_ || write_queue_.empty()) return;
         writing_ = true;
-        write_buffer_ = std::move(write_queue_.front());
-        write_queue_.pop();
-        ws_.async_write(net::buffer(write_buffer_),
+        // 开始写出的帧不可再被合并替换（async_write 引用其缓冲）
+        OutFrame& head = write_queue_.front();
+        if (!head.coalesce_key.empty()) {
+            auto it = coalesce_index_.find(head.coalesce_key);
+            if (it != coalesce_index_.end() && it->second == &head)
+                coalesce_index_.erase(it);
+        }
+        ws_.async_write(net::buffer(*write_queue_.front().data),
             beast::bind_front_handler(&WsSession::OnWrite, shared_from_this()));
     }
 
     void OnWrite(beast::error_code ec, std::size_t bytes_transferred) {
-        (void)bytes_transferred;
         writing_ = false;
         if (ec) {
             if (!closed_) {
@@ -205,6 +360,18 @@ private:
             }
             return;
         }
+        if (closed_) return;
+        GateMetrics& m = service_->metrics();
+        GateMetrics::Add(m.frames_written);
+        GateMetrics::Add(m.bytes_written, bytes_transferred);
+        AdjustQueuedBytes(-static_cast<int64_t>(write_queue_.front().data->size()));
+        write_queue_.pop_front();  // 写完才释放帧引用
+        if (kicking_ && write_queue_.empty()) {
+            Close();
+            return;
+        }
+        if (slow_ && BelowLowWater())
+            LeaveSlowState();
         if (!write_queue_.empty())
             DoWrite();
     }
@@ -212,12 +379,18 @@ private:
     void Close() {
         if (closed_) return;
         closed_ = true;
-        service_->RemoveCloseCallback(conn_id_);
-        service_->RemoveSendCallback(conn_id_);
-        ws_handler_->OnDisconnect(conn_id_);
-        service_->RemoveConnection(conn_id_);
+        if (handle_ != kInvalidConnHandle) {
+            service_->RemoveCloseCallback(handle_);
+            service_->RemoveSendCallback(handle_);
+            ws_handler_->OnDisconnect(handle_);
+            service_->RemoveConnection(handle_);
+        }
+        if (kick_timer_) kick_timer_->cancel();
+        LeaveSlowState();
+        // 未写出的积压不再计入全局 bytes_queued（帧本身随会话析构释放）
+        AdjustQueuedBytes(-queued_bytes_);
         beast::error_code ec;
-        ws_.close(websocket::close_code::normal, ec);
+        ws_.close(kicking_ ? websocket::close_code::policy_error : websocket::close_code::normal, ec);
     }
 
     websocket::stream<beast::tcp_stream> ws_;
@@ -226,9 +399,18 @@ private:
     beast::flat_buffer buffer_;
     std::shared_ptr<GateService> service_;
     std::shared_ptr<WebSocketHandler> ws_handler_;
-    std::string conn_id_;
-    std::queue<std::string> write_queue_;
-    std::string write_buffer_;
+    std::shared_ptr<WsListener> listener_;    // 所属监听器（心跳时间轮）
+    ConnHandle handle_ = kInvalidConnHandle;  // OnAccept 后由 GateService 分配
+    std::mutex pending_mutex_;             // 保护 pending_ / drain_posted_（跨线程 Send）
+    std::vector<OutFrame> pending_;
+    bool drain_posted_ = false;
+    // 以下仅在 strand 上访问
+    std::deque<OutFrame> write_queue_;     // 队首为正在写的帧；deque 尾插/头删不使其余元素引用失效
+    std::unordered_map<std::string, OutFrame*> coalesce_index_;  // coalesce_key -> 队列中待写帧
+    int64_t queued_bytes_ = 0;
+    bool slow_ = false;                    // 积压越过高水位，回落到低水位以下恢复
+    bool kicking_ = false;
+    std::unique_ptr<net::steady_timer> kick_timer_;
     bool writing_ = false;
     bool closed_ = false;
 };
@@ -242,11 +424,16 @@ private:
 WsListener::WsListener(net::io_context& ioc,
                        const std::string& host, int port,
                        std::shared_ptr<GateService> service,
-                       std::shared_ptr<WebSocketHandler> ws_handler)
+                       std::shared_ptr<WebSocketHandler> ws_handler,
+                       bool reuse_port,
+                       WsDeflateOptions deflate)
     : ioc_(ioc)
-    , acceptor_(ioc)
+    , acceptor_(net::make_strand(ioc))
     , service_(std::move(service))
-    , ws_handler_(std::move(ws_handler)) {
+    , ws_handler_(std::move(ws_handler))
+    , deflate_(deflate)
+    , reap_timer_(acceptor_.get_executor())
+    , wheel_(service_->HeartbeatCheckTickMs(), TimingWheel::kDefaultSlots, NowMs()) {
     beast::error_code ec;
     std::string bind_host = host.empty() ? "0.0.0.0" : host;
     auto addr = net::ip::make_address(bind_host, ec);
@@ -262,6 +449,25 @@ WsListener::WsListener(net::io_context& ioc,
     if (ec) {
         throw std::runtime_error("acceptor set_option: " + ec.message());
     }
+    if (deflate_.enable) {
+        if (deflate_.server_max_window_bits < 9 || deflate_.server_max_window_bits > 15 ||
+            deflate_.client_max_window_bits < 9 || deflate_.client_max_window_bits > 15) {
+            throw std::runtime_error("ws_deflate window bits must be within 9..15");
+        }
+#if BOOST_VERSION < 108100
+        if (deflate_.min_size > 0) {
+            std::cerr << "GateSvr ws: ws_deflate_min_size requires Boost >= 1.81, "
+                      << "all messages will be compressed" << std::endl;
+        }
+#endif
+    }
+    if (reuse_port) {
+        using reuse_port_option = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+        acceptor_.set_option(reuse_port_option(true), ec);
+        if (ec) {
+            throw std::runtime_error("acceptor set_option SO_REUSEPORT: " + ec.message());
+        }
+    }
     acceptor_.bind(endpoint, ec);
     if (ec) {
         throw std::runtime_error("acceptor bind: " + ec.message());
@@ -276,12 +482,40 @@ WsListener::~WsListener() = default;
 
 void WsListener::Run() {
     DoAccept();
+    net::dispatch(acceptor_.get_executor(), [self = shared_from_this()]() { self->ScheduleReap(); });
 }
 
 void WsListener::Stop() {
     stopped_ = true;
-    beast::error_code ec;
-    acceptor_.close(ec);
+    // acceptor 可能正被 I/O 线程使用，关闭操作投递到其 strand 上执行
+    net::post(acceptor_.get_executor(), [self = shared_from_this()]() {
+        beast::error_code ec;
+        self->acceptor_.close(ec);
+        self->reap_timer_.cancel();
+    });
+}
+
+void WsListener::Watch(ConnHandle handle) {
+    int64_t deadline = NowMs() + service_->HeartbeatTimeoutMs();
+    net::post(acceptor_.get_executor(), [self = shared_from_this(), handle, deadline]() {
+        self->wheel_.Schedule(handle, deadline);
+    });
+}
+
+void WsListener::ScheduleReap() {
+    if (stopped_) return;
+    reap_timer_.expires_after(std::chrono::milliseconds(wheel_.tick_ms()));
+    reap_timer_.async_wait(beast::bind_front_handler(&WsListener::OnReapTick, shared_from_this()));
+}
+
+void WsListener::OnReapTick(beast::error_code ec) {
+    if (ec || stopped_) return;
+    int64_t now_ms = NowMs();
+    // 只处理到期桶：仍有心跳的连接按最新心跳重新挂入，已断开的句柄查不到会话直接移出
+    wheel_.Advance(now_ms, [this, now_ms](ConnHandle handle) {
+        return service_->ReapIfIdle(handle, now_ms);
+    });
+    ScheduleReap();
 }
 
 void WsListener::DoAccept() {
@@ -297,7 +531,7 @@ void WsListener::OnAccept(beast::error_code ec, tcp::socket socket) {
             fail(ec, "accept");
         return;
     }
-    std::make_shared<WsSession>(std::move(socket), service_, ws_handler_)->Run();
+    std::make_shared<WsSession>(std::move(socket), service_, ws_handler_, shared_from_this())->Run();
     DoAccept();
 }
 
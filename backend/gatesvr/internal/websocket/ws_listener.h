@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
+#include "../service/timing_wheel.h"
 
 namespace swift::gate {
 
@@ -16,30 +18,60 @@ namespace websocket = beast::websocket;
 namespace net = boost::asio;
 using tcp = boost::asio::ip::tcp;
 
+/** permessage-deflate 协商参数；enable=false 时不提供该扩展 */
+struct WsDeflateOptions {
+    bool enable = false;
+    int server_max_window_bits = 15;
+    int client_max_window_bits = 15;
+    bool server_no_context_takeover = false;
+    bool client_no_context_takeover = false;
+    int level = 6;
+    int mem_level = 4;
+    std::size_t min_size = 256;
+};
+
 /**
  * WebSocket 监听器：Boost.Beast 实现，接受连接并创建 Session。
  * 与 GateService、WebSocketHandler 配合完成连接生命周期管理。
+ *
+ * reuse_port=true 时设置 SO_REUSEPORT，可在同一端口上为每个 io_context 各建一个监听器，
+ * 由内核在各 accept 队列间分摊新连接（每核一个 io_context 的部署方式）。
+ *
+ * 每个监听器持有一个心跳时间轮，与 acceptor 同在一个 strand 上按 tick 推进，
+ * 只处理本监听器接入的连接；心跳超时回收因此分散在各 I/O 线程上，无全局扫描。
  */
 class WsListener : public std::enable_shared_from_this<WsListener> {
 public:
     WsListener(net::io_context& ioc,
                const std::string& host, int port,
                std::shared_ptr<GateService> service,
-               std::shared_ptr<WebSocketHandler> ws_handler);
+               std::shared_ptr<WebSocketHandler> ws_handler,
+               bool reuse_port = false,
+               WsDeflateOptions deflate = {});
     ~WsListener();
 
     void Run();
     void Stop();
 
+    /** 将已建立的连接挂入心跳时间轮（可从任意线程调用，投递到监听器 strand） */
+    void Watch(ConnHandle handle);
+
+    const WsDeflateOptions& deflate_options() const { return deflate_; }
+
 private:
     void DoAccept();
     void OnAccept(beast::error_code ec, tcp::socket socket);
+    void ScheduleReap();
+    void OnReapTick(beast::error_code ec);
 
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
     std::shared_ptr<GateService> service_;
     std::shared_ptr<WebSocketHandler> ws_handler_;
-    bool stopped_ = false;
+    std::atomic<bool> stopped_{false};
+    const WsDeflateOptions deflate_;
+    net::steady_timer reap_timer_;  // 与 acceptor_ 共用 strand
+    TimingWheel wheel_;             // 仅在 strand 上访问
 };
 
 }  // namespace swift::gate
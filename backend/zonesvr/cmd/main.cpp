@@ -5,10 +5,13 @@
  * 接入认证：若配置 internal_secret，则通过 AuthMetadataProcessor 校验 x-internal-secret（见 system.md 2.7）。
  */
 
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include <grpcpp/security/server_credentials.h>
 #include <grpcpp/server.h>
@@ -18,6 +21,7 @@
 #include "config/config.h"
 #include "handler/zone_handler.h"
 #include "interceptor/internal_secret_processor.h"
+#include "rpc/rpc_client_base.h"
 #include "service/zone_service.h"
 #include "system/system_manager.h"
 
@@ -37,6 +41,15 @@ int main(int argc, char* argv[]) {
     swift::zone::ZoneConfig config = swift::zone::LoadConfig(config_file);
 
     // Step 13：先 SystemManager Init，再组装 ZoneService / Handler，最后 ServerBuilder 先认证再 RegisterService
+    // 所有 RpcClient 的 Channel 参数，须在 SystemManager 建连之前设置
+    swift::zone::RpcChannelOptions channel;
+    channel.channels = config.rpc_channels_per_backend;
+    channel.keepalive_time_ms = config.rpc_keepalive_time_ms;
+    channel.keepalive_timeout_ms = config.rpc_keepalive_timeout_ms;
+    channel.keepalive_permit_without_calls = config.rpc_keepalive_permit_without_calls;
+    channel.reconnect_backoff_max_ms = config.rpc_reconnect_backoff_max_ms;
+    swift::zone::RpcClientBase::SetDefaultChannelOptions(channel);
+
     swift::zone::SystemManager manager;
     if (!manager.Init(config)) {
         LogError("ZoneSvr SystemManager Init failed");
@@ -46,6 +59,29 @@ int main(int argc, char* argv[]) {
     auto zone_svc = std::make_shared<swift::zone::ZoneServiceImpl>(
         manager.GetSessionStore(), &manager);
     zone_svc->BindChatPushToUser();
+
+    swift::zone::RouteCacheOptions route_cache;
+    route_cache.capacity = config.route_cache_capacity > 0 ? static_cast<size_t>(config.route_cache_capacity) : 1;
+    route_cache.ttl_ms = config.route_cache_ttl_ms;
+    zone_svc->EnableRouteCache(route_cache, config.route_cache_pubsub);
+
+    swift::zone::GroupMemberCacheOptions group_cache;
+    group_cache.capacity = config.group_cache_capacity > 0 ? static_cast<size_t>(config.group_cache_capacity) : 1;
+    group_cache.ttl_ms = config.group_cache_ttl_ms;
+    zone_svc->EnableGroupMemberCache(group_cache);
+
+    swift::zone::FanoutOptions fanout;
+    fanout.workers = config.fanout_workers;
+    fanout.max_queue = config.fanout_max_queue > 0 ? static_cast<size_t>(config.fanout_max_queue) : 1;
+    fanout.max_inflight_pushes = config.fanout_max_inflight_pushes;
+    fanout.batch_size = config.fanout_batch_size > 0 ? static_cast<size_t>(config.fanout_batch_size) : 0;
+    fanout.deadline_ms = config.fanout_deadline_ms;
+    zone_svc->StartFanout(fanout);
+
+    swift::zone::RequestExecutorOptions executor;
+    executor.workers = config.client_request_workers;
+    executor.max_queue = config.client_request_max_queue > 0 ? static_cast<size_t>(config.client_request_max_queue) : 1;
+    zone_svc->StartRequestExecutor(executor);
     auto handler = std::make_shared<swift::zone::ZoneHandler>(zone_svc);
 
     std::string addr = config.host + ":" + std::to_string(config.port);
@@ -58,6 +94,10 @@ int main(int argc, char* argv[]) {
 
     grpc::ServerBuilder builder;
     builder.AddListeningPort(addr, creds);
+    if (config.grpc_max_concurrent_streams > 0)
+        builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS, config.grpc_max_concurrent_streams);
+    // 允许 Gate 等调用方按 keepalive 间隔 PING，避免被当作 ping flood 断开
+    builder.AddChannelArgument(GRPC_ARG_HTTP2_MIN_RECV_PING_INTERVAL_WITHOUT_DATA_MS, 10000);
     LogInfo("ZoneSvr Listening on " << addr);
     // 先认证（已通过 SetAuthMetadataProcessor 注入），再注册服务
     builder.RegisterService(handler.get());
@@ -70,7 +110,42 @@ int main(int argc, char* argv[]) {
     LogInfo("ZoneSvr listening on " << addr
               << (config.internal_secret.empty() ? " (no internal auth)" : " (internal secret required)")
               );
+
+    // 周期输出扇出统计：send → push 各阶段（排队、成员解析、会话解析、推送 RPC、总耗时）延迟分布；
+    // 请求执行器排队情况；
+    // 路由缓存命中率/陈旧度，以及 Redis 连接池借出等待/命令耗时与饱和情况
+    std::atomic<bool> running{true};
+    std::thread stats_thread;
+    if (config.stats_log_interval_seconds > 0) {
+        auto store = manager.GetSessionStore();
+        stats_thread = std::thread([&running, zone_svc, store, interval = config.stats_log_interval_seconds]() {
+            auto next = std::chrono::steady_clock::now();
+            while (running) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                if (!running) break;
+                if (std::chrono::steady_clock::now() < next) continue;
+                next = std::chrono::steady_clock::now() + std::chrono::seconds(interval);
+                LogInfo("ZoneSvr fanout stats: " << zone_svc->FanoutStats());
+                LogInfo("ZoneSvr request executor stats: " << zone_svc->RequestExecutorStats());
+                std::string route_stats = zone_svc->RouteCacheStats();
+                if (!route_stats.empty())
+                    LogInfo("ZoneSvr route cache stats: " << route_stats);
+                std::string group_stats = zone_svc->GroupMemberCacheStats();
+                if (!group_stats.empty())
+                    LogInfo("ZoneSvr group member cache stats: " << group_stats);
+                std::string store_stats = store ? store->FormatStats() : std::string();
+                if (!store_stats.empty())
+                    LogInfo("ZoneSvr redis pool stats: " << store_stats);
+            }
+        });
+    }
+
     server->Wait();
+    running = false;
+    if (stats_thread.joinable())
+        stats_thread.join();
+    zone_svc->StopRequestExecutor();
+    zone_svc->StopFanout();
     manager.Shutdown();
     swift::log::Shutdown();
     return 0;
@@ -16,8 +16,34 @@ ZoneConfig LoadConfig(const std::string& config_file) {
     c.gate_svr_addr = kv.Get("gate_svr_addr", c.gate_svr_addr);
     c.session_store_type = kv.Get("session_store_type", c.session_store_type);
     c.redis_url = kv.Get("redis_url", c.redis_url);
+    c.redis_pool_size = kv.GetInt("redis_pool_size", c.redis_pool_size);
+    c.redis_pool_checkout_timeout_ms = kv.GetInt("redis_pool_checkout_timeout_ms", c.redis_pool_checkout_timeout_ms);
+    c.redis_connect_timeout_ms = kv.GetInt("redis_connect_timeout_ms", c.redis_connect_timeout_ms);
+    c.redis_command_timeout_ms = kv.GetInt("redis_command_timeout_ms", c.redis_command_timeout_ms);
+    c.redis_reconnect_backoff_min_ms = kv.GetInt("redis_reconnect_backoff_min_ms", c.redis_reconnect_backoff_min_ms);
+    c.redis_reconnect_backoff_max_ms = kv.GetInt("redis_reconnect_backoff_max_ms", c.redis_reconnect_backoff_max_ms);
+    c.redis_health_check_interval_ms = kv.GetInt("redis_health_check_interval_ms", c.redis_health_check_interval_ms);
     c.session_expire_seconds = kv.GetInt("session_expire_seconds", c.session_expire_seconds);
     c.gate_heartbeat_timeout = kv.GetInt("gate_heartbeat_timeout", c.gate_heartbeat_timeout);
+    c.route_cache_capacity = kv.GetInt("route_cache_capacity", c.route_cache_capacity);
+    c.route_cache_ttl_ms = kv.GetInt("route_cache_ttl_ms", c.route_cache_ttl_ms);
+    c.route_cache_pubsub = kv.GetBool("route_cache_pubsub", c.route_cache_pubsub);
+    c.group_cache_capacity = kv.GetInt("group_cache_capacity", c.group_cache_capacity);
+    c.group_cache_ttl_ms = kv.GetInt("group_cache_ttl_ms", c.group_cache_ttl_ms);
+    c.fanout_workers = kv.GetInt("fanout_workers", c.fanout_workers);
+    c.fanout_max_queue = kv.GetInt("fanout_max_queue", c.fanout_max_queue);
+    c.fanout_max_inflight_pushes = kv.GetInt("fanout_max_inflight_pushes", c.fanout_max_inflight_pushes);
+    c.fanout_batch_size = kv.GetInt("fanout_batch_size", c.fanout_batch_size);
+    c.fanout_deadline_ms = kv.GetInt("fanout_deadline_ms", c.fanout_deadline_ms);
+    c.rpc_channels_per_backend = kv.GetInt("rpc_channels_per_backend", c.rpc_channels_per_backend);
+    c.rpc_keepalive_time_ms = kv.GetInt("rpc_keepalive_time_ms", c.rpc_keepalive_time_ms);
+    c.rpc_keepalive_timeout_ms = kv.GetInt("rpc_keepalive_timeout_ms", c.rpc_keepalive_timeout_ms);
+    c.rpc_keepalive_permit_without_calls = kv.GetBool("rpc_keepalive_permit_without_calls", c.rpc_keepalive_permit_without_calls);
+    c.rpc_reconnect_backoff_max_ms = kv.GetInt("rpc_reconnect_backoff_max_ms", c.rpc_reconnect_backoff_max_ms);
+    c.grpc_max_concurrent_streams = kv.GetInt("grpc_max_concurrent_streams", c.grpc_max_concurrent_streams);
+    c.client_request_workers = kv.GetInt("client_request_workers", c.client_request_workers);
+    c.client_request_max_queue = kv.GetInt("client_request_max_queue", c.client_request_max_queue);
+    c.stats_log_interval_seconds = kv.GetInt("stats_log_interval_seconds", c.stats_log_interval_seconds);
     c.log_dir = kv.Get("log_dir", c.log_dir);
     c.log_level = kv.Get("log_level", c.log_level);
     c.internal_secret = kv.Get("internal_secret", c.internal_secret);
@@ -19,6 +19,14 @@ struct ZoneConfig {
     // 会话存储配置
     std::string session_store_type = "redis";  // memory / redis
     std::string redis_url = "redis://localhost:6379";
+    // Redis 连接池（session_store_type=redis 时生效）
+    int redis_pool_size = 8;
+    int redis_pool_checkout_timeout_ms = 200;
+    int redis_connect_timeout_ms = 500;
+    int redis_command_timeout_ms = 1000;
+    int redis_reconnect_backoff_min_ms = 100;
+    int redis_reconnect_backoff_max_ms = 5000;
+    int redis_health_check_interval_ms = 30000;
 
     // 会话过期时间（秒）
     int session_expire_seconds = 3600;
@@ -26,6 +34,36 @@ struct ZoneConfig {
     // Gate 心跳超时（秒）
     int gate_heartbeat_timeout = 30;
 
+    // 用户→Gate 路由近端缓存：命中时 RouteToUser/群推送不再访问 SessionStore
+    int route_cache_capacity = 100000;
+    int route_cache_ttl_ms = 5000;         // <=0 关闭；未开启 pubsub 时即最大陈旧时间
+    bool route_cache_pubsub = false;       // 通过 Redis pub/sub 接收其他副本的上线/下线做失效（仅 redis 存储）
+
+    // 群成员缓存：群推送命中时不再调 ChatSvr GetGroupMembers；本服务处理的邀请/移除/退群/解散即时修补
+    int group_cache_capacity = 10000;      // 缓存的群数
+    int group_cache_ttl_ms = 30000;        // <=0 关闭；其他副本上的成员变更最多延迟该时间可见
+
+    // 群聊推送扇出引擎（发送者先回包，成员/会话解析与各 Gate 推送在后台并发完成）
+    int fanout_workers = 2;                // 工作线程数
+    int fanout_max_queue = 10000;          // 待处理任务上限，满时放弃实时推送（消息已落库，可拉取离线）
+    int fanout_max_inflight_pushes = 32;   // 全局同时在途的 Gate 推送 RPC 数
+    int fanout_batch_size = 500;           // 单次推送给同一 Gate 的最大用户数
+    int fanout_deadline_ms = 3000;         // 从入队起算的截止时间，剩余时间作为推送 RPC 超时
+
+    // 后端/Gate gRPC 连接：每个地址多条连接轮询使用，keepalive 及早发现半开连接
+    int rpc_channels_per_backend = 2;
+    int rpc_keepalive_time_ms = 60000;
+    int rpc_keepalive_timeout_ms = 20000;
+    bool rpc_keepalive_permit_without_calls = false;  // 需对端允许无调用时的 PING
+    int rpc_reconnect_backoff_max_ms = 5000;
+    // 本服务 gRPC 服务端：单连接最大并发流数（<=0 使用 gRPC 默认）
+    int grpc_max_concurrent_streams = 0;
+
+    // HandleClientRequest 异步处理：chat.send_message/mark_read 走异步后端调用，其余命令在工作线程上同步执行
+    int client_request_workers = 16;       // 工作线程数（同时进行的同步后端调用上限）
+    int client_request_max_queue = 10000;  // 排队上限，满时回 SERVICE_UNAVAILABLE
+    int stats_log_interval_seconds = 60;   // 扇出/Redis 连接池统计（含延迟直方图）日志间隔，<=0 关闭
+
     std::string log_dir = "/data/logs";
     std::string log_level = "INFO";
 
@@ -6,6 +6,7 @@
 #include "zone_handler.h"
 #include "../service/zone_service.h"
 #include <swift/error_code.h>
+#include <unordered_map>
 
 namespace swift::zone {
 
@@ -22,6 +23,7 @@ ZoneHandler::~ZoneHandler() = default;
     bool ok = service_->UserOnline(
         request->user_id(),
         request->gate_id(),
+        request->conn_id(),
         request->device_type(),
         request->device_id());
     response->set_code(ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
@@ -35,7 +37,7 @@ ZoneHandler::~ZoneHandler() = default;
                                         ::swift::common::CommonResponse* response) {
     (void)context;
     if (!request || !response) return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response");
-    bool ok = service_->UserOffline(request->user_id(), request->gate_id());
+    bool ok = service_->UserOffline(request->user_id(), request->gate_id(), request->conn_id());
     response->set_code(ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
                          : swift::ErrorCodeToInt(swift::ErrorCode::INTERNAL_ERROR));
     if (!ok) response->set_message(swift::ErrorCodeToString(swift::ErrorCode::INTERNAL_ERROR));
@@ -77,15 +79,22 @@ ZoneHandler::~ZoneHandler() = default;
                                          ::swift::zone::GetUserStatusResponse* response) {
     (void)context;
     if (!request || !response) return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response");
-    for (const auto& uid : request->user_ids()) {
+    // 一次批量查询（Redis 管道），按 user_id 回填；未查到的用户视为离线
+    std::vector<std::string> user_ids(request->user_ids().begin(), request->user_ids().end());
+    std::unordered_map<std::string, UserSession> online;
+    for (auto& session : service_->GetUserStatuses(user_ids)) {
+        std::string uid = session.user_id;
+        online.emplace(std::move(uid), std::move(session));
+    }
+    for (const auto& uid : user_ids) {
         auto* s = response->add_statuses();
         s->set_user_id(uid);
-        auto opt = service_->GetUserSession(uid);
-        if (opt) {
+        auto it = online.find(uid);
+        if (it != online.end()) {
             s->set_online(true);
-            s->set_gate_id(opt->gate_id);
-            s->set_device_type(opt->device_type);
-            s->set_last_active_at(opt->last_active_at);
+            s->set_gate_id(it->second.gate_id);
+            s->set_device_type(it->second.device_type);
+            s->set_last_active_at(it->second.last_active_at);
         } else {
             s->set_online(false);
         }
@@ -152,24 +161,35 @@ ZoneHandler::~ZoneHandler() = default;
     return ::grpc::Status::OK;
 }
 
-::grpc::Status ZoneHandler::HandleClientRequest(::grpc::ServerContext* context,
-                                                const ::swift::zone::HandleClientRequestRequest* request,
-                                                ::swift::zone::HandleClientRequestResponse* response) {
-    (void)context;
-    if (!request || !response) return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response");
-    std::string payload(request->payload().begin(), request->payload().end());
-    auto result = service_->HandleClientRequest(
+::grpc::ServerUnaryReactor* ZoneHandler::HandleClientRequest(
+    ::grpc::CallbackServerContext* context,
+    const ::swift::zone::HandleClientRequestRequest* request,
+    ::swift::zone::HandleClientRequestResponse* response) {
+    auto* reactor = context->DefaultReactor();
+    if (!request || !response) {
+        reactor->Finish(::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "null request/response"));
+        return reactor;
+    }
+    // Gate 已解析 cmd_id；直连的老调用方只带 cmd 字符串时在此查回。只带 cmd_id 时补齐 cmd 供日志使用
+    swift::CmdId cmd_id = swift::ResolveCmd(request->cmd_id(), request->cmd());
+    std::string cmd = request->cmd().empty() ? std::string(swift::CmdName(cmd_id)) : request->cmd();
+    // response 由 gRPC 持有到 Finish 为止；done 只调用一次
+    service_->HandleClientRequestAsync(
         request->conn_id(),
         request->user_id(),
-        request->cmd(),
-        payload,
+        cmd_id,
+        cmd,
+        std::string(request->payload().begin(), request->payload().end()),
         request->request_id(),
-        request->token());
-    response->set_code(result.code);
-    if (!result.message.empty()) response->set_message(result.message);
-    if (!result.payload.empty()) response->set_payload(result.payload);
-    if (!result.request_id.empty()) response->set_request_id(result.request_id);
-    return ::grpc::Status::OK;
+        request->token(),
+        [reactor, response](ZoneServiceImpl::HandleClientRequestResult result) {
+            response->set_code(result.code);
+            if (!result.message.empty()) response->set_message(result.message);
+            if (!result.payload.empty()) response->set_payload(std::move(result.payload));
+            if (!result.request_id.empty()) response->set_request_id(result.request_id);
+            reactor->Finish(::grpc::Status::OK);
+        });
+    return reactor;
 }
 
 }  // namespace swift::zone
@@ -3,6 +3,7 @@
  * @brief ZoneService gRPC 服务实现
  *
  * 继承 proto 生成的 ZoneService::Service，将每个 RPC 委托给 ZoneService 业务类。
+ * HandleClientRequest 使用 gRPC callback API（WithCallbackMethod），其余 RPC 仍为同步处理。
  */
 
 #pragma once
@@ -14,11 +15,14 @@ namespace swift::zone {
 
 class ZoneServiceImpl;
 
+using ZoneServiceBase =
+    swift::zone::ZoneService::WithCallbackMethod_HandleClientRequest<swift::zone::ZoneService::Service>;
+
 /**
  * ZoneHandler 实现 proto 定义的 ZoneService，每个 RPC 解析 request、
  * 调用 ZoneServiceImpl 对应方法、将结果写入 response、返回 Status::OK。
  */
-class ZoneHandler : public swift::zone::ZoneService::Service {
+class ZoneHandler : public ZoneServiceBase {
 public:
     explicit ZoneHandler(std::shared_ptr<ZoneServiceImpl> service);
     ~ZoneHandler() override;
@@ -59,10 +63,11 @@ public:
                                  const ::swift::zone::GateHeartbeatRequest* request,
                                  ::swift::common::CommonResponse* response) override;
 
-    /// 客户端业务请求统一入口：按 cmd 分发到各 System，各 System 通过 gRPC 调后端
-    ::grpc::Status HandleClientRequest(::grpc::ServerContext* context,
-                                       const ::swift::zone::HandleClientRequestRequest* request,
-                                       ::swift::zone::HandleClientRequestResponse* response) override;
+    /// 客户端业务请求统一入口：按 cmd 分发到各 System，各 System 通过 gRPC 调后端。
+    /// 异步处理：立即返回 reactor，后端回包后 Finish，不占用 gRPC 线程等待后端
+    ::grpc::ServerUnaryReactor* HandleClientRequest(::grpc::CallbackServerContext* context,
+                                                    const ::swift::zone::HandleClientRequestRequest* request,
+                                                    ::swift::zone::HandleClientRequestResponse* response) override;
 
 private:
     std::shared_ptr<ZoneServiceImpl> service_;
@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void AuthRpcClient::InitStub() {
-    stub_ = swift::auth::AuthService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 bool AuthRpcClient::Register(const std::string& username,
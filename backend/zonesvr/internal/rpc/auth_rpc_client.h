@@ -59,7 +59,7 @@ public:
                      std::string* out_error, const std::string& token = "");
 
 private:
-    std::unique_ptr<swift::auth::AuthService::Stub> stub_;
+    StubPool<swift::auth::AuthService> stub_;
 };
 
 }  // namespace zone
@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void ChatRpcClient::InitStub() {
-    stub_ = swift::chat::ChatService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 static ChatMessageResult FromProto(const swift::chat::ChatMessage& m) {
@@ -26,15 +26,11 @@ static ChatMessageResult FromProto(const swift::chat::ChatMessage& m) {
     return r;
 }
 
-SendMessageResult ChatRpcClient::SendMessage(const std::string& from_user_id, const std::string& to_id,
-                                             int32_t chat_type, const std::string& content,
-                                             const std::string& media_url, const std::string& media_type,
-                                             const std::vector<std::string>& mentions,
-                                             const std::string& reply_to_msg_id,
-                                             const std::string& client_msg_id, int64_t file_size,
-                                             const std::string& token) {
-    SendMessageResult result;
-    if (!stub_) return result;
+static swift::chat::SendMessageRequest BuildSendMessageRequest(
+    const std::string& from_user_id, const std::string& to_id, int32_t chat_type,
+    const std::string& content, const std::string& media_url, const std::string& media_type,
+    const std::vector<std::string>& mentions, const std::string& reply_to_msg_id,
+    const std::string& client_msg_id, int64_t file_size) {
     swift::chat::SendMessageRequest req;
     req.set_from_user_id(from_user_id);
     req.set_to_id(to_id);
@@ -46,9 +42,12 @@ SendMessageResult ChatRpcClient::SendMessage(const std::string& from_user_id, co
     if (!reply_to_msg_id.empty()) req.set_reply_to_msg_id(reply_to_msg_id);
     if (!client_msg_id.empty()) req.set_client_msg_id(client_msg_id);
     if (file_size > 0) req.set_file_size(file_size);
-    swift::chat::SendMessageResponse resp;
-    auto ctx = CreateContext(10000, token);
-    grpc::Status status = stub_->SendMessage(ctx.get(), req, &resp);
+    return req;
+}
+
+static SendMessageResult ToSendMessageResult(const grpc::Status& status,
+                                             const swift::chat::SendMessageResponse& resp) {
+    SendMessageResult result;
     if (!status.ok()) {
         result.error = status.error_message();
         return result;
@@ -60,9 +59,73 @@ SendMessageResult ChatRpcClient::SendMessage(const std::string& from_user_id, co
     result.success = true;
     result.msg_id = resp.msg_id();
     result.timestamp = resp.timestamp();
+    result.duplicate = resp.duplicate();
     return result;
 }
 
+static swift::chat::MarkReadRequest BuildMarkReadRequest(const std::string& user_id,
+                                                         const std::string& chat_id, int32_t chat_type,
+                                                         const std::string& last_msg_id) {
+    swift::chat::MarkReadRequest req;
+    req.set_user_id(user_id);
+    req.set_chat_id(chat_id);
+    req.set_chat_type(chat_type);
+    if (!last_msg_id.empty()) req.set_last_msg_id(last_msg_id);
+    return req;
+}
+
+static bool ToMarkReadResult(const grpc::Status& status, const swift::chat::MarkReadResponse& resp,
+                             std::string* out_error) {
+    if (!status.ok()) {
+        if (out_error) *out_error = status.error_message();
+        return false;
+    }
+    if (resp.code() != 0 && out_error)
+        *out_error = resp.message().empty() ? "mark read failed" : resp.message();
+    return resp.code() == 0;
+}
+
+SendMessageResult ChatRpcClient::SendMessage(const std::string& from_user_id, const std::string& to_id,
+                                             int32_t chat_type, const std::string& content,
+                                             const std::string& media_url, const std::string& media_type,
+                                             const std::vector<std::string>& mentions,
+                                             const std::string& reply_to_msg_id,
+                                             const std::string& client_msg_id, int64_t file_size,
+                                             const std::string& token) {
+    if (!stub_) return SendMessageResult{};
+    auto req = BuildSendMessageRequest(from_user_id, to_id, chat_type, content, media_url, media_type,
+                                       mentions, reply_to_msg_id, client_msg_id, file_size);
+    swift::chat::SendMessageResponse resp;
+    auto ctx = CreateContext(10000, token);
+    grpc::Status status = stub_->SendMessage(ctx.get(), req, &resp);
+    return ToSendMessageResult(status, resp);
+}
+
+void ChatRpcClient::SendMessageAsync(const std::string& from_user_id, const std::string& to_id,
+                                     int32_t chat_type, const std::string& content,
+                                     const std::string& media_url, const std::string& media_type,
+                                     const std::vector<std::string>& mentions,
+                                     const std::string& reply_to_msg_id,
+                                     const std::string& client_msg_id, int64_t file_size,
+                                     const std::string& token, SendMessageCallback done) {
+    if (!stub_) {
+        SendMessageResult result;
+        result.error = "stub not initialized";
+        if (done) done(result);
+        return;
+    }
+    AsyncUnary<swift::chat::SendMessageResponse>(
+        BuildSendMessageRequest(from_user_id, to_id, chat_type, content, media_url, media_type,
+                                mentions, reply_to_msg_id, client_msg_id, file_size),
+        10000, token,
+        [this](auto* ctx, auto* req, auto* resp, auto cb) {
+            stub_->async()->SendMessage(ctx, req, resp, std::move(cb));
+        },
+        [done = std::move(done)](const grpc::Status& status, swift::chat::SendMessageResponse& resp) {
+            if (done) done(ToSendMessageResult(status, resp));
+        });
+}
+
 bool ChatRpcClient::RecallMessage(const std::string& msg_id, const std::string& user_id,
                                   std::string* out_error, const std::string& token) {
     if (!stub_) return false;
@@ -200,21 +263,30 @@ bool ChatRpcClient::MarkRead(const std::string& user_id, const std::string& chat
                              const std::string& last_msg_id, std::string* out_error,
                              const std::string& token) {
     if (!stub_) return false;
-    swift::chat::MarkReadRequest req;
-    req.set_user_id(user_id);
-    req.set_chat_id(chat_id);
-    req.set_chat_type(chat_type);
-    if (!last_msg_id.empty()) req.set_last_msg_id(last_msg_id);
+    auto req = BuildMarkReadRequest(user_id, chat_id, chat_type, last_msg_id);
     swift::chat::MarkReadResponse resp;
     auto ctx = CreateContext(5000, token);
     grpc::Status status = stub_->MarkRead(ctx.get(), req, &resp);
-    if (!status.ok()) {
-        if (out_error) *out_error = status.error_message();
-        return false;
+    return ToMarkReadResult(status, resp, out_error);
+}
+
+void ChatRpcClient::MarkReadAsync(const std::string& user_id, const std::string& chat_id,
+                                  int32_t chat_type, const std::string& last_msg_id,
+                                  const std::string& token, MarkReadCallback done) {
+    if (!stub_) {
+        if (done) done(false, "stub not initialized");
+        return;
     }
-    if (resp.code() != 0 && out_error)
-        *out_error = resp.message().empty() ? "mark read failed" : resp.message();
-    return resp.code() == 0;
+    AsyncUnary<swift::chat::MarkReadResponse>(
+        BuildMarkReadRequest(user_id, chat_id, chat_type, last_msg_id), 5000, token,
+        [this](auto* ctx, auto* req, auto* resp, auto cb) {
+            stub_->async()->MarkRead(ctx, req, resp, std::move(cb));
+        },
+        [done = std::move(done)](const grpc::Status& status, swift::chat::MarkReadResponse& resp) {
+            std::string err;
+            bool ok = ToMarkReadResult(status, resp, &err);
+            if (done) done(ok, err);
+        });
 }
 
 }  // namespace zone
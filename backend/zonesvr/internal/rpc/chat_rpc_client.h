@@ -7,6 +7,7 @@
 
 #include "rpc_client_base.h"
 #include "chat.grpc.pb.h"
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -32,6 +33,7 @@ struct SendMessageResult {
     std::string msg_id;
     int64_t timestamp = 0;
     std::string error;
+    bool duplicate = false;  // client_msg_id 重试命中，消息已在首次发送时推送过
 };
 
 struct ConversationResult {
@@ -65,6 +67,15 @@ public:
                                   const std::string& reply_to_msg_id,
                                   const std::string& client_msg_id, int64_t file_size,
                                   const std::string& token = "");
+    /// SendMessage 的异步版本：不阻塞调用线程，done 在 gRPC 回调线程上调用一次
+    using SendMessageCallback = std::function<void(const SendMessageResult&)>;
+    void SendMessageAsync(const std::string& from_user_id, const std::string& to_id,
+                          int32_t chat_type, const std::string& content,
+                          const std::string& media_url, const std::string& media_type,
+                          const std::vector<std::string>& mentions,
+                          const std::string& reply_to_msg_id,
+                          const std::string& client_msg_id, int64_t file_size,
+                          const std::string& token, SendMessageCallback done);
     bool RecallMessage(const std::string& msg_id, const std::string& user_id, std::string* out_error,
                        const std::string& token = "");
     bool PullOffline(const std::string& user_id, int32_t limit, const std::string& cursor,
@@ -81,9 +92,13 @@ public:
                             std::string* out_error, const std::string& token = "");
     bool MarkRead(const std::string& user_id, const std::string& chat_id, int32_t chat_type,
                   const std::string& last_msg_id, std::string* out_error, const std::string& token = "");
+    /// MarkRead 的异步版本；失败时 error 非空
+    using MarkReadCallback = std::function<void(bool ok, const std::string& error)>;
+    void MarkReadAsync(const std::string& user_id, const std::string& chat_id, int32_t chat_type,
+                       const std::string& last_msg_id, const std::string& token, MarkReadCallback done);
 
 private:
-    std::unique_ptr<swift::chat::ChatService::Stub> stub_;
+    StubPool<swift::chat::ChatService> stub_;
 };
 
 }  // namespace zone
@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void FileRpcClient::InitStub() {
-    stub_ = swift::file::FileService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 InitUploadResult FileRpcClient::InitUpload(const std::string& user_id, const std::string& file_name,
@@ -72,7 +72,7 @@ public:
     bool DeleteFile(const std::string& file_id, const std::string& user_id, std::string* out_error);
 
 private:
-    std::unique_ptr<swift::file::FileService::Stub> stub_;
+    StubPool<swift::file::FileService> stub_;
 };
 
 }  // namespace zone
@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void FriendRpcClient::InitStub() {
-    stub_ = swift::relation::FriendService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 bool FriendRpcClient::AddFriend(const std::string& user_id, const std::string& friend_id,
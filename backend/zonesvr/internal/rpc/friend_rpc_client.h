@@ -94,7 +94,7 @@ public:
                    const std::string& token = "");
 
 private:
-    std::unique_ptr<swift::relation::FriendService::Stub> stub_;
+    StubPool<swift::relation::FriendService> stub_;
 };
 
 }  // namespace zone
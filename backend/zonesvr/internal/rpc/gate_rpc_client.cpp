@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void GateRpcClient::InitStub() {
-    stub_ = swift::gate::GateInternalService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 /**
@@ -39,6 +39,62 @@ bool GateRpcClient::PushMessage(const std::string& user_id, const std::string& c
     return resp.code() == 0;
 }
 
+bool GateRpcClient::BatchPushMessage(const std::vector<std::string>& user_ids,
+                                     const std::string& cmd, const std::string& payload,
+                                     int* delivered, std::vector<std::string>* offline,
+                                     std::string* out_error) {
+    if (!stub_) return false;
+    swift::gate::BatchPushMessageRequest req;
+    for (const auto& u : user_ids) req.add_user_ids(u);
+    req.set_cmd(cmd);
+    req.set_payload(payload);
+    swift::gate::BatchPushMessageResponse resp;
+    auto ctx = CreateContext(5000);
+    grpc::Status status = stub_->BatchPushMessage(ctx.get(), req, &resp);
+    if (!status.ok()) {
+        if (out_error) *out_error = status.error_message();
+        return false;
+    }
+    if (resp.code() != 0) {
+        if (out_error) *out_error = resp.message().empty() ? "batch push failed" : resp.message();
+        return false;
+    }
+    if (delivered) *delivered = resp.delivered_count();
+    if (offline)
+        offline->insert(offline->end(), resp.offline_user_ids().begin(), resp.offline_user_ids().end());
+    return true;
+}
+
+void GateRpcClient::BatchPushMessageAsync(const std::vector<std::string>& user_ids,
+                                          const std::string& cmd, const std::string& payload,
+                                          int timeout_ms, BatchPushCallback done) {
+    if (!stub_) {
+        if (done) done(false, 0, {}, "stub not initialized");
+        return;
+    }
+    swift::gate::BatchPushMessageRequest req;
+    for (const auto& u : user_ids) req.add_user_ids(u);
+    req.set_cmd(cmd);
+    req.set_payload(payload);
+    AsyncUnary<swift::gate::BatchPushMessageResponse>(std::move(req), timeout_ms, "",
+        [this](auto* ctx, auto* req, auto* resp, auto cb) {
+            stub_->async()->BatchPushMessage(ctx, req, resp, std::move(cb));
+        },
+        [done = std::move(done)](const grpc::Status& status, swift::gate::BatchPushMessageResponse& resp) {
+            if (!done) return;
+            if (!status.ok()) {
+                done(false, 0, {}, status.error_message());
+                return;
+            }
+            if (resp.code() != 0) {
+                done(false, 0, {}, resp.message().empty() ? "batch push failed" : resp.message());
+                return;
+            }
+            std::vector<std::string> offline(resp.offline_user_ids().begin(), resp.offline_user_ids().end());
+            done(true, resp.delivered_count(), offline, "");
+        });
+}
+
 bool GateRpcClient::DisconnectUser(const std::string& user_id, const std::string& reason,
                                    std::string* out_error) {
     if (!stub_) return false;
@@ -9,8 +9,10 @@
 
 #include "rpc_client_base.h"
 #include "gate.grpc.pb.h"
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace swift {
 namespace zone {
@@ -32,11 +34,24 @@ public:
     bool PushMessage(const std::string& user_id, const std::string& cmd,
                      const std::string& payload, std::string* out_error);
 
+    /// 同一消息批量推送给该 Gate 上的多个用户；delivered 为投递成功数，offline 追加 Gate 上已无连接的用户
+    bool BatchPushMessage(const std::vector<std::string>& user_ids, const std::string& cmd,
+                          const std::string& payload, int* delivered,
+                          std::vector<std::string>* offline, std::string* out_error);
+
+    /// BatchPushMessage 的异步版本（gRPC callback API），不阻塞调用线程；done 在 gRPC 线程上调用一次，
+    /// offline 为 Gate 上已无连接的用户
+    using BatchPushCallback = std::function<void(bool ok, int delivered,
+                                                 const std::vector<std::string>& offline,
+                                                 const std::string& error)>;
+    void BatchPushMessageAsync(const std::vector<std::string>& user_ids, const std::string& cmd,
+                               const std::string& payload, int timeout_ms, BatchPushCallback done);
+
     /// 断开用户连接
     bool DisconnectUser(const std::string& user_id, const std::string& reason, std::string* out_error);
 
 private:
-    std::unique_ptr<swift::gate::GateInternalService::Stub> stub_;
+    StubPool<swift::gate::GateInternalService> stub_;
 };
 
 }  // namespace zone
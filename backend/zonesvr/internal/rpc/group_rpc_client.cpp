@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void GroupRpcClient::InitStub() {
-    stub_ = swift::group::GroupService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 CreateGroupResult GroupRpcClient::CreateGroup(const std::string& creator_id,
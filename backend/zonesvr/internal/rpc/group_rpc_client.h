@@ -66,7 +66,7 @@ public:
                        const std::string& new_owner_id, std::string* out_error);
 
 private:
-    std::unique_ptr<swift::group::GroupService::Stub> stub_;
+    StubPool<swift::group::GroupService> stub_;
 };
 
 }  // namespace zone
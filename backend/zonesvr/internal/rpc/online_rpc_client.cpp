@@ -9,7 +9,7 @@ namespace swift {
 namespace zone {
 
 void OnlineRpcClient::InitStub() {
-    stub_ = swift::online::OnlineService::NewStub(GetChannel());
+    stub_.Init(GetChannels());
 }
 
 OnlineLoginResult OnlineRpcClient::Login(const std::string& user_id,
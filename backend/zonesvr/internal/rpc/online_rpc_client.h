@@ -52,7 +52,7 @@ public:
     OnlineTokenResult ValidateToken(const std::string& token);
 
 private:
-    std::unique_ptr<swift::online::OnlineService::Stub> stub_;
+    StubPool<swift::online::OnlineService> stub_;
 };
 
 }  // namespace zone
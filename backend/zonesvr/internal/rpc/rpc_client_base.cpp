@@ -9,33 +9,65 @@
 namespace swift {
 namespace zone {
 
+namespace {
+RpcChannelOptions& DefaultOptionsStorage() {
+    static RpcChannelOptions options;
+    return options;
+}
+}  // namespace
+
+void RpcClientBase::SetDefaultChannelOptions(const RpcChannelOptions& options) {
+    DefaultOptionsStorage() = options;
+}
+
+const RpcChannelOptions& RpcClientBase::DefaultChannelOptions() {
+    return DefaultOptionsStorage();
+}
+
 bool RpcClientBase::Connect(const std::string& address, bool wait_ready) {
     address_ = address;
+    channels_.clear();
+    const RpcChannelOptions& opts = DefaultChannelOptions();
+    int n = opts.channels > 0 ? opts.channels : 1;
 
-    grpc::ChannelArguments args;
-    args.SetMaxReceiveMessageSize(64 * 1024 * 1024);  // 64MB
-    args.SetMaxSendMessageSize(64 * 1024 * 1024);
-
-    channel_ = grpc::CreateCustomChannel(
-        address,
-        grpc::InsecureChannelCredentials(),
-        args
-    );
+    for (int i = 0; i < n; ++i) {
+        grpc::ChannelArguments args;
+        args.SetMaxReceiveMessageSize(64 * 1024 * 1024);  // 64MB
+        args.SetMaxSendMessageSize(64 * 1024 * 1024);
+        args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, opts.keepalive_time_ms);
+        args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, opts.keepalive_timeout_ms);
+        args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, opts.keepalive_permit_without_calls ? 1 : 0);
+        args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, opts.reconnect_backoff_max_ms);
+        // 参数相同的 Channel 会共用全局 subchannel（即同一条 TCP 连接）；
+        // 本地 subchannel 池 + 互不相同的序号保证每条 Channel 各自建连
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+        args.SetInt("swift.channel_index", i);
+        channels_.push_back(grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args));
+    }
 
-    if (!wait_ready) return true;
-    auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(5);
-    return channel_->WaitForConnected(deadline);
+    if (!wait_ready) {
+        // 立即在后台发起连接，首个请求不必再等握手
+        for (auto& ch : channels_) ch->GetState(true);
+        return true;
+    }
+    auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(opts.connect_wait_ms);
+    for (auto& ch : channels_) {
+        if (!ch->WaitForConnected(deadline)) return false;
+    }
+    return true;
 }
 
 void RpcClientBase::Disconnect() {
-    channel_.reset();
+    channels_.clear();
     address_.clear();
 }
 
 bool RpcClientBase::IsConnected() const {
-    if (!channel_) return false;
-    auto state = channel_->GetState(false);
-    return state == GRPC_CHANNEL_READY || state == GRPC_CHANNEL_IDLE;
+    for (const auto& ch : channels_) {
+        auto state = ch->GetState(false);
+        if (state == GRPC_CHANNEL_READY || state == GRPC_CHANNEL_IDLE) return true;
+    }
+    return false;
 }
 
 std::unique_ptr<grpc::ClientContext> RpcClientBase::CreateContext(int timeout_ms,
@@ -3,21 +3,63 @@
  * @brief gRPC 客户端基类
  * 
  * 封装 gRPC 通用功能：
- * - Channel 管理
+ * - Channel 管理（每个后端地址一组独立连接，按调用轮询）
+ * - keepalive 与重连退避参数
  * - 连接状态监控
  * - 超时设置
  * - 重试策略
+ * - 异步一元调用（gRPC callback API，回调在 gRPC 内部共享的完成队列线程上执行）
  */
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <grpcpp/grpcpp.h>
 
 namespace swift {
 namespace zone {
 
+/**
+ * Channel 参数（见 zonesvr.conf.example 中 rpc_*）
+ */
+struct RpcChannelOptions {
+    int channels = 2;                             // 每个后端地址的连接数；单条 HTTP/2 连接的并发流受对端 max_concurrent_streams 限制
+    int keepalive_time_ms = 60000;                // 连接上有调用时的 PING 间隔，及早发现半开连接
+    int keepalive_timeout_ms = 20000;             // PING 无响应多久判定连接失效
+    bool keepalive_permit_without_calls = false;  // 无调用时也 PING（需对端允许，否则会被 GOAWAY）
+    int reconnect_backoff_max_ms = 5000;          // 断线后 gRPC 内部重连退避上限
+    int connect_wait_ms = 5000;                   // Connect(wait_ready=true) 等待就绪的上限
+};
+
+/**
+ * 同一后端的多个 Stub，各自绑定一条 Channel，每次调用轮询取一个，使 HTTP/2 流分散到多条连接。
+ * 用法与 std::unique_ptr<Stub> 相同：stub_->Method(...)、if (!stub_)。
+ */
+template <typename Service>
+class StubPool {
+public:
+    void Init(const std::vector<std::shared_ptr<grpc::Channel>>& channels) {
+        stubs_.clear();
+        for (const auto& ch : channels) stubs_.push_back(Service::NewStub(ch));
+    }
+
+    explicit operator bool() const { return !stubs_.empty(); }
+
+    typename Service::Stub* operator->() {
+        size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        return stubs_[i % stubs_.size()].get();
+    }
+
+private:
+    std::vector<std::unique_ptr<typename Service::Stub>> stubs_;
+    std::atomic<size_t> next_{0};
+};
+
 /**
  * @class RpcClientBase
  * @brief gRPC 客户端基类
@@ -26,29 +68,64 @@ class RpcClientBase {
 public:
     virtual ~RpcClientBase() = default;
 
-    /// 连接到服务；wait_ready=false 时仅创建 channel 不等待就绪（用于 standalone 测试）
+    /// 进程级默认 Channel 参数，须在任何 Connect 之前（启动时）设置一次
+    static void SetDefaultChannelOptions(const RpcChannelOptions& options);
+    static const RpcChannelOptions& DefaultChannelOptions();
+
+    /// 连接到服务；wait_ready=false 时仅创建 channel 并在后台发起连接，不阻塞调用线程
+    /// （请求路径上按需创建客户端、standalone 测试均应使用 false）
     bool Connect(const std::string& address, bool wait_ready = true);
 
     /// 断开连接
     void Disconnect();
 
-    /// 检查连接状态
+    /// 检查连接状态：任一 Channel 为 READY/IDLE 即视为可用。
+    /// 断线后 Channel 会自行重连，调用方无需因暂时不可用而重建客户端
     bool IsConnected() const;
 
     /// 获取服务地址
     const std::string& GetAddress() const { return address_; }
 
 protected:
-    /// 获取 Channel（供子类创建 Stub）
-    std::shared_ptr<grpc::Channel> GetChannel() { return channel_; }
+    /// 获取第一条 Channel
+    std::shared_ptr<grpc::Channel> GetChannel() { return channels_.empty() ? nullptr : channels_.front(); }
+    /// 获取全部 Channel（供子类 StubPool::Init）
+    const std::vector<std::shared_ptr<grpc::Channel>>& GetChannels() const { return channels_; }
 
     /// 创建带超时的 Context；token 非空时注入 authorization: Bearer <token> 供业务服务鉴权
     std::unique_ptr<grpc::ClientContext> CreateContext(int timeout_ms = 5000,
                                                         const std::string& token = "");
 
+    /**
+     * 异步一元调用：start 发起 stub_->async()->Method(ctx, req, resp, cb)，本函数立即返回。
+     * ctx/req/resp 由内部持有到回调结束；done(status, resp) 在 gRPC 回调线程上调用且仅调用一次，
+     * 不得在其中做阻塞操作（阻塞工作应转交给工作线程）。
+     *
+     *   AsyncUnary<chat::MarkReadResponse>(std::move(req), 5000, token,
+     *       [this](auto* ctx, auto* req, auto* resp, auto cb) {
+     *           stub_->async()->MarkRead(ctx, req, resp, std::move(cb)); },
+     *       [](const grpc::Status& s, chat::MarkReadResponse& resp) { ... });
+     */
+    template <typename Response, typename Request, typename StartFn>
+    void AsyncUnary(Request request, int timeout_ms, const std::string& token, StartFn start,
+                    std::function<void(const grpc::Status&, Response&)> done) {
+        struct Call {
+            std::unique_ptr<grpc::ClientContext> ctx;
+            Request req;
+            Response resp;
+        };
+        auto call = std::make_shared<Call>();
+        call->ctx = CreateContext(timeout_ms > 0 ? timeout_ms : 1, token);
+        call->req = std::move(request);
+        start(call->ctx.get(), &call->req, &call->resp,
+              std::function<void(grpc::Status)>([call, done = std::move(done)](grpc::Status status) {
+                  if (done) done(status, call->resp);
+              }));
+    }
+
 private:
     std::string address_;
-    std::shared_ptr<grpc::Channel> channel_;
+    std::vector<std::shared_ptr<grpc::Channel>> channels_;
 };
 
 }  // namespace zone
@@ -0,0 +1,266 @@
+#include "fanout_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+namespace swift::zone {
+
+namespace {
+
+int64_t ElapsedUs(FanoutEngine::Clock::time_point from, FanoutEngine::Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+}  // namespace
+
+struct FanoutEngine::Impl {
+    struct Pending {
+        FanoutTask task;
+        Clock::time_point enqueued;
+        Clock::time_point deadline;
+    };
+
+    /// 一次扇出拆出的所有推送分片共享；最后一个分片完成时记录 total
+    struct TaskState {
+        Clock::time_point enqueued;
+        std::atomic<size_t> remaining{0};
+    };
+
+    FanoutOptions opts;
+    MemberResolver resolve_members_fn;
+    SessionResolver resolve_sessions_fn;
+    GatePusher pusher;
+
+    mutable std::mutex mu;
+    std::condition_variable queue_cv;
+    std::condition_variable slot_cv;  // 在途推送数变化（亦用于 Stop 等待在途清零）
+    std::deque<Pending> queue;
+    int inflight = 0;
+    bool running = false;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> expired{0};
+    std::atomic<uint64_t> pushes{0};
+    std::atomic<uint64_t> delivered{0};
+
+    LatencyHistogram h_queue_wait;
+    LatencyHistogram h_resolve_members;
+    LatencyHistogram h_resolve_sessions;
+    LatencyHistogram h_push_rpc;
+    LatencyHistogram h_total;
+
+    void WorkerLoop();
+    void Process(Pending& p);
+    bool AcquireSlot(Clock::time_point deadline);
+    void ReleaseSlot();
+    void Complete(const std::shared_ptr<TaskState>& state, int n);
+};
+
+void FanoutEngine::Impl::WorkerLoop() {
+    for (;;) {
+        Pending p;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            p = std::move(queue.front());
+            queue.pop_front();
+        }
+        Process(p);
+    }
+}
+
+void FanoutEngine::Impl::Process(Pending& p) {
+    auto now = Clock::now();
+    h_queue_wait.Record(ElapsedUs(p.enqueued, now));
+    if (now >= p.deadline) {
+        expired.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::vector<std::string> users;
+    if (!p.task.group_id.empty()) {
+        if (!resolve_members_fn || !resolve_members_fn(p.task.group_id, &users))
+            return;
+        auto t = Clock::now();
+        h_resolve_members.Record(ElapsedUs(now, t));
+        now = t;
+    } else {
+        users = std::move(p.task.user_ids);
+    }
+    if (!p.task.exclude_user_id.empty())
+        users.erase(std::remove(users.begin(), users.end(), p.task.exclude_user_id), users.end());
+    if (users.empty()) return;
+
+    std::unordered_map<std::string, std::vector<std::string>> by_gate;
+    if (resolve_sessions_fn) resolve_sessions_fn(users, &by_gate);
+    h_resolve_sessions.Record(ElapsedUs(now, Clock::now()));
+
+    // 按 batch_size 拆分，同一 Gate 上的大群也能并发推送
+    const size_t batch = opts.batch_size > 0 ? opts.batch_size : users.size();
+    std::vector<std::pair<const std::string*, std::vector<std::string>>> chunks;
+    for (auto& [gate_addr, gate_users] : by_gate) {
+        if (gate_users.size() <= batch) {
+            chunks.emplace_back(&gate_addr, std::move(gate_users));
+            continue;
+        }
+        for (size_t i = 0; i < gate_users.size(); i += batch) {
+            size_t end = std::min(gate_users.size(), i + batch);
+            chunks.emplace_back(&gate_addr, std::vector<std::string>(
+                std::make_move_iterator(gate_users.begin() + i),
+                std::make_move_iterator(gate_users.begin() + end)));
+        }
+    }
+    if (chunks.empty()) {
+        h_total.Record(ElapsedUs(p.enqueued, Clock::now()));
+        return;
+    }
+
+    auto state = std::make_shared<TaskState>();
+    state->enqueued = p.enqueued;
+    state->remaining.store(chunks.size(), std::memory_order_relaxed);
+    for (auto& [gate_addr, chunk_users] : chunks) {
+        if (!AcquireSlot(p.deadline)) {
+            expired.fetch_add(1, std::memory_order_relaxed);
+            Complete(state, 0);
+            continue;
+        }
+        pushes.fetch_add(1, std::memory_order_relaxed);
+        auto sent = Clock::now();
+        pusher(*gate_addr, chunk_users, p.task.cmd, p.task.payload, p.deadline,
+               [this, state, sent](int n) {
+                   h_push_rpc.Record(ElapsedUs(sent, Clock::now()));
+                   Complete(state, n);
+                   ReleaseSlot();  // 最后一步：Stop 可能在在途清零后立即析构本对象
+               });
+    }
+}
+
+bool FanoutEngine::Impl::AcquireSlot(Clock::time_point deadline) {
+    const int limit = opts.max_inflight_pushes > 0 ? opts.max_inflight_pushes : 1;
+    std::unique_lock<std::mutex> lock(mu);
+    if (!slot_cv.wait_until(lock, deadline, [&] { return stopping || inflight < limit; }))
+        return false;
+    if (stopping) return false;
+    ++inflight;
+    return true;
+}
+
+void FanoutEngine::Impl::ReleaseSlot() {
+    std::lock_guard<std::mutex> lock(mu);
+    --inflight;
+    slot_cv.notify_all();
+}
+
+void FanoutEngine::Impl::Complete(const std::shared_ptr<TaskState>& state, int n) {
+    if (n > 0) delivered.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        h_total.Record(ElapsedUs(state->enqueued, Clock::now()));
+}
+
+FanoutEngine::FanoutEngine(FanoutOptions options, MemberResolver members,
+                           SessionResolver sessions, GatePusher pusher)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->opts = options;
+    impl_->resolve_members_fn = std::move(members);
+    impl_->resolve_sessions_fn = std::move(sessions);
+    impl_->pusher = std::move(pusher);
+}
+
+FanoutEngine::~FanoutEngine() {
+    Stop();
+}
+
+void FanoutEngine::Start() {
+    std::lock_guard<std::mutex> lock(impl_->mu);
+    if (impl_->running) return;
+    impl_->running = true;
+    impl_->stopping = false;
+    int n = impl_->opts.workers > 0 ? impl_->opts.workers : 1;
+    for (int i = 0; i < n; ++i)
+        impl_->workers.emplace_back([this] { impl_->WorkerLoop(); });
+}
+
+void FanoutEngine::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mu);
+        if (!impl_->running) return;
+        impl_->running = false;
+        impl_->stopping = true;
+    }
+    impl_->queue_cv.notify_all();
+    impl_->slot_cv.notify_all();
+    for (auto& t : impl_->workers) {
+        if (t.joinable()) t.join();
+    }
+    impl_->workers.clear();
+    std::unique_lock<std::mutex> lock(impl_->mu);
+    impl_->slot_cv.wait(lock, [this] { return impl_->inflight == 0; });
+    impl_->queue.clear();
+}
+
+bool FanoutEngine::Submit(FanoutTask task) {
+    auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(impl_->mu);
+        if (!impl_->running || impl_->queue.size() >= impl_->opts.max_queue) {
+            impl_->rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Impl::Pending p;
+        p.task = std::move(task);
+        p.enqueued = now;
+        p.deadline = now + std::chrono::milliseconds(impl_->opts.deadline_ms > 0 ? impl_->opts.deadline_ms : 1);
+        impl_->queue.push_back(std::move(p));
+    }
+    impl_->submitted.fetch_add(1, std::memory_order_relaxed);
+    impl_->queue_cv.notify_one();
+    return true;
+}
+
+FanoutEngine::Stats FanoutEngine::GetStats() const {
+    Stats s;
+    s.submitted = impl_->submitted.load(std::memory_order_relaxed);
+    s.rejected = impl_->rejected.load(std::memory_order_relaxed);
+    s.expired = impl_->expired.load(std::memory_order_relaxed);
+    s.pushes = impl_->pushes.load(std::memory_order_relaxed);
+    s.delivered = impl_->delivered.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(impl_->mu);
+    s.queued = impl_->queue.size();
+    s.inflight = impl_->inflight;
+    return s;
+}
+
+const LatencyHistogram& FanoutEngine::queue_wait() const { return impl_->h_queue_wait; }
+const LatencyHistogram& FanoutEngine::resolve_members() const { return impl_->h_resolve_members; }
+const LatencyHistogram& FanoutEngine::resolve_sessions() const { return impl_->h_resolve_sessions; }
+const LatencyHistogram& FanoutEngine::push_rpc() const { return impl_->h_push_rpc; }
+const LatencyHistogram& FanoutEngine::total() const { return impl_->h_total; }
+
+std::string FanoutEngine::FormatStats() const {
+    Stats s = GetStats();
+    std::ostringstream os;
+    os << "submitted=" << s.submitted
+       << " rejected=" << s.rejected
+       << " expired=" << s.expired
+       << " pushes=" << s.pushes
+       << " delivered=" << s.delivered
+       << " queued=" << s.queued
+       << " inflight=" << s.inflight
+       << "\n  queue_wait: " << impl_->h_queue_wait.Format()
+       << "\n  resolve_members: " << impl_->h_resolve_members.Format()
+       << "\n  resolve_sessions: " << impl_->h_resolve_sessions.Format()
+       << "\n  push_rpc: " << impl_->h_push_rpc.Format()
+       << "\n  total: " << impl_->h_total.Format();
+    return os.str();
+}
+
+}  // namespace swift::zone
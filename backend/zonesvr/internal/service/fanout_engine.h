@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "latency_histogram.h"
+
+namespace swift::zone {
+
+/**
+ * 扇出引擎参数（见 zonesvr.conf.example 中 fanout_*）
+ */
+struct FanoutOptions {
+    int workers = 2;                // 解析成员/会话的工作线程数
+    size_t max_queue = 10000;       // 待处理任务上限，满时 Submit 返回 false
+    int max_inflight_pushes = 32;   // 全局同时在途的 Gate 推送 RPC 数
+    size_t batch_size = 500;        // 单次推送给同一 Gate 的最大用户数，超出则拆成多次并发
+    int deadline_ms = 3000;         // 从提交起算的截止时间，逐级传给推送 RPC
+};
+
+/**
+ * 一次扇出：group_id 非空时由 MemberResolver 展开成员，否则直接使用 user_ids；
+ * exclude_user_id（一般为发送者）不会收到推送。
+ */
+struct FanoutTask {
+    std::string group_id;
+    std::vector<std::string> user_ids;
+    std::string exclude_user_id;
+    std::string cmd;
+    std::string payload;
+};
+
+/**
+ * 群聊推送扇出引擎
+ *
+ * 调用方（HandleChat）Submit 后立即给发送者回包；工作线程依次执行：
+ *   queue_wait → resolve_members（群成员）→ resolve_sessions（批量查在线会话并按 Gate 分组）
+ *   → dispatch（各 Gate 推送并发发出，全局在途数受 max_inflight_pushes 限制）
+ * 截止时间从 Submit 时刻算起，过期任务/分片直接丢弃并计数，剩余时间作为推送 RPC 的 deadline。
+ * 各阶段耗时记入 LatencyHistogram，由主程序周期性以 FormatStats() 输出。
+ */
+class FanoutEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+    using MemberResolver = std::function<bool(const std::string& group_id,
+                                              std::vector<std::string>* members)>;
+    /// 批量解析在线会话，输出 gate_addr -> 该 Gate 上的在线用户
+    using SessionResolver = std::function<void(
+        const std::vector<std::string>& user_ids,
+        std::unordered_map<std::string, std::vector<std::string>>* by_gate)>;
+    using PushDone = std::function<void(int delivered)>;
+    /// 异步推送：须且仅须调用一次 done（可在任意线程、也可在调用内同步调用）
+    using GatePusher = std::function<void(const std::string& gate_addr,
+                                          const std::vector<std::string>& user_ids,
+                                          const std::string& cmd, const std::string& payload,
+                                          Clock::time_point deadline, PushDone done)>;
+
+    FanoutEngine(FanoutOptions options, MemberResolver members, SessionResolver sessions,
+                 GatePusher pusher);
+    ~FanoutEngine();
+
+    FanoutEngine(const FanoutEngine&) = delete;
+    FanoutEngine& operator=(const FanoutEngine&) = delete;
+
+    void Start();
+    /// 停止工作线程并等待在途推送回调完成；未处理的任务丢弃
+    void Stop();
+
+    /// 入队；队列满或未启动返回 false（调用方可回退为同步 Broadcast）
+    bool Submit(FanoutTask task);
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;     // 队列满被拒
+        uint64_t expired = 0;      // 因截止时间丢弃的任务或推送分片
+        uint64_t pushes = 0;       // 发出的 Gate 推送 RPC 数
+        uint64_t delivered = 0;    // Gate 返回的投递成功数
+        size_t queued = 0;
+        int inflight = 0;
+    };
+    Stats GetStats() const;
+
+    const LatencyHistogram& queue_wait() const;
+    const LatencyHistogram& resolve_members() const;
+    const LatencyHistogram& resolve_sessions() const;
+    const LatencyHistogram& push_rpc() const;
+    const LatencyHistogram& total() const;
+
+    /// 计数 + 各阶段直方图，多行文本
+    std::string FormatStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace swift::zone
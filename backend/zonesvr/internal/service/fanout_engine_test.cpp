@@ -0,0 +1,215 @@
+/**
+ * @file fanout_engine_test.cpp
+ * @brief FanoutEngine 单元测试（成员展开与排除、按 Gate 分片、并发上限、截止时间、队列上限）
+ */
+
+#include "fanout_engine.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace swift::zone {
+
+namespace {
+
+using Clock = FanoutEngine::Clock;
+
+/// 用户 "uN" 在 gate "gN%gates"
+FanoutEngine::SessionResolver SessionsOnGates(int gates) {
+    return [gates](const std::vector<std::string>& users,
+                   std::unordered_map<std::string, std::vector<std::string>>* by_gate) {
+        for (const auto& u : users)
+            (*by_gate)["g" + std::to_string(std::stoi(u.substr(1)) % gates)].push_back(u);
+    };
+}
+
+FanoutEngine::MemberResolver Members(int count) {
+    return [count](const std::string&, std::vector<std::string>* out) {
+        for (int i = 0; i < count; ++i) out->push_back("u" + std::to_string(i));
+        return true;
+    };
+}
+
+bool WaitFor(const std::function<bool()>& pred, int timeout_ms = 2000) {
+    auto until = Clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (Clock::now() > until) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+// 群成员展开、排除发送者、按 Gate 分组后每个 Gate 一次推送
+TEST(FanoutEngineTest, GroupsByGateAndExcludesSender) {
+    std::mutex mu;
+    std::map<std::string, std::vector<std::string>> pushed;
+    FanoutOptions opts;
+    FanoutEngine engine(opts, Members(10), SessionsOnGates(3),
+        [&](const std::string& gate, const std::vector<std::string>& users, const std::string& cmd,
+            const std::string& payload, Clock::time_point, FanoutEngine::PushDone done) {
+            EXPECT_EQ(cmd, "chat.message");
+            EXPECT_EQ(payload, "p");
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                auto& v = pushed[gate];
+                v.insert(v.end(), users.begin(), users.end());
+            }
+            done(static_cast<int>(users.size()));
+        });
+    engine.Start();
+    FanoutTask task;
+    task.group_id = "grp";
+    task.exclude_user_id = "u0";
+    task.cmd = "chat.message";
+    task.payload = "p";
+    ASSERT_TRUE(engine.Submit(std::move(task)));
+    ASSERT_TRUE(WaitFor([&] { return engine.total().Count() == 1; }));
+
+    std::lock_guard<std::mutex> lock(mu);
+    EXPECT_EQ(pushed.size(), 3u);
+    size_t n = 0;
+    for (auto& [gate, users] : pushed) {
+        n += users.size();
+        EXPECT_EQ(std::count(users.begin(), users.end(), "u0"), 0);
+    }
+    EXPECT_EQ(n, 9u);
+    auto s = engine.GetStats();
+    EXPECT_EQ(s.pushes, 3u);
+    EXPECT_EQ(s.delivered, 9u);
+}
+
+// 同一 Gate 上超过 batch_size 的用户拆成多次推送
+TEST(FanoutEngineTest, SplitsLargeGateIntoBatches) {
+    std::atomic<int> calls{0};
+    FanoutOptions opts;
+    opts.batch_size = 4;
+    FanoutEngine engine(opts, nullptr, SessionsOnGates(1),
+        [&](const std::string&, const std::vector<std::string>& users, const std::string&,
+            const std::string&, Clock::time_point, FanoutEngine::PushDone done) {
+            EXPECT_LE(users.size(), 4u);
+            ++calls;
+            done(static_cast<int>(users.size()));
+        });
+    engine.Start();
+    FanoutTask task;
+    for (int i = 0; i < 10; ++i) task.user_ids.push_back("u" + std::to_string(i));
+    ASSERT_TRUE(engine.Submit(std::move(task)));
+    ASSERT_TRUE(WaitFor([&] { return engine.total().Count() == 1; }));
+    EXPECT_EQ(calls.load(), 3);
+    EXPECT_EQ(engine.GetStats().delivered, 10u);
+}
+
+// 在途推送数不超过 max_inflight_pushes，异步完成后释放名额
+TEST(FanoutEngineTest, BoundsInflightPushes) {
+    std::mutex mu;
+    std::vector<FanoutEngine::PushDone> pending;
+    std::atomic<int> max_seen{0};
+    FanoutOptions opts;
+    opts.max_inflight_pushes = 2;
+    opts.deadline_ms = 5000;
+    FanoutEngine engine(opts, nullptr, SessionsOnGates(6),
+        [&](const std::string&, const std::vector<std::string>& users, const std::string&,
+            const std::string&, Clock::time_point, FanoutEngine::PushDone done) {
+            std::lock_guard<std::mutex> lock(mu);
+            pending.push_back(std::move(done));
+            max_seen = std::max(max_seen.load(), engine.GetStats().inflight);
+            (void)users;
+        });
+    engine.Start();
+    FanoutTask task;
+    for (int i = 0; i < 6; ++i) task.user_ids.push_back("u" + std::to_string(i));
+    ASSERT_TRUE(engine.Submit(std::move(task)));
+
+    // 逐个完成，直到 6 个 Gate 全部推送
+    int completed = 0;
+    while (completed < 6) {
+        FanoutEngine::PushDone done;
+        ASSERT_TRUE(WaitFor([&] {
+            std::lock_guard<std::mutex> lock(mu);
+            return static_cast<int>(pending.size()) > completed;
+        }));
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            EXPECT_LE(static_cast<int>(pending.size()) - completed, 2);
+            done = pending[completed];
+        }
+        done(1);
+        ++completed;
+    }
+    ASSERT_TRUE(WaitFor([&] { return engine.total().Count() == 1; }));
+    EXPECT_LE(max_seen.load(), 2);
+    EXPECT_EQ(engine.GetStats().delivered, 6u);
+}
+
+// 截止时间传给推送；排队超过截止时间的任务被丢弃
+TEST(FanoutEngineTest, PropagatesAndEnforcesDeadline) {
+    std::atomic<bool> block{true};
+    std::atomic<int> pushes{0};
+    Clock::time_point seen_deadline{};
+    FanoutOptions opts;
+    opts.workers = 1;
+    opts.deadline_ms = 50;
+    FanoutEngine engine(opts, nullptr, SessionsOnGates(1),
+        [&](const std::string&, const std::vector<std::string>&, const std::string&,
+            const std::string&, Clock::time_point deadline, FanoutEngine::PushDone done) {
+            if (pushes.load() == 0) seen_deadline = deadline;  // 先写后发布，主线程见到计数后再读
+            ++pushes;
+            while (block) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            done(1);
+        });
+    engine.Start();
+    auto before = Clock::now();
+    FanoutTask a;
+    a.user_ids = {"u1"};
+    ASSERT_TRUE(engine.Submit(a));
+    ASSERT_TRUE(WaitFor([&] { return pushes.load() == 1; }));
+    EXPECT_GT(seen_deadline, before);
+    EXPECT_LE(seen_deadline, Clock::now() + std::chrono::milliseconds(50));
+
+    // 唯一的工作线程被阻塞，第二个任务排队至过期
+    ASSERT_TRUE(engine.Submit(a));
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    block = false;
+    ASSERT_TRUE(WaitFor([&] { return engine.GetStats().expired == 1; }));
+    EXPECT_EQ(pushes.load(), 1);
+}
+
+// 队列满或未启动时 Submit 返回 false
+TEST(FanoutEngineTest, RejectsWhenQueueFullOrStopped) {
+    std::atomic<bool> block{true};
+    std::atomic<int> pushes{0};
+    FanoutOptions opts;
+    opts.workers = 1;
+    opts.max_queue = 1;
+    FanoutEngine engine(opts, nullptr, SessionsOnGates(1),
+        [&](const std::string&, const std::vector<std::string>&, const std::string&,
+            const std::string&, Clock::time_point, FanoutEngine::PushDone done) {
+            ++pushes;
+            while (block) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            done(1);
+        });
+    FanoutTask t;
+    t.user_ids = {"u1"};
+    EXPECT_FALSE(engine.Submit(t));  // 未启动
+    engine.Start();
+    ASSERT_TRUE(engine.Submit(t));
+    ASSERT_TRUE(WaitFor([&] { return pushes.load() == 1; }));
+    EXPECT_TRUE(engine.Submit(t));   // 排队
+    EXPECT_FALSE(engine.Submit(t));  // 队列满
+    block = false;
+    engine.Stop();
+    EXPECT_FALSE(engine.Submit(t));
+    EXPECT_EQ(engine.GetStats().rejected, 3u);
+}
+
+}  // namespace swift::zone
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+#include "group_member_cache.h"
+#include <algorithm>
+#include <sstream>
+
+namespace swift::zone {
+
+namespace {
+
+void SortUnique(std::vector<std::string>* ids) {
+    std::sort(ids->begin(), ids->end());
+    ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+    ids->shrink_to_fit();
+}
+
+}  // namespace
+
+GroupMemberCache::GroupMemberCache(GroupMemberCacheOptions options)
+    : cache_(ShardedTtlCacheOptions{options.capacity, options.ttl_ms, options.shards}) {}
+
+GroupMemberCache::~GroupMemberCache() = default;
+
+std::shared_ptr<const GroupMembers> GroupMemberCache::Get(const std::string& group_id, int64_t now_ms) {
+    auto members = cache_.Get(group_id, now_ms);
+    return members ? std::move(*members) : nullptr;
+}
+
+bool GroupMemberCache::Put(const std::string& group_id, std::vector<std::string> member_ids,
+                           uint64_t load_epoch, int64_t now_ms) {
+    auto members = std::make_shared<GroupMembers>();
+    members->member_ids = std::move(member_ids);
+    SortUnique(&members->member_ids);  // 排序在锁外完成
+
+    return cache_.Fill(group_id, load_epoch, now_ms,
+        [&](const std::shared_ptr<const GroupMembers>* old) -> std::shared_ptr<const GroupMembers> {
+            if (old)
+                members->version = (*old)->version + 1;
+            return std::move(members);
+        });
+}
+
+void GroupMemberCache::AddMembers(const std::string& group_id, const std::vector<std::string>& user_ids) {
+    bool patched = cache_.Modify(group_id, [&](std::shared_ptr<const GroupMembers>& cur) {
+        auto next = std::make_shared<GroupMembers>();
+        next->version = cur->version + 1;
+        next->member_ids.reserve(cur->member_ids.size() + user_ids.size());
+        next->member_ids.insert(next->member_ids.end(), cur->member_ids.begin(), cur->member_ids.end());
+        next->member_ids.insert(next->member_ids.end(), user_ids.begin(), user_ids.end());
+        SortUnique(&next->member_ids);
+        cur = std::move(next);
+        return true;
+    });
+    if (patched)
+        patches_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GroupMemberCache::RemoveMember(const std::string& group_id, const std::string& user_id) {
+    bool patched = cache_.Modify(group_id, [&](std::shared_ptr<const GroupMembers>& cur) {
+        auto pos = std::lower_bound(cur->member_ids.begin(), cur->member_ids.end(), user_id);
+        if (pos == cur->member_ids.end() || *pos != user_id) return false;
+        auto next = std::make_shared<GroupMembers>();
+        next->version = cur->version + 1;
+        next->member_ids.reserve(cur->member_ids.size() - 1);
+        next->member_ids.insert(next->member_ids.end(), cur->member_ids.begin(), pos);
+        next->member_ids.insert(next->member_ids.end(), pos + 1, cur->member_ids.end());
+        cur = std::move(next);
+        return true;
+    });
+    if (patched)
+        patches_.fetch_add(1, std::memory_order_relaxed);
+}
+
+GroupMemberCache::Stats GroupMemberCache::GetStats() const {
+    return Stats{cache_.GetStats(), patches_.load(std::memory_order_relaxed)};
+}
+
+std::string GroupMemberCache::FormatStats() const {
+    std::ostringstream os;
+    os << cache_.FormatStats() << " patches=" << patches_.load(std::memory_order_relaxed);
+    return os.str();
+}
+
+}  // namespace swift::zone
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sharded_ttl_cache.h"
+
+namespace swift::zone {
+
+/**
+ * 群成员缓存参数（见 zonesvr.conf.example 中 group_cache_*）
+ */
+struct GroupMemberCacheOptions {
+    size_t capacity = 10000;   // 缓存的群数上限（按分片均分，分片内 LRU 淘汰）
+    int ttl_ms = 30000;        // 条目有效期；其他 ZoneSvr 副本上的成员变更最多在此时间后可见
+    size_t shards = 16;
+};
+
+/**
+ * 一个群的成员快照：member_ids 升序、无重复；version 每次本地增量修改递增。
+ * 以 shared_ptr<const> 交给读者，修改时复制后替换，读者无需持锁。
+ */
+struct GroupMembers {
+    uint64_t version = 0;
+    std::vector<std::string> member_ids;
+};
+
+/**
+ * 群成员进程内缓存（ShardedTtlCache：分片 LRU + TTL + 回填 epoch 保护）
+ *
+ * 群推送（扇出）命中时不再调用 GetGroupMembers RPC，ChatSvr 也不必逐个反序列化成员 JSON。
+ * 经本服务处理的 invite/remove/leave 就地修补快照，dismiss 直接失效；
+ * 回源前 LoadEpoch()，Put 时分片有过修改则放弃回填。
+ */
+class GroupMemberCache {
+public:
+    explicit GroupMemberCache(GroupMemberCacheOptions options);
+    ~GroupMemberCache();
+
+    GroupMemberCache(const GroupMemberCache&) = delete;
+    GroupMemberCache& operator=(const GroupMemberCache&) = delete;
+
+    /// 未命中或已过期返回 nullptr
+    std::shared_ptr<const GroupMembers> Get(const std::string& group_id, int64_t now_ms);
+
+    /// 回源前调用，返回值交给 Put
+    uint64_t LoadEpoch(const std::string& group_id) const { return cache_.LoadEpoch(group_id); }
+    /// 回填（member_ids 无需有序）；load_epoch 之后该分片有过修改则丢弃，返回是否写入
+    bool Put(const std::string& group_id, std::vector<std::string> member_ids,
+             uint64_t load_epoch, int64_t now_ms);
+
+    /// 成员变更：已缓存则修补快照并递增 version，未缓存则不做处理（下次回源）
+    void AddMembers(const std::string& group_id, const std::vector<std::string>& user_ids);
+    void RemoveMember(const std::string& group_id, const std::string& user_id);
+    /// 群解散或无法增量修补时调用
+    void Invalidate(const std::string& group_id) { cache_.Invalidate(group_id); }
+
+    size_t Size() const { return cache_.Size(); }
+
+    struct Stats : ShardedTtlCache<std::string, std::shared_ptr<const GroupMembers>>::Stats {
+        uint64_t patches = 0;        // 增量修补次数
+    };
+    Stats GetStats() const;
+
+    /// 单行 key=value 文本（含命中率）
+    std::string FormatStats() const;
+
+private:
+    ShardedTtlCache<std::string, std::shared_ptr<const GroupMembers>> cache_;
+    std::atomic<uint64_t> patches_{0};
+};
+
+}  // namespace swift::zone
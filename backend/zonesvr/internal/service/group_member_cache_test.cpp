@@ -0,0 +1,74 @@
+/**
+ * @file group_member_cache_test.cpp
+ * @brief GroupMemberCache 单元测试（排序去重、修补与版本、修补使在途回填作废；缓存通用行为见 sharded_ttl_cache_test）
+ */
+
+#include "group_member_cache.h"
+#include <gtest/gtest.h>
+
+namespace swift::zone {
+
+// 回填后成员有序去重；覆盖已缓存的群时版本递增
+TEST(GroupMemberCacheTest, PutSortsAndBumpsVersionOnRefill) {
+    GroupMemberCache cache{GroupMemberCacheOptions{}};
+    ASSERT_TRUE(cache.Put("g1", {"u3", "u1", "u2", "u1"}, cache.LoadEpoch("g1"), 0));
+
+    auto hit = cache.Get("g1", 1);
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->member_ids, (std::vector<std::string>{"u1", "u2", "u3"}));
+
+    ASSERT_TRUE(cache.Put("g1", {"u4"}, cache.LoadEpoch("g1"), 2));
+    auto refilled = cache.Get("g1", 3);
+    EXPECT_EQ(refilled->member_ids, (std::vector<std::string>{"u4"}));
+    EXPECT_EQ(refilled->version, hit->version + 1);
+}
+
+// 邀请/移除就地修补并递增版本，已取走的旧快照不受影响
+TEST(GroupMemberCacheTest, PatchesBumpVersion) {
+    GroupMemberCache cache{GroupMemberCacheOptions{}};
+    cache.Put("g1", {"u1", "u3"}, cache.LoadEpoch("g1"), 0);
+    auto before = cache.Get("g1", 1);
+
+    cache.AddMembers("g1", {"u2", "u3"});
+    auto added = cache.Get("g1", 1);
+    EXPECT_EQ(added->member_ids, (std::vector<std::string>{"u1", "u2", "u3"}));
+    EXPECT_EQ(added->version, before->version + 1);
+
+    cache.RemoveMember("g1", "u1");
+    cache.RemoveMember("g1", "nobody");
+    auto removed = cache.Get("g1", 1);
+    EXPECT_EQ(removed->member_ids, (std::vector<std::string>{"u2", "u3"}));
+    EXPECT_EQ(removed->version, before->version + 2);
+
+    EXPECT_EQ(before->member_ids, (std::vector<std::string>{"u1", "u3"}));
+    EXPECT_EQ(cache.GetStats().patches, 2u);
+}
+
+// 解散后不再命中；未缓存的群修补不产生条目
+TEST(GroupMemberCacheTest, InvalidateAndPatchMissingGroup) {
+    GroupMemberCache cache{GroupMemberCacheOptions{}};
+    cache.Put("g1", {"u1"}, cache.LoadEpoch("g1"), 0);
+    cache.Invalidate("g1");
+    EXPECT_EQ(cache.Get("g1", 1), nullptr);
+
+    cache.AddMembers("g2", {"u1"});
+    EXPECT_EQ(cache.Get("g2", 1), nullptr);
+    EXPECT_EQ(cache.Size(), 0u);
+}
+
+// 回源期间发生成员变更：旧成员列表不得回填
+TEST(GroupMemberCacheTest, FillAfterConcurrentChangeIsDropped) {
+    GroupMemberCache cache{GroupMemberCacheOptions{}};
+    uint64_t epoch = cache.LoadEpoch("g1");
+    cache.RemoveMember("g1", "u1");
+    EXPECT_FALSE(cache.Put("g1", {"u1", "u2"}, epoch, 0));
+    EXPECT_EQ(cache.Get("g1", 1), nullptr);
+    EXPECT_EQ(cache.GetStats().fill_dropped, 1u);
+}
+
+}  // namespace swift::zone
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,47 @@
+#include "latency_histogram.h"
+#include <iomanip>
+#include <sstream>
+
+namespace swift::zone {
+
+void LatencyHistogram::Record(int64_t us) {
+    if (us < 0) us = 0;
+    size_t i = 0;
+    while (us > kBoundsUs[i]) ++i;  // 最后一桶为 INT64_MAX，必然终止
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+    int64_t prev = max_us_.load(std::memory_order_relaxed);
+    while (us > prev && !max_us_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+    }
+}
+
+int64_t LatencyHistogram::PercentileUs(double p) const {
+    uint64_t total = Count();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total));
+    if (rank >= total) rank = total - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen > rank)
+            return i + 1 < kBoundsUs.size() ? kBoundsUs[i] : MaxUs();
+    }
+    return MaxUs();
+}
+
+std::string LatencyHistogram::Format() const {
+    uint64_t n = Count();
+    double avg_ms = n ? static_cast<double>(sum_us_.load(std::memory_order_relaxed)) / n / 1000.0 : 0.0;
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1)
+       << "count=" << n
+       << " avg=" << avg_ms << "ms"
+       << " p50=" << PercentileUs(0.50) / 1000.0 << "ms"
+       << " p90=" << PercentileUs(0.90) / 1000.0 << "ms"
+       << " p99=" << PercentileUs(0.99) / 1000.0 << "ms"
+       << " max=" << MaxUs() / 1000.0 << "ms";
+    return os.str();
+}
+
+}  // namespace swift::zone
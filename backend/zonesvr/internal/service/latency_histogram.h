@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace swift::zone {
+
+/**
+ * 延迟直方图（微秒，固定对数分桶，原子量 relaxed 累加，热路径无锁）。
+ * 分位数按桶上界估算，精度取决于分桶粒度，用于日志观测而非精确统计。
+ */
+class LatencyHistogram {
+public:
+    /// 各桶上界（微秒）；最后一桶为溢出桶
+    static constexpr std::array<int64_t, 16> kBoundsUs = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+        50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, INT64_MAX,
+    };
+
+    void Record(int64_t us);
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    int64_t MaxUs() const { return max_us_.load(std::memory_order_relaxed); }
+
+    /// 估算分位数（p 取 0~1），返回所在桶上界（微秒）；无样本返回 0
+    int64_t PercentileUs(double p) const;
+
+    /// 单行文本：count / avg / p50 / p90 / p99 / max（毫秒）
+    std::string Format() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBoundsUs.size()> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<int64_t> sum_us_{0};
+    std::atomic<int64_t> max_us_{0};
+};
+
+}  // namespace swift::zone
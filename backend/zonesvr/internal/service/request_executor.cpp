@@ -0,0 +1,134 @@
+#include "request_executor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace swift::zone {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t ElapsedUs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+}  // namespace
+
+struct RequestExecutor::Impl {
+    struct Pending {
+        std::function<void()> fn;
+        Clock::time_point enqueued;
+    };
+
+    RequestExecutorOptions opts;
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    std::deque<Pending> queue;
+    bool running = false;
+    bool stopping = false;
+    int active = 0;
+    std::vector<std::thread> workers;
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> rejected{0};
+    LatencyHistogram h_queue_wait;
+
+    void WorkerLoop() {
+        for (;;) {
+            Pending p;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) return;
+                p = std::move(queue.front());
+                queue.pop_front();
+                ++active;
+            }
+            h_queue_wait.Record(ElapsedUs(p.enqueued, Clock::now()));
+            p.fn();
+            std::lock_guard<std::mutex> lock(mu);
+            --active;
+        }
+    }
+};
+
+RequestExecutor::RequestExecutor(RequestExecutorOptions options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->opts = options;
+}
+
+RequestExecutor::~RequestExecutor() {
+    Stop();
+}
+
+void RequestExecutor::Start() {
+    std::lock_guard<std::mutex> lock(impl_->mu);
+    if (impl_->running) return;
+    impl_->running = true;
+    impl_->stopping = false;
+    int n = impl_->opts.workers > 0 ? impl_->opts.workers : 1;
+    for (int i = 0; i < n; ++i)
+        impl_->workers.emplace_back([this] { impl_->WorkerLoop(); });
+}
+
+void RequestExecutor::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mu);
+        if (!impl_->running) return;
+        impl_->running = false;
+        impl_->stopping = true;
+        impl_->queue.clear();
+    }
+    impl_->cv.notify_all();
+    for (auto& t : impl_->workers) {
+        if (t.joinable()) t.join();
+    }
+    impl_->workers.clear();
+}
+
+bool RequestExecutor::Submit(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mu);
+        if (!impl_->running || impl_->queue.size() >= impl_->opts.max_queue) {
+            impl_->rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        impl_->queue.push_back(Impl::Pending{std::move(fn), Clock::now()});
+    }
+    impl_->submitted.fetch_add(1, std::memory_order_relaxed);
+    impl_->cv.notify_one();
+    return true;
+}
+
+RequestExecutor::Stats RequestExecutor::GetStats() const {
+    Stats s;
+    s.submitted = impl_->submitted.load(std::memory_order_relaxed);
+    s.rejected = impl_->rejected.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(impl_->mu);
+    s.queued = impl_->queue.size();
+    s.active = impl_->active;
+    return s;
+}
+
+const LatencyHistogram& RequestExecutor::queue_wait() const {
+    return impl_->h_queue_wait;
+}
+
+std::string RequestExecutor::FormatStats() const {
+    Stats s = GetStats();
+    std::ostringstream os;
+    os << "submitted=" << s.submitted
+       << " rejected=" << s.rejected
+       << " queued=" << s.queued
+       << " active=" << s.active
+       << "\n  queue_wait: " << impl_->h_queue_wait.Format();
+    return os.str();
+}
+
+}  // namespace swift::zone
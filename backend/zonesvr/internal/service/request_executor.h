@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "latency_histogram.h"
+
+namespace swift::zone {
+
+/**
+ * 阻塞型请求执行器参数（见 zonesvr.conf.example 中 client_request_*）
+ */
+struct RequestExecutorOptions {
+    int workers = 16;           // 工作线程数：同时执行的同步后端调用上限
+    size_t max_queue = 10000;   // 排队上限，满时 Submit 返回 false（调用方回 SERVICE_UNAVAILABLE）
+};
+
+/**
+ * 有界工作线程池
+ *
+ * HandleClientRequest 改为 gRPC callback 处理后，回调线程不能阻塞；尚未改为异步的命令
+ * （auth/friend/group/file 等同步 RPC）以及回包后的推送在这里执行。
+ * 队列有上限，过载时快速拒绝而不是无限堆积。
+ */
+class RequestExecutor {
+public:
+    explicit RequestExecutor(RequestExecutorOptions options);
+    ~RequestExecutor();
+
+    RequestExecutor(const RequestExecutor&) = delete;
+    RequestExecutor& operator=(const RequestExecutor&) = delete;
+
+    void Start();
+    /// 停止并等待工作线程退出；已排队未执行的任务丢弃
+    void Stop();
+
+    /// 入队；队列满或未启动返回 false
+    bool Submit(std::function<void()> fn);
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;
+        size_t queued = 0;
+        int active = 0;          // 正在执行的任务数
+    };
+    Stats GetStats() const;
+    const LatencyHistogram& queue_wait() const;
+
+    /// 单行 key=value 文本（含排队耗时分布）
+    std::string FormatStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace swift::zone
@@ -0,0 +1,84 @@
+/**
+ * @file request_executor_test.cpp
+ * @brief RequestExecutor 单元测试（执行、队列满拒绝、未启动/停止后拒绝）
+ */
+
+#include "request_executor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace swift::zone {
+
+// 提交的任务全部在工作线程上执行
+TEST(RequestExecutorTest, RunsSubmittedTasks) {
+    RequestExecutorOptions o;
+    o.workers = 4;
+    RequestExecutor ex(o);
+    ex.Start();
+    std::atomic<int> done{0};
+    for (int i = 0; i < 100; ++i)
+        ASSERT_TRUE(ex.Submit([&done] { done.fetch_add(1); }));
+    for (int i = 0; i < 200 && done.load() < 100; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(done.load(), 100);
+    EXPECT_EQ(ex.GetStats().submitted, 100u);
+    EXPECT_EQ(ex.queue_wait().Count(), 100u);
+}
+
+// 唯一的工作线程被占住时，排队数达到 max_queue 后拒绝
+TEST(RequestExecutorTest, RejectsWhenQueueFull) {
+    RequestExecutorOptions o;
+    o.workers = 1;
+    o.max_queue = 2;
+    RequestExecutor ex(o);
+    ex.Start();
+
+    std::mutex mu;
+    std::condition_variable cv;
+    bool started = false;
+    bool release = false;
+    ASSERT_TRUE(ex.Submit([&] {
+        std::unique_lock<std::mutex> lock(mu);
+        started = true;
+        cv.notify_all();
+        cv.wait(lock, [&] { return release; });
+    }));
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return started; });
+    }
+    EXPECT_TRUE(ex.Submit([] {}));
+    EXPECT_TRUE(ex.Submit([] {}));
+    EXPECT_FALSE(ex.Submit([] {}));
+    auto s = ex.GetStats();
+    EXPECT_EQ(s.rejected, 1u);
+    EXPECT_EQ(s.queued, 2u);
+    EXPECT_EQ(s.active, 1);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        release = true;
+    }
+    cv.notify_all();
+    ex.Stop();
+}
+
+// 未启动或已停止时拒绝
+TEST(RequestExecutorTest, RejectsWhenNotRunning) {
+    RequestExecutor ex(RequestExecutorOptions{});
+    EXPECT_FALSE(ex.Submit([] {}));
+    ex.Start();
+    ex.Stop();
+    EXPECT_FALSE(ex.Submit([] {}));
+    EXPECT_EQ(ex.GetStats().rejected, 2u);
+}
+
+}  // namespace swift::zone
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
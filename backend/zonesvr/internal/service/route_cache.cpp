@@ -0,0 +1,39 @@
+#include "route_cache.h"
+#include <sstream>
+
+namespace swift::zone {
+
+RouteCache::RouteCache(RouteCacheOptions options)
+    : cache_(ShardedTtlCacheOptions{options.capacity, options.ttl_ms, options.shards}) {}
+
+RouteCache::~RouteCache() = default;
+
+std::optional<CachedRoute> RouteCache::Get(const std::string& user_id, int64_t now_ms) {
+    int64_t loaded_ms = 0;
+    auto route = cache_.Get(user_id, now_ms, &loaded_ms);
+    if (route)
+        hit_age_.Record((now_ms - loaded_ms) * 1000);
+    return route;
+}
+
+void RouteCache::ReportStale(size_t n) {
+    stale_.fetch_add(n, std::memory_order_relaxed);
+}
+
+RouteCache::Stats RouteCache::GetStats() const {
+    return Stats{cache_.GetStats(), stale_.load(std::memory_order_relaxed)};
+}
+
+const LatencyHistogram& RouteCache::hit_age() const {
+    return hit_age_;
+}
+
+std::string RouteCache::FormatStats() const {
+    std::ostringstream os;
+    os << cache_.FormatStats()
+       << " stale=" << stale_.load(std::memory_order_relaxed)
+       << "\n  hit_age: " << hit_age_.Format();
+    return os.str();
+}
+
+}  // namespace swift::zone
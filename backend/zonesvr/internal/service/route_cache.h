@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include "latency_histogram.h"
+#include "sharded_ttl_cache.h"
+
+namespace swift::zone {
+
+/**
+ * 路由近端缓存参数（见 zonesvr.conf.example 中 route_cache_*）
+ */
+struct RouteCacheOptions {
+    size_t capacity = 100000;  // 总条目上限（按分片均分，分片内 LRU 淘汰）
+    int ttl_ms = 5000;         // 条目有效期；跨副本失效关闭时它就是最大陈旧时间
+    size_t shards = 16;
+};
+
+/** 缓存的路由信息：只保存推送需要的字段 */
+struct CachedRoute {
+    std::string gate_id;
+    std::string gate_addr;
+};
+
+/**
+ * 用户 → Gate 路由的进程内缓存（ShardedTtlCache：分片 LRU + TTL + 回填 epoch 保护）
+ *
+ * 只缓存在线用户；UserOnline/UserOffline/KickUser 及其他副本的会话变更通知触发失效。
+ * 回源前取 LoadEpoch()，回填时 Put 带上该值，期间分片内发生过失效则放弃回填。
+ */
+class RouteCache {
+public:
+    explicit RouteCache(RouteCacheOptions options);
+    ~RouteCache();
+
+    RouteCache(const RouteCache&) = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    std::optional<CachedRoute> Get(const std::string& user_id, int64_t now_ms);
+
+    /// 回源前调用，返回值交给 Put
+    uint64_t LoadEpoch(const std::string& user_id) const { return cache_.LoadEpoch(user_id); }
+    /// 回填；load_epoch 之后该分片有过失效则丢弃，返回是否写入
+    bool Put(const std::string& user_id, CachedRoute route, uint64_t load_epoch, int64_t now_ms) {
+        return cache_.Put(user_id, std::move(route), load_epoch, now_ms);
+    }
+
+    void Invalidate(const std::string& user_id) { cache_.Invalidate(user_id); }
+    /// 清空（如订阅断线重连期间可能漏掉失效通知）
+    void Clear() { cache_.Clear(); }
+
+    /// 调用方发现缓存路由已失效（Gate 上已无该用户）时上报
+    void ReportStale(size_t n = 1);
+
+    size_t Size() const { return cache_.Size(); }
+
+    struct Stats : ShardedTtlCache<std::string, CachedRoute>::Stats {
+        uint64_t stale = 0;          // 命中后投递发现路由过时
+    };
+    Stats GetStats() const;
+    /// 命中时条目的年龄分布（自回源起），衡量读到的路由有多“旧”
+    const LatencyHistogram& hit_age() const;
+
+    /// 单行 key=value 文本（含命中率与 hit_age 分布）
+    std::string FormatStats() const;
+
+private:
+    ShardedTtlCache<std::string, CachedRoute> cache_;
+    std::atomic<uint64_t> stale_{0};
+    LatencyHistogram hit_age_;
+};
+
+}  // namespace swift::zone
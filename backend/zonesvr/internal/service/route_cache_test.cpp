@@ -0,0 +1,42 @@
+/**
+ * @file route_cache_test.cpp
+ * @brief RouteCache 单元测试（路由字段、stale 上报与 hit_age 统计；缓存通用行为见 sharded_ttl_cache_test）
+ */
+
+#include "route_cache.h"
+#include <gtest/gtest.h>
+
+namespace swift::zone {
+
+// 命中返回完整路由并记录条目年龄；失效后回源得到新路由；stale 上报计入统计
+TEST(RouteCacheTest, RouteFieldsAndStats) {
+    RouteCache cache{RouteCacheOptions{}};
+    ASSERT_TRUE(cache.Put("u1", CachedRoute{"g1", "g1:9091"}, cache.LoadEpoch("u1"), 0));
+
+    auto hit = cache.Get("u1", 40);
+    ASSERT_TRUE(hit);
+    EXPECT_EQ(hit->gate_id, "g1");
+    EXPECT_EQ(hit->gate_addr, "g1:9091");
+
+    cache.Invalidate("u1");  // 例如用户切换了 Gate
+    EXPECT_FALSE(cache.Get("u1", 41));
+    ASSERT_TRUE(cache.Put("u1", CachedRoute{"g2", "g2:9091"}, cache.LoadEpoch("u1"), 41));
+    EXPECT_EQ(cache.Get("u1", 42)->gate_id, "g2");
+
+    cache.ReportStale(3);
+    auto s = cache.GetStats();
+    EXPECT_EQ(s.hits, 2u);
+    EXPECT_EQ(s.misses, 1u);
+    EXPECT_EQ(s.invalidations, 1u);
+    EXPECT_EQ(s.stale, 3u);
+    std::string text = cache.FormatStats();
+    EXPECT_NE(text.find("stale=3"), std::string::npos);
+    EXPECT_NE(text.find("hit_age:"), std::string::npos);
+}
+
+}  // namespace swift::zone
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace swift::zone {
+
+/** ShardedTtlCache 参数 */
+struct ShardedTtlCacheOptions {
+    size_t capacity = 1;  // 总条目上限（按分片均分，分片内 LRU 淘汰）
+    int ttl_ms = 0;       // 条目有效期；<= 0 关闭缓存（Put 一律不写入）
+    size_t shards = 1;
+};
+
+/**
+ * 进程内近端缓存的公共部分：分片 LRU + TTL + 回填 epoch 保护。RouteCache / GroupMemberCache 在其上实现。
+ *
+ * 防止“读旧值 → 失效 → 回填旧值”：回源前取 LoadEpoch()，回填时 Put 带上该值，
+ * 期间分片内发生过 Invalidate / Modify（epoch 递增）则放弃回填。
+ * Value 在锁内复制返回，应是小对象或 shared_ptr<const T>。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedTtlCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t expired = 0;        // 命中但已过期（计入 misses）
+        uint64_t invalidations = 0;
+        uint64_t evictions = 0;      // 容量淘汰
+        uint64_t fill_dropped = 0;   // 回填因并发失效/修改被丢弃
+    };
+
+    explicit ShardedTtlCache(const ShardedTtlCacheOptions& options)
+        : ttl_ms_(options.ttl_ms),
+          shard_count_(options.shards > 0 ? options.shards : 1),
+          shards_(std::make_unique<Shard[]>(shard_count_)) {
+        size_t cap = options.capacity > 0 ? options.capacity : 1;
+        shard_capacity_ = (cap + shard_count_ - 1) / shard_count_;
+    }
+
+    ShardedTtlCache(const ShardedTtlCache&) = delete;
+    ShardedTtlCache& operator=(const ShardedTtlCache&) = delete;
+
+    /// 未命中或已过期返回 nullopt（过期条目顺带移除）；loaded_ms 非空时返回命中条目的回填时间
+    std::optional<Value> Get(const Key& key, int64_t now_ms, int64_t* loaded_ms = nullptr) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        auto entry = it->second;
+        if (now_ms >= entry->expires_ms) {
+            shard.lru.erase(entry);
+            shard.index.erase(it);
+            expired_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        if (loaded_ms) *loaded_ms = entry->loaded_ms;
+        return entry->value;
+    }
+
+    /// 回源前调用，返回值交给 Put / Fill
+    uint64_t LoadEpoch(const Key& key) const {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.epoch;
+    }
+
+    /// 回填；load_epoch 之后该分片有过失效或修改则丢弃，返回是否写入
+    bool Put(const Key& key, Value value, uint64_t load_epoch, int64_t now_ms) {
+        return Fill(key, load_epoch, now_ms, [&](const Value*) { return std::move(value); });
+    }
+
+    /// 同 Put，新值由 make(旧值，未缓存时为 nullptr) 在分片锁内生成（如据旧值递增版本号）
+    template <typename Make>
+    bool Fill(const Key& key, uint64_t load_epoch, int64_t now_ms, Make&& make) {
+        if (ttl_ms_ <= 0) return false;
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.epoch != load_epoch) {
+            fill_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            auto entry = it->second;
+            entry->value = make(&entry->value);
+            entry->loaded_ms = now_ms;
+            entry->expires_ms = now_ms + ttl_ms_;
+            shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+            return true;
+        }
+        if (shard.index.size() >= shard_capacity_) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.lru.push_front(Entry{key, make(static_cast<const Value*>(nullptr)), now_ms, now_ms + ttl_ms_});
+        shard.index.emplace(key, shard.lru.begin());
+        return true;
+    }
+
+    /**
+     * 就地修改已缓存的条目（不刷新 TTL 与 LRU 位置）。无论条目是否存在都递增分片 epoch，使在途回填作废。
+     * fn(Value&) 返回是否有改动；条目不存在返回 false。
+     */
+    template <typename Fn>
+    bool Modify(const Key& key, Fn&& fn) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.epoch;
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return false;
+        return fn(it->second->value);
+    }
+
+    void Invalidate(const Key& key) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.epoch;
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    /// 清空全部分片（如订阅断线重连期间可能漏掉失效通知）
+    void Clear() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            ++shards_[i].epoch;
+            shards_[i].lru.clear();
+            shards_[i].index.clear();
+        }
+    }
+
+    size_t Size() const {
+        size_t n = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            n += shards_[i].index.size();
+        }
+        return n;
+    }
+
+    Stats GetStats() const {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.expired = expired_.load(std::memory_order_relaxed);
+        s.invalidations = invalidations_.load(std::memory_order_relaxed);
+        s.evictions = evictions_.load(std::memory_order_relaxed);
+        s.fill_dropped = fill_dropped_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /// 公共统计的单行 key=value 文本（含命中率），各缓存在其后追加自己的计数
+    std::string FormatStats() const {
+        Stats s = GetStats();
+        uint64_t lookups = s.hits + s.misses;
+        std::ostringstream os;
+        os << "size=" << Size()
+           << " hits=" << s.hits
+           << " misses=" << s.misses
+           << " hit_ratio=" << std::fixed << std::setprecision(3)
+           << (lookups ? static_cast<double>(s.hits) / lookups : 0.0)
+           << " expired=" << s.expired
+           << " invalidations=" << s.invalidations
+           << " evictions=" << s.evictions
+           << " fill_dropped=" << s.fill_dropped;
+        return os.str();
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        int64_t loaded_ms = 0;
+        int64_t expires_ms = 0;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // 头部最近使用
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+        uint64_t epoch = 0;    // 每次失效/修改递增
+    };
+
+    Shard& ShardFor(const Key& key) const { return shards_[Hash{}(key) % shard_count_]; }
+
+    int ttl_ms_;
+    size_t shard_count_;
+    size_t shard_capacity_ = 1;
+    std::unique_ptr<Shard[]> shards_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> fill_dropped_{0};
+};
+
+}  // namespace swift::zone
@@ -0,0 +1,118 @@
+/**
+ * @file sharded_ttl_cache_test.cpp
+ * @brief ShardedTtlCache 单元测试（命中/过期、失效、并发失效/修改下的回填、LRU 淘汰、关闭与清空）
+ */
+
+#include "sharded_ttl_cache.h"
+#include <gtest/gtest.h>
+
+namespace swift::zone {
+
+namespace {
+
+using Cache = ShardedTtlCache<std::string, int>;
+
+ShardedTtlCacheOptions SmallCache(size_t capacity = 100, int ttl_ms = 1000) {
+    ShardedTtlCacheOptions o;
+    o.capacity = capacity;
+    o.ttl_ms = ttl_ms;
+    o.shards = 1;
+    return o;
+}
+
+}  // namespace
+
+// 回填后 TTL 内命中并返回回填时间，到期后未命中并移除
+TEST(ShardedTtlCacheTest, HitUntilTtlExpires) {
+    Cache cache(SmallCache(100, 1000));
+    EXPECT_FALSE(cache.Get("k1", 0));
+    ASSERT_TRUE(cache.Put("k1", 7, cache.LoadEpoch("k1"), 10));
+
+    int64_t loaded_ms = 0;
+    auto hit = cache.Get("k1", 999, &loaded_ms);
+    ASSERT_TRUE(hit);
+    EXPECT_EQ(*hit, 7);
+    EXPECT_EQ(loaded_ms, 10);
+
+    EXPECT_FALSE(cache.Get("k1", 1010));
+    EXPECT_EQ(cache.Size(), 0u);
+    auto s = cache.GetStats();
+    EXPECT_EQ(s.hits, 1u);
+    EXPECT_EQ(s.misses, 2u);
+    EXPECT_EQ(s.expired, 1u);
+}
+
+// 失效后不再命中
+TEST(ShardedTtlCacheTest, InvalidateRemovesEntry) {
+    Cache cache(SmallCache());
+    cache.Put("k1", 1, cache.LoadEpoch("k1"), 0);
+    cache.Invalidate("k1");
+    EXPECT_FALSE(cache.Get("k1", 1));
+    EXPECT_EQ(cache.GetStats().invalidations, 1u);
+}
+
+// 回源期间发生失效或修改：旧值不得回填；之后重新取 epoch 可正常回填
+TEST(ShardedTtlCacheTest, FillAfterConcurrentChangeIsDropped) {
+    Cache cache(SmallCache());
+    uint64_t epoch = cache.LoadEpoch("k1");
+    cache.Invalidate("k1");
+    EXPECT_FALSE(cache.Put("k1", 1, epoch, 0));
+    EXPECT_FALSE(cache.Get("k1", 1));
+
+    epoch = cache.LoadEpoch("k1");
+    EXPECT_FALSE(cache.Modify("k1", [](int&) { return true; }));  // 未缓存也使在途回填作废
+    EXPECT_FALSE(cache.Put("k1", 1, epoch, 0));
+    EXPECT_EQ(cache.GetStats().fill_dropped, 2u);
+
+    EXPECT_TRUE(cache.Put("k1", 2, cache.LoadEpoch("k1"), 0));
+    EXPECT_TRUE(cache.Modify("k1", [](int& v) { v += 1; return true; }));
+    EXPECT_EQ(*cache.Get("k1", 1), 3);
+}
+
+// Fill 覆盖已缓存条目时可见旧值
+TEST(ShardedTtlCacheTest, FillSeesPreviousValue) {
+    Cache cache(SmallCache());
+    cache.Put("k1", 5, cache.LoadEpoch("k1"), 0);
+    ASSERT_TRUE(cache.Fill("k1", cache.LoadEpoch("k1"), 1, [](const int* old) { return old ? *old * 2 : -1; }));
+    EXPECT_EQ(*cache.Get("k1", 2), 10);
+    ASSERT_TRUE(cache.Fill("k2", cache.LoadEpoch("k2"), 1, [](const int* old) { return old ? *old * 2 : -1; }));
+    EXPECT_EQ(*cache.Get("k2", 2), -1);
+}
+
+// 容量满时淘汰最久未使用的条目
+TEST(ShardedTtlCacheTest, EvictsLeastRecentlyUsed) {
+    Cache cache(SmallCache(2));
+    cache.Put("k1", 1, cache.LoadEpoch("k1"), 0);
+    cache.Put("k2", 2, cache.LoadEpoch("k2"), 0);
+    ASSERT_TRUE(cache.Get("k1", 1));  // k1 变为最近使用
+    cache.Put("k3", 3, cache.LoadEpoch("k3"), 1);
+
+    EXPECT_TRUE(cache.Get("k1", 2));
+    EXPECT_FALSE(cache.Get("k2", 2));
+    EXPECT_TRUE(cache.Get("k3", 2));
+    EXPECT_EQ(cache.GetStats().evictions, 1u);
+}
+
+// ttl_ms <= 0 关闭缓存；Clear 清空全部分片
+TEST(ShardedTtlCacheTest, DisabledAndClear) {
+    Cache off(SmallCache(100, 0));
+    EXPECT_FALSE(off.Put("k1", 1, off.LoadEpoch("k1"), 0));
+
+    ShardedTtlCacheOptions o = SmallCache();
+    o.shards = 4;
+    Cache cache(o);
+    for (int i = 0; i < 20; ++i) {
+        std::string k = "k" + std::to_string(i);
+        cache.Put(k, i, cache.LoadEpoch(k), 0);
+    }
+    EXPECT_EQ(cache.Size(), 20u);
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0u);
+}
+
+}  // namespace swift::zone
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -11,24 +11,108 @@
 #include "rpc/gate_rpc_client.h"
 #include <swift/error_code.h>
 #include <swift/log_helper.h>
+#include <algorithm>
 #include <chrono>
+#include <future>
+#include <iterator>
 #include <unordered_map>
 
 namespace swift::zone {
 
 namespace {
+int64_t SteadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 void SetResultError(ZoneServiceImpl::HandleClientRequestResult& r, swift::ErrorCode ec,
                     const std::string& request_id) {
     r.code = swift::ErrorCodeToInt(ec);
     r.message = swift::ErrorCodeToString(ec);
     r.request_id = request_id;
 }
+
+void LogClientRequestDone(const ZoneServiceImpl::HandleClientRequestResult& r, const std::string& cmd) {
+    if (r.code != swift::ErrorCodeToInt(swift::ErrorCode::OK)) {
+        LogWarning(TAG("service", "zonesvr"), "HandleClientRequest done with error: request_id="
+                   << r.request_id << ", cmd=" << cmd
+                   << ", code=" << r.code
+                   << ", message=" << r.message);
+    } else {
+        LogDebug(TAG("service", "zonesvr"), "HandleClientRequest done: request_id=" << r.request_id
+                 << ", cmd=" << cmd
+                 << ", code=" << r.code
+                 << ", response_payload_size=" << r.payload.size());
+    }
+}
+
+/// chat.send_message 的回包
+ZoneServiceImpl::HandleClientRequestResult SendMessageResponse(const ChatSystem::SendMessageResult& r,
+                                                               const std::string& request_id) {
+    ZoneServiceImpl::HandleClientRequestResult result;
+    result.request_id = request_id;
+    ChatSendMessageResponsePayload resp_pb;
+    resp_pb.set_success(r.success);
+    resp_pb.set_msg_id(r.msg_id);
+    resp_pb.set_timestamp(r.timestamp);
+    resp_pb.set_error(r.error);
+    if (!resp_pb.SerializeToString(&result.payload)) {
+        SetResultError(result, swift::ErrorCode::INTERNAL_ERROR, request_id);
+        return result;
+    }
+    result.code = r.success ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
+                           : swift::ErrorCodeToInt(swift::ErrorCode::MSG_SEND_FAILED);
+    if (!r.error.empty()) result.message = r.error;
+    else if (!r.success) result.message = swift::ErrorCodeToString(swift::ErrorCode::MSG_SEND_FAILED);
+    return result;
+}
+
+/// 新消息推送体；序列化失败返回 false
+bool BuildChatMessagePush(const ChatSendMessagePayload& req, const std::string& msg_id,
+                          int64_t timestamp, std::string* out) {
+    ChatMessagePushPayload push_pb;
+    push_pb.set_msg_id(msg_id);
+    push_pb.set_from_user_id(req.from_user_id());
+    push_pb.set_to_id(req.to_id());
+    push_pb.set_chat_type(req.chat_type());
+    push_pb.set_content(req.content());
+    push_pb.set_media_url(req.media_url());
+    push_pb.set_media_type(req.media_type());
+    push_pb.set_timestamp(timestamp);
+    for (const auto& u : req.mentions()) push_pb.add_mentions(u);
+    if (!req.reply_to_msg_id().empty()) push_pb.set_reply_to_msg_id(req.reply_to_msg_id());
+    return push_pb.SerializeToString(out);
+}
+
+/// chat.mark_read 的回包
+ZoneServiceImpl::HandleClientRequestResult MarkReadResponse(bool ok, const std::string& err,
+                                                            const std::string& request_id) {
+    ZoneServiceImpl::HandleClientRequestResult result;
+    result.request_id = request_id;
+    result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
+                    : swift::ErrorCodeToInt(swift::ErrorCode::INVALID_PARAM);
+    if (!err.empty()) result.message = err;
+    else if (!ok) result.message = "mark read failed";
+    return result;
+}
+
+/// 已读回执推送体；序列化失败返回 false
+bool BuildReadReceipt(const std::string& user_id, const ChatMarkReadPayload& req, std::string* out) {
+    swift::gate::ReadReceiptNotify receipt;
+    receipt.set_chat_id(req.chat_id());
+    receipt.set_user_id(user_id);
+    receipt.set_last_read_msg_id(req.last_msg_id());
+    return receipt.SerializeToString(out);
+}
 }  // namespace
 
 ZoneServiceImpl::ZoneServiceImpl(std::shared_ptr<SessionStore> store, SystemManager* manager)
     : store_(std::move(store)), manager_(manager) {}
 
-ZoneServiceImpl::~ZoneServiceImpl() = default;
+ZoneServiceImpl::~ZoneServiceImpl() {
+    StopRequestExecutor();  // 先停执行器：其中的推送任务可能还要提交给扇出引擎
+    StopFanout();
+}
 
 void ZoneServiceImpl::BindChatPushToUser() {
     if (!manager_) return;
@@ -41,7 +125,155 @@ void ZoneServiceImpl::BindChatPushToUser() {
     });
 }
 
+void ZoneServiceImpl::StartFanout(const FanoutOptions& options) {
+    if (fanout_) return;
+    fanout_ = std::make_unique<FanoutEngine>(
+        options,
+        [this](const std::string& group_id, std::vector<std::string>* members) {
+            return ResolveGroupMembers(group_id, members);
+        },
+        [this](const std::vector<std::string>& user_ids,
+               std::unordered_map<std::string, std::vector<std::string>>* by_gate) {
+            ResolveRoutes(user_ids, by_gate);
+        },
+        [this](const std::string& gate_addr, const std::vector<std::string>& user_ids,
+               const std::string& cmd, const std::string& payload,
+               FanoutEngine::Clock::time_point deadline, FanoutEngine::PushDone done) {
+            PushToGateAsync(gate_addr, user_ids, cmd, payload, deadline, std::move(done));
+        });
+    fanout_->Start();
+    LogInfo(TAG("service", "zonesvr"), "Fanout engine started: workers=" << options.workers
+            << ", max_queue=" << options.max_queue
+            << ", max_inflight_pushes=" << options.max_inflight_pushes
+            << ", batch_size=" << options.batch_size
+            << ", deadline_ms=" << options.deadline_ms);
+}
+
+void ZoneServiceImpl::StopFanout() {
+    if (fanout_) fanout_->Stop();
+}
+
+void ZoneServiceImpl::StartRequestExecutor(const RequestExecutorOptions& options) {
+    if (executor_) return;
+    executor_ = std::make_unique<RequestExecutor>(options);
+    executor_->Start();
+    LogInfo(TAG("service", "zonesvr"), "Request executor started: workers=" << options.workers
+            << ", max_queue=" << options.max_queue);
+}
+
+void ZoneServiceImpl::StopRequestExecutor() {
+    if (executor_) executor_->Stop();
+}
+
+std::string ZoneServiceImpl::RequestExecutorStats() const {
+    return executor_ ? executor_->FormatStats() : std::string();
+}
+
+void ZoneServiceImpl::EnableRouteCache(const RouteCacheOptions& options, bool pubsub) {
+    if (route_cache_ || options.ttl_ms <= 0) return;
+    route_cache_ = std::make_shared<RouteCache>(options);
+    bool subscribed = false;
+    if (pubsub) {
+        // 捕获 weak_ptr：订阅线程由 SessionStore 持有，可能比本对象活得久
+        std::weak_ptr<RouteCache> weak = route_cache_;
+        subscribed = store_->SubscribeSessionChanges([weak](const std::string& user_id) {
+            auto cache = weak.lock();
+            if (!cache) return;
+            if (user_id.empty()) cache->Clear();
+            else cache->Invalidate(user_id);
+        });
+        if (!subscribed) {
+            LogWarning(TAG("service", "zonesvr"), "Route cache pub/sub invalidation unavailable for this "
+                       "session store; entries rely on ttl_ms=" << options.ttl_ms);
+        }
+    }
+    LogInfo(TAG("service", "zonesvr"), "Route cache enabled: capacity=" << options.capacity
+            << ", ttl_ms=" << options.ttl_ms << ", pubsub=" << (subscribed ? "on" : "off"));
+}
+
+std::string ZoneServiceImpl::RouteCacheStats() const {
+    return route_cache_ ? route_cache_->FormatStats() : std::string();
+}
+
+void ZoneServiceImpl::EnableGroupMemberCache(const GroupMemberCacheOptions& options) {
+    if (group_cache_ || options.ttl_ms <= 0) return;
+    group_cache_ = std::make_unique<GroupMemberCache>(options);
+    LogInfo(TAG("service", "zonesvr"), "Group member cache enabled: capacity=" << options.capacity
+            << ", ttl_ms=" << options.ttl_ms);
+}
+
+std::string ZoneServiceImpl::GroupMemberCacheStats() const {
+    return group_cache_ ? group_cache_->FormatStats() : std::string();
+}
+
+std::optional<CachedRoute> ZoneServiceImpl::LookupRoute(const std::string& user_id, bool* from_cache) {
+    *from_cache = false;
+    uint64_t epoch = 0;
+    if (route_cache_) {
+        if (auto hit = route_cache_->Get(user_id, SteadyNowMs())) {
+            *from_cache = true;
+            return hit;
+        }
+        epoch = route_cache_->LoadEpoch(user_id);
+    }
+    auto session = store_->GetSession(user_id);
+    if (!session) return std::nullopt;
+    CachedRoute route{session->gate_id, session->gate_addr};
+    if (route_cache_) route_cache_->Put(user_id, route, epoch, SteadyNowMs());
+    return route;
+}
+
+size_t ZoneServiceImpl::ResolveRoutes(const std::vector<std::string>& user_ids,
+                                      std::unordered_map<std::string, std::vector<std::string>>* by_gate) {
+    size_t online = 0;
+    if (!route_cache_) {
+        for (auto& s : store_->GetSessions(user_ids)) {
+            (*by_gate)[s.gate_addr].push_back(std::move(s.user_id));
+            ++online;
+        }
+        return online;
+    }
+    // 先查近端缓存，未命中的用户一次批量回源
+    int64_t now = SteadyNowMs();
+    std::vector<std::string> misses;
+    std::unordered_map<std::string, uint64_t> epochs;
+    for (const auto& uid : user_ids) {
+        if (auto hit = route_cache_->Get(uid, now)) {
+            (*by_gate)[hit->gate_addr].push_back(uid);
+            ++online;
+            continue;
+        }
+        epochs[uid] = route_cache_->LoadEpoch(uid);
+        misses.push_back(uid);
+    }
+    if (misses.empty()) return online;
+    auto sessions = store_->GetSessions(misses);
+    now = SteadyNowMs();
+    for (auto& s : sessions) {
+        route_cache_->Put(s.user_id, CachedRoute{s.gate_id, s.gate_addr}, epochs[s.user_id], now);
+        (*by_gate)[s.gate_addr].push_back(std::move(s.user_id));
+        ++online;
+    }
+    return online;
+}
+
+void ZoneServiceImpl::InvalidateRoute(const std::string& user_id) {
+    if (route_cache_) route_cache_->Invalidate(user_id);
+}
+
+void ZoneServiceImpl::DropStaleRoutes(const std::vector<std::string>& user_ids) {
+    if (!route_cache_ || user_ids.empty()) return;
+    route_cache_->ReportStale(user_ids.size());
+    for (const auto& uid : user_ids)
+        route_cache_->Invalidate(uid);
+}
+
+std::string ZoneServiceImpl::FanoutStats() const {
+    return fanout_ ? fanout_->FormatStats() : std::string();
+}
+
 bool ZoneServiceImpl::UserOnline(const std::string& user_id, const std::string& gate_id,
+                                 const std::string& conn_id,
                                  const std::string& device_type, const std::string& device_id) {
     auto gate = store_->GetGate(gate_id);
     if (!gate) {
@@ -53,12 +285,14 @@ bool ZoneServiceImpl::UserOnline(const std::string& user_id, const std::string&
     session.user_id = user_id;
     session.gate_id = gate_id;
     session.gate_addr = gate->address;
+    session.conn_id = conn_id;
     session.device_type = device_type;
     session.device_id = device_id;
     session.online_at = session.last_active_at =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
     bool ok = store_->SetOnline(session);
+    InvalidateRoute(user_id);
     if (ok) {
         LogInfo(TAG("service", "zonesvr"), "UserOnline success: user_id=" << user_id
                 << ", gate_id=" << gate_id
@@ -70,14 +304,21 @@ bool ZoneServiceImpl::UserOnline(const std::string& user_id, const std::string&
     return ok;
 }
 
-bool ZoneServiceImpl::UserOffline(const std::string& user_id, const std::string& gate_id) {
-    bool ok = store_->SetOffline(user_id);
-    if (ok) {
+bool ZoneServiceImpl::UserOffline(const std::string& user_id, const std::string& gate_id,
+                                  const std::string& conn_id) {
+    bool removed = false;
+    bool ok = store_->SetOfflineIfMatch(user_id, gate_id, conn_id, &removed);
+    if (removed)
+        InvalidateRoute(user_id);
+    if (!ok) {
+        LogWarning(TAG("service", "zonesvr"), "UserOffline failed: user_id=" << user_id
+                   << ", gate_id=" << gate_id << ", conn_id=" << conn_id);
+    } else if (removed) {
         LogInfo(TAG("service", "zonesvr"), "UserOffline success: user_id=" << user_id
-                << ", gate_id=" << gate_id);
+                << ", gate_id=" << gate_id << ", conn_id=" << conn_id);
     } else {
-        LogWarning(TAG("service", "zonesvr"), "UserOffline failed: user_id=" << user_id
-                   << ", gate_id=" << gate_id);
+        LogInfo(TAG("service", "zonesvr"), "UserOffline skipped: session belongs to another connection, user_id="
+                << user_id << ", gate_id=" << gate_id << ", conn_id=" << conn_id);
     }
     return ok;
 }
@@ -94,7 +335,8 @@ ZoneServiceImpl::RouteResult ZoneServiceImpl::RouteToUser(const std::string& use
                                                           const std::string& cmd,
                                                           const std::string& payload) {
     RouteResult result{};
-    auto opt = store_->GetSession(user_id);
+    bool from_cache = false;
+    auto opt = LookupRoute(user_id, &from_cache);
     if (!opt) {
         result.user_online = false;
         LogDebug(TAG("service", "zonesvr"), "RouteToUser skipped: user offline, user_id=" << user_id
@@ -104,6 +346,21 @@ ZoneServiceImpl::RouteResult ZoneServiceImpl::RouteToUser(const std::string& use
     result.user_online = true;
     result.gate_id = opt->gate_id;
     result.delivered = PushToGate(opt->gate_addr, user_id, cmd, payload);
+    if (!result.delivered && from_cache) {
+        // 缓存的路由可能已过时（用户换了 Gate 或已下线）：失效后回源，路由变化则重试一次
+        InvalidateRoute(user_id);
+        auto fresh = LookupRoute(user_id, &from_cache);
+        if (!fresh || fresh->gate_addr != opt->gate_addr) {
+            route_cache_->ReportStale();
+            if (!fresh) {
+                result.user_online = false;
+                return result;
+            }
+            opt = fresh;
+            result.gate_id = opt->gate_id;
+            result.delivered = PushToGate(opt->gate_addr, user_id, cmd, payload);
+        }
+    }
     if (!result.delivered) {
         LogWarning(TAG("service", "zonesvr"), "RouteToUser failed: push to gate failed, user_id=" << user_id
                    << ", gate_id=" << result.gate_id
@@ -122,13 +379,23 @@ ZoneServiceImpl::BroadcastResult ZoneServiceImpl::Broadcast(const std::vector<st
                                                            const std::string& cmd,
                                                            const std::string& payload) {
     BroadcastResult result{};
-    auto sessions = store_->GetSessions(user_ids);
-    result.online_count = static_cast<int>(sessions.size());
+    // 按 gate_addr 分组：N 个接收者只需 (Gate 数) 次 RPC，payload 每个 Gate 传一次
+    std::unordered_map<std::string, std::vector<std::string>> by_gate;
+    result.online_count = static_cast<int>(ResolveRoutes(user_ids, &by_gate));
     result.delivered_count = 0;
-    for (const auto& s : sessions) {
-        if (PushToGate(s.gate_addr, s.user_id, cmd, payload))
-            result.delivered_count++;
+    for (const auto& [gate_addr, gate_users] : by_gate) {
+        if (gate_users.size() == 1) {
+            if (PushToGate(gate_addr, gate_users[0], cmd, payload))
+                result.delivered_count++;
+            continue;
+        }
+        result.delivered_count += PushToGateBatch(gate_addr, gate_users, cmd, payload);
     }
+    LogDebug(TAG("service", "zonesvr"), "Broadcast: cmd=" << cmd
+             << ", recipients=" << user_ids.size()
+             << ", online=" << result.online_count
+             << ", gates=" << by_gate.size()
+             << ", delivered=" << result.delivered_count);
     return result;
 }
 
@@ -163,20 +430,19 @@ bool ZoneServiceImpl::GateHeartbeat(const std::string& gate_id, int connections)
 
 bool ZoneServiceImpl::KickUser(const std::string& user_id, const std::string& reason) {
     (void)reason;
-    return store_->SetOffline(user_id);
+    bool ok = store_->SetOffline(user_id);
+    InvalidateRoute(user_id);
+    return ok;
 }
 
 std::shared_ptr<GateRpcClient> ZoneServiceImpl::GetOrCreateGateClient(const std::string& gate_addr) {
     if (gate_addr.empty()) return nullptr;
     std::lock_guard<std::mutex> lock(gate_clients_mutex_);
     auto it = gate_clients_.find(gate_addr);
-    if (it != gate_clients_.end()) {
-        auto& client = it->second;
-        if (client->IsConnected()) return client;
-        client->Disconnect();
-    }
+    // 已有客户端直接复用：Channel 断线后在后台按退避自行重连，不在请求路径上重建或等待就绪
+    if (it != gate_clients_.end()) return it->second;
     auto client = std::make_shared<GateRpcClient>();
-    if (!client->Connect(gate_addr)) {
+    if (!client->Connect(gate_addr, /*wait_ready=*/false)) {
         LogWarning(TAG("service", "zonesvr"), "GetOrCreateGateClient Connect failed: gate_addr=" << gate_addr);
         return nullptr;
     }
@@ -202,20 +468,150 @@ bool ZoneServiceImpl::PushToGate(const std::string& gate_addr, const std::string
     return true;
 }
 
+int ZoneServiceImpl::PushToGateBatch(const std::string& gate_addr,
+                                     const std::vector<std::string>& user_ids,
+                                     const std::string& cmd, const std::string& payload) {
+    auto client = GetOrCreateGateClient(gate_addr);
+    if (!client) {
+        LogWarning(TAG("service", "zonesvr"), "PushToGateBatch failed: no client for gate_addr=" << gate_addr
+                   << ", users=" << user_ids.size() << ", cmd=" << cmd);
+        return 0;
+    }
+    int delivered = 0;
+    std::vector<std::string> offline;
+    std::string err;
+    if (!client->BatchPushMessage(user_ids, cmd, payload, &delivered, &offline, &err)) {
+        LogWarning(TAG("service", "zonesvr"), "PushToGateBatch failed: gate_addr=" << gate_addr
+                   << ", users=" << user_ids.size() << ", cmd=" << cmd << ", error=" << err);
+        return 0;
+    }
+    if (!offline.empty()) {
+        LogDebug(TAG("service", "zonesvr"), "PushToGateBatch: " << offline.size()
+                 << " user(s) no longer connected on gate_addr=" << gate_addr << ", cmd=" << cmd);
+        DropStaleRoutes(offline);
+    }
+    return delivered;
+}
+
+void ZoneServiceImpl::PushToGateAsync(const std::string& gate_addr,
+                                      const std::vector<std::string>& user_ids,
+                                      const std::string& cmd, const std::string& payload,
+                                      FanoutEngine::Clock::time_point deadline,
+                                      FanoutEngine::PushDone done) {
+    auto client = GetOrCreateGateClient(gate_addr);
+    if (!client) {
+        LogWarning(TAG("service", "zonesvr"), "PushToGateAsync failed: no client for gate_addr=" << gate_addr
+                   << ", users=" << user_ids.size() << ", cmd=" << cmd);
+        done(0);
+        return;
+    }
+    auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - FanoutEngine::Clock::now()).count();
+    if (remaining_ms <= 0) {
+        done(0);
+        return;
+    }
+    client->BatchPushMessageAsync(user_ids, cmd, payload, static_cast<int>(remaining_ms),
+        [this, client, gate_addr, cmd, users = user_ids.size(), done = std::move(done)](
+            bool ok, int delivered, const std::vector<std::string>& offline, const std::string& err) {
+            if (!ok) {
+                LogWarning(TAG("service", "zonesvr"), "PushToGateAsync failed: gate_addr=" << gate_addr
+                           << ", users=" << users << ", cmd=" << cmd << ", error=" << err);
+            }
+            DropStaleRoutes(offline);
+            done(ok ? delivered : 0);
+        });
+}
+
+bool ZoneServiceImpl::ResolveGroupMembers(const std::string& group_id, std::vector<std::string>* out) {
+    uint64_t epoch = 0;
+    if (group_cache_) {
+        if (auto hit = group_cache_->Get(group_id, SteadyNowMs())) {
+            *out = hit->member_ids;
+            return true;
+        }
+        epoch = group_cache_->LoadEpoch(group_id);
+    }
+    auto* grp = manager_ ? manager_->GetGroupSystem() : nullptr;
+    if (!grp) return false;
+    std::vector<GroupMemberResult> members;
+    int total = 0;
+    std::string err;
+    if (!grp->GetGroupMembers(group_id, 0, 10000, &members, &total, &err)) {
+        LogWarning(TAG("service", "zonesvr"), "ResolveGroupMembers failed: group_id=" << group_id
+                   << ", error=" << err);
+        return false;
+    }
+    out->reserve(members.size());
+    for (auto& m : members)
+        out->push_back(std::move(m.user_id));
+    // 超过单页上限的大群成员不完整，不缓存
+    if (group_cache_ && total <= static_cast<int>(out->size()))
+        group_cache_->Put(group_id, *out, epoch, SteadyNowMs());
+    return true;
+}
+
+void ZoneServiceImpl::FanoutToGroup(const std::string& group_id, const std::string& exclude_user_id,
+                                    const std::string& cmd, const std::string& payload) {
+    if (fanout_) {
+        FanoutTask task;
+        task.group_id = group_id;
+        task.exclude_user_id = exclude_user_id;
+        task.cmd = cmd;
+        task.payload = payload;
+        // 队列满时放弃实时推送：消息已落库，接收方上线/拉取离线时仍可获得
+        if (!fanout_->Submit(std::move(task))) {
+            LogWarning(TAG("service", "zonesvr"), "FanoutToGroup rejected: queue full, group_id=" << group_id
+                       << ", cmd=" << cmd);
+        }
+        return;
+    }
+    std::vector<std::string> recipients;
+    if (!ResolveGroupMembers(group_id, &recipients))
+        return;
+    recipients.erase(std::remove(recipients.begin(), recipients.end(), exclude_user_id),
+                     recipients.end());
+    Broadcast(recipients, cmd, payload);
+}
+
+void ZoneServiceImpl::PushToConversation(int32_t chat_type, const std::string& chat_id,
+                                         const std::string& exclude_user_id, const std::string& cmd,
+                                         const std::string& payload) {
+    if (chat_type == static_cast<int32_t>(swift::ChatType::PRIVATE)) {
+        RouteToUser(chat_id, cmd, payload);
+        return;
+    }
+    if (chat_type == static_cast<int32_t>(swift::ChatType::GROUP))
+        FanoutToGroup(chat_id, exclude_user_id, cmd, payload);
+}
+
+void ZoneServiceImpl::DeferPush(std::function<void()> fn) {
+    if (!executor_) {
+        fn();
+        return;
+    }
+    // 与 FanoutToGroup 一致：过载时放弃实时推送，消息已落库，接收方可拉取
+    if (!executor_->Submit(std::move(fn)))
+        LogWarning(TAG("service", "zonesvr"), "DeferPush rejected: request executor queue full");
+}
+
 // -----------------------------------------------------------------------------
-// HandleClientRequest：按前缀表驱动分发，避免长 if-else
+// HandleClientRequest：按 CmdId 所属域查表分发，无字符串解析与分配
 // -----------------------------------------------------------------------------
 
-const std::unordered_map<std::string, ZoneServiceImpl::CmdHandlerFn>&
-ZoneServiceImpl::GetPrefixHandlers() {
-    static const std::unordered_map<std::string, CmdHandlerFn> kHandlers = {
-        {"auth",   &ZoneServiceImpl::HandleAuth},
-        {"chat",   &ZoneServiceImpl::HandleChat},
-        {"friend", &ZoneServiceImpl::HandleFriend},
-        {"group",  &ZoneServiceImpl::HandleGroup},
-        {"file",   &ZoneServiceImpl::HandleFile},
+ZoneServiceImpl::CmdHandlerFn ZoneServiceImpl::DomainHandler(swift::CmdId cmd_id) {
+    // 下标即 CmdDomain 取值
+    static constexpr CmdHandlerFn kHandlers[] = {
+        nullptr,                        // SYSTEM（heartbeat 等由 Gate 处理）
+        &ZoneServiceImpl::HandleAuth,
+        &ZoneServiceImpl::HandleChat,
+        &ZoneServiceImpl::HandleFriend,
+        &ZoneServiceImpl::HandleGroup,
+        &ZoneServiceImpl::HandleFile,
     };
-    return kHandlers;
+    if (cmd_id == swift::CmdId::UNKNOWN) return nullptr;
+    auto domain = static_cast<size_t>(swift::CmdDomainOf(cmd_id));
+    return domain < std::size(kHandlers) ? kHandlers[domain] : nullptr;
 }
 
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::NotImplemented(
@@ -229,6 +625,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::NotImplemented(
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleClientRequest(
     const std::string& conn_id,
     const std::string& user_id,
+    swift::CmdId cmd_id,
     const std::string& cmd,
     const std::string& payload,
     const std::string& request_id,
@@ -247,26 +644,16 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleClientRequest(
                  << request_id << ", cmd=" << cmd);
         return result;
     }
-    std::string prefix;
-    {
-        size_t dot = cmd.find('.');
-        prefix = (dot != std::string::npos) ? cmd.substr(0, dot) : cmd;
-    }
-    const auto& handlers = GetPrefixHandlers();
-    auto it = handlers.find(prefix);
-    if (it != handlers.end()) {
-        auto handled = (this->*it->second)(user_id, cmd, payload, request_id, token);
-        if (handled.code != swift::ErrorCodeToInt(swift::ErrorCode::OK)) {
-            LogWarning(TAG("service", "zonesvr"), "HandleClientRequest done with error: request_id="
-                       << request_id << ", cmd=" << cmd
-                       << ", code=" << handled.code
-                       << ", message=" << handled.message);
-        } else {
-            LogDebug(TAG("service", "zonesvr"), "HandleClientRequest done: request_id=" << request_id
-                     << ", cmd=" << cmd
-                     << ", code=" << handled.code
-                     << ", response_payload_size=" << handled.payload.size());
-        }
+    if (cmd_id == swift::CmdId::CHAT_SEND_MESSAGE || cmd_id == swift::CmdId::CHAT_MARK_READ) {
+        // 只有异步实现（HandleChatAsync 内已记日志），同步调用在此等待回包
+        std::promise<HandleClientRequestResult> reply;
+        HandleClientRequestDone done = [&reply](HandleClientRequestResult r) { reply.set_value(std::move(r)); };
+        HandleChatAsync(user_id, cmd_id, cmd, payload, request_id, token, done);
+        return reply.get_future().get();
+    }
+    if (CmdHandlerFn handler = DomainHandler(cmd_id)) {
+        auto handled = (this->*handler)(user_id, cmd_id, cmd, payload, request_id, token);
+        LogClientRequestDone(handled, cmd);
         return handled;
     }
     LogWarning(TAG("service", "zonesvr"), "HandleClientRequest unsupported cmd: request_id="
@@ -274,9 +661,34 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleClientRequest(
     return NotImplemented(cmd, request_id);
 }
 
+void ZoneServiceImpl::HandleClientRequestAsync(const std::string& conn_id,
+                                               const std::string& user_id,
+                                               swift::CmdId cmd_id,
+                                               const std::string& cmd,
+                                               const std::string& payload,
+                                               const std::string& request_id,
+                                               const std::string& token,
+                                               HandleClientRequestDone done) {
+    if (manager_ && HandleChatAsync(user_id, cmd_id, cmd, payload, request_id, token, done))
+        return;
+    if (!executor_) {
+        done(HandleClientRequest(conn_id, user_id, cmd_id, cmd, payload, request_id, token));
+        return;
+    }
+    bool queued = executor_->Submit([this, conn_id, user_id, cmd_id, cmd, payload, request_id, token, done]() {
+        done(HandleClientRequest(conn_id, user_id, cmd_id, cmd, payload, request_id, token));
+    });
+    if (queued) return;
+    HandleClientRequestResult result;
+    SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
+    LogWarning(TAG("service", "zonesvr"), "HandleClientRequest rejected: request executor queue full, request_id="
+               << request_id << ", cmd=" << cmd);
+    done(std::move(result));
+}
+
 // ---------- auth.* ----------
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
-    const std::string& user_id, const std::string& cmd,
+    const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
     const std::string& payload, const std::string& request_id,
     const std::string& token) {
     (void)user_id;
@@ -288,7 +700,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
         SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
         return result;
     }
-    if (cmd == "auth.register") {
+    if (cmd_id == swift::CmdId::AUTH_REGISTER) {
         swift::zone::AuthRegisterPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -315,7 +727,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
         if (!reg.error.empty()) result.message = reg.error;
         return result;
     }
-    if (cmd == "auth.login") {
+    if (cmd_id == swift::CmdId::AUTH_LOGIN) {
         AuthLoginPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -339,7 +751,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
         else if (!login.success) result.message = swift::ErrorCodeToString(swift::ErrorCode::AUTH_FAILED);
         return result;
     }
-    if (cmd == "auth.logout") {
+    if (cmd_id == swift::CmdId::AUTH_LOGOUT) {
         AuthLogoutPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -352,7 +764,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
         else if (!logout.success) result.message = swift::ErrorCodeToString(swift::ErrorCode::AUTH_FAILED);
         return result;
     }
-    if (cmd == "auth.validate_token") {
+    if (cmd_id == swift::CmdId::AUTH_VALIDATE_TOKEN) {
         AuthValidateTokenPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -373,7 +785,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleAuth(
 
 // ---------- chat.* ----------
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
-    const std::string& user_id, const std::string& cmd,
+    const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
     const std::string& payload, const std::string& request_id,
     const std::string& token) {
     HandleClientRequestResult result;
@@ -383,113 +795,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
         SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
         return result;
     }
-    if (cmd == "chat.send_message") {
-        ChatSendMessagePayload req;
-        if (!req.ParseFromString(payload)) {
-            SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
-            return result;
-        }
-        std::vector<std::string> mentions(req.mentions().begin(), req.mentions().end());
-        auto r = chat->SendMessage(req.from_user_id(), req.to_id(), req.chat_type(),
-                                  req.content(), req.media_url(), req.media_type(),
-                                  mentions, req.reply_to_msg_id(),
-                                  req.client_msg_id(), req.file_size(), token);
-        ChatSendMessageResponsePayload resp_pb;
-        resp_pb.set_success(r.success);
-        resp_pb.set_msg_id(r.msg_id);
-        resp_pb.set_timestamp(r.timestamp);
-        resp_pb.set_error(r.error);
-        if (!resp_pb.SerializeToString(&result.payload)) {
-            SetResultError(result, swift::ErrorCode::INTERNAL_ERROR, request_id);
-            return result;
-        }
-        result.code = r.success ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
-                               : swift::ErrorCodeToInt(swift::ErrorCode::MSG_SEND_FAILED);
-        if (!r.error.empty()) result.message = r.error;
-        else if (!r.success) result.message = swift::ErrorCodeToString(swift::ErrorCode::MSG_SEND_FAILED);
-
-        // 推送给在线接收者（卫语句：不满足条件则直接 return，避免深层嵌套）
-        if (!r.success || r.msg_id.empty())
-            return result;
-        ChatMessagePushPayload push_pb;
-        push_pb.set_msg_id(r.msg_id);
-        push_pb.set_from_user_id(req.from_user_id());
-        push_pb.set_to_id(req.to_id());
-        push_pb.set_chat_type(req.chat_type());
-        push_pb.set_content(req.content());
-        push_pb.set_media_url(req.media_url());
-        push_pb.set_media_type(req.media_type());
-        push_pb.set_timestamp(r.timestamp);
-        for (const auto& u : req.mentions()) push_pb.add_mentions(u);
-        if (!req.reply_to_msg_id().empty()) push_pb.set_reply_to_msg_id(req.reply_to_msg_id());
-        std::string push_payload;
-        if (!push_pb.SerializeToString(&push_payload))
-            return result;
-        if (req.chat_type() == static_cast<int32_t>(swift::ChatType::PRIVATE)) {
-            RouteToUser(req.to_id(), "chat.message", push_payload);
-            return result;
-        }
-        if (req.chat_type() != static_cast<int32_t>(swift::ChatType::GROUP))
-            return result;
-        auto* grp = manager_->GetGroupSystem();
-        if (!grp)
-            return result;
-        std::vector<GroupMemberResult> members;
-        int total = 0;
-        std::string err;
-        if (!grp->GetGroupMembers(req.to_id(), 0, 10000, &members, &total, &err))
-            return result;
-        for (const auto& m : members) {
-            if (m.user_id != req.from_user_id())
-                RouteToUser(m.user_id, "chat.message", push_payload);
-        }
-        return result;
-    }
-    if (cmd == "chat.mark_read") {
-        ChatMarkReadPayload req;
-        if (!req.ParseFromString(payload)) {
-            SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
-            return result;
-        }
-        std::string err;
-        bool ok = chat->MarkRead(user_id, req.chat_id(), req.chat_type(),
-                                req.last_msg_id(), &err, token);
-        result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
-                        : swift::ErrorCodeToInt(swift::ErrorCode::INVALID_PARAM);
-        if (!err.empty()) result.message = err;
-        else if (!ok) result.message = "mark read failed";
-
-        // 已读回执：推送给会话内其他人（卫语句减少嵌套）
-        if (!ok || req.last_msg_id().empty())
-            return result;
-        swift::gate::ReadReceiptNotify receipt;
-        receipt.set_chat_id(req.chat_id());
-        receipt.set_user_id(user_id);
-        receipt.set_last_read_msg_id(req.last_msg_id());
-        std::string receipt_payload;
-        if (!receipt.SerializeToString(&receipt_payload))
-            return result;
-        if (req.chat_type() == static_cast<int32_t>(swift::ChatType::PRIVATE)) {
-            RouteToUser(req.chat_id(), "chat.read_receipt", receipt_payload);
-            return result;
-        }
-        if (req.chat_type() != static_cast<int32_t>(swift::ChatType::GROUP))
-            return result;
-        auto* grp = manager_->GetGroupSystem();
-        if (!grp)
-            return result;
-        std::vector<GroupMemberResult> members;
-        int total = 0;
-        std::string grp_err;
-        if (!grp->GetGroupMembers(req.chat_id(), 0, 10000, &members, &total, &grp_err))
-            return result;
-        for (const auto& m : members) {
-            if (m.user_id != user_id)
-                RouteToUser(m.user_id, "chat.read_receipt", receipt_payload);
-        }
-        return result;
-    }
-    if (cmd == "chat.pull_offline") {
+    if (cmd_id == swift::CmdId::CHAT_PULL_OFFLINE) {
         ChatPullOfflinePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -531,7 +837,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "chat.recall_message") {
+    if (cmd_id == swift::CmdId::CHAT_RECALL_MESSAGE) {
         ChatRecallMessagePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -545,7 +851,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
         else if (!ok) result.message = swift::ErrorCodeToString(swift::ErrorCode::RECALL_NOT_ALLOWED);
         return result;
     }
-    if (cmd == "chat.get_history") {
+    if (cmd_id == swift::CmdId::CHAT_GET_HISTORY) {
         ChatGetHistoryPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -583,7 +889,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "chat.sync_conversations") {
+    if (cmd_id == swift::CmdId::CHAT_SYNC_CONVERSATIONS) {
         ChatSyncConversationsPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -621,7 +927,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "chat.delete_conversation") {
+    if (cmd_id == swift::CmdId::CHAT_DELETE_CONVERSATION) {
         ChatDeleteConversationPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -641,9 +947,76 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleChat(
     return NotImplemented(cmd, request_id);
 }
 
+bool ZoneServiceImpl::HandleChatAsync(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
+                                      const std::string& payload, const std::string& request_id,
+                                      const std::string& token, HandleClientRequestDone& done) {
+    if (cmd_id != swift::CmdId::CHAT_SEND_MESSAGE && cmd_id != swift::CmdId::CHAT_MARK_READ)
+        return false;
+    HandleClientRequestResult result;
+    auto* chat = manager_->GetChatSystem();
+    if (!chat) {
+        SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
+        LogClientRequestDone(result, cmd);
+        done(std::move(result));
+        return true;
+    }
+    if (cmd_id == swift::CmdId::CHAT_SEND_MESSAGE) {
+        auto req = std::make_shared<ChatSendMessagePayload>();
+        if (!req->ParseFromString(payload)) {
+            SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
+            LogClientRequestDone(result, cmd);
+            done(std::move(result));
+            return true;
+        }
+        std::vector<std::string> mentions(req->mentions().begin(), req->mentions().end());
+        chat->SendMessageAsync(req->from_user_id(), req->to_id(), req->chat_type(),
+                               req->content(), req->media_url(), req->media_type(),
+                               mentions, req->reply_to_msg_id(),
+                               req->client_msg_id(), req->file_size(), token,
+            [this, req, cmd, request_id, done = std::move(done)](const ChatSystem::SendMessageResult& r) {
+                auto result = SendMessageResponse(r, request_id);
+                LogClientRequestDone(result, cmd);
+                done(std::move(result));
+                if (!r.success || r.msg_id.empty() || r.duplicate)
+                    return;
+                std::string push_payload;
+                if (!BuildChatMessagePush(*req, r.msg_id, r.timestamp, &push_payload))
+                    return;
+                DeferPush([this, chat_type = req->chat_type(), to_id = req->to_id(),
+                           from = req->from_user_id(), push_payload = std::move(push_payload)]() {
+                    PushToConversation(chat_type, to_id, from, "chat.message", push_payload);
+                });
+            });
+        return true;
+    }
+    auto req = std::make_shared<ChatMarkReadPayload>();
+    if (!req->ParseFromString(payload)) {
+        SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
+        LogClientRequestDone(result, cmd);
+        done(std::move(result));
+        return true;
+    }
+    chat->MarkReadAsync(user_id, req->chat_id(), req->chat_type(), req->last_msg_id(), token,
+        [this, req, user_id, cmd, request_id, done = std::move(done)](bool ok, const std::string& err) {
+            auto result = MarkReadResponse(ok, err, request_id);
+            LogClientRequestDone(result, cmd);
+            done(std::move(result));
+            if (!ok || req->last_msg_id().empty())
+                return;
+            std::string receipt_payload;
+            if (!BuildReadReceipt(user_id, *req, &receipt_payload))
+                return;
+            DeferPush([this, req, user_id, receipt_payload = std::move(receipt_payload)]() {
+                PushToConversation(req->chat_type(), req->chat_id(), user_id, "chat.read_receipt",
+                                   receipt_payload);
+            });
+        });
+    return true;
+}
+
 // ---------- friend.* ----------
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
-    const std::string& user_id, const std::string& cmd,
+    const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
     const std::string& payload, const std::string& request_id,
     const std::string& token) {
     HandleClientRequestResult result;
@@ -653,7 +1026,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
         return result;
     }
-    if (cmd == "friend.add") {
+    if (cmd_id == swift::CmdId::FRIEND_ADD) {
         FriendAddPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -664,7 +1037,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "friend.handle_request") {
+    if (cmd_id == swift::CmdId::FRIEND_HANDLE_REQUEST) {
         FriendHandleRequestPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -675,7 +1048,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "friend.remove") {
+    if (cmd_id == swift::CmdId::FRIEND_REMOVE) {
         FriendRemovePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -686,7 +1059,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "friend.block") {
+    if (cmd_id == swift::CmdId::FRIEND_BLOCK) {
         FriendBlockPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -697,7 +1070,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "friend.unblock") {
+    if (cmd_id == swift::CmdId::FRIEND_UNBLOCK) {
         FriendBlockPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -708,7 +1081,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "friend.get_friends") {
+    if (cmd_id == swift::CmdId::FRIEND_GET_FRIENDS) {
         FriendGetFriendsPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -743,7 +1116,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "friend.get_requests" || cmd == "friend.get_friend_requests") {
+    if (cmd_id == swift::CmdId::FRIEND_GET_REQUESTS || cmd_id == swift::CmdId::FRIEND_GET_FRIEND_REQUESTS) {
         FriendGetRequestsPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -780,7 +1153,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "friend.search") {
+    if (cmd_id == swift::CmdId::FRIEND_SEARCH) {
         FriendSearchPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -822,7 +1195,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "friend.get_block_list") {
+    if (cmd_id == swift::CmdId::FRIEND_GET_BLOCK_LIST) {
         FriendGetBlockListPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -851,7 +1224,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "friend.create_group") {
+    if (cmd_id == swift::CmdId::FRIEND_CREATE_GROUP) {
         FriendCreateGroupPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -875,7 +1248,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         if (!ok && !err.empty()) result.message = err;
         return result;
     }
-    if (cmd == "friend.get_groups") {
+    if (cmd_id == swift::CmdId::FRIEND_GET_GROUPS) {
         FriendGetGroupsPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -909,7 +1282,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "friend.move_to_group") {
+    if (cmd_id == swift::CmdId::FRIEND_MOVE_TO_GROUP) {
         FriendMoveToGroupPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -933,7 +1306,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         if (!ok && !err.empty()) result.message = err;
         return result;
     }
-    if (cmd == "friend.delete_group") {
+    if (cmd_id == swift::CmdId::FRIEND_DELETE_GROUP) {
         FriendDeleteGroupPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -957,7 +1330,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
         if (!ok && !err.empty()) result.message = err;
         return result;
     }
-    if (cmd == "friend.set_remark") {
+    if (cmd_id == swift::CmdId::FRIEND_SET_REMARK) {
         FriendSetRemarkPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -986,7 +1359,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFriend(
 
 // ---------- group.* ----------
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
-    const std::string& user_id, const std::string& cmd,
+    const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
     const std::string& payload, const std::string& request_id,
     const std::string& token) {
     (void)user_id;
@@ -998,7 +1371,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
         SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
         return result;
     }
-    if (cmd == "group.create") {
+    if (cmd_id == swift::CmdId::GROUP_CREATE) {
         GroupCreatePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1019,19 +1392,20 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
         if (group_id.empty()) result.message = swift::ErrorCodeToString(swift::ErrorCode::INTERNAL_ERROR);
         return result;
     }
-    if (cmd == "group.dismiss") {
+    if (cmd_id == swift::CmdId::GROUP_DISMISS) {
         GroupDismissPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
             return result;
         }
         bool ok = grp->DismissGroup(req.group_id(), req.operator_id());
+        if (ok && group_cache_) group_cache_->Invalidate(req.group_id());
         result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
                         : swift::ErrorCodeToInt(swift::ErrorCode::NOT_GROUP_OWNER);
         if (!ok) result.message = swift::ErrorCodeToString(swift::ErrorCode::NOT_GROUP_OWNER);
         return result;
     }
-    if (cmd == "group.invite_members") {
+    if (cmd_id == swift::CmdId::GROUP_INVITE_MEMBERS) {
         GroupInviteMembersPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1039,33 +1413,36 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
         }
         std::vector<std::string> ids(req.member_ids().begin(), req.member_ids().end());
         bool ok = grp->InviteMembers(req.group_id(), req.inviter_id(), ids);
+        if (ok && group_cache_) group_cache_->AddMembers(req.group_id(), ids);
         result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "group.remove_member") {
+    if (cmd_id == swift::CmdId::GROUP_REMOVE_MEMBER) {
         GroupRemoveMemberPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
             return result;
         }
         bool ok = grp->RemoveMember(req.group_id(), req.operator_id(), req.member_id());
+        if (ok && group_cache_) group_cache_->RemoveMember(req.group_id(), req.member_id());
         result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "group.leave") {
+    if (cmd_id == swift::CmdId::GROUP_LEAVE) {
         GroupLeavePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
             return result;
         }
         bool ok = grp->LeaveGroup(req.group_id(), req.user_id());
+        if (ok && group_cache_) group_cache_->RemoveMember(req.group_id(), req.user_id());
         result.code = ok ? swift::ErrorCodeToInt(swift::ErrorCode::OK)
                         : swift::ErrorCodeToInt(swift::ErrorCode::UNKNOWN);
         return result;
     }
-    if (cmd == "group.get_info") {
+    if (cmd_id == swift::CmdId::GROUP_GET_INFO) {
         GroupGetInfoPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1095,7 +1472,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "group.get_members") {
+    if (cmd_id == swift::CmdId::GROUP_GET_MEMBERS) {
         GroupGetMembersPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1128,7 +1505,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
         result.code = swift::ErrorCodeToInt(swift::ErrorCode::OK);
         return result;
     }
-    if (cmd == "group.get_user_groups") {
+    if (cmd_id == swift::CmdId::GROUP_GET_USER_GROUPS) {
         GroupGetUserGroupsPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1169,7 +1546,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleGroup(
 
 // ---------- file.* ----------
 ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
-    const std::string& user_id, const std::string& cmd,
+    const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
     const std::string& payload, const std::string& request_id,
     const std::string& token) {
     (void)token;
@@ -1180,7 +1557,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
         SetResultError(result, swift::ErrorCode::SERVICE_UNAVAILABLE, request_id);
         return result;
     }
-    if (cmd == "file.get_upload_token") {
+    if (cmd_id == swift::CmdId::FILE_GET_UPLOAD_TOKEN) {
         FileGetUploadTokenPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1201,7 +1578,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
         if (tok.token.empty()) result.message = swift::ErrorCodeToString(swift::ErrorCode::UPLOAD_FAILED);
         return result;
     }
-    if (cmd == "file.init_upload") {
+    if (cmd_id == swift::CmdId::FILE_INIT_UPLOAD) {
         FileInitUploadPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1223,7 +1600,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
         if (!r.success && !r.error.empty()) result.message = r.error;
         return result;
     }
-    if (cmd == "file.get_file_info") {
+    if (cmd_id == swift::CmdId::FILE_GET_FILE_INFO) {
         FileGetFileInfoPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1249,7 +1626,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
         if (!r.success && !r.error.empty()) result.message = r.error;
         return result;
     }
-    if (cmd == "file.get_file_url") {
+    if (cmd_id == swift::CmdId::FILE_GET_FILE_URL) {
         FileGetFileUrlPayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1272,7 +1649,7 @@ ZoneServiceImpl::HandleClientRequestResult ZoneServiceImpl::HandleFile(
         if (url.url.empty()) result.message = swift::ErrorCodeToString(swift::ErrorCode::FILE_NOT_FOUND);
         return result;
     }
-    if (cmd == "file.delete") {
+    if (cmd_id == swift::CmdId::FILE_DELETE) {
         FileDeletePayload req;
         if (!req.ParseFromString(payload)) {
             SetResultError(result, swift::ErrorCode::INVALID_PARAM, request_id);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -7,6 +8,11 @@
 #include <vector>
 #include "../store/session_store.h"
 #include "../rpc/gate_rpc_client.h"
+#include "fanout_engine.h"
+#include "group_member_cache.h"
+#include "request_executor.h"
+#include "route_cache.h"
+#include "swift/cmd_id.h"
 
 namespace swift::zone {
 
@@ -30,11 +36,11 @@ public:
     ~ZoneServiceImpl();
     
     // 用户上线
-    bool UserOnline(const std::string& user_id, const std::string& gate_id,
+    bool UserOnline(const std::string& user_id, const std::string& gate_id, const std::string& conn_id,
                     const std::string& device_type, const std::string& device_id);
     
-    // 用户下线
-    bool UserOffline(const std::string& user_id, const std::string& gate_id);
+    // 用户下线：仅当会话仍属于该 gate_id/conn_id 时删除，迟到的下线不影响重连后的新会话
+    bool UserOffline(const std::string& user_id, const std::string& gate_id, const std::string& conn_id);
     
     // 获取用户会话（用于消息路由）
     std::optional<UserSession> GetUserSession(const std::string& user_id);
@@ -51,7 +57,7 @@ public:
     RouteResult RouteToUser(const std::string& user_id, const std::string& cmd,
                             const std::string& payload);
     
-    // 广播消息给多个用户
+    // 广播消息给多个用户：按所在 Gate 分组，每个 Gate 一次 BatchPushMessage
     struct BroadcastResult {
         int online_count;
         int delivered_count;
@@ -68,6 +74,7 @@ public:
 
     /**
      * 客户端业务请求统一入口：按 cmd 分发到对应 System，各 System 通过 gRPC 调后端。
+     * chat.send_message / chat.mark_read 走 HandleChatAsync，本函数阻塞等待其回包。
      * @return code, message, payload（业务返回体序列化），request_id 由调用方回填
      */
     struct HandleClientRequestResult {
@@ -78,48 +85,126 @@ public:
     };
     HandleClientRequestResult HandleClientRequest(const std::string& conn_id,
                                                   const std::string& user_id,
+                                                  swift::CmdId cmd_id,
                                                   const std::string& cmd,
                                                   const std::string& payload,
                                                   const std::string& request_id,
                                                   const std::string& token);
 
+    /**
+     * HandleClientRequest 的异步版本（供 gRPC callback 服务端使用），调用线程不阻塞：
+     * - chat.send_message / chat.mark_read 直接发起异步后端调用，done 在后端回包的 gRPC 线程上调用；
+     * - 其余命令交给请求执行器在工作线程上同步执行，队列满时立即以 SERVICE_UNAVAILABLE 回包；
+     * - 未启动请求执行器时退化为在调用线程上同步执行。
+     * done 恰好调用一次。
+     */
+    using HandleClientRequestDone = std::function<void(HandleClientRequestResult)>;
+    void HandleClientRequestAsync(const std::string& conn_id,
+                                  const std::string& user_id,
+                                  swift::CmdId cmd_id,
+                                  const std::string& cmd,
+                                  const std::string& payload,
+                                  const std::string& request_id,
+                                  const std::string& token,
+                                  HandleClientRequestDone done);
+
+    /// 启动/停止请求执行器（执行同步命令与回包后的推送）
+    void StartRequestExecutor(const RequestExecutorOptions& options);
+    void StopRequestExecutor();
+    /// 请求执行器计数与排队耗时分布（未启动返回空串）
+    std::string RequestExecutorStats() const;
+
     /// 绑定 ChatSystem::PushToUser 到本服务的 RouteToUser，需在构造后调用一次
     void BindChatPushToUser();
 
+    /// 启动群聊推送扇出引擎；未启动时群推送在请求线程内同步 Broadcast
+    void StartFanout(const FanoutOptions& options);
+    void StopFanout();
+    /// 扇出计数与各阶段延迟直方图（未启动返回空串），供主程序周期性输出
+    std::string FanoutStats() const;
+
+    /// 启用用户→Gate 路由近端缓存（ttl_ms<=0 不启用）；pubsub 为 true 时订阅其他副本的会话变更做失效
+    void EnableRouteCache(const RouteCacheOptions& options, bool pubsub);
+    /// 路由缓存命中率与陈旧度统计（未启用返回空串）
+    std::string RouteCacheStats() const;
+
+    /// 启用群成员缓存（ttl_ms<=0 不启用）：群推送命中时不再调 GetGroupMembers
+    void EnableGroupMemberCache(const GroupMemberCacheOptions& options);
+    /// 群成员缓存统计（未启用返回空串）
+    std::string GroupMemberCacheStats() const;
+
 private:
-    // 按域分发：各域内再按 cmd 细分，通过 gRPC 调对应 System/后端；token 供调业务服务时注入 metadata
-    HandleClientRequestResult HandleAuth(const std::string& user_id, const std::string& cmd,
+    // 按域分发：各域内再按 cmd_id 细分（cmd 仅用于日志），通过 gRPC 调对应 System/后端；token 供调业务服务时注入 metadata
+    HandleClientRequestResult HandleAuth(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
                                          const std::string& payload, const std::string& request_id,
                                          const std::string& token);
-    HandleClientRequestResult HandleChat(const std::string& user_id, const std::string& cmd,
+    HandleClientRequestResult HandleChat(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
                                          const std::string& payload, const std::string& request_id,
                                          const std::string& token);
-    HandleClientRequestResult HandleFriend(const std::string& user_id, const std::string& cmd,
+    HandleClientRequestResult HandleFriend(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
                                           const std::string& payload, const std::string& request_id,
                                           const std::string& token);
-    HandleClientRequestResult HandleGroup(const std::string& user_id, const std::string& cmd,
+    HandleClientRequestResult HandleGroup(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
                                          const std::string& payload, const std::string& request_id,
                                          const std::string& token);
-    HandleClientRequestResult HandleFile(const std::string& user_id, const std::string& cmd,
+    HandleClientRequestResult HandleFile(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
                                         const std::string& payload, const std::string& request_id,
                                         const std::string& token);
 
+    /// chat.send_message / chat.mark_read 的异步实现；其他 cmd 返回 false 且不调用 done
+    bool HandleChatAsync(const std::string& user_id, swift::CmdId cmd_id, const std::string& cmd,
+                         const std::string& payload, const std::string& request_id,
+                         const std::string& token, HandleClientRequestDone& done);
+
     static HandleClientRequestResult NotImplemented(const std::string& cmd,
                                                     const std::string& request_id);
 
     using CmdHandlerFn = HandleClientRequestResult (ZoneServiceImpl::*)(
-        const std::string&, const std::string&, const std::string&, const std::string&, const std::string&);
-    static const std::unordered_map<std::string, CmdHandlerFn>& GetPrefixHandlers();
+        const std::string&, swift::CmdId, const std::string&, const std::string&, const std::string&,
+        const std::string&);
+    /// 命令所属域的处理函数（按 CmdDomain 下标查常量表），无对应域返回 nullptr
+    static CmdHandlerFn DomainHandler(swift::CmdId cmd_id);
 
     bool PushToGate(const std::string& gate_addr, const std::string& user_id,
                     const std::string& cmd, const std::string& payload);
+    /// 批量推送给同一 Gate 上的多个用户，返回投递成功数（RPC 失败返回 0）
+    int PushToGateBatch(const std::string& gate_addr, const std::vector<std::string>& user_ids,
+                        const std::string& cmd, const std::string& payload);
 
     std::shared_ptr<GateRpcClient> GetOrCreateGateClient(const std::string& gate_addr);
 
+    /// 群推送：扇出引擎已启动则入队后立即返回，否则同步展开成员并 Broadcast
+    void FanoutToGroup(const std::string& group_id, const std::string& exclude_user_id,
+                       const std::string& cmd, const std::string& payload);
+    /// 推送给会话另一方：单聊 RouteToUser，群聊 FanoutToGroup（排除 exclude_user_id）
+    void PushToConversation(int32_t chat_type, const std::string& chat_id,
+                            const std::string& exclude_user_id, const std::string& cmd,
+                            const std::string& payload);
+    /// 异步回包后的推送：转交请求执行器，避免阻塞 gRPC 回调线程；执行器未启动时直接执行
+    void DeferPush(std::function<void()> fn);
+    bool ResolveGroupMembers(const std::string& group_id, std::vector<std::string>* out);
+
+    /// 查单个用户路由：先查近端缓存，未命中回源 SessionStore 并回填；*from_cache 标记结果来源
+    std::optional<CachedRoute> LookupRoute(const std::string& user_id, bool* from_cache);
+    /// 批量查路由并按 gate_addr 分组，缓存未命中的用户一次 GetSessions 回源；返回在线人数
+    size_t ResolveRoutes(const std::vector<std::string>& user_ids,
+                         std::unordered_map<std::string, std::vector<std::string>>* by_gate);
+    void InvalidateRoute(const std::string& user_id);
+    /// Gate 回报已无连接的用户：缓存路由已过时，计入 stale 并失效
+    void DropStaleRoutes(const std::vector<std::string>& user_ids);
+    /// FanoutEngine 的异步推送实现：剩余截止时间作为 BatchPushMessage 的 RPC 超时
+    void PushToGateAsync(const std::string& gate_addr, const std::vector<std::string>& user_ids,
+                         const std::string& cmd, const std::string& payload,
+                         FanoutEngine::Clock::time_point deadline, FanoutEngine::PushDone done);
+
     std::shared_ptr<SessionStore> store_;
     SystemManager* manager_ = nullptr;
     std::mutex gate_clients_mutex_;
     std::unordered_map<std::string, std::shared_ptr<GateRpcClient>> gate_clients_;
+    std::shared_ptr<RouteCache> route_cache_;
+    std::unique_ptr<GroupMemberCache> group_cache_;
+    std::unique_ptr<RequestExecutor> executor_;
+    std::unique_ptr<FanoutEngine> fanout_;  // 最后声明：先于 gate_clients_ 析构，等待在途推送回调结束
 };
 
 }  // namespace swift::zone
@@ -0,0 +1,238 @@
+#include "redis_pool.h"
+
+#if defined(ZONESVR_USE_HIREDIS) && ZONESVR_USE_HIREDIS
+
+#include <hiredis/hiredis.h>
+#include <swift/log_helper.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace swift::zone {
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+timeval ToTimeval(int ms) {
+    if (ms <= 0) ms = 1;
+    timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    return tv;
+}
+
+}  // namespace
+
+struct RedisPool::Impl {
+    struct Slot {
+        redisContext* ctx = nullptr;
+        int64_t last_used_us = 0;
+        int64_t next_connect_us = 0;  // 退避期内不重连
+        int failures = 0;
+    };
+
+    std::string host;
+    int port = 6379;
+    RedisPoolOptions opts;
+    std::vector<Slot> slots;
+    std::vector<size_t> idle;  // 空闲槽位栈：后进先出，热连接优先复用
+    std::mutex mutex;
+    std::condition_variable cv;
+    RedisPoolStats stats;
+
+    /// 在调用线程上为 slot 建连（不持有池锁）；失败按指数退避推迟下次尝试
+    bool Connect(Slot& slot, int64_t now_us) {
+        if (slot.ctx) {
+            redisFree(slot.ctx);
+            slot.ctx = nullptr;
+        }
+        if (now_us < slot.next_connect_us) {
+            stats.backoff_skips.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        redisContext* ctx = redisConnectWithTimeout(host.c_str(), port, ToTimeval(opts.connect_timeout_ms));
+        if (ctx == nullptr || ctx->err != 0) {
+            int64_t backoff_ms = std::max(1, opts.reconnect_backoff_min_ms);
+            for (int i = 0; i < slot.failures && backoff_ms < opts.reconnect_backoff_max_ms; ++i)
+                backoff_ms *= 2;
+            backoff_ms = std::min<int64_t>(backoff_ms, std::max(1, opts.reconnect_backoff_max_ms));
+            thread_local std::mt19937 rng{std::random_device{}()};
+            backoff_ms += std::uniform_int_distribution<int64_t>(0, backoff_ms / 4)(rng);  // 抖动，避免各槽位同时重连
+            slot.failures++;
+            slot.next_connect_us = now_us + backoff_ms * 1000;
+            stats.connect_failures.fetch_add(1, std::memory_order_relaxed);
+            LogWarning(TAG("service", "zonesvr"), "RedisPool connect failed: host=" << host
+                       << ", port=" << port
+                       << ", err=" << (ctx ? ctx->errstr : "null context")
+                       << ", failures=" << slot.failures
+                       << ", retry_in_ms=" << backoff_ms);
+            if (ctx) redisFree(ctx);
+            return false;
+        }
+        redisSetTimeout(ctx, ToTimeval(opts.command_timeout_ms));
+        if (slot.failures > 0) {
+            LogInfo(TAG("service", "zonesvr"), "RedisPool reconnected: host=" << host << ", port=" << port
+                    << ", after_failures=" << slot.failures);
+        }
+        slot.ctx = ctx;
+        slot.failures = 0;
+        slot.next_connect_us = 0;
+        stats.connects.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// 空闲过久的连接可能已被服务端或中间设备断开，借出前 PING 一次
+    bool HealthCheck(Slot& slot) {
+        redisReply* r = static_cast<redisReply*>(redisCommand(slot.ctx, "PING"));
+        bool ok = r && r->type == REDIS_REPLY_STATUS && r->len == 4 && std::memcmp(r->str, "PONG", 4) == 0;
+        if (r) freeReplyObject(r);
+        if (!ok) stats.health_check_failures.fetch_add(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    void Release(size_t index, bool broken, int64_t acquired_us) {
+        int64_t now = NowUs();
+        stats.command.Record(now - acquired_us);
+        stats.in_use.fetch_sub(1, std::memory_order_relaxed);
+        Slot& slot = slots[index];
+        if (slot.ctx && (broken || slot.ctx->err != 0)) {
+            stats.broken.fetch_add(1, std::memory_order_relaxed);
+            redisFree(slot.ctx);
+            slot.ctx = nullptr;
+        }
+        slot.last_used_us = now;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(index);
+        }
+        cv.notify_one();
+    }
+};
+
+RedisPool::RedisPool(std::string host, int port, RedisPoolOptions options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->host = std::move(host);
+    impl_->port = port;
+    impl_->opts = options;
+    size_t n = options.size > 0 ? static_cast<size_t>(options.size) : 1;
+    impl_->slots.resize(n);
+    impl_->idle.reserve(n);
+    // 预热：启动时 Redis 不可用不阻止启动，借出时按退避重连
+    int64_t now = NowUs();
+    for (size_t i = 0; i < n; ++i) {
+        impl_->Connect(impl_->slots[i], now);
+        impl_->slots[i].last_used_us = now;
+        impl_->idle.push_back(n - 1 - i);
+    }
+    LogInfo(TAG("service", "zonesvr"), "RedisPool created: host=" << impl_->host << ", port=" << port
+            << ", size=" << n << ", connected=" << impl_->stats.connects.load(std::memory_order_relaxed));
+}
+
+RedisPool::~RedisPool() {
+    for (auto& slot : impl_->slots) {
+        if (slot.ctx) redisFree(slot.ctx);
+        slot.ctx = nullptr;
+    }
+}
+
+RedisPool::Lease RedisPool::Acquire() {
+    int64_t start = NowUs();
+    size_t index = 0;
+    {
+        std::unique_lock<std::mutex> lock(impl_->mutex);
+        auto timeout = std::chrono::milliseconds(std::max(0, impl_->opts.checkout_timeout_ms));
+        if (!impl_->cv.wait_for(lock, timeout, [this] { return !impl_->idle.empty(); })) {
+            impl_->stats.checkout_timeouts.fetch_add(1, std::memory_order_relaxed);
+            impl_->stats.checkout_wait.Record(NowUs() - start);
+            return Lease();
+        }
+        index = impl_->idle.back();
+        impl_->idle.pop_back();
+    }
+    int64_t now = NowUs();
+    impl_->stats.checkout_wait.Record(now - start);
+    impl_->stats.checkouts.fetch_add(1, std::memory_order_relaxed);
+    impl_->stats.in_use.fetch_add(1, std::memory_order_relaxed);
+
+    Lease lease;
+    lease.pool_ = this;
+    lease.slot_ = index;
+    lease.acquired_us_ = now;
+    Impl::Slot& slot = impl_->slots[index];
+    bool ready = slot.ctx != nullptr && slot.ctx->err == 0;
+    if (ready && impl_->opts.health_check_interval_ms > 0
+        && now - slot.last_used_us > static_cast<int64_t>(impl_->opts.health_check_interval_ms) * 1000)
+        ready = impl_->HealthCheck(slot);
+    if (!ready)
+        ready = impl_->Connect(slot, now);
+    if (ready)
+        lease.ctx_ = slot.ctx;  // 失败时 ctx_ 为空，析构时仍归还槽位
+    return lease;
+}
+
+const RedisPoolStats& RedisPool::stats() const {
+    return impl_->stats;
+}
+
+std::string RedisPool::FormatStats() const {
+    const RedisPoolStats& s = impl_->stats;
+    auto load = [](const auto& v) { return v.load(std::memory_order_relaxed); };
+    std::ostringstream os;
+    os << "size=" << impl_->slots.size()
+       << " in_use=" << load(s.in_use)
+       << " checkouts=" << load(s.checkouts)
+       << " checkout_timeouts=" << load(s.checkout_timeouts)
+       << " connects=" << load(s.connects)
+       << " connect_failures=" << load(s.connect_failures)
+       << " backoff_skips=" << load(s.backoff_skips)
+       << " health_check_failures=" << load(s.health_check_failures)
+       << " broken=" << load(s.broken)
+       << "\n  checkout_wait: " << s.checkout_wait.Format()
+       << "\n  command: " << s.command.Format();
+    return os.str();
+}
+
+RedisPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), slot_(other.slot_), ctx_(other.ctx_),
+      broken_(other.broken_), acquired_us_(other.acquired_us_) {
+    other.pool_ = nullptr;
+    other.ctx_ = nullptr;
+}
+
+RedisPool::Lease& RedisPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = other.pool_;
+        slot_ = other.slot_;
+        ctx_ = other.ctx_;
+        broken_ = other.broken_;
+        acquired_us_ = other.acquired_us_;
+        other.pool_ = nullptr;
+        other.ctx_ = nullptr;
+    }
+    return *this;
+}
+
+RedisPool::Lease::~Lease() {
+    Release();
+}
+
+void RedisPool::Lease::Release() {
+    if (!pool_) return;
+    pool_->impl_->Release(slot_, broken_, acquired_us_);
+    pool_ = nullptr;
+    ctx_ = nullptr;
+}
+
+}  // namespace swift::zone
+
+#endif  // ZONESVR_USE_HIREDIS
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "service/latency_histogram.h"
+
+struct redisContext;
+
+namespace swift::zone {
+
+/**
+ * Redis 连接池参数（见 zonesvr.conf.example 中 redis_*）
+ */
+struct RedisPoolOptions {
+    int size = 8;                          // 连接数
+    int checkout_timeout_ms = 200;         // 借连接的最长等待，超时本次调用失败
+    int connect_timeout_ms = 500;          // 建连超时
+    int command_timeout_ms = 1000;         // 单条命令/管道读写超时
+    int reconnect_backoff_min_ms = 100;    // 重连退避下限，连续失败按 2 倍递增
+    int reconnect_backoff_max_ms = 5000;   // 重连退避上限
+    int health_check_interval_ms = 30000;  // 空闲超过该时长的连接借出前先 PING
+};
+
+/**
+ * 连接池计数（原子量，relaxed 累加）
+ */
+struct RedisPoolStats {
+    std::atomic<uint64_t> checkouts{0};
+    std::atomic<uint64_t> checkout_timeouts{0};   // 池满等待超时
+    std::atomic<uint64_t> connects{0};            // 成功建连（含重连）
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> backoff_skips{0};       // 处于退避期、未尝试重连即失败的借出
+    std::atomic<uint64_t> health_check_failures{0};
+    std::atomic<uint64_t> broken{0};              // 归还时发现连接出错被丢弃
+    std::atomic<int64_t> in_use{0};
+    LatencyHistogram checkout_wait;               // 借连接等待耗时
+    LatencyHistogram command;                     // 借出到归还（命令往返 + 解析）耗时
+};
+
+/**
+ * hiredis 同步连接池
+ *
+ * 每条连接同一时刻只被一个线程持有（Lease），不同线程的命令可在不同连接上并行；
+ * 建连/重连只阻塞借到该槽位的线程，且带超时与指数退避，Redis 不可用时快速失败而不是堆积在锁上。
+ */
+class RedisPool {
+public:
+    RedisPool(std::string host, int port, RedisPoolOptions options);
+    ~RedisPool();
+
+    RedisPool(const RedisPool&) = delete;
+    RedisPool& operator=(const RedisPool&) = delete;
+
+    /// 借出的连接；析构时归还，连接出错（ctx->err）或 MarkBroken 后归还时丢弃，下次借出时重连
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        explicit operator bool() const { return ctx_ != nullptr; }
+        redisContext* get() const { return ctx_; }
+        /// 连接状态不可信（如管道中途失败、缓冲里残留未读回复）时调用
+        void MarkBroken() { broken_ = true; }
+
+    private:
+        friend class RedisPool;
+        void Release();
+
+        RedisPool* pool_ = nullptr;
+        size_t slot_ = 0;
+        redisContext* ctx_ = nullptr;
+        bool broken_ = false;
+        int64_t acquired_us_ = 0;
+    };
+
+    /// 借连接：等待空闲槽位至 checkout_timeout_ms，无可用连接返回空 Lease
+    Lease Acquire();
+
+    const RedisPoolStats& stats() const;
+    /// 单行 key=value 文本，便于日志采集
+    std::string FormatStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace swift::zone
@@ -1,15 +1,20 @@
 #include "session_store.h"
 #include <swift/log_helper.h>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
 #if defined(ZONESVR_USE_HIREDIS) && ZONESVR_USE_HIREDIS
 #include <hiredis/hiredis.h>
+#include <poll.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstdarg>
 #include <cstdlib>
 #include <cstring>
 #include <string_view>
+#include <thread>
 #endif
 
 namespace swift::zone {
@@ -37,6 +42,20 @@ bool MemorySessionStore::SetOffline(const std::string& user_id) {
     return true;
 }
 
+bool MemorySessionStore::SetOfflineIfMatch(const std::string& user_id, const std::string& gate_id,
+                                           const std::string& conn_id, bool* removed) {
+    std::unique_lock lock(impl_->mutex);
+    *removed = false;
+    auto it = impl_->sessions.find(user_id);
+    if (it == impl_->sessions.end() || it->second.gate_id != gate_id)
+        return true;
+    if (!conn_id.empty() && !it->second.conn_id.empty() && it->second.conn_id != conn_id)
+        return true;
+    impl_->sessions.erase(it);
+    *removed = true;
+    return true;
+}
+
 std::optional<UserSession> MemorySessionStore::GetSession(const std::string& user_id) {
     std::shared_lock lock(impl_->mutex);
     auto it = impl_->sessions.find(user_id);
@@ -127,6 +146,45 @@ constexpr int kGateExpireSeconds = 60;
 constexpr char kSessionPrefix[] = "session:";
 constexpr char kGatePrefix[] = "gate:";
 constexpr char kGateListKey[] = "gate:list";
+constexpr char kSessionChangeChannel[] = "zone:session:changed";  // 会话变更通知（payload 为 user_id），供各副本路由缓存失效
+constexpr size_t kPipelineBatch = 512;  // 单个管道的最大命令数，避免超大群一次占满输出/输入缓冲
+
+// 仅在会话仍存在时刷新活跃时间与过期，避免为已下线用户建出残缺的 session hash
+constexpr char kTouchSessionScript[] =
+    "if redis.call('EXISTS', KEYS[1]) == 0 then return 0 end "
+    "redis.call('HSET', KEYS[1], 'last_active_at', ARGV[1]) "
+    "redis.call('EXPIRE', KEYS[1], ARGV[2]) "
+    "return 1";
+
+// 条件下线：gate_id 一致且 conn_id 一致（任一侧为空不比较）才 DEL；ARGV[3]=1 时同一脚本内 PUBLISH 变更
+constexpr char kOfflineIfMatchScript[] =
+    "local cur = redis.call('HMGET', KEYS[1], 'gate_id', 'conn_id') "
+    "if cur[1] ~= ARGV[1] then return 0 end "
+    "if ARGV[2] ~= '' and cur[2] and cur[2] ~= '' and cur[2] ~= ARGV[2] then return 0 end "
+    "redis.call('DEL', KEYS[1]) "
+    "if ARGV[3] == '1' then redis.call('PUBLISH', ARGV[4], ARGV[5]) end "
+    "return 1";
+
+using Argv = std::vector<std::string>;
+
+/// 管道回复集合，析构时统一释放
+struct Replies {
+    std::vector<redisReply*> v;
+    Replies() = default;
+    Replies(const Replies&) = delete;
+    Replies& operator=(const Replies&) = delete;
+    ~Replies() {
+        for (redisReply* r : v) freeReplyObject(r);
+    }
+};
+
+bool IsOkStatus(const redisReply* r) {
+    return r && (r->type == REDIS_REPLY_STATUS || r->type == REDIS_REPLY_STRING);
+}
+
+bool IsIntegerOne(const redisReply* r) {
+    return r && r->type == REDIS_REPLY_INTEGER && r->integer == 1;
+}
 
 void ParseRedisUrl(const std::string& redis_url, std::string* host, int* port) {
     *port = 6379;
@@ -144,91 +202,225 @@ void ParseRedisUrl(const std::string& redis_url, std::string* host, int* port) {
     }
 }
 
+/// 同步执行一条命令（格式串接口），仅用于参数简单的单条命令
+redisReply* Command(RedisPool::Lease& conn, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    redisReply* reply = static_cast<redisReply*>(redisvCommand(conn.get(), fmt, ap));
+    va_end(ap);
+    return reply;
+}
+
+/**
+ * 管道：先把全部命令写入输出缓冲，再依次读回复，N 条命令只有 1 次往返。
+ * 参数按 argv 传递（二进制安全，不经格式串解析）；中途失败返回 false，已读到的回复仍在 out 中由其析构释放。
+ * 失败时缓冲区里可能残留未发出的命令或未读的回复，连接标记为损坏，归还时丢弃。
+ */
+bool Pipeline(RedisPool::Lease& conn, const std::vector<Argv>& cmds, Replies* out) {
+    redisContext* ctx = conn.get();
+    std::vector<const char*> argv;
+    std::vector<size_t> lens;
+    for (const auto& c : cmds) {
+        argv.clear();
+        lens.clear();
+        for (const auto& a : c) {
+            argv.push_back(a.data());
+            lens.push_back(a.size());
+        }
+        if (redisAppendCommandArgv(ctx, static_cast<int>(argv.size()), argv.data(), lens.data()) != REDIS_OK) {
+            conn.MarkBroken();
+            return false;
+        }
+    }
+    out->v.reserve(out->v.size() + cmds.size());
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        void* r = nullptr;
+        if (redisGetReply(ctx, &r) != REDIS_OK || r == nullptr) {
+            LogWarning(TAG("service", "zonesvr"), "RedisSessionStore pipeline failed: "
+                       << (ctx->err ? ctx->errstr : "null reply") << ", commands=" << cmds.size());
+            conn.MarkBroken();
+            return false;
+        }
+        out->v.push_back(static_cast<redisReply*>(r));
+    }
+    return true;
+}
+
+/**
+ * MULTI + cmds + EXEC 作为一个管道发出：原子执行且只有 1 次往返。
+ * 成功时返回 EXEC 的回复（数组，元素与 cmds 一一对应），生命周期随 out。
+ */
+redisReply* Transaction(RedisPool::Lease& conn, const std::vector<Argv>& cmds, Replies* out) {
+    std::vector<Argv> all;
+    all.reserve(cmds.size() + 2);
+    all.push_back({"MULTI"});
+    all.insert(all.end(), cmds.begin(), cmds.end());
+    all.push_back({"EXEC"});
+    if (!Pipeline(conn, all, out)) return nullptr;
+    redisReply* exec = out->v.back();
+    if (exec->type != REDIS_REPLY_ARRAY || exec->elements != cmds.size()) return nullptr;
+    return exec;
+}
+
 }  // namespace
 
 struct RedisSessionStore::Impl {
     std::string redis_url;
     std::string host;
     int port = 6379;
-    redisContext* ctx = nullptr;
-    std::mutex mutex;
-
-    bool EnsureConnected() {
-        if (ctx != nullptr && ctx->err == 0) return true;
-        if (ctx != nullptr && ctx->err != 0) {
-            LogWarning(TAG("service", "zonesvr"), "RedisSessionStore reconnecting after context error: "
-                       << ctx->errstr);
-            redisFree(ctx);
-            ctx = nullptr;
+    RedisPoolOptions pool_options;
+    std::unique_ptr<RedisPool> pool;
+
+    // 会话变更订阅：独立连接（SUBSCRIBE 后连接不能再执行普通命令），后台线程阻塞读
+    std::atomic<bool> publish_changes{false};
+    std::atomic<bool> stop{false};
+    SessionChangeCallback on_change;
+    std::thread subscriber;
+
+    void SubscribeLoop();
+    /// 读一条订阅消息：收到时 *got=true；超时或半条消息返回 true 且 *got 不变；连接出错返回 false
+    bool ReadMessage(redisContext* c, std::string* user_id, bool* got);
+    void SleepUnlessStopped(int ms) {
+        for (int waited = 0; waited < ms && !stop; waited += 50)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+};
+
+void RedisSessionStore::Impl::SubscribeLoop() {
+    int backoff_ms = std::max(1, pool_options.reconnect_backoff_min_ms);
+    while (!stop) {
+        timeval tv{pool_options.connect_timeout_ms / 1000, (pool_options.connect_timeout_ms % 1000) * 1000};
+        redisContext* c = redisConnectWithTimeout(host.c_str(), port, tv);
+        redisReply* r = nullptr;
+        if (c && c->err == 0)
+            r = static_cast<redisReply*>(redisCommand(c, "SUBSCRIBE %s", kSessionChangeChannel));
+        bool subscribed = r && r->type == REDIS_REPLY_ARRAY;
+        if (r) freeReplyObject(r);
+        if (!subscribed) {
+            LogWarning(TAG("service", "zonesvr"), "RedisSessionStore subscribe failed: host=" << host
+                       << ", port=" << port << ", err=" << (c ? c->errstr : "null context")
+                       << ", retry_in_ms=" << backoff_ms);
+            if (c) redisFree(c);
+            SleepUnlessStopped(backoff_ms);
+            backoff_ms = std::min(backoff_ms * 2, std::max(1, pool_options.reconnect_backoff_max_ms));
+            continue;
         }
-        ctx = redisConnect(host.c_str(), port);
-        if (ctx == nullptr) {
-            LogError(TAG("service", "zonesvr"), "RedisSessionStore connect failed: host="
-                     << host << ", port=" << port << ", reason=null context");
-            return false;
+        backoff_ms = std::max(1, pool_options.reconnect_backoff_min_ms);
+        LogInfo(TAG("service", "zonesvr"), "RedisSessionStore subscribed: channel=" << kSessionChangeChannel);
+        on_change("");  // 未订阅期间的通知已丢失，整体失效
+
+        while (!stop) {
+            std::string user_id;
+            bool got = false;
+            if (!ReadMessage(c, &user_id, &got)) break;
+            if (got && !user_id.empty()) on_change(user_id);
         }
-        if (ctx->err != 0) {
-            LogError(TAG("service", "zonesvr"), "RedisSessionStore connect failed: host="
-                     << host << ", port=" << port
-                     << ", err=" << ctx->errstr);
-            return false;
+        if (!stop) {
+            LogWarning(TAG("service", "zonesvr"), "RedisSessionStore subscription lost: err="
+                       << (c->err ? c->errstr : "unexpected reply") << ", resubscribing");
         }
-        LogInfo(TAG("service", "zonesvr"), "RedisSessionStore connected: host=" << host << ", port=" << port);
-        return true;
+        redisFree(c);
     }
+}
 
-    redisReply* Command(const char* fmt, ...) {
-        va_list ap;
-        va_start(ap, fmt);
-        redisReply* reply = static_cast<redisReply*>(redisvCommand(ctx, fmt, ap));
-        va_end(ap);
-        return reply;
+bool RedisSessionStore::Impl::ReadMessage(redisContext* c, std::string* user_id, bool* got) {
+    void* reply = nullptr;
+    if (redisReaderGetReply(c->reader, &reply) != REDIS_OK) return false;
+    if (!reply) {
+        // 读缓冲已空：poll 带超时等待，便于及时响应 stop
+        pollfd pfd{c->fd, POLLIN, 0};
+        int n = ::poll(&pfd, 1, 500);
+        if (n == 0) return true;
+        if (n < 0) return errno == EINTR;
+        if (redisBufferRead(c) != REDIS_OK) return false;
+        if (redisReaderGetReply(c->reader, &reply) != REDIS_OK) return false;
+        if (!reply) return true;  // 半条消息，下次继续读
     }
-};
+    redisReply* r = static_cast<redisReply*>(reply);
+    // 推送格式：["message", channel, payload]
+    if (r->type == REDIS_REPLY_ARRAY && r->elements == 3 && r->element[2]->type == REDIS_REPLY_STRING) {
+        user_id->assign(r->element[2]->str, r->element[2]->len);
+        *got = true;
+    }
+    freeReplyObject(r);
+    return true;
+}
 
-RedisSessionStore::RedisSessionStore(const std::string& redis_url)
+RedisSessionStore::RedisSessionStore(const std::string& redis_url, const RedisPoolOptions& pool_options)
     : impl_(std::make_unique<Impl>()) {
     impl_->redis_url = redis_url;
     ParseRedisUrl(redis_url, &impl_->host, &impl_->port);
-    impl_->EnsureConnected();
+    impl_->pool_options = pool_options;
+    impl_->pool = std::make_unique<RedisPool>(impl_->host, impl_->port, pool_options);
 }
 
 RedisSessionStore::~RedisSessionStore() {
-    if (impl_->ctx) {
-        redisFree(impl_->ctx);
-        impl_->ctx = nullptr;
-    }
+    impl_->stop = true;
+    if (impl_->subscriber.joinable())
+        impl_->subscriber.join();
+}
+
+bool RedisSessionStore::SubscribeSessionChanges(SessionChangeCallback cb) {
+    if (!cb || impl_->subscriber.joinable()) return false;
+    impl_->on_change = std::move(cb);
+    impl_->publish_changes = true;  // 订阅方同时负责发布，副本间对称
+    impl_->subscriber = std::thread([this] { impl_->SubscribeLoop(); });
+    return true;
+}
+
+std::string RedisSessionStore::FormatStats() const {
+    return impl_->pool->FormatStats();
 }
 
 bool RedisSessionStore::SetOnline(const UserSession& session) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     std::string key = std::string(kSessionPrefix) + session.user_id;
-    redisReply* r = impl_->Command("HMSET %s user_id %s gate_id %s gate_addr %s device_type %s device_id %s online_at %lld last_active_at %lld",
-                                   key.c_str(), session.user_id.c_str(), session.gate_id.c_str(),
-                                   session.gate_addr.c_str(), session.device_type.c_str(),
-                                   session.device_id.c_str(),
-                                   static_cast<long long>(session.online_at),
-                                   static_cast<long long>(session.last_active_at));
-    if (!r) return false;
-    bool ok = (r->type == REDIS_REPLY_STATUS || r->type == REDIS_REPLY_STRING);
-    freeReplyObject(r);
-    if (!ok) return false;
-    r = impl_->Command("EXPIRE %s %d", key.c_str(), kSessionExpireSeconds);
-    if (r) { ok = (r->type == REDIS_REPLY_INTEGER && r->integer == 1); freeReplyObject(r); }
-    return ok;
+    // HMSET + EXPIRE 在同一事务中：不会留下无过期时间的会话；开启变更通知时同一事务内 PUBLISH
+    std::vector<Argv> cmds = {
+        {"HMSET", key, "user_id", session.user_id, "gate_id", session.gate_id,
+         "gate_addr", session.gate_addr, "conn_id", session.conn_id, "device_type", session.device_type,
+         "device_id", session.device_id, "online_at", std::to_string(session.online_at),
+         "last_active_at", std::to_string(session.last_active_at)},
+        {"EXPIRE", key, std::to_string(kSessionExpireSeconds)},
+    };
+    if (impl_->publish_changes)
+        cmds.push_back({"PUBLISH", kSessionChangeChannel, session.user_id});
+    Replies replies;
+    redisReply* exec = Transaction(conn, cmds, &replies);
+    return exec && IsOkStatus(exec->element[0]) && IsIntegerOne(exec->element[1]);
 }
 
 bool RedisSessionStore::SetOffline(const std::string& user_id) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     std::string key = std::string(kSessionPrefix) + user_id;
-    redisReply* r = impl_->Command("DEL %s", key.c_str());
+    if (impl_->publish_changes) {
+        Replies replies;
+        return Transaction(conn, {{"DEL", key}, {"PUBLISH", kSessionChangeChannel, user_id}}, &replies) != nullptr;
+    }
+    redisReply* r = Command(conn, "DEL %s", key.c_str());
     if (!r) return false;
     freeReplyObject(r);
     return true;
 }
 
+bool RedisSessionStore::SetOfflineIfMatch(const std::string& user_id, const std::string& gate_id,
+                                          const std::string& conn_id, bool* removed) {
+    *removed = false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
+    std::string key = std::string(kSessionPrefix) + user_id;
+    // 比较与删除在脚本内原子完成：两次往返之间新会话写入也不会被误删
+    Replies replies;
+    if (!Pipeline(conn, {{"EVAL", kOfflineIfMatchScript, "1", key, gate_id, conn_id,
+                           impl_->publish_changes ? "1" : "0", kSessionChangeChannel, user_id}}, &replies))
+        return false;
+    if (replies.v[0]->type != REDIS_REPLY_INTEGER) return false;
+    *removed = replies.v[0]->integer == 1;
+    return true;
+}
+
 static std::optional<UserSession> ParseUserSessionHash(redisReply* r, const std::string& user_id) {
     if (!r || r->type != REDIS_REPLY_ARRAY || r->elements == 0) return std::nullopt;
     UserSession s;
@@ -240,6 +432,7 @@ static std::optional<UserSession> ParseUserSessionHash(redisReply* r, const std:
         std::string val(r->element[i + 1]->str, r->element[i + 1]->len);
         if (field == "gate_id") s.gate_id = val;
         else if (field == "gate_addr") s.gate_addr = val;
+        else if (field == "conn_id") s.conn_id = val;
         else if (field == "device_type") s.device_type = val;
         else if (field == "device_id") s.device_id = val;
         else if (field == "online_at") { try { s.online_at = std::stoll(val); } catch (...) {} }
@@ -249,10 +442,10 @@ static std::optional<UserSession> ParseUserSessionHash(redisReply* r, const std:
 }
 
 std::optional<UserSession> RedisSessionStore::GetSession(const std::string& user_id) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return std::nullopt;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return std::nullopt;
     std::string key = std::string(kSessionPrefix) + user_id;
-    redisReply* r = impl_->Command("HGETALL %s", key.c_str());
+    redisReply* r = Command(conn, "HGETALL %s", key.c_str());
     std::optional<UserSession> out = ParseUserSessionHash(r, user_id);
     if (r) freeReplyObject(r);
     return out;
@@ -260,100 +453,101 @@ std::optional<UserSession> RedisSessionStore::GetSession(const std::string& user
 
 std::vector<UserSession> RedisSessionStore::GetSessions(const std::vector<std::string>& user_ids) {
     std::vector<UserSession> result;
-    for (const auto& uid : user_ids) {
-        auto opt = GetSession(uid);
-        if (opt) result.push_back(*opt);
+    if (user_ids.empty()) return result;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return result;
+    // 每 kPipelineBatch 个用户一个管道：N 个用户 ceil(N / batch) 次往返，而非 N 次
+    std::vector<Argv> cmds;
+    for (size_t begin = 0; begin < user_ids.size(); begin += kPipelineBatch) {
+        size_t end = std::min(user_ids.size(), begin + kPipelineBatch);
+        cmds.clear();
+        for (size_t i = begin; i < end; ++i)
+            cmds.push_back({"HGETALL", std::string(kSessionPrefix) + user_ids[i]});
+        Replies replies;
+        if (!Pipeline(conn, cmds, &replies)) break;
+        for (size_t i = begin; i < end; ++i) {
+            auto opt = ParseUserSessionHash(replies.v[i - begin], user_ids[i]);
+            if (opt) result.push_back(std::move(*opt));
+        }
     }
     return result;
 }
 
 bool RedisSessionStore::IsOnline(const std::string& user_id) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     std::string key = std::string(kSessionPrefix) + user_id;
-    redisReply* r = impl_->Command("EXISTS %s", key.c_str());
+    redisReply* r = Command(conn, "EXISTS %s", key.c_str());
     bool ok = (r && r->type == REDIS_REPLY_INTEGER && r->integer == 1);
     if (r) freeReplyObject(r);
     return ok;
 }
 
 bool RedisSessionStore::UpdateLastActive(const std::string& user_id, int64_t timestamp) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     std::string key = std::string(kSessionPrefix) + user_id;
-    redisReply* r = impl_->Command("HSET %s last_active_at %lld", key.c_str(), static_cast<long long>(timestamp));
-    if (!r) return false;
-    bool ok = true;
-    freeReplyObject(r);
-    r = impl_->Command("EXPIRE %s %d", key.c_str(), kSessionExpireSeconds);
-    if (r) { ok = (r->type == REDIS_REPLY_INTEGER && r->integer == 1); freeReplyObject(r); }
-    return ok;
+    // 脚本内完成 存在判断 + HSET + EXPIRE：一次往返，语义与内存实现一致（会话不存在返回 false）
+    Replies replies;
+    if (!Pipeline(conn, {{"EVAL", kTouchSessionScript, "1", key,
+                           std::to_string(timestamp), std::to_string(kSessionExpireSeconds)}}, &replies))
+        return false;
+    return IsIntegerOne(replies.v[0]);
 }
 
 bool RedisSessionStore::RegisterGate(const GateNode& node) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) {
+    auto conn = impl_->pool->Acquire();
+    if (!conn) {
         LogError(TAG("service", "zonesvr"), "RegisterGate redis unavailable: gate_id=" << node.gate_id);
         return false;
     }
     std::string key = std::string(kGatePrefix) + node.gate_id;
-    redisReply* r = impl_->Command("HMSET %s gate_id %s address %s current_connections %d registered_at %lld last_heartbeat %lld",
-                                  key.c_str(), node.gate_id.c_str(), node.address.c_str(),
-                                  node.current_connections,
-                                  static_cast<long long>(node.registered_at),
-                                  static_cast<long long>(node.last_heartbeat));
-    if (!r) {
-        LogError(TAG("service", "zonesvr"), "RegisterGate HMSET failed: gate_id=" << node.gate_id
+    Replies replies;
+    redisReply* exec = Transaction(conn, {
+        {"HMSET", key, "gate_id", node.gate_id, "address", node.address,
+         "current_connections", std::to_string(node.current_connections),
+         "registered_at", std::to_string(node.registered_at),
+         "last_heartbeat", std::to_string(node.last_heartbeat)},
+        {"EXPIRE", key, std::to_string(kGateExpireSeconds)},
+        {"SADD", kGateListKey, node.gate_id},
+    }, &replies);
+    if (!exec) {
+        LogError(TAG("service", "zonesvr"), "RegisterGate transaction failed: gate_id=" << node.gate_id
                  << ", key=" << key);
         return false;
     }
-    bool ok = (r->type == REDIS_REPLY_STATUS || r->type == REDIS_REPLY_STRING);
-    freeReplyObject(r);
-    if (!ok) {
-        LogError(TAG("service", "zonesvr"), "RegisterGate HMSET unexpected reply: gate_id=" << node.gate_id);
+    if (!IsOkStatus(exec->element[0]) || !IsIntegerOne(exec->element[1])
+        || exec->element[2]->type != REDIS_REPLY_INTEGER) {
+        LogError(TAG("service", "zonesvr"), "RegisterGate unexpected reply: gate_id=" << node.gate_id
+                 << ", key=" << key << ", set_key=" << kGateListKey);
         return false;
     }
-    r = impl_->Command("EXPIRE %s %d", key.c_str(), kGateExpireSeconds);
-    if (r) { ok = (r->type == REDIS_REPLY_INTEGER && r->integer == 1); freeReplyObject(r); }
-    if (!ok) {
-        LogError(TAG("service", "zonesvr"), "RegisterGate EXPIRE failed: gate_id=" << node.gate_id
-                 << ", key=" << key);
-        return false;
-    }
-    r = impl_->Command("SADD %s %s", kGateListKey, node.gate_id.c_str());
-    if (r) { ok = (r->type == REDIS_REPLY_INTEGER); freeReplyObject(r); }
-    if (!ok) {
-        LogError(TAG("service", "zonesvr"), "RegisterGate SADD failed: gate_id=" << node.gate_id
-                 << ", set_key=" << kGateListKey);
-    }
-    return ok;
+    return true;
 }
 
 bool RedisSessionStore::UnregisterGate(const std::string& gate_id) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     std::string key = std::string(kGatePrefix) + gate_id;
-    redisReply* r = impl_->Command("DEL %s", key.c_str());
-    if (r) freeReplyObject(r);
-    r = impl_->Command("SREM %s %s", kGateListKey, gate_id.c_str());
-    if (r) freeReplyObject(r);
+    Replies replies;
+    Transaction(conn, {{"DEL", key}, {"SREM", kGateListKey, gate_id}}, &replies);
     return true;
 }
 
 bool RedisSessionStore::UpdateGateHeartbeat(const std::string& gate_id, int connections) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return false;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return false;
     int64_t now = static_cast<int64_t>(
         std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::system_clock::now().time_since_epoch()).count());
     std::string key = std::string(kGatePrefix) + gate_id;
-    redisReply* r = impl_->Command("HSET %s current_connections %d last_heartbeat %lld", key.c_str(), connections, static_cast<long long>(now));
-    if (!r) return false;
-    freeReplyObject(r);
-    r = impl_->Command("EXPIRE %s %d", key.c_str(), kGateExpireSeconds);
-    bool ok = (r && r->type == REDIS_REPLY_INTEGER && r->integer == 1);
-    if (r) freeReplyObject(r);
-    return ok;
+    Replies replies;
+    redisReply* exec = Transaction(conn, {
+        {"HSET", key, "current_connections", std::to_string(connections),
+         "last_heartbeat", std::to_string(now)},
+        {"EXPIRE", key, std::to_string(kGateExpireSeconds)},
+    }, &replies);
+    return exec && IsIntegerOne(exec->element[1]);
 }
 
 static std::optional<GateNode> ParseGateNodeHash(redisReply* r, const std::string& gate_id) {
@@ -374,31 +568,37 @@ static std::optional<GateNode> ParseGateNodeHash(redisReply* r, const std::strin
 }
 
 std::optional<GateNode> RedisSessionStore::GetGate(const std::string& gate_id) {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return std::nullopt;
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return std::nullopt;
     std::string key = std::string(kGatePrefix) + gate_id;
-    redisReply* r = impl_->Command("HGETALL %s", key.c_str());
+    redisReply* r = Command(conn, "HGETALL %s", key.c_str());
     std::optional<GateNode> out = ParseGateNodeHash(r, gate_id);
     if (r) freeReplyObject(r);
     return out;
 }
 
 std::vector<GateNode> RedisSessionStore::GetAllGates() {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    if (!impl_->EnsureConnected()) return {};
-    redisReply* r = impl_->Command("SMEMBERS %s", kGateListKey);
+    auto conn = impl_->pool->Acquire();
+    if (!conn) return {};
+    redisReply* r = Command(conn, "SMEMBERS %s", kGateListKey);
     if (!r || r->type != REDIS_REPLY_ARRAY) { if (r) freeReplyObject(r); return {}; }
-    std::vector<GateNode> result;
+    std::vector<std::string> gate_ids;
     for (size_t i = 0; i < r->elements; i++) {
         if (r->element[i]->type != REDIS_REPLY_STRING) continue;
-        std::string gid(r->element[i]->str, r->element[i]->len);
-        std::string key = std::string(kGatePrefix) + gid;
-        redisReply* h = impl_->Command("HGETALL %s", key.c_str());
-        auto opt = ParseGateNodeHash(h, gid);
-        if (h) freeReplyObject(h);
-        if (opt) result.push_back(*opt);
+        gate_ids.emplace_back(r->element[i]->str, r->element[i]->len);
     }
     freeReplyObject(r);
+    std::vector<Argv> cmds;
+    cmds.reserve(gate_ids.size());
+    for (const auto& gid : gate_ids)
+        cmds.push_back({"HGETALL", std::string(kGatePrefix) + gid});
+    Replies replies;
+    if (!Pipeline(conn, cmds, &replies)) return {};
+    std::vector<GateNode> result;
+    for (size_t i = 0; i < gate_ids.size(); ++i) {
+        auto opt = ParseGateNodeHash(replies.v[i], gate_ids[i]);
+        if (opt) result.push_back(std::move(*opt));
+    }
     return result;
 }
 
@@ -428,7 +628,7 @@ struct RedisSessionStore::Impl {
     int port = 6379;
 };
 
-RedisSessionStore::RedisSessionStore(const std::string& redis_url)
+RedisSessionStore::RedisSessionStore(const std::string& redis_url, const RedisPoolOptions&)
     : impl_(std::make_unique<Impl>()) {
     impl_->redis_url = redis_url;
     ParseRedisUrl(redis_url, &impl_->host, &impl_->port);
@@ -436,8 +636,16 @@ RedisSessionStore::RedisSessionStore(const std::string& redis_url)
 
 RedisSessionStore::~RedisSessionStore() = default;
 
+std::string RedisSessionStore::FormatStats() const { return {}; }
+bool RedisSessionStore::SubscribeSessionChanges(SessionChangeCallback) { LogHiredisMissingOnce(); return false; }
+
 bool RedisSessionStore::SetOnline(const UserSession&) { LogHiredisMissingOnce(); (void)impl_; return false; }
 bool RedisSessionStore::SetOffline(const std::string&) { LogHiredisMissingOnce(); return false; }
+bool RedisSessionStore::SetOfflineIfMatch(const std::string&, const std::string&, const std::string&, bool* removed) {
+    LogHiredisMissingOnce();
+    *removed = false;
+    return false;
+}
 std::optional<UserSession> RedisSessionStore::GetSession(const std::string&) { LogHiredisMissingOnce(); return std::nullopt; }
 std::vector<UserSession> RedisSessionStore::GetSessions(const std::vector<std::string>&) { LogHiredisMissingOnce(); return {}; }
 bool RedisSessionStore::IsOnline(const std::string&) { LogHiredisMissingOnce(); return false; }
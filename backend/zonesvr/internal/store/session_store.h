@@ -1,9 +1,11 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <optional>
 #include <memory>
+#include "redis_pool.h"
 
 namespace swift::zone {
 
@@ -14,6 +16,7 @@ struct UserSession {
     std::string user_id;
     std::string gate_id;         // 连接的网关 ID
     std::string gate_addr;       // 网关 gRPC 地址
+    std::string conn_id;         // 网关侧连接 ID（旧 Gate 上报的会话为空）
     std::string device_type;
     std::string device_id;
     int64_t online_at = 0;
@@ -39,7 +42,7 @@ struct GateNode {
  * 2. RedisSessionStore  - Redis 存储（生产/多副本）
  * 
  * Redis Key 设计：
- *   session:{user_id}     -> UserSession (Hash)
+ *   session:{user_id}     -> UserSession (Hash)，条件下线用 Lua 比较 gate_id/conn_id 后 DEL
  *   gate:{gate_id}        -> GateNode (Hash)
  *   gate:list             -> [gate_id...] (Set)
  */
@@ -50,6 +53,13 @@ public:
     // === 用户会话 ===
     virtual bool SetOnline(const UserSession& session) = 0;
     virtual bool SetOffline(const std::string& user_id) = 0;
+    /**
+     * 条件下线：仅当会话的 gate_id 一致、且 conn_id 一致（任一侧为空则不比较）时删除，
+     * 避免迟到的下线删掉同一用户重连后的新会话。*removed 返回是否真的删除。
+     * @return false 表示存储出错
+     */
+    virtual bool SetOfflineIfMatch(const std::string& user_id, const std::string& gate_id,
+                                   const std::string& conn_id, bool* removed) = 0;
     virtual std::optional<UserSession> GetSession(const std::string& user_id) = 0;
     virtual std::vector<UserSession> GetSessions(const std::vector<std::string>& user_ids) = 0;
     virtual bool IsOnline(const std::string& user_id) = 0;
@@ -61,6 +71,17 @@ public:
     virtual bool UpdateGateHeartbeat(const std::string& gate_id, int connections) = 0;
     virtual std::optional<GateNode> GetGate(const std::string& gate_id) = 0;
     virtual std::vector<GateNode> GetAllGates() = 0;
+
+    /// 存储层统计（如连接池），供主程序周期性输出；无统计时返回空串
+    virtual std::string FormatStats() const { return {}; }
+
+    /**
+     * 订阅会话变更（上线/下线，含其他 ZoneSvr 副本），用于本地路由缓存失效。
+     * 回调在后台线程执行；user_id 为空表示期间可能漏掉通知，调用方应整体失效。
+     * @return false 表示不支持（单进程内存实现无需跨副本通知）
+     */
+    using SessionChangeCallback = std::function<void(const std::string& user_id)>;
+    virtual bool SubscribeSessionChanges(SessionChangeCallback cb) { (void)cb; return false; }
 };
 
 /**
@@ -73,6 +94,8 @@ public:
     
     bool SetOnline(const UserSession& session) override;
     bool SetOffline(const std::string& user_id) override;
+    bool SetOfflineIfMatch(const std::string& user_id, const std::string& gate_id,
+                           const std::string& conn_id, bool* removed) override;
     std::optional<UserSession> GetSession(const std::string& user_id) override;
     std::vector<UserSession> GetSessions(const std::vector<std::string>& user_ids) override;
     bool IsOnline(const std::string& user_id) override;
@@ -95,16 +118,21 @@ private:
  * 优点：
  * - 多个 ZoneSvr Pod 共享状态
  * - 支持过期自动清理
- * - 原子操作保证一致性
+ * - 原子操作保证一致性：多命令写（HMSET+EXPIRE 等）走 MULTI/EXEC 或 Lua 脚本，一次往返
+ * - GetSessions 以管道批量 HGETALL，N 个用户按批次往返而非逐个
+ * - 连接来自 RedisPool，各 gRPC 工作线程在不同连接上并行执行
  */
 class RedisSessionStore : public SessionStore {
 public:
-    explicit RedisSessionStore(const std::string& redis_url);
+    explicit RedisSessionStore(const std::string& redis_url,
+                               const RedisPoolOptions& pool_options = RedisPoolOptions());
     ~RedisSessionStore() override;
     
     // ... 同上接口 ...
     bool SetOnline(const UserSession& session) override;
     bool SetOffline(const std::string& user_id) override;
+    bool SetOfflineIfMatch(const std::string& user_id, const std::string& gate_id,
+                           const std::string& conn_id, bool* removed) override;
     std::optional<UserSession> GetSession(const std::string& user_id) override;
     std::vector<UserSession> GetSessions(const std::vector<std::string>& user_ids) override;
     bool IsOnline(const std::string& user_id) override;
@@ -115,6 +143,10 @@ public:
     bool UpdateGateHeartbeat(const std::string& gate_id, int connections) override;
     std::optional<GateNode> GetGate(const std::string& gate_id) override;
     std::vector<GateNode> GetAllGates() override;
+
+    std::string FormatStats() const override;
+    /// 通过 Redis pub/sub（频道 zone:session:changed）收发；调用后 SetOnline/SetOffline 在同一事务内 PUBLISH
+    bool SubscribeSessionChanges(SessionChangeCallback cb) override;
     
 private:
     struct Impl;
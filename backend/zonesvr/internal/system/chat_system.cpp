@@ -50,9 +50,35 @@ ChatSystem::SendMessageResult ChatSystem::SendMessage(const std::string& from_us
     result.msg_id = r.msg_id;
     result.timestamp = r.timestamp;
     result.error = r.error;
+    result.duplicate = r.duplicate;
     return result;
 }
 
+void ChatSystem::SendMessageAsync(const std::string& from_user_id, const std::string& to_id,
+                                  int32_t chat_type, const std::string& content,
+                                  const std::string& media_url, const std::string& media_type,
+                                  const std::vector<std::string>& mentions,
+                                  const std::string& reply_to_msg_id,
+                                  const std::string& client_msg_id, int64_t file_size,
+                                  const std::string& token, SendMessageCallback done) {
+    if (!rpc_client_) {
+        if (done) done(SendMessageResult{});
+        return;
+    }
+    rpc_client_->SendMessageAsync(from_user_id, to_id, chat_type, content, media_url, media_type,
+                                  mentions, reply_to_msg_id, client_msg_id, file_size, token,
+                                  [done = std::move(done)](const swift::zone::SendMessageResult& r) {
+                                      if (!done) return;
+                                      SendMessageResult result;
+                                      result.success = r.success;
+                                      result.msg_id = r.msg_id;
+                                      result.timestamp = r.timestamp;
+                                      result.error = r.error;
+                                      result.duplicate = r.duplicate;
+                                      done(result);
+                                  });
+}
+
 ChatSystem::OfflineResult ChatSystem::PullOffline(const std::string& user_id,
                                                   int32_t limit,
                                                   const std::string& cursor,
@@ -108,6 +134,16 @@ bool ChatSystem::MarkRead(const std::string& user_id, const std::string& chat_id
     return rpc_client_->MarkRead(user_id, chat_id, chat_type, last_msg_id, out_error, token);
 }
 
+void ChatSystem::MarkReadAsync(const std::string& user_id, const std::string& chat_id,
+                               int32_t chat_type, const std::string& last_msg_id,
+                               const std::string& token, MarkReadCallback done) {
+    if (!rpc_client_) {
+        if (done) done(false, "ChatSystem not available");
+        return;
+    }
+    rpc_client_->MarkReadAsync(user_id, chat_id, chat_type, last_msg_id, token, std::move(done));
+}
+
 ChatSystem::GetHistoryResult ChatSystem::GetHistory(const std::string& user_id,
                                                      const std::string& chat_id,
                                                      int32_t chat_type,
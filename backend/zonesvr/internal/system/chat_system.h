@@ -49,6 +49,7 @@ public:
         std::string msg_id;
         int64_t timestamp = 0;
         std::string error;
+        bool duplicate = false;  // client_msg_id 重试：返回的是首次结果，不应再次推送
     };
     SendMessageResult SendMessage(const std::string& from_user_id, const std::string& to_id,
                                   int32_t chat_type, const std::string& content,
@@ -58,6 +59,16 @@ public:
                                   const std::string& client_msg_id = "", int64_t file_size = 0,
                                   const std::string& token = "");
 
+    /// SendMessage 的异步版本：立即返回，done 在 gRPC 回调线程上调用一次（其中不得阻塞）
+    using SendMessageCallback = std::function<void(const SendMessageResult&)>;
+    void SendMessageAsync(const std::string& from_user_id, const std::string& to_id,
+                          int32_t chat_type, const std::string& content,
+                          const std::string& media_url, const std::string& media_type,
+                          const std::vector<std::string>& mentions,
+                          const std::string& reply_to_msg_id,
+                          const std::string& client_msg_id, int64_t file_size,
+                          const std::string& token, SendMessageCallback done);
+
     /// 撤回消息 → ChatSvr.RecallMessage
     bool RecallMessage(const std::string& msg_id, const std::string& user_id, std::string* out_error,
                        const std::string& token = "");
@@ -88,6 +99,11 @@ public:
                   const std::string& last_msg_id, std::string* out_error,
                   const std::string& token = "");
 
+    /// MarkRead 的异步版本；失败时 error 非空
+    using MarkReadCallback = std::function<void(bool ok, const std::string& error)>;
+    void MarkReadAsync(const std::string& user_id, const std::string& chat_id, int32_t chat_type,
+                       const std::string& last_msg_id, const std::string& token, MarkReadCallback done);
+
     /// 会话历史 → ChatSvr.GetHistory
     struct GetHistoryResult {
         bool success = false;
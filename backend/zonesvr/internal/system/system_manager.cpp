@@ -24,7 +24,15 @@ SystemManager::~SystemManager() {
 bool SystemManager::Init(const ZoneConfig& config) {
     // 1. 创建 SessionStore（所有 System 共享）
     if (config.session_store_type == "redis") {
-        session_store_ = std::make_shared<RedisSessionStore>(config.redis_url);
+        RedisPoolOptions pool;
+        pool.size = config.redis_pool_size;
+        pool.checkout_timeout_ms = config.redis_pool_checkout_timeout_ms;
+        pool.connect_timeout_ms = config.redis_connect_timeout_ms;
+        pool.command_timeout_ms = config.redis_command_timeout_ms;
+        pool.reconnect_backoff_min_ms = config.redis_reconnect_backoff_min_ms;
+        pool.reconnect_backoff_max_ms = config.redis_reconnect_backoff_max_ms;
+        pool.health_check_interval_ms = config.redis_health_check_interval_ms;
+        session_store_ = std::make_shared<RedisSessionStore>(config.redis_url, pool);
     } else {
         session_store_ = std::make_shared<MemorySessionStore>();
     }
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+GateSvr WebSocket I/O 线程扩展性基准
+
+依次以 io_threads=1,2,4,8（可配）启动 gatesvr，用多进程客户端测量：
+  - 建连吞吐：TCP 连接 + WebSocket 握手（/ws）完成数 / 秒
+  - 消息吞吐：heartbeat 请求-响应往返数 / 秒（heartbeat 由 Gate 本地处理，不依赖 ZoneSvr）
+
+用法示例：
+  python3 scripts/gate_io_benchmark.py --gatesvr-bin build/backend/gatesvr/gatesvr \\
+      --threads 1,2,4,8 --connections 4000 --messages 50 --reuse-port
+"""
+
+import argparse
+import base64
+import multiprocessing as mp
+import os
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+
+DEFAULT_WS_PORT = 19090
+DEFAULT_GRPC_PORT = 19091
+
+
+def encode_client_message(cmd, request_id):
+    """手工编码 gate.ClientMessage{cmd=1, payload=2, request_id=3}（仅字符串字段，长度 < 128）"""
+    c = cmd.encode()
+    r = request_id.encode()
+    return bytes([0x0A, len(c)]) + c + bytes([0x1A, len(r)]) + r
+
+
+def ws_frame(payload):
+    """客户端二进制帧（FIN + opcode=2，带掩码）"""
+    mask = os.urandom(4)
+    n = len(payload)
+    if n < 126:
+        header = struct.pack("!BB", 0x82, 0x80 | n)
+    else:
+        header = struct.pack("!BBH", 0x82, 0x80 | 126, n)
+    masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    return header + mask + masked
+
+
+def recv_exact(sock, n):
+    buf = b""
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            raise ConnectionError("closed")
+        buf += chunk
+    return buf
+
+
+def recv_frame(sock):
+    b0, b1 = recv_exact(sock, 2)
+    n = b1 & 0x7F
+    if n == 126:
+        n = struct.unpack("!H", recv_exact(sock, 2))[0]
+    elif n == 127:
+        n = struct.unpack("!Q", recv_exact(sock, 8))[0]
+    return recv_exact(sock, n)
+
+
+def ws_connect(host, port):
+    sock = socket.create_connection((host, port), timeout=10)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    key = base64.b64encode(os.urandom(16)).decode()
+    req = (f"GET /ws HTTP/1.1\r\nHost: {host}:{port}\r\nUpgrade: websocket\r\n"
+           f"Connection: Upgrade\r\nSec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n")
+    sock.sendall(req.encode())
+    resp = b""
+    while b"\r\n\r\n" not in resp:
+        chunk = sock.recv(1024)
+        if not chunk:
+            raise ConnectionError("handshake closed")
+        resp += chunk
+    if b" 101 " not in resp.split(b"\r\n", 1)[0]:
+        raise ConnectionError("handshake rejected")
+    return sock
+
+
+def client_worker(host, port, num_conns, num_messages, barrier, out_q):
+    """单个客户端进程：先全部建连（阶段 1），再逐轮对所有连接发 heartbeat 并收齐响应（阶段 2）"""
+    socks = []
+    failed = 0
+    barrier.wait()
+    t0 = time.perf_counter()
+    for _ in range(num_conns):
+        try:
+            socks.append(ws_connect(host, port))
+        except OSError:
+            failed += 1
+    connect_secs = time.perf_counter() - t0
+
+    barrier.wait()
+    ok = 0
+    t1 = time.perf_counter()
+    for i in range(num_messages):
+        frame = ws_frame(encode_client_message("heartbeat", f"r{i}"))
+        alive = []
+        for s in socks:
+            try:
+                s.sendall(frame)
+                alive.append(s)
+            except OSError:
+                pass
+        for s in alive:
+            try:
+                recv_frame(s)
+                ok += 1
+            except (OSError, ConnectionError):
+                pass
+    message_secs = time.perf_counter() - t1
+    for s in socks:
+        s.close()
+    out_q.put((len(socks), failed, connect_secs, ok, message_secs))
+
+
+def wait_port(host, port, timeout):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        try:
+            socket.create_connection((host, port), timeout=1).close()
+            return True
+        except OSError:
+            time.sleep(0.2)
+    return False
+
+
+def run_once(args, io_threads):
+    conf_dir = tempfile.mkdtemp(prefix="gate_bench_")
+    conf = os.path.join(conf_dir, "gatesvr.conf")
+    with open(conf, "w") as f:
+        f.write(f"host={args.host}\nwebsocket_port={args.port}\ngrpc_port={args.grpc_port}\n"
+                f"zone_svr_addr=\nio_threads={io_threads}\n"
+                f"io_reuse_port={'true' if args.reuse_port else 'false'}\n"
+                f"io_cpu_affinity={'true' if args.cpu_affinity else 'false'}\n"
+                f"max_connections={args.connections * 2}\nheartbeat_timeout_seconds=600\n"
+                f"log_dir={conf_dir}\nlog_level=ERROR\n")
+    proc = subprocess.Popen([args.gatesvr_bin, conf], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        if not wait_port(args.host, args.port, 60):
+            raise RuntimeError("gatesvr did not start listening")
+        procs = args.procs
+        per_proc = max(1, args.connections // procs)
+        barrier = mp.Barrier(procs)
+        out_q = mp.Queue()
+        workers = [mp.Process(target=client_worker,
+                              args=(args.host, args.port, per_proc, args.messages, barrier, out_q))
+                   for _ in range(procs)]
+        for w in workers:
+            w.start()
+        results = [out_q.get() for _ in workers]
+        for w in workers:
+            w.join()
+    finally:
+        proc.terminate()
+        proc.wait(timeout=10)
+    conns = sum(r[0] for r in results)
+    failed = sum(r[1] for r in results)
+    msgs = sum(r[3] for r in results)
+    connect_secs = max(r[2] for r in results) or 1e-9
+    message_secs = max(r[4] for r in results) or 1e-9
+    return conns, failed, conns / connect_secs, msgs / message_secs
+
+
+def main():
+    parser = argparse.ArgumentParser(description="GateSvr io_threads scalability benchmark")
+    parser.add_argument("--gatesvr-bin", default="build/backend/gatesvr/gatesvr")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=DEFAULT_WS_PORT)
+    parser.add_argument("--grpc-port", type=int, default=DEFAULT_GRPC_PORT)
+    parser.add_argument("--threads", default="1,2,4,8", help="逗号分隔的 io_threads 取值")
+    parser.add_argument("--connections", type=int, default=2000)
+    parser.add_argument("--messages", type=int, default=50, help="每连接 heartbeat 往返次数")
+    parser.add_argument("--procs", type=int, default=os.cpu_count() or 4, help="客户端进程数")
+    parser.add_argument("--reuse-port", action="store_true", help="每线程独立 io_context + SO_REUSEPORT")
+    parser.add_argument("--cpu-affinity", action="store_true", help="I/O 线程绑核")
+    args = parser.parse_args()
+
+    print(f"{'io_threads':>10} {'conns':>8} {'failed':>7} {'conns/s':>12} {'msgs/s':>12}")
+    for t in [int(x) for x in args.threads.split(",") if x.strip()]:
+        conns, failed, cps, mps = run_once(args, t)
+        print(f"{t:>10} {conns:>8} {failed:>7} {cps:>12.0f} {mps:>12.0f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+GateSvr permessage-deflate 参数评估基准
+
+按 RFC 7692 的方式（raw deflate + Z_SYNC_FLUSH，去掉尾部 00 00 ff ff）压缩与线上格式一致的
+ServerMessage 帧，对比不同 ws_deflate_* 取值下的：
+  - 线上字节：WebSocket 帧头 + （压缩后）负载
+  - CPU：每条消息的压缩耗时（process_time）
+  - 每连接压缩内存估算：zlib deflate 状态 (1 << (window_bits + 2)) + (1 << (mem_level + 9))
+
+负载为手工编码的 protobuf（字段号与 zone.proto 一致）：
+  chat.pull_offline   ChatPullOfflineResponsePayload（默认 100 条消息）
+  chat.get_history    ChatGetHistoryResponsePayload（默认 50 条）
+  chat.sync_conversations ChatSyncConversationsResponsePayload（默认 30 个会话）
+  chat.new_message    单条推送（小消息，观察 min_size 阈值的作用）
+
+用法示例：
+  python3 scripts/ws_deflate_benchmark.py --rounds 200
+  python3 scripts/ws_deflate_benchmark.py --levels 1,6,9 --window-bits 10,15
+"""
+
+import argparse
+import random
+import string
+import time
+import zlib
+
+SYNC_TAIL = b"\x00\x00\xff\xff"
+
+
+# ---------------------------------------------------------------------------
+# protobuf 手工编码（仅用到 varint / length-delimited）
+# ---------------------------------------------------------------------------
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def f_bytes(field, data):
+    if isinstance(data, str):
+        data = data.encode()
+    if not data:
+        return b""
+    return varint((field << 3) | 2) + varint(len(data)) + data
+
+
+def f_int(field, n):
+    if not n:
+        return b""
+    return varint(field << 3) + varint(n)
+
+
+def server_message(cmd, payload, request_id=""):
+    return f_bytes(1, cmd) + f_bytes(2, payload) + f_bytes(3, request_id)
+
+
+# ---------------------------------------------------------------------------
+# 负载生成
+# ---------------------------------------------------------------------------
+
+PHRASES = [
+    "好的，我晚点看一下", "收到", "明天上午十点开会，记得带上周报", "哈哈哈哈",
+    "这个需求下周能上线吗？", "[图片]", "ok, let's sync after lunch",
+    "I pushed the fix to the release branch", "辛苦了", "文档已经更新到群文件里了",
+    "有人知道测试环境的账号吗", "👍", "等我五分钟", "The build is green again",
+]
+
+
+def short_id(rng, prefix, n=16):
+    return prefix + "".join(rng.choice(string.ascii_lowercase + string.digits) for _ in range(n))
+
+
+def chat_message(rng, users, chat_id, chat_type, ts):
+    content = " ".join(rng.choice(PHRASES) for _ in range(rng.randint(1, 3)))
+    media = rng.random() < 0.1
+    return (f_bytes(1, short_id(rng, "m_"))
+            + f_bytes(2, rng.choice(users))
+            + f_bytes(3, chat_id)
+            + f_int(4, chat_type)
+            + f_bytes(5, content)
+            + f_bytes(6, f"https://files.example.com/{short_id(rng, 'f_', 24)}.jpg" if media else "")
+            + f_bytes(7, "image" if media else "")
+            + f_int(8, ts))
+
+
+def build_payloads(rng, users, offline, history, conversations, ts):
+    """生成一组（各命令一条）帧；同一连接上的连续帧内容各不相同，避免高估上下文复用的收益"""
+    group = short_id(rng, "g_", 12)
+
+    def msgs(count):
+        return b"".join(f_bytes(1, chat_message(rng, users, group, 2, ts + i * 1000)) for i in range(count))
+
+    pull_offline = server_message("chat.pull_offline",
+                                  msgs(offline) + f_bytes(2, short_id(rng, "c_")) + f_int(3, 1), "r1")
+    get_history = server_message("chat.get_history", msgs(history) + f_int(2, 1), "r2")
+    convs = b""
+    for i in range(conversations):
+        conv = (f_bytes(1, short_id(rng, "g_", 12)) + f_int(2, rng.choice([1, 2]))
+                + f_bytes(3, rng.choice(users)) + f_bytes(4, "测试群 %d" % i)
+                + f_bytes(5, f"https://files.example.com/avatar/{short_id(rng, 'a_', 16)}.png")
+                + f_int(6, rng.randint(0, 99)) + f_int(7, ts + i)
+                + f_bytes(8, short_id(rng, "m_")) + f_bytes(9, rng.choice(PHRASES)) + f_int(10, ts + i))
+        convs += f_bytes(1, conv)
+    sync_conversations = server_message("chat.sync_conversations", convs, "r3")
+    new_message = server_message("chat.new_message", chat_message(rng, users, group, 2, ts))
+    return [
+        ("chat.pull_offline", pull_offline),
+        ("chat.get_history", get_history),
+        ("chat.sync_conversations", sync_conversations),
+        ("chat.new_message", new_message),
+    ]
+
+
+# ---------------------------------------------------------------------------
+# permessage-deflate 模拟
+# ---------------------------------------------------------------------------
+
+def ws_header_len(n):
+    return 2 if n < 126 else (4 if n < 65536 else 10)
+
+
+class Deflater:
+    """一个连接方向上的压缩上下文；no_context_takeover 时每条消息重建"""
+
+    def __init__(self, level, window_bits, mem_level, context_takeover):
+        self.args = (level, zlib.DEFLATED, -window_bits, mem_level)
+        self.context_takeover = context_takeover
+        self.obj = zlib.compressobj(*self.args)
+
+    def compress(self, data):
+        if not self.context_takeover:
+            self.obj = zlib.compressobj(*self.args)
+        out = self.obj.compress(data) + self.obj.flush(zlib.Z_SYNC_FLUSH)
+        if out.endswith(SYNC_TAIL):
+            out = out[:-4]
+        return out
+
+
+def run_case(frames, level, window_bits, mem_level, context_takeover, min_size):
+    d = Deflater(level, window_bits, mem_level, context_takeover)
+    wire = 0
+    t0 = time.process_time()
+    for payload in frames:
+        if len(payload) < min_size:
+            body = len(payload)
+        else:
+            body = len(d.compress(payload))
+        wire += ws_header_len(body) + body
+    cpu = time.process_time() - t0
+    return wire / len(frames), cpu / len(frames) * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description="permessage-deflate bytes-on-wire / CPU benchmark")
+    parser.add_argument("--rounds", type=int, default=200, help="每种负载在同一连接上发送的条数（内容各不相同）")
+    parser.add_argument("--levels", default="1,6,9")
+    parser.add_argument("--window-bits", default="10,15")
+    parser.add_argument("--mem-level", type=int, default=4)
+    parser.add_argument("--min-size", type=int, default=256)
+    parser.add_argument("--offline", type=int, default=100)
+    parser.add_argument("--history", type=int, default=50)
+    parser.add_argument("--conversations", type=int, default=30)
+    parser.add_argument("--seed", type=int, default=42)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    users = [short_id(rng, "u_", 12) for _ in range(20)]
+    frames = {}
+    for r in range(args.rounds):
+        for name, payload in build_payloads(rng, users, args.offline, args.history,
+                                            args.conversations, 1760000000000 + r * 60000):
+            frames.setdefault(name, []).append(payload)
+    levels = [int(x) for x in args.levels.split(",") if x.strip()]
+    wbits = [int(x) for x in args.window_bits.split(",") if x.strip()]
+
+    print(f"{'cmd':<24} {'raw':>7} {'level':>5} {'wbits':>5} {'ctx':>4} "
+          f"{'wire':>8} {'ratio':>6} {'us/msg':>8} {'mem/conn':>9}")
+    for name, batch in frames.items():
+        raw = sum(ws_header_len(len(p)) + len(p) for p in batch) / len(batch)
+        print(f"{name:<24} {raw:>7.0f} {'-':>5} {'-':>5} {'-':>4} {raw:>8.0f} {1.0:>6.2f} {0.0:>8.1f} {'-':>9}")
+        for level in levels:
+            for wb in wbits:
+                for ctx in (True, False):
+                    wire, us = run_case(batch, level, wb, args.mem_level, ctx, args.min_size)
+                    mem = (1 << (wb + 2)) + (1 << (args.mem_level + 9))
+                    print(f"{'':<24} {'':>7} {level:>5} {wb:>5} {'on' if ctx else 'off':>4} "
+                          f"{wire:>8.0f} {raw / wire:>6.2f} {us:>8.1f} {mem // 1024:>8}K")
+
+
+if __name__ == "__main__":
+    main()